@@ -0,0 +1,107 @@
+// measures set_piece_hashes() throughput through the sequential reader and
+// hasher thread pool, and through the disk I/O subsystem, on a generated
+// data set
+//
+// usage: bench_create_torrent [total-MiB] [file-MiB] [piece-KiB]
+//
+// for a cold cache run, drop the page cache between the two passes
+
+#include "libtorrent/create_torrent.hpp"
+#include "libtorrent/entry.hpp"
+#include "libtorrent/file_storage.hpp"
+#include "libtorrent/session.hpp" // for default_disk_io_constructor
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/aux_/path.hpp"
+#include "libtorrent/time.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	std::string const data_dir = "bench_create_torrent_data";
+
+	void make_data_set(std::int64_t const total, std::int64_t const file_size)
+	{
+		error_code ec;
+		create_directories(combine_path(data_dir, "set"), ec);
+		std::mt19937 rng(0x5eed);
+		std::vector<char> buf(1024 * 1024);
+		int file = 0;
+		for (std::int64_t written = 0; written < total; ++file)
+		{
+			std::string const name = combine_path(combine_path(data_dir, "set")
+				, "file-" + std::to_string(file));
+			FILE* f = std::fopen(name.c_str(), "wb");
+			if (f == nullptr) { std::perror("fopen"); std::exit(1); }
+			std::int64_t const size = std::min(file_size, total - written);
+			for (std::int64_t left = size; left > 0;)
+			{
+				for (auto& c : buf) c = char(rng());
+				std::size_t const n = std::size_t(std::min(left, std::int64_t(buf.size())));
+				std::fwrite(buf.data(), 1, n, f);
+				left -= std::int64_t(n);
+			}
+			std::fclose(f);
+			written += size;
+		}
+	}
+
+	template <typename Fun>
+	double seconds_for(Fun f)
+	{
+		time_point const start = clock_type::now();
+		f();
+		return double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+	}
+}
+
+int main(int argc, char const* argv[])
+{
+	std::int64_t const total = (argc > 1 ? std::atoll(argv[1]) : 2048) * 1024 * 1024;
+	std::int64_t const file_size = (argc > 2 ? std::atoll(argv[2]) : 64) * 1024 * 1024;
+	int const piece_size = (argc > 3 ? std::atoi(argv[3]) : 1024) * 1024;
+	int const threads = argc > 4 ? std::atoi(argv[4])
+		: std::max(1, int(std::thread::hardware_concurrency()));
+
+	make_data_set(total, file_size);
+
+	file_storage fs;
+	add_files(fs, combine_path(data_dir, "set"));
+	create_torrent sequential(fs, piece_size);
+	create_torrent disk_io(fs, piece_size);
+
+	settings_pack pack;
+	pack.set_int(settings_pack::hashing_threads, threads);
+	error_code ec;
+	double const seq = seconds_for([&] {
+		set_piece_hashes(sequential, data_dir, pack, aux::nop, ec);
+	});
+	if (ec) { std::printf("error: %s\n", ec.message().c_str()); return 1; }
+	std::printf("sequential reader: %.2f s, %.0f MiB/s\n"
+		, seq, double(total) / 1024 / 1024 / seq);
+
+	double const dio = seconds_for([&] {
+		set_piece_hashes(disk_io, data_dir, pack, default_disk_io_constructor
+			, aux::nop, ec);
+	});
+	if (ec) { std::printf("error: %s\n", ec.message().c_str()); return 1; }
+	std::printf("disk I/O subsystem: %.2f s, %.0f MiB/s\n"
+		, dio, double(total) / 1024 / 1024 / dio);
+
+	if (sequential.generate()["info"]["pieces"] != disk_io.generate()["info"]["pieces"])
+	{
+		std::printf("piece hashes differ\n");
+		return 1;
+	}
+
+	remove_all(data_dir, ec);
+	return 0;
+}
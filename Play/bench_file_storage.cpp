@@ -0,0 +1,159 @@
+// measures file_storage construction time, memory footprint and map_block()
+// latency for a torrent with many small files spread over many directories
+//
+// usage: bench_file_storage [num-files] [files-per-directory] [num-lookups]
+
+#include "libtorrent/file_storage.hpp"
+#include "libtorrent/time.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	// every allocation is prefixed by its size, to keep track of the number
+	// of bytes and blocks currently allocated
+	std::atomic<std::int64_t> g_allocated{0};
+	std::atomic<std::int64_t> g_blocks{0};
+	std::size_t const header = alignof(std::max_align_t);
+
+	template <typename Fun>
+	double seconds_for(Fun f)
+	{
+		time_point const start = clock_type::now();
+		f();
+		return double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+	}
+
+	struct file_spec
+	{
+		std::string path;
+		std::int64_t size;
+	};
+
+	std::vector<file_spec> make_files(int const num_files, int const per_dir
+		, std::mt19937& rng)
+	{
+		std::vector<file_spec> ret;
+		ret.reserve(std::size_t(num_files));
+		char buf[200];
+		for (int i = 0; i < num_files; ++i)
+		{
+			int const dir = i / per_dir;
+			std::snprintf(buf, sizeof(buf), "dataset/shard-%03d/group-%04d/sample-%06d.bin"
+				, dir / 1000, dir % 1000, i);
+			// mostly small files, with the occasional large one
+			std::int64_t const size = (rng() % 64 == 0)
+				? std::int64_t(rng() % (64 * 1024 * 1024))
+				: std::int64_t(rng() % (256 * 1024));
+			ret.push_back({buf, size});
+		}
+		return ret;
+	}
+}
+
+void* operator new(std::size_t const size)
+{
+	void* p = std::malloc(size + header);
+	if (p == nullptr) throw std::bad_alloc();
+	*static_cast<std::size_t*>(p) = size;
+	g_allocated += std::int64_t(size);
+	++g_blocks;
+	return static_cast<char*>(p) + header;
+}
+
+void operator delete(void* p) noexcept
+{
+	if (p == nullptr) return;
+	char* const base = static_cast<char*>(p) - header;
+	g_allocated -= std::int64_t(*reinterpret_cast<std::size_t*>(base));
+	--g_blocks;
+	std::free(base);
+}
+
+void* operator new[](std::size_t const size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+int main(int argc, char const* argv[])
+{
+	int const num_files = argc > 1 ? std::atoi(argv[1]) : 500000;
+	int const per_dir = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+	int const num_lookups = argc > 3 ? std::atoi(argv[3]) : 2000000;
+
+	std::mt19937 rng(0x5eed);
+	auto const files = make_files(num_files, per_dir, rng);
+
+	// add_file() copies the file names, like create_torrent does
+	std::int64_t const before = g_allocated;
+	std::int64_t const before_blocks = g_blocks;
+	file_storage fs;
+	double const construct = seconds_for([&] {
+		for (auto const& f : files) fs.add_file(f.path, f.size);
+	});
+	fs.set_piece_length(256 * 1024);
+	fs.set_num_pieces(aux::calc_num_pieces(fs));
+	std::int64_t const owned = g_allocated - before;
+	std::int64_t const owned_blocks = g_blocks - before_blocks;
+
+	std::printf("%d files in %d directories\n", fs.num_files()
+		, int(fs.paths().size()));
+	std::printf("add_file(): %.3f s, %.1f MiB (%.1f bytes/file) in %" PRId64 " allocations\n"
+		, construct, double(owned) / 1024 / 1024, double(owned) / num_files, owned_blocks);
+
+	// add_file_borrow() is what loading a .torrent file does, the file
+	// names point into the info section
+	std::int64_t const before_borrow = g_allocated;
+	file_storage borrowed;
+	double const construct_borrow = seconds_for([&] {
+		for (auto const& f : files)
+		{
+			auto const slash = f.path.rfind('/');
+			borrowed.add_file_borrow(string_view(f.path).substr(slash + 1)
+				, f.path, f.size);
+		}
+	});
+	std::int64_t const borrow = g_allocated - before_borrow;
+	std::printf("add_file_borrow(): %.3f s, %.1f MiB (%.1f bytes/file)\n"
+		, construct_borrow, double(borrow) / 1024 / 1024, double(borrow) / num_files);
+
+	double const copy = seconds_for([&] {
+		file_storage const c(fs);
+		if (c.num_files() != fs.num_files()) std::abort();
+	});
+	std::printf("copy: %.3f s\n", copy);
+
+	std::vector<piece_index_t> pieces;
+	pieces.reserve(std::size_t(num_lookups));
+	for (int i = 0; i < num_lookups; ++i)
+		pieces.push_back(piece_index_t(int(rng() % std::uint32_t(fs.num_pieces() - 1))));
+
+	std::int64_t slices = 0;
+	double const map = seconds_for([&] {
+		for (auto const p : pieces)
+			slices += std::int64_t(fs.map_block(p, 0, default_block_size).size());
+	});
+	std::printf("map_block(): %.0f ns (%.2f slices per block)\n"
+		, map * 1e9 / num_lookups, double(slices) / num_lookups);
+
+	std::int64_t hits = 0;
+	double const at_offset = seconds_for([&] {
+		for (auto const p : pieces)
+			hits += static_cast<int>(fs.file_index_at_piece(p));
+	});
+	std::printf("file_index_at_offset(): %.0f ns (%" PRId64 ")\n"
+		, at_offset * 1e9 / num_lookups, hits);
+
+	return 0;
+}
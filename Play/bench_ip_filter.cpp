@@ -0,0 +1,100 @@
+// measures ip_filter load time, lookup throughput and memory footprint for a
+// block list of random IPv4 ranges
+//
+// usage: bench_ip_filter [num-ranges] [num-lookups]
+
+#include "libtorrent/ip_filter.hpp"
+#include "libtorrent/address.hpp"
+#include "libtorrent/time.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	std::vector<ip_range<address_v4>> random_ranges(int const count, std::mt19937& rng)
+	{
+		std::vector<ip_range<address_v4>> ret;
+		ret.reserve(std::size_t(count));
+		for (int i = 0; i < count; ++i)
+		{
+			std::uint32_t const first = std::uint32_t(rng());
+			std::uint32_t const size = std::uint32_t(rng() % 4096);
+			std::uint32_t const last = first + size < first ? 0xffffffff : first + size;
+			ret.push_back({address_v4(first), address_v4(last), ip_filter::blocked});
+		}
+		return ret;
+	}
+
+	template <typename Fun>
+	double seconds_for(Fun f)
+	{
+		time_point const start = clock_type::now();
+		f();
+		return double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+	}
+}
+
+int main(int argc, char const* argv[])
+{
+	int const num_ranges = argc > 1 ? std::atoi(argv[1]) : 500000;
+	int const num_lookups = argc > 2 ? std::atoi(argv[2]) : 10000000;
+
+	std::mt19937 rng(0x5eed);
+	auto const ranges = random_ranges(num_ranges, rng);
+
+	std::vector<ip_range<address_v4::bytes_type>> rules;
+	rules.reserve(ranges.size());
+	for (auto const& r : ranges)
+		rules.push_back({r.first.to_bytes(), r.last.to_bytes(), r.flags});
+
+	aux::filter_impl<address_v4::bytes_type> f;
+	double const load = seconds_for([&] { f.add_rules(rules); });
+
+	auto const exported = f.export_filter<address_v4>();
+	std::printf("%d rules -> %d ranges, add_rules(): %.3f s\n"
+		, num_ranges, int(exported.size()), load);
+
+	// reloading from the exported (sorted, non-overlapping) ranges is the
+	// path taken when restoring session state
+	ip_filter reload;
+	double const reload_time = seconds_for([&] { reload.add_rules(exported); });
+	std::printf("reload of %d exported ranges: %.3f s\n"
+		, int(exported.size()), reload_time);
+
+	// block lists are usually sorted, in which case add_rule() appends
+	aux::filter_impl<address_v4::bytes_type> incremental;
+	double const one_by_one = seconds_for([&] {
+		for (auto const& r : exported)
+			incremental.add_rule(r.first.to_bytes(), r.last.to_bytes(), r.flags);
+	});
+	std::printf("add_rule() of %d sorted ranges: %.3f s\n"
+		, int(exported.size()), one_by_one);
+
+	std::size_t const flat = f.memory_usage();
+	// a std::set node carries three pointers and a color on top of the
+	// element, rounded up to the allocation granularity
+	std::size_t const tree = exported.size() * ((sizeof(void*) * 4
+		+ sizeof(address_v4::bytes_type) + sizeof(std::uint32_t) + 15) & ~std::size_t(15));
+	std::printf("memory: %.1f kiB (std::set estimate: %.1f kiB)\n"
+		, double(flat) / 1024.0, double(tree) / 1024.0);
+
+	std::vector<address_v4::bytes_type> addrs;
+	addrs.reserve(std::size_t(num_lookups));
+	for (int i = 0; i < num_lookups; ++i)
+		addrs.push_back(address_v4(std::uint32_t(rng())).to_bytes());
+
+	std::uint32_t blocked = 0;
+	double const lookup = seconds_for([&] {
+		for (auto const& a : addrs) blocked += f.access(a);
+	});
+	std::printf("lookups: %.2f M/s (%u blocked)\n"
+		, num_lookups / lookup / 1000000.0, blocked);
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+// measures the time from an announce asking for its tracker's address to the
+// address being available, for a session starting up with many trackers.
+// Lookups are answered by a stand-in for the DNS server that takes a fixed
+// time per query
+//
+// usage: bench_resolver [num-hosts] [lookup-ms]
+
+#include "libtorrent/aux_/resolver.hpp"
+#include "libtorrent/io_context.hpp"
+#include "libtorrent/time.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	std::atomic<int> g_queries{0};
+
+	aux::resolver::lookup_function stand_in(int const lookup_ms)
+	{
+		return [lookup_ms](std::string const&, std::vector<address>& ips)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(lookup_ms));
+			++g_queries;
+			ips.push_back(make_address_v4("127.0.0.1"));
+			return error_code();
+		};
+	}
+
+	std::vector<std::string> make_hosts(int const num_hosts)
+	{
+		std::vector<std::string> ret;
+		for (int i = 0; i < num_hosts; ++i)
+			ret.push_back("tracker" + std::to_string(i) + ".example.com");
+		return ret;
+	}
+
+	// starts one announce per host and prints how long each had to wait
+	// for its address
+	void announce_all(char const* label, io_context& ios, aux::resolver& r
+		, std::vector<std::string> const& hosts)
+	{
+		std::vector<double> wait;
+		int const queries = g_queries;
+		time_point const start = clock_type::now();
+		for (auto const& h : hosts)
+		{
+			r.async_resolve(h, aux::resolver_interface::abort_on_shutdown
+				, [&, start](error_code const&, std::vector<address> const&)
+				{ wait.push_back(double(total_microseconds(clock_type::now() - start)) / 1000.0); });
+		}
+		while (wait.size() < hosts.size()) ios.run_one();
+
+		std::sort(wait.begin(), wait.end());
+		std::printf("%-28s median: %8.2f ms  max: %8.2f ms  queries: %d\n"
+			, label, wait[wait.size() / 2], wait.back(), g_queries - queries);
+	}
+
+	// the lookup threads post their results, keep the io_context from
+	// running out of work while they're busy, like the session's does
+	struct fixture
+	{
+		explicit fixture(int const lookup_ms, int const concurrency)
+		{
+			r.set_lookup_function(stand_in(lookup_ms));
+			r.set_max_concurrency(concurrency);
+		}
+		io_context ios;
+		boost::asio::executor_work_guard<io_context::executor_type> work
+			= boost::asio::make_work_guard(ios);
+		aux::resolver r{ios};
+	};
+}
+
+int main(int argc, char const* argv[])
+{
+	int const num_hosts = argc > 1 ? std::atoi(argv[1]) : 200;
+	int const lookup_ms = argc > 2 ? std::atoi(argv[2]) : 50;
+	auto const hosts = make_hosts(num_hosts);
+
+	std::printf("%d tracker hosts, %d ms per lookup\n", num_hosts, lookup_ms);
+
+	// cold start, every announce waits for its own lookup
+	for (int const concurrency : {1, 4, 16, 64})
+	{
+		fixture f(lookup_ms, concurrency);
+		char label[50];
+		std::snprintf(label, sizeof(label), "cold, %d parallel:", concurrency);
+		announce_all(label, f.ios, f.r, hosts);
+	}
+
+	// the hosts are prefetched when the torrents are loaded, and resolved
+	// by the time the first announce goes out
+	{
+		fixture f(lookup_ms, 4);
+		int const queries = g_queries;
+		for (auto const& h : hosts) f.r.prefetch(h);
+		while (g_queries - queries < num_hosts) f.ios.run_for(milliseconds(10));
+		f.ios.run_for(milliseconds(10));
+		announce_all("prefetched, 4 parallel:", f.ios, f.r, hosts);
+	}
+
+	// re-announces after the cache entries would have timed out. The
+	// entries in use are refreshed in the background before then
+	{
+		fixture f(lookup_ms, 16);
+		f.r.set_cache_timeout(seconds(4));
+		announce_all("first announce:", f.ios, f.r, hosts);
+		f.ios.run_for(seconds(5));
+		announce_all("re-announce after timeout:", f.ios, f.r, hosts);
+	}
+
+	return 0;
+}
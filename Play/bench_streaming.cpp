@@ -0,0 +1,419 @@
+// streams media sized files from a seed to a downloader, two sessions in
+// this process talking over loopback, and replays a playback trace against
+// the downloader the way the bt demuxer drives it: every piece at low
+// priority and sequential download, a window of pieces ahead of the playhead
+// at top priority, and every piece in the window read with read_piece() once
+// it's downloaded. The playhead only moves over pieces that have been read.
+// In ``window`` mode the torrent is in torrent_flags::sequential_window mode
+// instead, with its window cursor following the playhead and all pieces at
+// the default priority.
+// Reported are:
+//
+// * time to first piece: from the start of playback until the piece under
+//   the playhead has been read
+// * rebuffers: how many times, and for how long in total, the playhead
+//   reached a piece that wasn't read yet
+// * seek to data: from a seek, or a switch to the next file, until the piece
+//   under the new playhead has been read
+// * wasted bytes: payload downloaded beyond the pieces the playhead went over
+//
+// The link rate is the seed's upload rate limit. To add latency and loss,
+// add them to the loopback interface, e.g.
+//
+//   tc qdisc add dev lo root netem delay 25ms loss 1%
+//
+// A trace has one command per line:
+//
+//   play <seconds>   play this many seconds of media
+//   seek <percent>   seek to this position in the playing file
+//   next             switch to the start of the next file
+//
+// usage: bench_streaming [trace-file|-] [file-MiB] [files] [piece-KiB]
+//        [media-kbit/s] [link-kbit/s] [window-pieces] [priority|window]
+
+#include "libtorrent/alert_types.hpp"
+#include "libtorrent/bencode.hpp"
+#include "libtorrent/create_torrent.hpp"
+#include "libtorrent/file_storage.hpp"
+#include "libtorrent/session.hpp"
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/time.hpp"
+#include "libtorrent/torrent_handle.hpp"
+#include "libtorrent/torrent_info.hpp"
+#include "libtorrent/torrent_status.hpp"
+#include "libtorrent/aux_/path.hpp"
+
+#include "settings.hpp"
+#include "setup_transfer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	std::string const seed_dir = "tmp1_streaming";
+	std::string const download_dir = "tmp2_streaming";
+
+	// give up on a piece after this long, the swarm is stuck
+	time_duration const give_up = seconds(120);
+
+	struct command
+	{
+		std::string op;
+		double arg;
+	};
+
+	std::vector<command> default_trace()
+	{
+		return {
+			{"play", 20}, {"seek", 60}, {"play", 10}, {"seek", 20}, {"play", 10}
+			, {"next", 0}, {"play", 15}
+		};
+	}
+
+	std::vector<command> load_trace(char const* path)
+	{
+		std::vector<command> ret;
+		std::ifstream in(path);
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream l(line);
+			command c{"", 0};
+			if (!(l >> c.op) || c.op[0] == '#') continue;
+			l >> c.arg;
+			ret.push_back(c);
+		}
+		return ret;
+	}
+
+	std::shared_ptr<torrent_info> make_media_torrent(int const files
+		, std::int64_t const file_size, int const piece_size)
+	{
+		error_code ec;
+		file_storage fs;
+		create_directories(combine_path(seed_dir, "media"), ec);
+		std::vector<char> buf(1024 * 1024);
+		for (int i = 0; i < files; ++i)
+		{
+			// random data, it's as incompressible as media
+			std::string const name = combine_path("media", "episode-" + std::to_string(i) + ".mkv");
+			std::ofstream f(combine_path(seed_dir, name).c_str(), std::ios::binary);
+			for (std::int64_t left = file_size; left > 0;)
+			{
+				for (auto& c : buf) c = char(std::rand());
+				std::size_t const n = std::size_t(std::min(left, std::int64_t(buf.size())));
+				f.write(buf.data(), std::streamsize(n));
+				left -= std::int64_t(n);
+			}
+			fs.add_file(name, file_size);
+		}
+
+		lt::create_torrent ct(fs, piece_size);
+		set_piece_hashes(ct, seed_dir, ec);
+		if (ec)
+		{
+			std::printf("set_piece_hashes: %s\n", ec.message().c_str());
+			std::exit(1);
+		}
+		std::vector<char> torrent;
+		bencode(std::back_inserter(torrent), ct.generate());
+		return std::make_shared<torrent_info>(torrent, from_span);
+	}
+
+	double ms_since(time_point const t)
+	{
+		return double(total_microseconds(clock_type::now() - t)) / 1000.0;
+	}
+
+	struct player
+	{
+		player(session& s, torrent_handle h, int const window, std::int64_t const rate
+			, bool const window_mode)
+			: m_ses(s), m_handle(std::move(h)), m_ti(m_handle.torrent_file())
+			, m_window(window), m_rate(rate), m_window_mode(window_mode) {}
+
+		void start()
+		{
+			m_file = file_index_t(0);
+			m_pos = m_ti->files().file_offset(m_file);
+			wait("first piece");
+		}
+
+		void play(double const media_seconds)
+		{
+			double left = media_seconds * double(m_rate);
+			time_point last = clock_type::now();
+			while (left > 0)
+			{
+				pump(milliseconds(10));
+				time_point const now = clock_type::now();
+				double budget = double(m_rate) * double(total_microseconds(now - last)) / 1000000.0;
+				last = now;
+
+				while (budget > 0 && left > 0)
+				{
+					piece_index_t const p = piece();
+					if (m_ready.count(p) == 0) break;
+					std::int64_t const piece_end = std::min(file_end()
+						, std::int64_t(static_cast<int>(p) + 1) * m_ti->piece_length());
+					double const n = std::min({budget, left, double(piece_end - m_pos)});
+					m_pos += std::int64_t(n);
+					budget -= n;
+					left -= n;
+					m_played.insert(p);
+					// the end of the file, the player stops
+					if (m_pos >= file_end()) return;
+				}
+				if (left <= 0) break;
+
+				if (m_ready.count(piece()) == 0)
+				{
+					++rebuffers;
+					time_point const start = clock_type::now();
+					if (!wait(nullptr)) return;
+					rebuffer_ms += ms_since(start);
+					last = clock_type::now();
+				}
+			}
+		}
+
+		void seek(double const percent)
+		{
+			std::int64_t const size = m_ti->files().file_size(m_file);
+			move_to(m_ti->files().file_offset(m_file) + std::int64_t(double(size) * percent / 100));
+			wait("seek");
+		}
+
+		void next()
+		{
+			if (static_cast<int>(m_file) + 1 >= m_ti->num_files()) return;
+			++m_file;
+			move_to(m_ti->files().file_offset(m_file));
+			wait("next");
+		}
+
+		double first_piece_ms = 0;
+		int rebuffers = 0;
+		double rebuffer_ms = 0;
+		std::vector<double> seek_ms;
+
+		std::int64_t played_bytes() const
+		{
+			std::int64_t ret = 0;
+			for (auto const p : m_played) ret += m_ti->piece_size(p);
+			return ret;
+		}
+
+	private:
+
+		piece_index_t piece() const
+		{ return piece_index_t(int(m_pos / m_ti->piece_length())); }
+
+		std::int64_t file_end() const
+		{ return m_ti->files().file_offset(m_file) + m_ti->files().file_size(m_file); }
+
+		piece_index_t last_piece() const
+		{ return piece_index_t(int((file_end() - 1) / m_ti->piece_length())); }
+
+		// like the demuxer, pieces read for the old position are dropped
+		// and the old window goes back to low priority
+		void move_to(std::int64_t const pos)
+		{
+			for (auto const p : m_window_pieces)
+			{
+				if (!m_handle.have_piece(p) && m_handle.piece_priority(p) == top_priority)
+					m_handle.piece_priority(p, low_priority);
+			}
+			m_window_pieces.clear();
+			m_ready.clear();
+			m_pos = pos;
+		}
+
+		// top priority for the window ahead of the playhead, and read the
+		// pieces in it that are downloaded
+		void update_window()
+		{
+			piece_index_t const first = piece();
+			if (m_window_mode && first != m_cursor)
+			{
+				m_handle.set_window_cursor(first);
+				m_cursor = first;
+			}
+			piece_index_t const last = std::min(last_piece()
+				, piece_index_t(static_cast<int>(first) + m_window - 1));
+			for (piece_index_t p = first; p <= last; ++p)
+			{
+				if (m_ready.count(p) || m_reading.count(p)) continue;
+				if (m_handle.have_piece(p))
+				{
+					m_handle.read_piece(p, torrent_handle::playback);
+					m_reading.insert(p);
+				}
+				else if (!m_window_mode && m_window_pieces.insert(p).second)
+				{
+					m_handle.piece_priority(p, top_priority);
+				}
+			}
+		}
+
+		void pump(time_duration const max_wait)
+		{
+			update_window();
+			m_ses.wait_for_alert(max_wait);
+			std::vector<alert*> alerts;
+			m_ses.pop_alerts(&alerts);
+			for (alert const* a : alerts)
+			{
+				if (auto const* rp = alert_cast<read_piece_alert>(a))
+				{
+					m_reading.erase(rp->piece);
+					piece_index_t const first = piece();
+					if (!rp->error && rp->piece >= first
+						&& rp->piece < piece_index_t(static_cast<int>(first) + m_window))
+					{
+						m_ready.insert(rp->piece);
+					}
+				}
+			}
+		}
+
+		// until the piece under the playhead has been read. With a label,
+		// it's reported as a seek (or as the first piece)
+		bool wait(char const* label)
+		{
+			time_point const start = clock_type::now();
+			while (m_ready.count(piece()) == 0)
+			{
+				if (clock_type::now() - start > give_up)
+				{
+					std::printf("gave up waiting for piece %d\n", static_cast<int>(piece()));
+					return false;
+				}
+				pump(milliseconds(10));
+			}
+			if (label == nullptr) return true;
+
+			double const ms = ms_since(start);
+			std::printf("%-12s file %d at %5.1f %%: %8.1f ms\n", label
+				, static_cast<int>(m_file)
+				, double(m_pos - m_ti->files().file_offset(m_file)) * 100
+					/ double(m_ti->files().file_size(m_file))
+				, ms);
+			if (std::string(label) == "first piece") first_piece_ms = ms;
+			else seek_ms.push_back(ms);
+			return true;
+		}
+
+		session& m_ses;
+		torrent_handle m_handle;
+		std::shared_ptr<torrent_info const> m_ti;
+		int m_window;
+		std::int64_t m_rate;
+		bool m_window_mode;
+		piece_index_t m_cursor{-1};
+
+		file_index_t m_file{0};
+		std::int64_t m_pos = 0;
+		std::set<piece_index_t> m_window_pieces;
+		std::set<piece_index_t> m_reading;
+		std::set<piece_index_t> m_ready;
+		std::set<piece_index_t> m_played;
+	};
+}
+
+int main(int argc, char const* argv[])
+{
+	std::vector<command> const trace = (argc > 1 && std::string(argv[1]) != "-")
+		? load_trace(argv[1]) : default_trace();
+	std::int64_t const file_size = (argc > 2 ? std::atoll(argv[2]) : 64) * 1024 * 1024;
+	int const files = argc > 3 ? std::atoi(argv[3]) : 3;
+	int const piece_size = (argc > 4 ? std::atoi(argv[4]) : 256) * 1024;
+	std::int64_t const media_rate = (argc > 5 ? std::atoll(argv[5]) : 4000) * 1000 / 8;
+	int const link_rate = (argc > 6 ? std::atoi(argv[6]) : 16000) * 1000 / 8;
+	int const window = argc > 7 ? std::atoi(argv[7]) : 3;
+	bool const window_mode = argc > 8 && std::string(argv[8]) == "window";
+
+	std::printf("%d files of %d MiB, %d kiB pieces, media %d kbit/s, link %d kbit/s, window %d pieces, %s mode\n"
+		, files, int(file_size / 1024 / 1024), piece_size / 1024
+		, int(media_rate * 8 / 1000), link_rate * 8 / 1000, window
+		, window_mode ? "window" : "priority");
+
+	error_code ec;
+	remove_all(seed_dir, ec);
+	remove_all(download_dir, ec);
+	std::shared_ptr<torrent_info> ti = make_media_torrent(files, file_size, piece_size);
+
+	settings_pack pack = settings();
+	pack.set_int(settings_pack::alert_mask, alert_category::error
+		| alert_category::status | alert_category::storage);
+	pack.set_str(settings_pack::listen_interfaces, "127.0.0.1:0");
+	pack.set_bool(settings_pack::enable_upnp, false);
+	pack.set_bool(settings_pack::enable_natpmp, false);
+	pack.set_int(settings_pack::aio_threads, 4);
+	pack.set_int(settings_pack::hashing_threads, 2);
+	session seed(pack);
+	session downloader(pack);
+
+	settings_pack limit;
+	limit.set_int(settings_pack::upload_rate_limit, link_rate);
+	seed.apply_settings(limit);
+
+	// both sessions get these, the seed ignores the priorities
+	add_torrent_params p;
+	p.flags &= ~torrent_flags::paused;
+	p.flags &= ~torrent_flags::auto_managed;
+	if (window_mode)
+	{
+		p.flags |= torrent_flags::sequential_window;
+	}
+	else
+	{
+		p.flags |= torrent_flags::sequential_download;
+		p.piece_priorities.assign(std::size_t(ti->num_pieces()), low_priority);
+	}
+
+	torrent_handle h;
+	std::tie(std::ignore, h, std::ignore) = setup_transfer(&seed, &downloader, nullptr
+		, false, false, true, "_streaming", piece_size, &ti, false, &p);
+
+	player pl(downloader, h, window, media_rate, window_mode);
+	time_point const start = clock_type::now();
+	pl.start();
+	for (auto const& c : trace)
+	{
+		if (c.op == "play") pl.play(c.arg);
+		else if (c.op == "seek") pl.seek(c.arg);
+		else if (c.op == "next") pl.next();
+		else std::printf("unknown command: %s\n", c.op.c_str());
+	}
+	double const elapsed = ms_since(start) / 1000.0;
+
+	std::int64_t const downloaded = h.status().total_payload_download;
+	std::vector<double> seeks = pl.seek_ms;
+	std::sort(seeks.begin(), seeks.end());
+
+	std::printf("\nran %.1f s\n", elapsed);
+	std::printf("time to first piece: %8.1f ms\n", pl.first_piece_ms);
+	std::printf("rebuffers:           %8d, %.1f ms total\n", pl.rebuffers, pl.rebuffer_ms);
+	std::printf("seek to data:        %8.1f ms median, %.1f ms max (%d seeks)\n"
+		, seeks.empty() ? 0.0 : seeks[seeks.size() / 2]
+		, seeks.empty() ? 0.0 : seeks.back(), int(seeks.size()));
+	std::printf("downloaded:          %8.1f MiB, played %.1f MiB, wasted %.1f MiB\n"
+		, double(downloaded) / 1024 / 1024, double(pl.played_bytes()) / 1024 / 1024
+		, double(std::max(std::int64_t(0), downloaded - pl.played_bytes())) / 1024 / 1024);
+
+	remove_all(seed_dir, ec);
+	remove_all(download_dir, ec);
+	return 0;
+}
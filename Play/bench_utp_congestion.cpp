@@ -0,0 +1,294 @@
+// runs uTP transfers over a simulated bottleneck link, within the process,
+// and reports the throughput, the queuing delay at the bottleneck and the
+// packet loss for each congestion controller, with and without pacing.
+// The flows start a few seconds apart, to show how a latecomer shares the
+// link with the flows already running
+//
+// usage: bench_utp_congestion [seconds] [num-flows] [kbit/s] [one-way-delay-ms]
+//     [queue-kB] [random-loss-percent]
+
+#include "libtorrent/aux_/utp_socket_manager.hpp"
+#include "libtorrent/aux_/utp_stream.hpp"
+#include "libtorrent/aux_/session_settings.hpp"
+#include "libtorrent/aux_/socket_type.hpp"
+#include "libtorrent/deadline_timer.hpp"
+#include "libtorrent/io_context.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/time.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace lt;
+using lt::aux::utp_socket_manager;
+using lt::aux::utp_stream;
+
+namespace
+{
+	struct sim_socket : aux::utp_socket_interface
+	{
+		explicit sim_socket(udp::endpoint const& ep) : m_ep(ep) {}
+		udp::endpoint get_local_endpoint() override { return m_ep; }
+	private:
+		udp::endpoint m_ep;
+	};
+
+	struct link_config
+	{
+		// bytes per second
+		std::int64_t rate;
+		time_duration delay;
+		int queue_size;
+		double random_loss;
+	};
+
+	// a link with a drop-tail queue in front of it. Packets are delivered to
+	// the socket manager on the other end after they've been serialized
+	// at the link rate and the propagation delay has passed
+	struct link
+	{
+		link(io_context& ios, link_config const& cfg, std::mt19937& rng)
+			: m_timer(ios), m_cfg(cfg), m_rng(rng) {}
+
+		void connect(utp_socket_manager* dst, std::weak_ptr<aux::utp_socket_interface> sock
+			, udp::endpoint const& from)
+		{
+			m_dst = dst;
+			m_sock = std::move(sock);
+			m_from = from;
+		}
+
+		void send(span<char const> buf)
+		{
+			time_point const now = clock_type::now();
+			if (m_busy_until < now) m_busy_until = now;
+			std::int64_t const backlog = total_microseconds(m_busy_until - now)
+				* m_cfg.rate / 1000000;
+
+			++packets;
+			if (backlog + buf.size() > m_cfg.queue_size
+				|| std::uniform_real_distribution<double>(0, 1)(m_rng) < m_cfg.random_loss)
+			{
+				++dropped;
+				return;
+			}
+
+			queue_delay_us.push_back(total_microseconds(m_busy_until - now));
+			m_busy_until += microseconds(buf.size() * 1000000 / m_cfg.rate);
+			m_in_flight.push_back({m_busy_until + m_cfg.delay, {buf.begin(), buf.end()}});
+			if (m_in_flight.size() == 1) arm();
+		}
+
+		std::int64_t packets = 0;
+		std::int64_t dropped = 0;
+		std::vector<std::int64_t> queue_delay_us;
+
+	private:
+
+		void arm()
+		{
+			m_timer.expires_at(m_in_flight.front().deliver_at);
+			m_timer.async_wait([this](error_code const& ec)
+			{
+				if (ec) return;
+				time_point const now = clock_type::now();
+				while (!m_in_flight.empty() && m_in_flight.front().deliver_at <= now)
+				{
+					auto const p = std::move(m_in_flight.front());
+					m_in_flight.pop_front();
+					m_dst->incoming_packet(m_sock, m_from, p.buf);
+				}
+				m_dst->socket_drained();
+				if (!m_in_flight.empty()) arm();
+			});
+		}
+
+		struct packet
+		{
+			time_point deliver_at;
+			std::vector<char> buf;
+		};
+
+		deadline_timer m_timer;
+		link_config m_cfg;
+		std::mt19937& m_rng;
+		std::deque<packet> m_in_flight;
+		time_point m_busy_until = clock_type::now();
+		utp_socket_manager* m_dst = nullptr;
+		std::weak_ptr<aux::utp_socket_interface> m_sock;
+		udp::endpoint m_from;
+	};
+
+	struct flow
+	{
+		explicit flow(io_context& ios) : sender(ios), buf(1024 * 1024, 'x') {}
+
+		void write()
+		{
+			sender.async_write_some(boost::asio::buffer(buf)
+				, [this](error_code const& ec, std::size_t) { if (!ec) write(); });
+		}
+
+		void read()
+		{
+			boost::get<utp_stream>(*receiver).async_read_some(boost::asio::buffer(rbuf)
+				, [this](error_code const& ec, std::size_t const n)
+			{
+				if (ec) return;
+				received += std::int64_t(n);
+				read();
+			});
+		}
+
+		utp_stream sender;
+		std::unique_ptr<aux::socket_type> receiver;
+		std::vector<char> buf;
+		std::vector<char> rbuf = std::vector<char>(1024 * 1024);
+		std::int64_t received = 0;
+	};
+
+	void run(char const* label, int const algorithm, bool const pacing
+		, int const duration, int const num_flows, link_config const& cfg)
+	{
+		io_context ios;
+		std::mt19937 rng(0x5eed);
+		counters cnt;
+		aux::session_settings sett;
+		sett.set_int(settings_pack::utp_congestion_control, algorithm);
+		sett.set_bool(settings_pack::utp_pacing, pacing);
+		sett.set_int(settings_pack::utp_target_delay
+			, algorithm == settings_pack::ledbat_plus_plus ? 60 : 100);
+
+		udp::endpoint const sender_ep(make_address_v4("10.0.0.1"), 6881);
+		udp::endpoint const receiver_ep(make_address_v4("10.0.0.2"), 6881);
+		auto const sender_sock = std::make_shared<sim_socket>(sender_ep);
+		auto const receiver_sock = std::make_shared<sim_socket>(receiver_ep);
+
+		// the bottleneck is on the data path, ACKs only see the delay
+		link_config ack_cfg = cfg;
+		ack_cfg.rate = 1000 * 1000 * 1000;
+		ack_cfg.queue_size = 1000 * 1000;
+		ack_cfg.random_loss = 0;
+		link forward(ios, cfg, rng);
+		link backward(ios, ack_cfg, rng);
+
+		std::vector<std::unique_ptr<flow>> flows;
+
+		utp_socket_manager sender_sm(
+			[&](std::weak_ptr<aux::utp_socket_interface>, udp::endpoint const&
+				, span<char const> p, error_code&, udp_send_flags_t) { forward.send(p); }
+			, [](aux::socket_type) {}
+			, ios, sett, cnt, nullptr);
+		utp_socket_manager receiver_sm(
+			[&](std::weak_ptr<aux::utp_socket_interface>, udp::endpoint const&
+				, span<char const> p, error_code&, udp_send_flags_t) { backward.send(p); }
+			, [&](aux::socket_type s)
+			{
+				// the flows connect one at a time, the accepted socket is
+				// the newest flow's
+				flows.back()->receiver = std::make_unique<aux::socket_type>(std::move(s));
+				flows.back()->read();
+			}
+			, ios, sett, cnt, nullptr);
+		forward.connect(&receiver_sm, receiver_sock, sender_ep);
+		backward.connect(&sender_sm, sender_sock, receiver_ep);
+
+		deadline_timer tick(ios);
+		std::function<void(error_code const&)> on_tick = [&](error_code const& ec)
+		{
+			if (ec) return;
+			sender_sm.tick(clock_type::now());
+			receiver_sm.tick(clock_type::now());
+			tick.expires_after(milliseconds(100));
+			tick.async_wait(on_tick);
+		};
+		on_tick(error_code());
+
+		// the flows start 3 seconds apart
+		for (int i = 0; i < num_flows; ++i)
+		{
+			flows.emplace_back(new flow(ios));
+			flow& f = *flows.back();
+			f.sender.set_impl(sender_sm.new_utp_socket(&f.sender));
+			f.sender.async_connect(tcp::endpoint(receiver_ep.address(), receiver_ep.port())
+				, [&f](error_code const& ec) { if (!ec) f.write(); });
+			if (i < num_flows - 1) ios.run_for(seconds(3));
+		}
+		time_point const start = clock_type::now();
+		std::vector<std::int64_t> received_at_start;
+		for (auto const& f : flows) received_at_start.push_back(f->received);
+		std::size_t const delay_samples_at_start = forward.queue_delay_us.size();
+		std::int64_t const packets_at_start = forward.packets;
+		std::int64_t const dropped_at_start = forward.dropped;
+
+		ios.run_for(seconds(duration));
+		double const elapsed = double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+
+		// only the time all flows were running is measured
+		std::int64_t total = 0;
+		std::vector<double> rates;
+		for (std::size_t i = 0; i < flows.size(); ++i)
+		{
+			std::int64_t const bytes = flows[i]->received - received_at_start[i];
+			total += bytes;
+			rates.push_back(double(bytes) * 8 / 1000 / elapsed);
+		}
+		std::vector<std::int64_t> delay(forward.queue_delay_us.begin()
+			+ std::ptrdiff_t(delay_samples_at_start), forward.queue_delay_us.end());
+		std::sort(delay.begin(), delay.end());
+		double const mean_delay = delay.empty() ? 0.0
+			: double(std::accumulate(delay.begin(), delay.end(), std::int64_t(0)))
+				/ double(delay.size()) / 1000.0;
+		double const p95_delay = delay.empty() ? 0.0
+			: double(delay[delay.size() * 95 / 100]) / 1000.0;
+		std::int64_t const packets = forward.packets - packets_at_start;
+		std::int64_t const dropped = forward.dropped - dropped_at_start;
+
+		std::printf("%-22s %8.0f kbit/s  queue delay mean: %6.1f ms p95: %6.1f ms  loss: %5.2f %%  flows:"
+			, label, double(total) * 8 / 1000 / elapsed, mean_delay, p95_delay
+			, packets ? double(dropped) * 100 / double(packets) : 0.0);
+		for (double const r : rates) std::printf(" %.0f", r);
+		std::printf("\n");
+
+		// close the sockets and let the handlers run before they go away
+		for (auto const& f : flows)
+		{
+			f->sender.close();
+			if (f->receiver) boost::get<utp_stream>(*f->receiver).close();
+		}
+		ios.run_for(milliseconds(100));
+		flows.clear();
+		sender_sm.tick(clock_type::now());
+		receiver_sm.tick(clock_type::now());
+		tick.cancel();
+	}
+}
+
+int main(int argc, char const* argv[])
+{
+	int const duration = argc > 1 ? std::atoi(argv[1]) : 20;
+	int const num_flows = argc > 2 ? std::max(1, std::atoi(argv[2])) : 2;
+	link_config cfg;
+	cfg.rate = (argc > 3 ? std::atoll(argv[3]) : 10000) * 1000 / 8;
+	cfg.delay = milliseconds(argc > 4 ? std::atoi(argv[4]) : 20);
+	cfg.queue_size = (argc > 5 ? std::atoi(argv[5]) : 150) * 1000;
+	cfg.random_loss = (argc > 6 ? std::atof(argv[6]) : 0.0) / 100.0;
+
+	std::printf("%d flows, %d kbit/s, %d ms one-way delay, %d kB queue, %.1f%% random loss\n"
+		, num_flows, int(cfg.rate * 8 / 1000), int(total_milliseconds(cfg.delay))
+		, cfg.queue_size / 1000, cfg.random_loss * 100);
+
+	run("ledbat", settings_pack::ledbat, false, duration, num_flows, cfg);
+	run("ledbat, paced", settings_pack::ledbat, true, duration, num_flows, cfg);
+	run("ledbat++", settings_pack::ledbat_plus_plus, false, duration, num_flows, cfg);
+	run("ledbat++, paced", settings_pack::ledbat_plus_plus, true, duration, num_flows, cfg);
+	return 0;
+}
@@ -0,0 +1,161 @@
+// measures the time to find the uTP socket an incoming packet belongs to,
+// with the socket index and with the std::multimap keyed by connection ID it
+// replaced. Packets arrive in bursts for the same socket, which the last
+// socket check answers without a lookup
+//
+// usage: bench_utp_lookup [num-sockets] [num-packets] [burst-length]
+
+#include "libtorrent/aux_/utp_socket_index.hpp"
+#include "libtorrent/address.hpp"
+#include "libtorrent/time.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+	// stands in for utp_socket_impl, with the same key and match()
+	struct fake_socket
+	{
+		fake_socket(udp::endpoint const& ep, std::uint16_t const id)
+			: m_remote_address(ep.address()), m_port(ep.port()), m_recv_id(id) {}
+
+		udp::endpoint remote_endpoint() const { return {m_remote_address, m_port}; }
+		std::uint16_t receive_id() const { return m_recv_id; }
+		bool match(udp::endpoint const& ep, std::uint16_t const id) const
+		{
+			return m_recv_id == id
+				&& m_port == ep.port()
+				&& m_remote_address == ep.address();
+		}
+
+		std::int64_t packets = 0;
+
+	private:
+		// keep the sockets about the size of the real ones, so they don't
+		// all share a few cache lines
+		char m_state[1200];
+		address m_remote_address;
+		std::uint16_t m_port;
+		std::uint16_t m_recv_id;
+	};
+
+	struct packet
+	{
+		udp::endpoint ep;
+		std::uint16_t id;
+	};
+
+	template <typename Fun>
+	double seconds_for(Fun f)
+	{
+		time_point const start = clock_type::now();
+		f();
+		return double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+	}
+
+	udp::endpoint random_endpoint(std::mt19937& rng)
+	{
+		if (rng() % 4 == 0)
+		{
+			address_v6::bytes_type b;
+			for (auto& c : b) c = std::uint8_t(rng());
+			b[0] = 0x20;
+			return {address_v6(b), std::uint16_t(rng())};
+		}
+		return {address_v4(std::uint32_t(rng())), std::uint16_t(rng())};
+	}
+}
+
+int main(int argc, char const* argv[])
+{
+	int const num_sockets = argc > 1 ? std::atoi(argv[1]) : 5000;
+	int const num_packets = argc > 2 ? std::atoi(argv[2]) : 10000000;
+	int const burst = argc > 3 ? std::max(1, std::atoi(argv[3])) : 4;
+
+	std::mt19937 rng(0x5eed);
+
+	std::vector<std::unique_ptr<fake_socket>> sockets;
+	std::multimap<std::uint16_t, fake_socket*> map;
+	aux::utp_socket_index<fake_socket> index;
+	for (int i = 0; i < num_sockets; ++i)
+	{
+		// some peers have several connections to us, from the same address
+		udp::endpoint ep = (i > 0 && rng() % 8 == 0)
+			? udp::endpoint(sockets.back()->remote_endpoint().address(), std::uint16_t(rng()))
+			: random_endpoint(rng);
+		sockets.emplace_back(new fake_socket(ep, std::uint16_t(rng())));
+		map.emplace(sockets.back()->receive_id(), sockets.back().get());
+		index.insert(sockets.back().get());
+	}
+
+	std::vector<packet> packets;
+	packets.reserve(std::size_t(num_packets));
+	while (int(packets.size()) < num_packets)
+	{
+		fake_socket const& s = *sockets[rng() % sockets.size()];
+		for (int i = 0; i < burst && int(packets.size()) < num_packets; ++i)
+			packets.push_back({s.remote_endpoint(), s.receive_id()});
+	}
+
+	std::printf("%d sockets, %d packets in bursts of %d\n"
+		, num_sockets, num_packets, burst);
+
+	fake_socket* last = nullptr;
+	double const map_time = seconds_for([&] {
+		for (auto const& p : packets)
+		{
+			if (last && last->match(p.ep, p.id)) { ++last->packets; continue; }
+			auto r = map.equal_range(p.id);
+			for (; r.first != r.second; ++r.first)
+			{
+				if (!r.first->second->match(p.ep, p.id)) continue;
+				last = r.first->second;
+				++last->packets;
+				break;
+			}
+		}
+	});
+	std::printf("std::multimap: %6.1f ns/packet\n", map_time * 1e9 / num_packets);
+
+	last = nullptr;
+	double const index_time = seconds_for([&] {
+		for (auto const& p : packets)
+		{
+			if (last && last->match(p.ep, p.id)) { ++last->packets; continue; }
+			if (fake_socket* s = index.find(p.ep, p.id))
+			{
+				last = s;
+				++last->packets;
+			}
+		}
+	});
+	std::printf("socket index:  %6.1f ns/packet\n", index_time * 1e9 / num_packets);
+
+	std::int64_t total = 0;
+	for (auto const& s : sockets) total += s->packets;
+	if (total != 2 * std::int64_t(num_packets))
+	{
+		std::printf("lost packets: %lld\n", static_cast<long long>(2 * std::int64_t(num_packets) - total));
+		return 1;
+	}
+
+	// connections coming and going
+	double const churn = seconds_for([&] {
+		for (int round = 0; round < 10; ++round)
+		{
+			for (auto const& s : sockets) index.erase(s.get());
+			for (auto const& s : sockets) index.insert(s.get());
+		}
+	});
+	std::printf("erase + insert: %.1f ns/socket\n", churn * 1e9 / (10.0 * num_sockets));
+
+	return 0;
+}
@@ -0,0 +1,327 @@
+// runs uTP transfers over a simulated lossy link, within the process, with
+// and without RACK loss detection and tail loss probes. The link drops and
+// reorders packets according to a seeded model, so the same packets are lost
+// from run to run (as long as the same packets are sent). The scenarios are:
+//
+// * bulk transfers over a link with random loss, bursty (wifi-like) loss and
+//   reordering, reporting the goodput
+// * 16 kB messages written every 250 ms over a link with random loss,
+//   reporting how long each message takes to arrive. A lost packet at the
+//   end of a message has no packets after it to be detected by, it's left
+//   to the tail loss probe or the retransmission timeout
+//
+// usage: bench_utp_loss [seconds] [kbit/s] [one-way-delay-ms] [loss-percent]
+
+#include "libtorrent/aux_/utp_socket_manager.hpp"
+#include "libtorrent/aux_/utp_stream.hpp"
+#include "libtorrent/aux_/session_settings.hpp"
+#include "libtorrent/aux_/socket_type.hpp"
+#include "libtorrent/deadline_timer.hpp"
+#include "libtorrent/io_context.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/time.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace lt;
+using lt::aux::utp_socket_manager;
+using lt::aux::utp_stream;
+
+namespace
+{
+	struct sim_socket : aux::utp_socket_interface
+	{
+		explicit sim_socket(udp::endpoint const& ep) : m_ep(ep) {}
+		udp::endpoint get_local_endpoint() override { return m_ep; }
+	private:
+		udp::endpoint m_ep;
+	};
+
+	struct loss_model
+	{
+		// the probability of a packet being dropped in the good and bad
+		// state, and of moving from one state to the other, per packet.
+		// Random loss has no bad state
+		double good_loss = 0;
+		double bad_loss = 0;
+		double to_bad = 0;
+		double to_good = 1;
+
+		// the probability of a packet being held back, and for how long
+		double reorder = 0;
+		time_duration reorder_delay = milliseconds(0);
+	};
+
+	// a link that serializes packets at its rate, drops and delays them
+	// according to the loss model and delivers them to the socket manager
+	// on the other end after the propagation delay
+	struct link
+	{
+		link(io_context& ios, std::int64_t const rate, time_duration const delay
+			, loss_model const& m, std::uint32_t const seed)
+			: m_timer(ios), m_rate(rate), m_delay(delay), m_model(m), m_rng(seed) {}
+
+		void connect(utp_socket_manager* dst, std::weak_ptr<aux::utp_socket_interface> sock
+			, udp::endpoint const& from)
+		{
+			m_dst = dst;
+			m_sock = std::move(sock);
+			m_from = from;
+		}
+
+		void send(span<char const> buf)
+		{
+			++packets;
+			std::uniform_real_distribution<double> dist(0, 1);
+			m_bad = m_bad ? dist(m_rng) >= m_model.to_good : dist(m_rng) < m_model.to_bad;
+			if (dist(m_rng) < (m_bad ? m_model.bad_loss : m_model.good_loss))
+			{
+				++dropped;
+				return;
+			}
+
+			time_point const now = clock_type::now();
+			if (m_busy_until < now) m_busy_until = now;
+			m_busy_until += microseconds(buf.size() * 1000000 / m_rate);
+			time_point deliver_at = m_busy_until + m_delay;
+			if (dist(m_rng) < m_model.reorder) deliver_at += m_model.reorder_delay;
+
+			bool const first = m_in_flight.empty() || deliver_at < m_in_flight.begin()->first;
+			m_in_flight.emplace(deliver_at, std::vector<char>(buf.begin(), buf.end()));
+			if (first) arm();
+		}
+
+		std::int64_t packets = 0;
+		std::int64_t dropped = 0;
+
+	private:
+
+		void arm()
+		{
+			m_timer.expires_at(m_in_flight.begin()->first);
+			m_timer.async_wait([this](error_code const& ec)
+			{
+				if (ec) return;
+				time_point const now = clock_type::now();
+				while (!m_in_flight.empty() && m_in_flight.begin()->first <= now)
+				{
+					auto const buf = std::move(m_in_flight.begin()->second);
+					m_in_flight.erase(m_in_flight.begin());
+					m_dst->incoming_packet(m_sock, m_from, buf);
+				}
+				m_dst->socket_drained();
+				if (!m_in_flight.empty()) arm();
+			});
+		}
+
+		deadline_timer m_timer;
+		std::int64_t m_rate;
+		time_duration m_delay;
+		loss_model m_model;
+		std::mt19937 m_rng;
+		bool m_bad = false;
+		std::multimap<time_point, std::vector<char>> m_in_flight;
+		time_point m_busy_until = clock_type::now();
+		utp_socket_manager* m_dst = nullptr;
+		std::weak_ptr<aux::utp_socket_interface> m_sock;
+		udp::endpoint m_from;
+	};
+
+	// a transfer in one direction. With a message size, the sender writes
+	// a message every interval, otherwise it keeps the socket's send buffer
+	// full
+	struct flow
+	{
+		flow(io_context& ios, int const msg_size)
+			: sender(ios), timer(ios), message_size(msg_size)
+			, buf(msg_size > 0 ? std::size_t(msg_size) : 1024 * 1024, 'x') {}
+
+		void write()
+		{
+			sender.async_write_some(boost::asio::buffer(buf)
+				, [this](error_code const& ec, std::size_t) { if (!ec) write(); });
+		}
+
+		void write_message()
+		{
+			sent_at.push_back(clock_type::now());
+			boost::asio::async_write(sender, boost::asio::buffer(buf)
+				, [](error_code const&, std::size_t) {});
+			timer.expires_after(milliseconds(250));
+			timer.async_wait([this](error_code const& ec) { if (!ec) write_message(); });
+		}
+
+		void read()
+		{
+			boost::get<utp_stream>(*receiver).async_read_some(boost::asio::buffer(rbuf)
+				, [this](error_code const& ec, std::size_t const n)
+			{
+				if (ec) return;
+				received += std::int64_t(n);
+				while (message_size > 0
+					&& received >= std::int64_t(latency_ms.size() + 1) * message_size)
+				{
+					latency_ms.push_back(double(total_microseconds(clock_type::now()
+						- sent_at[latency_ms.size()])) / 1000.0);
+				}
+				read();
+			});
+		}
+
+		utp_stream sender;
+		std::unique_ptr<aux::socket_type> receiver;
+		deadline_timer timer;
+		int message_size;
+		std::vector<char> buf;
+		std::vector<char> rbuf = std::vector<char>(1024 * 1024);
+		std::int64_t received = 0;
+		std::vector<time_point> sent_at;
+		std::vector<double> latency_ms;
+	};
+
+	struct link_config
+	{
+		std::int64_t rate;
+		time_duration delay;
+		int duration;
+	};
+
+	void run(char const* label, bool const rack, loss_model const& model
+		, link_config const& cfg, int const message_size)
+	{
+		io_context ios;
+		counters cnt;
+		aux::session_settings sett;
+		sett.set_bool(settings_pack::utp_rack, rack);
+
+		udp::endpoint const sender_ep(make_address_v4("10.0.0.1"), 6881);
+		udp::endpoint const receiver_ep(make_address_v4("10.0.0.2"), 6881);
+		auto const sender_sock = std::make_shared<sim_socket>(sender_ep);
+		auto const receiver_sock = std::make_shared<sim_socket>(receiver_ep);
+
+		// the loss is on the data path, ACKs are only delayed
+		link forward(ios, cfg.rate, cfg.delay, model, 0x5eed);
+		link backward(ios, 1000 * 1000 * 1000, cfg.delay, loss_model(), 0x5eed);
+
+		auto f = std::make_unique<flow>(ios, message_size);
+
+		utp_socket_manager sender_sm(
+			[&](std::weak_ptr<aux::utp_socket_interface>, udp::endpoint const&
+				, span<char const> p, error_code&, udp_send_flags_t) { forward.send(p); }
+			, [](aux::socket_type) {}
+			, ios, sett, cnt, nullptr);
+		utp_socket_manager receiver_sm(
+			[&](std::weak_ptr<aux::utp_socket_interface>, udp::endpoint const&
+				, span<char const> p, error_code&, udp_send_flags_t) { backward.send(p); }
+			, [&](aux::socket_type s)
+			{
+				f->receiver = std::make_unique<aux::socket_type>(std::move(s));
+				f->read();
+			}
+			, ios, sett, cnt, nullptr);
+		forward.connect(&receiver_sm, receiver_sock, sender_ep);
+		backward.connect(&sender_sm, sender_sock, receiver_ep);
+
+		// the session ticks the socket manager every 500 ms
+		deadline_timer tick(ios);
+		std::function<void(error_code const&)> on_tick = [&](error_code const& ec)
+		{
+			if (ec) return;
+			sender_sm.tick(clock_type::now());
+			receiver_sm.tick(clock_type::now());
+			tick.expires_after(milliseconds(500));
+			tick.async_wait(on_tick);
+		};
+		on_tick(error_code());
+
+		f->sender.set_impl(sender_sm.new_utp_socket(&f->sender));
+		f->sender.async_connect(tcp::endpoint(receiver_ep.address(), receiver_ep.port())
+			, [&](error_code const& ec)
+			{
+				if (ec) return;
+				if (f->message_size > 0) f->write_message();
+				else f->write();
+			});
+
+		time_point const start = clock_type::now();
+		ios.run_for(seconds(cfg.duration));
+		double const elapsed = double(total_microseconds(clock_type::now() - start)) / 1000000.0;
+
+		std::printf("%-28s %-5s", label, rack ? "rack" : "dup");
+		if (message_size > 0)
+		{
+			std::vector<double> lat = f->latency_ms;
+			std::sort(lat.begin(), lat.end());
+			std::printf(" messages: %4d median: %6.1f ms p95: %6.1f ms max: %6.1f ms"
+				, int(lat.size())
+				, lat.empty() ? 0.0 : lat[lat.size() / 2]
+				, lat.empty() ? 0.0 : lat[lat.size() * 95 / 100]
+				, lat.empty() ? 0.0 : lat.back());
+		}
+		else
+		{
+			std::printf(" %8.0f kbit/s", double(f->received) * 8 / 1000 / elapsed);
+		}
+		std::printf("  loss: %4.1f %%  resent: %5d timeouts: %3d spurious: %4d probes: %3d\n"
+			, forward.packets ? double(forward.dropped) * 100 / double(forward.packets) : 0.0
+			, int(cnt[counters::utp_packet_resend]), int(cnt[counters::utp_timeout])
+			, int(cnt[counters::utp_spurious_retransmit])
+			, int(cnt[counters::utp_tail_loss_probe]));
+
+		// close the sockets and let the handlers run before they go away
+		f->timer.cancel();
+		f->sender.close();
+		if (f->receiver) boost::get<utp_stream>(*f->receiver).close();
+		ios.run_for(milliseconds(100));
+		f.reset();
+		sender_sm.tick(clock_type::now());
+		receiver_sm.tick(clock_type::now());
+		tick.cancel();
+	}
+}
+
+int main(int argc, char const* argv[])
+{
+	link_config cfg;
+	cfg.duration = argc > 1 ? std::atoi(argv[1]) : 10;
+	cfg.rate = (argc > 2 ? std::atoll(argv[2]) : 20000) * 1000 / 8;
+	cfg.delay = milliseconds(argc > 3 ? std::atoi(argv[3]) : 25);
+	double const loss = (argc > 4 ? std::atof(argv[4]) : 2.0) / 100.0;
+
+	std::printf("%d s, %d kbit/s, %d ms one-way delay, %.1f%% loss\n"
+		, cfg.duration, int(cfg.rate * 8 / 1000), int(total_milliseconds(cfg.delay))
+		, loss * 100);
+
+	loss_model random;
+	random.good_loss = loss;
+
+	// a wifi link in a bad spot. Mostly fine, with bursts where over half
+	// the packets are lost. The same average loss as the random model
+	loss_model bursty;
+	bursty.bad_loss = 0.6;
+	bursty.to_good = 0.2;
+	bursty.to_bad = loss / bursty.bad_loss * bursty.to_good;
+
+	// no loss, but packets overtaking each other
+	loss_model reordering;
+	reordering.reorder = 0.05;
+	reordering.reorder_delay = cfg.delay / 2;
+
+	for (bool const rack : {false, true})
+		run("bulk, random loss:", rack, random, cfg, 0);
+	for (bool const rack : {false, true})
+		run("bulk, bursty loss:", rack, bursty, cfg, 0);
+	for (bool const rack : {false, true})
+		run("bulk, reordering:", rack, reordering, cfg, 0);
+	for (bool const rack : {false, true})
+		run("16 kB messages, random loss:", rack, random, cfg, 16 * 1024);
+	return 0;
+}
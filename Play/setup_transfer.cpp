@@ -808,32 +808,21 @@ std::shared_ptr<lt::torrent_info> make_torrent(span<const int> const file_sizes
 	return make_torrent(fs);
 }
 
-// std::shared_ptr<lt::torrent_info> make_torrent(lt::file_storage& fs)
-// {
-// 	lt::create_torrent ct(fs, fs.piece_length());
-
-// 	for (auto const i : fs.piece_range())
-// 	{
-// 		std::vector<char> piece = generate_piece(i, fs.piece_size(i));
-// 		ct.set_hash(i, hasher(piece).final());
-
-// 		// aux::vector<sha256_hash> tree(merkle_num_nodes(fs.piece_length() / default_block_size));
-
-// 		int const blocks_per_piece = fs.piece_length() / default_block_size;
-// 		for (int j = 0; j < int(piece.size()); j += default_block_size)
-// 		{
-// 			tree[tree.end_index() - blocks_per_piece + j / default_block_size]
-// 				= hasher256(piece.data() + j, std::min(default_block_size, int(piece.size()) - j)).final();
-// 		}
-// 		// merkle_fill_tree(tree, fs.piece_length() / default_block_size);
-// 		file_index_t const f(fs.file_index_at_piece(i));
-// 		// ct.set_hash2(f, i - fs.piece_index_at_file(f), tree[0]);
-// 	}
-
-// 	std::vector<char> buf;
-// 	bencode(std::back_inserter(buf), ct.generate());
-// 	return std::make_shared<torrent_info>(buf, from_span);
-// }
+// v1 hashes only, this tree doesn't build v2 torrents
+std::shared_ptr<lt::torrent_info> make_torrent(lt::file_storage& fs)
+{
+	lt::create_torrent ct(fs, fs.piece_length());
+
+	for (auto const i : fs.piece_range())
+	{
+		std::vector<char> piece = generate_piece(i, fs.piece_size(i));
+		ct.set_hash(i, hasher(piece).final());
+	}
+
+	std::vector<char> buf;
+	bencode(std::back_inserter(buf), ct.generate());
+	return std::make_shared<torrent_info>(buf, from_span);
+}
 
 void create_random_files(std::string const& path, span<const int> file_sizes
 	, file_storage* fs)
@@ -0,0 +1,143 @@
+/* Gst-Bt - BitTorrent related GStreamer elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gst_bt_buffer_pool.hpp"
+
+G_DEFINE_TYPE (GstBtBufferPool, gst_bt_buffer_pool, GST_TYPE_BUFFER_POOL);
+
+static GstFlowReturn
+gst_bt_buffer_pool_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn ret;
+
+  ret = GST_BUFFER_POOL_CLASS (gst_bt_buffer_pool_parent_class)->alloc_buffer (
+      pool, buffer, params);
+  if (ret == GST_FLOW_OK)
+  {
+    g_atomic_int_inc (&GST_BT_BUFFER_POOL (pool)->allocated);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_bt_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn ret;
+
+  ret = GST_BUFFER_POOL_CLASS (gst_bt_buffer_pool_parent_class)->acquire_buffer (
+      pool, buffer, params);
+  if (ret == GST_FLOW_OK)
+  {
+    g_atomic_int_inc (&GST_BT_BUFFER_POOL (pool)->acquired);
+    g_atomic_int_inc (&GST_BT_BUFFER_POOL (pool)->outstanding);
+  }
+
+  return ret;
+}
+
+static void
+gst_bt_buffer_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  g_atomic_int_add (&GST_BT_BUFFER_POOL (pool)->outstanding, -1);
+
+  GST_BUFFER_POOL_CLASS (gst_bt_buffer_pool_parent_class)->release_buffer (
+      pool, buffer);
+}
+
+static void
+gst_bt_buffer_pool_class_init (GstBtBufferPoolClass * klass)
+{
+  GstBufferPoolClass *pool_class;
+
+  pool_class = (GstBufferPoolClass *) klass;
+
+  pool_class->alloc_buffer = gst_bt_buffer_pool_alloc_buffer;
+  pool_class->acquire_buffer = gst_bt_buffer_pool_acquire_buffer;
+  pool_class->release_buffer = gst_bt_buffer_pool_release_buffer;
+}
+
+static void
+gst_bt_buffer_pool_init (GstBtBufferPool * thiz)
+{
+  thiz->allocated = 0;
+  thiz->acquired = 0;
+  thiz->outstanding = 0;
+}
+
+GstBufferPool *
+gst_bt_buffer_pool_new (guint size, guint min_buffers)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+
+  pool = GST_BUFFER_POOL (g_object_new (GST_TYPE_BT_BUFFER_POOL, NULL));
+  gst_object_ref_sink (pool);
+
+  //no maximum, a read_piece() call must not wait for the decoder to give a buffer back
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, min_buffers, 0);
+  if (!gst_buffer_pool_set_config (pool, config) ||
+      !gst_buffer_pool_set_active (pool, TRUE))
+  {
+    gst_object_unref (pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+//unmaps and gives the buffer back to the pool when the last shared_array referring to it goes away
+struct GstBtBufferPoolPieceRelease
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  void operator() (char *)
+  {
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+};
+
+boost::shared_array<char>
+gst_bt_buffer_pool_acquire_piece (GstBufferPool * pool)
+{
+  GstBufferPoolAcquireParams params = GstBufferPoolAcquireParams ();
+  GstBtBufferPoolPieceRelease release;
+
+  if (pool == NULL)
+  {
+    return boost::shared_array<char> ();
+  }
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  if (gst_buffer_pool_acquire_buffer (pool, &release.buffer, &params) != GST_FLOW_OK)
+  {
+    return boost::shared_array<char> ();
+  }
+
+  if (!gst_buffer_map (release.buffer, &release.map, GST_MAP_WRITE))
+  {
+    gst_buffer_unref (release.buffer);
+    return boost::shared_array<char> ();
+  }
+
+  return boost::shared_array<char> ((char *) release.map.data, release);
+}
@@ -0,0 +1,65 @@
+/* Gst-Bt - BitTorrent related GStreamer elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GST_BT_BUFFER_POOL_H
+#define GST_BT_BUFFER_POOL_H
+
+#include <gst/gst.h>
+
+#include <boost/shared_array.hpp>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_BT_BUFFER_POOL            (gst_bt_buffer_pool_get_type())
+#define GST_BT_BUFFER_POOL(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj),\
+                                               GST_TYPE_BT_BUFFER_POOL, GstBtBufferPool))
+#define GST_IS_BT_BUFFER_POOL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj),\
+                                               GST_TYPE_BT_BUFFER_POOL))
+
+/* piece sized buffers for libtorrent to read pieces into. A piece read into
+ * one goes downstream in the same memory, and the buffer comes back to the
+ * pool once the decoder and the read_piece_alert are done with it */
+typedef struct _GstBtBufferPool
+{
+  GstBufferPool parent;
+
+  /* buffers the pool allocated memory for */
+  gint allocated;
+  /* buffers handed out, new or recycled */
+  gint acquired;
+  /* buffers handed out and not released yet */
+  gint outstanding;
+} GstBtBufferPool;
+
+typedef struct _GstBtBufferPoolClass
+{
+  GstBufferPoolClass parent_class;
+} GstBtBufferPoolClass;
+
+GType gst_bt_buffer_pool_get_type (void);
+
+/* an active pool of buffers of size bytes, with min_buffers allocated up
+ * front. It grows when more are out at once, it never blocks */
+GstBufferPool * gst_bt_buffer_pool_new (guint size, guint min_buffers);
+
+G_END_DECLS
+
+/* a buffer from the pool to pass to torrent_handle::read_piece(). Empty if
+ * pool is NULL or has nothing to give, libtorrent allocates one then */
+boost::shared_array<char> gst_bt_buffer_pool_acquire_piece (GstBufferPool * pool);
+
+#endif /* GST_BT_BUFFER_POOL_H */
@@ -49,6 +49,16 @@
 #define DEFAULT_TYPEFIND TRUE
 #define DEFAULT_BUFFER_PIECES 3
 #define DEFAULT_DIR "btdemux"
+//give up locating the container index after this many pieces
+#define MAX_INDEX_PROBE_READS 8
+//don't read indexes bigger than this for their keyframes
+#define MAX_INDEX_SIZE (64 * 1024 * 1024)
+//on a user seek, fetch the keyframe and this much of the media after it at top priority
+#define SEEK_PREFETCH_SECONDS 4
+//once this much (percent) of the playing file is pushed, fetch the start of the next one
+#define DEFAULT_LOOKAHEAD_THRESHOLD 80
+//how much of the next file to fetch, in seconds of media
+#define DEFAULT_LOOKAHEAD_SECONDS 10
 
 GST_DEBUG_CATEGORY_EXTERN (gst_bt_demux_debug);
 #define GST_CAT_DEFAULT gst_bt_demux_debug
@@ -73,6 +83,30 @@ gst_bt_demux_stream_info (GstBtDemuxStream * thiz,
     gint * start_piece, gint * end_offset, gint * end_piece,
     gint64 * size, gint64 * start_byte, gint64 * end_byte);
 
+static void
+gst_bt_demux_stream_probe_index (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, gboolean urgent);
+
+static void
+gst_bt_demux_stream_index_urgent (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h);
+
+static void
+gst_bt_demux_index_piece_finished (GstBtDemux * demux,
+    libtorrent::torrent_handle h, gint piece);
+
+static gboolean
+gst_bt_demux_index_read_piece (GstBtDemux * demux,
+    libtorrent::torrent_handle h, libtorrent::read_piece_alert * p);
+
+static void
+gst_bt_demux_stream_seek_prefetch (GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, gint64 time);
+
+static void
+gst_bt_demux_lookahead (GstBtDemux * thiz, GstBtDemuxStream * current,
+    libtorrent::torrent_handle h);
+
 
 
 typedef struct _GstBtDemuxBufferData
@@ -87,7 +121,8 @@ typedef struct _GstBtDemuxBufferData
  *----------------------------------------------------------------------------*/
 static void gst_bt_demux_buffer_data_free (gpointer data)
 {
-  g_free (data);
+  //runs the shared_array's destructor, which gives a pooled piece buffer back
+  delete (GstBtDemuxBufferData *) data;
 }
 
 GstBuffer * gst_bt_demux_buffer_new (boost::shared_array <char> const buffer,
@@ -97,7 +132,7 @@ GstBuffer * gst_bt_demux_buffer_new (boost::shared_array <char> const buffer,
   GstBtDemuxBufferData *buf_data;
   guint8 *data;
 
-  buf_data = g_new0 (GstBtDemuxBufferData, 1);
+  buf_data = new GstBtDemuxBufferData ();
   buf_data->buffer = buffer;
 
   data = (guint8 *)buffer.get ();
@@ -159,6 +194,16 @@ GstBuffer * gst_bt_demux_buffer_new (boost::shared_array <char> const buffer,
   return buf;
 }
 
+//read the piece into a buffer from our pool, the read_piece_alert hands it back with the data.
+//only playback reads move the stream cursor of the streaming cache, index probes must not
+static void
+gst_bt_demux_read_piece (GstBtDemux * thiz, libtorrent::torrent_handle h, gint piece,
+    gboolean playback)
+{
+  h.read_piece (piece, gst_bt_buffer_pool_acquire_piece (thiz->pool),
+      playback ? libtorrent::torrent_handle::playback : libtorrent::read_piece_flags_t{});
+}
+
 
 
 
@@ -628,7 +673,7 @@ printf("(bt_demux_stream_push_loop) recovery lock (%d)\n", thiz->current_piece);
                                       thiz->start_piece);
 
         //**fire the read on start_piece, the rest will follow automatically, like a chain reaction, or domino effect
-        h.read_piece(thiz->start_piece);
+        gst_bt_demux_read_piece (demux, h, thiz->start_piece, TRUE);
       }
       thiz->moov_after_mdat = FALSE;
   }
@@ -659,7 +704,7 @@ printf("(bt_demux_stream_push_loop) recovery lock (%d)\n", thiz->current_piece);
           if (send_eos ==FALSE) {
               printf ("(bt_demux_stream_push_loop) Luckily we have next piece %d, call read_piece() on it, current:%d\n", ipc_data->piece+1, thiz->current_piece);
               //**fire the read on start_piece, the rest will follow automatically, like a chain reaction, or domino effect
-              h.read_piece (next);
+              gst_bt_demux_read_piece (demux, h, next, TRUE);
             
           } else {
                           //generally, it is reached when EOS occured
@@ -753,6 +798,12 @@ printf("(bt_demux_stream_push_loop) recovery lock (%d)\n", thiz->current_piece);
 
   g_static_rec_mutex_unlock (thiz->lock);
 
+  //far enough into this file, get the start of the next one in the playlist
+  if (!need_re_push && !send_eos)
+  {
+    gst_bt_demux_lookahead (demux, thiz, h);
+  }
+
   // g_mutex_unlock (demux->streams_lock);
 
   if (update_buffering)
@@ -1133,6 +1184,434 @@ gst_bt_demux_stream_info (GstBtDemuxStream * thiz,
 
 
 
+/*----------------------------------------------------------------------------*
+ *                         The container index probe                          *
+ *----------------------------------------------------------------------------*/
+//The demuxers can't output the first frame before they've parsed the index (mp4 moov, mkv Cues, avi idx1).
+//When it's behind the media data, qtdemux only finds out once the first piece is pushed, seeks there
+//(see moov_after_mdat), and only then those pieces get downloaded. Instead, as soon as the playlist is fed,
+//walk the container's top level structure a piece at a time and raise the index pieces' priority.
+//Only the stream being played gets them at top_priority. The next one in the playlist is probed when the
+//lookahead fetches its start, at default_priority, so a season pack's indexes don't compete with the
+//playing file's buffering window
+
+//raise a piece the probe needs to the priority of the stream's index. Never lower it, it may be in
+//the buffering window of the stream being played
+static void
+gst_bt_demux_stream_index_want (GstBtDemuxStream * thiz, libtorrent::torrent_handle h, gint piece)
+{
+  libtorrent::download_priority_t prio;
+
+  prio = thiz->index_urgent ? libtorrent::top_priority : libtorrent::default_priority;
+  if (h.have_piece (piece) || h.piece_priority (piece) >= prio)
+  {
+    return;
+  }
+  h.piece_priority (piece, prio);
+}
+
+//ask for the piece holding `offset` (in bytes from the start of the file) to continue the walk with
+static void
+gst_bt_demux_stream_probe_piece (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, gint64 offset)
+{
+  GSList *walk;
+  gint piece_length;
+  gint piece;
+
+  piece_length = h.torrent_file ()->piece_length ();
+  piece = (thiz->start_byte_global + offset) / piece_length;
+
+  thiz->index_probe_piece = piece;
+  thiz->index_probe_reading = FALSE;
+  thiz->index_probe_reads++;
+
+  if (!h.have_piece (piece))
+  {
+    //read when its piece_finished_alert comes
+    gst_bt_demux_stream_index_want (thiz, h, piece);
+    return;
+  }
+
+  //a piece shared by two files may already be read for the other file's probe,
+  //one read_piece_alert serves both
+  for (walk = demux->streams; walk; walk = g_slist_next (walk))
+  {
+    GstBtDemuxStream *other = GST_BT_DEMUX_STREAM (walk->data);
+
+    if (other != thiz && other->index_probe_reading && other->index_probe_piece == piece)
+    {
+      thiz->index_probe_reading = TRUE;
+      return;
+    }
+  }
+
+  thiz->index_probe_reading = TRUE;
+  gst_bt_demux_read_piece (demux, h, piece, FALSE);
+}
+
+static void
+gst_bt_demux_stream_probe_index (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, gboolean urgent)
+{
+  GstBtMediaContainer container;
+  gint piece_length;
+  gint last;
+
+  if (thiz->index_probe_started)
+  {
+    return;
+  }
+  thiz->index_probe_started = TRUE;
+  thiz->index_urgent = urgent;
+
+  container = gst_bt_media_container_from_path (thiz->path);
+  gst_bt_media_index_probe_init (&thiz->index_probe, container);
+  if (container == GST_BT_MEDIA_CONTAINER_NONE)
+  {
+    return;
+  }
+
+  //an index behind the media data is at the very end of the file, mostly. Get the last piece along with the
+  //first, rather than a round trip after the first piece told us where the index is
+  piece_length = h.torrent_file ()->piece_length ();
+  last = (thiz->end_byte_global - 1) / piece_length;
+  gst_bt_demux_stream_index_want (thiz, h, last);
+
+  gst_bt_demux_stream_probe_piece (demux, thiz, h, 0);
+}
+
+//the stream is the one played now. Probe its index if that's not started yet, or raise what the probe
+//waits for to top_priority if it started as the lookahead's
+static void
+gst_bt_demux_stream_index_urgent (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h)
+{
+  gint piece_length;
+  gint i;
+
+  if (!thiz->index_probe_started)
+  {
+    gst_bt_demux_stream_probe_index (demux, thiz, h, TRUE);
+    return;
+  }
+  if (thiz->index_urgent)
+  {
+    return;
+  }
+  thiz->index_urgent = TRUE;
+
+  if (thiz->index_probe_piece >= 0)
+  {
+    gst_bt_demux_stream_index_want (thiz, h, thiz->index_probe_piece);
+  }
+  if (thiz->index_data)
+  {
+    piece_length = h.torrent_file ()->piece_length ();
+    for (i = (thiz->start_byte_global + thiz->index_probe.index_start) / piece_length;
+        i <= (thiz->start_byte_global + thiz->index_probe.index_end - 1) / piece_length; i++)
+    {
+      gst_bt_demux_stream_index_want (thiz, h, i);
+    }
+  }
+}
+
+//a piece the probe waits for is downloaded, read it
+static void
+gst_bt_demux_index_piece_finished (GstBtDemux * demux,
+    libtorrent::torrent_handle h, gint piece)
+{
+  GSList *walk;
+  gboolean read = FALSE;
+
+  for (walk = demux->streams; walk; walk = g_slist_next (walk))
+  {
+    GstBtDemuxStream *stream = GST_BT_DEMUX_STREAM (walk->data);
+
+    if (stream->index_probe_piece != piece || stream->index_probe_reading)
+    {
+      continue;
+    }
+
+    stream->index_probe_reading = TRUE;
+    if (!read)
+    {
+      gst_bt_demux_read_piece (demux, h, piece, FALSE);
+      read = TRUE;
+    }
+  }
+}
+
+static void
+gst_bt_demux_stream_index_found (GstBtDemuxStream * thiz, libtorrent::torrent_handle h)
+{
+  gint piece_length;
+  gint first, last, i;
+
+  piece_length = h.torrent_file ()->piece_length ();
+  first = (thiz->start_byte_global + thiz->index_probe.index_start) / piece_length;
+  last = (thiz->start_byte_global + thiz->index_probe.index_end - 1) / piece_length;
+
+          printf ("(gst_bt_demux_stream_index_found) %s: index at [%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT
+              "), pieces [%d,%d] at %s, %d pieces read\n",
+              thiz->path, thiz->index_probe.index_start, thiz->index_probe.index_end, first, last,
+              thiz->index_urgent ? "top_priority" : "default_priority", thiz->index_probe_reads);
+
+  for (i = first; i <= last; i++)
+  {
+    gst_bt_demux_stream_index_want (thiz, h, i);
+  }
+
+  //read the index too, for the keyframes a user seek is mapped to
+  if (thiz->index_probe.container != GST_BT_MEDIA_CONTAINER_AVI
+      && thiz->index_probe.index_end - thiz->index_probe.index_start <= MAX_INDEX_SIZE)
+  {
+    thiz->index_data = g_byte_array_new ();
+  }
+}
+
+//appends the part of the index in the data, and asks for the piece after it until it's complete
+static void
+gst_bt_demux_stream_index_collect (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, const guint8 * data, gint64 data_offset, gint64 size)
+{
+  gint64 have = thiz->index_probe.index_start + thiz->index_data->len;
+  gint64 end = MIN (thiz->index_probe.index_end, data_offset + size);
+
+  if (have >= data_offset && have < end)
+  {
+    g_byte_array_append (thiz->index_data, data + (have - data_offset), end - have);
+    have = end;
+  }
+
+  if (have < thiz->index_probe.index_end)
+  {
+    gst_bt_demux_stream_probe_piece (demux, thiz, h, have);
+    return;
+  }
+
+  //the seek handler reads them from the streaming thread
+  g_static_rec_mutex_lock (thiz->lock);
+  thiz->keyframes = gst_bt_media_index_keyframes (&thiz->index_probe,
+      thiz->index_data->data, thiz->index_data->len);
+  g_static_rec_mutex_unlock (thiz->lock);
+  g_byte_array_free (thiz->index_data, TRUE);
+  thiz->index_data = NULL;
+
+          printf ("(gst_bt_demux_stream_index_collect) %s: %d keyframes in the index\n",
+              thiz->path, thiz->keyframes ? (int)thiz->keyframes->len : 0);
+}
+
+//continues the walk with a piece read for it
+static void
+gst_bt_demux_stream_index_feed (GstBtDemux * demux, GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, libtorrent::read_piece_alert * p)
+{
+  GstBtMediaIndexResult res;
+  const guint8 *data;
+  gint64 file_size;
+  gint64 data_offset;
+  gint64 size;
+  gint64 next;
+
+  thiz->index_probe_reading = FALSE;
+  thiz->index_probe_piece = -1;
+
+  if (p->buffer == NULL)
+  {
+    return;
+  }
+
+  //only the part of the piece that belongs to this file, in offsets from the start of the file
+  file_size = thiz->end_byte_global - thiz->start_byte_global;
+  data = (const guint8 *) p->buffer.get ();
+  size = p->size;
+  data_offset = (gint64) static_cast<int>(p->piece) * h.torrent_file ()->piece_length ()
+      - thiz->start_byte_global;
+  if (data_offset < 0)
+  {
+    data -= data_offset;
+    size += data_offset;
+    data_offset = 0;
+  }
+  if (data_offset + size > file_size)
+  {
+    size = file_size - data_offset;
+  }
+
+  if (thiz->index_data)
+  {
+    gst_bt_demux_stream_index_collect (demux, thiz, h, data, data_offset, size);
+    return;
+  }
+
+  //put the tail of the previous piece in front of this one
+  if (thiz->index_probe_carry->len > 0
+      && thiz->index_probe_carry_offset + thiz->index_probe_carry->len == data_offset)
+  {
+    g_byte_array_append (thiz->index_probe_carry, data, size);
+    data = thiz->index_probe_carry->data;
+    size = thiz->index_probe_carry->len;
+    data_offset = thiz->index_probe_carry_offset;
+  }
+
+  res = gst_bt_media_index_probe_feed (&thiz->index_probe, data, data_offset, size, file_size);
+
+  if (res == GST_BT_MEDIA_INDEX_FOUND)
+  {
+    gst_bt_demux_stream_index_found (thiz, h);
+    if (thiz->index_data)
+    {
+      gst_bt_demux_stream_index_collect (demux, thiz, h, data, data_offset, size);
+    }
+    g_byte_array_set_size (thiz->index_probe_carry, 0);
+    return;
+  }
+
+  if (res == GST_BT_MEDIA_INDEX_NOT_FOUND || thiz->index_probe_reads >= MAX_INDEX_PROBE_READS)
+  {
+          printf ("(gst_bt_demux_stream_index_feed) %s: index not found, %d pieces read\n",
+              thiz->path, thiz->index_probe_reads);
+    g_byte_array_set_size (thiz->index_probe_carry, 0);
+    return;
+  }
+
+  next = thiz->index_probe.offset;
+  if (next >= data_offset && next < data_offset + size)
+  {
+    //a header straddles the end of this piece, keep its start for the next one
+    if (data == thiz->index_probe_carry->data)
+    {
+      g_byte_array_remove_range (thiz->index_probe_carry, 0, next - data_offset);
+    }
+    else
+    {
+      g_byte_array_set_size (thiz->index_probe_carry, 0);
+      g_byte_array_append (thiz->index_probe_carry, data + (next - data_offset),
+          data_offset + size - next);
+    }
+    thiz->index_probe_carry_offset = next;
+    next = data_offset + size;
+  }
+  else
+  {
+    g_byte_array_set_size (thiz->index_probe_carry, 0);
+  }
+
+  gst_bt_demux_stream_probe_piece (demux, thiz, h, next);
+}
+
+//returns TRUE if the piece was read for the probes, it's not one for the push loop then
+static gboolean
+gst_bt_demux_index_read_piece (GstBtDemux * demux,
+    libtorrent::torrent_handle h, libtorrent::read_piece_alert * p)
+{
+  GSList *walk;
+  GSList *waiting = NULL;
+
+  for (walk = demux->streams; walk; walk = g_slist_next (walk))
+  {
+    GstBtDemuxStream *stream = GST_BT_DEMUX_STREAM (walk->data);
+
+    if (stream->index_probe_reading && stream->index_probe_piece == static_cast<int>(p->piece))
+    {
+      waiting = g_slist_append (waiting, stream);
+    }
+  }
+
+  if (waiting == NULL)
+  {
+    return FALSE;
+  }
+
+  for (walk = waiting; walk; walk = g_slist_next (walk))
+  {
+    gst_bt_demux_stream_index_feed (demux, GST_BT_DEMUX_STREAM (walk->data), h, p);
+  }
+  g_slist_free (waiting);
+
+  return TRUE;
+}
+
+
+
+
+//qtdemux and matroskademux push a user's seek upstream in time first, and when we refuse it, seek in bytes to
+//the keyframe before that time themselves. Map the time to the same keyframe with the container index, and
+//fetch it and the SEEK_PREFETCH_SECONDS of media after it at top priority, so only the bytes needed to show
+//a picture and keep playing are in the way, and they're on their way by the time the byte seek asks for them.
+//Sequential download takes top priority pieces in order, so the keyframe's piece comes first
+static void
+gst_bt_demux_stream_seek_prefetch (GstBtDemuxStream * thiz,
+    libtorrent::torrent_handle h, gint64 time)
+{
+  GstBtMediaKeyframe *kf;
+  gint64 file_size;
+  gint64 end;
+  gint piece_length;
+  gint first, last, i;
+  guint k, next;
+
+  if (thiz->keyframes == NULL)
+  {
+    return;
+  }
+
+  file_size = thiz->end_byte_global - thiz->start_byte_global;
+  k = gst_bt_media_index_keyframe_before (thiz->keyframes, time);
+  kf = &g_array_index (thiz->keyframes, GstBtMediaKeyframe, k);
+
+  //up to the first keyframe SEEK_PREFETCH_SECONDS later
+  end = file_size;
+  for (next = k + 1; next < thiz->keyframes->len; next++)
+  {
+    GstBtMediaKeyframe *n = &g_array_index (thiz->keyframes, GstBtMediaKeyframe, next);
+    if (n->time >= kf->time + SEEK_PREFETCH_SECONDS * GST_SECOND && n->offset > kf->offset)
+    {
+      end = n->offset;
+      break;
+    }
+  }
+
+  piece_length = h.torrent_file ()->piece_length ();
+  first = (thiz->start_byte_global + kf->offset) / piece_length;
+  last = (thiz->start_byte_global + MAX (end, kf->offset + 1) - 1) / piece_length;
+
+          printf ("(gst_bt_demux_stream_seek_prefetch) seek to %" GST_TIME_FORMAT ", keyframe at %" GST_TIME_FORMAT
+              " offset %" G_GINT64_FORMAT ", prefetch pieces [%d,%d]\n", GST_TIME_ARGS (time), GST_TIME_ARGS (kf->time),
+              kf->offset, first, last);
+
+  //the previous seek's pieces we don't have are not urgent any more
+  if (thiz->prefetch_first >= 0)
+  {
+    for (i = thiz->prefetch_first; i <= thiz->prefetch_last; i++)
+    {
+      if (i >= first && i <= last)
+      {
+        continue;
+      }
+      if (!h.have_piece (i) && h.piece_priority (i) == libtorrent::top_priority)
+      {
+        h.piece_priority (i, libtorrent::default_priority);
+      }
+    }
+  }
+
+  for (i = first; i <= last; i++)
+  {
+    if (h.have_piece (i))
+    {
+      continue;
+    }
+    h.piece_priority (i, libtorrent::top_priority);
+  }
+
+  thiz->prefetch_first = first;
+  thiz->prefetch_last = last;
+}
+
+
+
 static gboolean
 gst_bt_demux_stream_seek (GstBtDemuxStream * thiz, GstEvent * event)
 {
@@ -1168,17 +1647,20 @@ gst_bt_demux_stream_seek (GstBtDemuxStream * thiz, GstEvent * event)
   torrent_info ti = h.get_torrent_info ();
   piece_length = ti.piece_length ();
 
+  //Parses a seek @event and stores the results in the given result locations.
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type,
+      &start, &stop_type, &stop);
+
   //if this seek event is triggered by [user], the format is GST_FORMAT_TIME in first enter this function
   //if this seek event is triggered by [qtdemux], which means that it failed to got moov header in first piece of data
   if(format == GST_FORMAT_TIME)
   {
     thiz->is_user_seek = TRUE; 
-  }
 
-
-  //Parses a seek @event and stores the results in the given result locations.
-  gst_event_parse_seek (event, &rate, &format, &flags, &start_type,
-      &start, &stop_type, &stop);
+    g_static_rec_mutex_lock (thiz->lock);
+    gst_bt_demux_stream_seek_prefetch (thiz, h, start);
+    g_static_rec_mutex_unlock (thiz->lock);
+  }
 
 
   /* sanitize stuff */
@@ -1380,7 +1862,7 @@ printf ("(bt_demux_stream_seek) fileidx(%d) start_byte_global = %d\n",
                                                                   thiz->start_piece);
     //we must already have this piece before we call `read_piece`
     //**fire the read on start_piece, the rest will follow automatically, like a chain reaction, or domino effect
-    h.read_piece (thiz->start_piece);
+    gst_bt_demux_read_piece (demux, h, thiz->start_piece, TRUE);
   } 
   //area we seeking to do need to buffer
   else 
@@ -1600,6 +2082,24 @@ gst_bt_demux_stream_dispose (GObject * object)
     g_array_free (thiz->cur_buffering_flags, TRUE);
   }
 
+  if (thiz->index_probe_carry)
+  {
+    g_byte_array_free (thiz->index_probe_carry, TRUE);
+    thiz->index_probe_carry = NULL;
+  }
+
+  if (thiz->index_data)
+  {
+    g_byte_array_free (thiz->index_data, TRUE);
+    thiz->index_data = NULL;
+  }
+
+  if (thiz->keyframes)
+  {
+    g_array_free (thiz->keyframes, TRUE);
+    thiz->keyframes = NULL;
+  }
+
 
   g_static_rec_mutex_free (thiz->lock);
   g_free (thiz->lock);
@@ -1658,6 +2158,13 @@ gst_bt_demux_stream_init (GstBtDemuxStream * thiz)
 
   thiz->cur_buffering_flags = NULL;
 
+  thiz->index_probe_piece = -1;
+  thiz->index_probe_started = FALSE;
+  thiz->index_urgent = FALSE;
+  thiz->index_probe_carry = g_byte_array_new ();
+  thiz->prefetch_first = -1;
+  thiz->prefetch_last = -1;
+
   /* our ipc */
   thiz->ipc = g_async_queue_new_full (
       (GDestroyNotify) gst_bt_demux_buffer_data_free);
@@ -1676,6 +2183,11 @@ enum {
   PROP_TYPEFIND,
   PROP_N_STREAMS,
   PROP_CURRENT_STREAM,
+  PROP_POOL_ALLOCATED,
+  PROP_POOL_REUSED,
+  PROP_POOL_OUTSTANDING,
+  PROP_LOOKAHEAD_THRESHOLD,
+  PROP_LOOKAHEAD_SECONDS,
 };
 
 enum
@@ -1895,7 +2407,7 @@ printf("(gst_bt_demux_send_buffering) recovery lock (%d)\n", stream->current_pie
       
       // every time current_piece plus one, which guarantee the piece be pushed in order, 
       // aka. read_piece_alert retrieved in order, so push_loop can push in piece order
-      h.read_piece (stream->current_piece+1);
+      gst_bt_demux_read_piece (thiz, h, stream->current_piece+1, TRUE);
     } 
     else
     {
@@ -1917,6 +2429,140 @@ printf("(gst_bt_demux_send_buffering) recovery lock (%d)\n", stream->current_pie
 
 
 
+//The playlist plays the video files in torrent order, and only switches to the next one on EOS. Its first
+//pieces would only be asked for then, and every transition in a season pack stalls on them. Once the playing
+//file is lookahead_threshold percent pushed, raise the first lookahead_seconds of the next one to
+//default_priority: ahead of the rest of the torrent, behind the playing file's own top_priority pieces
+static void
+gst_bt_demux_lookahead (GstBtDemux * thiz, GstBtDemuxStream * current,
+    libtorrent::torrent_handle h)
+{
+  GSList *walk;
+  GstBtDemuxStream *next = NULL;
+  gint64 end;
+  gint piece_length;
+  gint first, last, i;
+
+  if (thiz->lookahead_seconds <= 0 || thiz->lookahead_file_idx != -1)
+  {
+    return;
+  }
+
+  if ((current->current_piece - current->start_piece + 1) * 100 <
+      (current->end_piece - current->start_piece + 1) * thiz->lookahead_threshold)
+  {
+    return;
+  }
+
+  //this runs on the push loop's task. The probe state of every stream is shared with the alert thread,
+  //which handles the probe's reads under streams_lock, so start it under the same lock
+  g_mutex_lock (thiz->streams_lock);
+
+  //the streams are in file order, like the playlist
+  for (walk = thiz->streams; walk; walk = g_slist_next (walk))
+  {
+    if (walk->data == current)
+    {
+      if (g_slist_next (walk))
+      {
+        next = GST_BT_DEMUX_STREAM (g_slist_next (walk)->data);
+      }
+      break;
+    }
+  }
+  if (next == NULL)
+  {
+    g_mutex_unlock (thiz->streams_lock);
+    return;
+  }
+
+  piece_length = h.torrent_file ()->piece_length ();
+
+  //its index too, unless the probe is already started
+  gst_bt_demux_stream_probe_index (thiz, next, h, FALSE);
+
+  g_mutex_unlock (thiz->streams_lock);
+
+  g_static_rec_mutex_lock (next->lock);
+
+  //up to the first keyframe lookahead_seconds in, when its index is parsed. Otherwise as much as
+  //gst_bt_demux_stream_activate() would buffer before playing it
+  end = -1;
+  if (next->keyframes != NULL)
+  {
+    guint k;
+
+    end = next->end_byte_global - next->start_byte_global;
+    for (k = 0; k < next->keyframes->len; k++)
+    {
+      GstBtMediaKeyframe *kf = &g_array_index (next->keyframes, GstBtMediaKeyframe, k);
+      if (kf->time >= thiz->lookahead_seconds * GST_SECOND)
+      {
+        end = kf->offset;
+        break;
+      }
+    }
+  }
+
+  first = next->start_byte_global / piece_length;
+  if (end > 0)
+  {
+    last = (next->start_byte_global + end - 1) / piece_length;
+  }
+  else
+  {
+    last = first + thiz->buffer_pieces - 1;
+  }
+  if (last > next->last_piece)
+  {
+    last = next->last_piece;
+  }
+
+  g_static_rec_mutex_unlock (next->lock);
+
+          printf ("(gst_bt_demux_lookahead) stream %s at piece %d, fetch the first %ds of file %d, pieces [%d,%d]\n",
+              GST_PAD_NAME (current), current->current_piece, thiz->lookahead_seconds, next->file_idx, first, last);
+
+  for (i = first; i <= last; i++)
+  {
+    if (h.have_piece (i) || h.piece_priority (i) >= libtorrent::default_priority)
+    {
+      continue;
+    }
+    h.piece_priority (i, libtorrent::default_priority);
+  }
+
+  thiz->lookahead_file_idx = next->file_idx;
+  thiz->lookahead_first = first;
+  thiz->lookahead_last = last;
+}
+
+//the playlist moved on. If not to the file we fetched ahead, those pieces are back to low_priority
+static void
+gst_bt_demux_lookahead_reset (GstBtDemux * thiz, libtorrent::torrent_handle h,
+    gint desired_file_idx)
+{
+  gint i;
+
+  if (thiz->lookahead_file_idx == -1)
+  {
+    return;
+  }
+
+  if (thiz->lookahead_file_idx != desired_file_idx)
+  {
+    for (i = thiz->lookahead_first; i <= thiz->lookahead_last; i++)
+    {
+      if (!h.have_piece (i) && h.piece_priority (i) == libtorrent::default_priority)
+      {
+        h.piece_priority (i, libtorrent::low_priority);
+      }
+    }
+  }
+
+  thiz->lookahead_file_idx = -1;
+}
+
 static void
 gst_bt_demux_switch_streams (GstBtDemux * thiz, gint desired_file_idx)
 {
@@ -1945,6 +2591,7 @@ gst_bt_demux_switch_streams (GstBtDemux * thiz, gint desired_file_idx)
     h = *ptr_h;
   ptr_h = NULL;
 
+  gst_bt_demux_lookahead_reset (thiz, h, desired_file_idx);
 
   for (walk = thiz->streams; walk; walk = g_slist_next (walk)) 
   {
@@ -1967,6 +2614,8 @@ gst_bt_demux_switch_streams (GstBtDemux * thiz, gint desired_file_idx)
         update_buffering = gst_bt_demux_stream_activate (stream, h,
           thiz->buffer_pieces);
 
+        gst_bt_demux_stream_index_urgent (thiz, stream, h);
+
         printf("(gst_bt_demux_switch_streams) Switching to stream '%s', reading piece %d, current: %d, buffering(%s)\n", 
                     GST_PAD_NAME (stream), stream->start_piece, stream->current_piece, update_buffering?"Yes":"No");
 
@@ -1981,7 +2630,7 @@ gst_bt_demux_switch_streams (GstBtDemux * thiz, gint desired_file_idx)
           printf("(gst_bt_demux_switch_streams) call read_piece() on piece %d\n",
             stream->start_piece);
           //**fire the read on start_piece, the rest will follow automatically, like a chain reaction, or domino effect
-          h.read_piece (stream->start_piece);
+          gst_bt_demux_read_piece (thiz, h, stream->start_piece, TRUE);
 
         }
     }
@@ -2078,7 +2727,7 @@ gst_bt_demux_task_cleanup (GstBtDemux * thiz)
     GstBtDemuxBufferData *ipc_data;
 
     /* send a cleanup buffer */
-    ipc_data = g_new0 (GstBtDemuxBufferData, 1);
+    ipc_data = new GstBtDemuxBufferData ();
     g_async_queue_push (stream->ipc, ipc_data);
     GstTaskState tstate = gst_pad_get_task_state (GST_PAD (stream));
     if(tstate != GST_TASK_STOPPED)
@@ -2211,6 +2860,14 @@ gst_bt_demux_dispose(GObject * object)
 
   g_mutex_free (thiz->streams_lock);
 
+  //buffers still out are freed when they're released
+  if (thiz->pool)
+  {
+    gst_buffer_pool_set_active (thiz->pool, FALSE);
+    gst_object_unref (thiz->pool);
+    thiz->pool = NULL;
+  }
+
 
   G_OBJECT_CLASS (gst_bt_demux_parent_class)->dispose (object);
 }
@@ -2361,6 +3018,12 @@ gst_bt_demux_set_property (GObject * object, guint prop_id,
     case PROP_TYPEFIND:
       thiz->typefind = g_value_get_boolean (value);
       break;
+    case PROP_LOOKAHEAD_THRESHOLD:
+      thiz->lookahead_threshold = g_value_get_int (value);
+      break;
+    case PROP_LOOKAHEAD_SECONDS:
+      thiz->lookahead_seconds = g_value_get_int (value);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -2391,6 +3054,30 @@ gst_bt_demux_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_boolean (value, thiz->typefind);
       break;
 
+    case PROP_POOL_ALLOCATED:
+      g_value_set_int (value, thiz->pool ?
+          g_atomic_int_get (&GST_BT_BUFFER_POOL (thiz->pool)->allocated) : 0);
+      break;
+
+    case PROP_POOL_REUSED:
+      g_value_set_int (value, thiz->pool ?
+          g_atomic_int_get (&GST_BT_BUFFER_POOL (thiz->pool)->acquired) -
+          g_atomic_int_get (&GST_BT_BUFFER_POOL (thiz->pool)->allocated) : 0);
+      break;
+
+    case PROP_POOL_OUTSTANDING:
+      g_value_set_int (value, thiz->pool ?
+          g_atomic_int_get (&GST_BT_BUFFER_POOL (thiz->pool)->outstanding) : 0);
+      break;
+
+    case PROP_LOOKAHEAD_THRESHOLD:
+      g_value_set_int (value, thiz->lookahead_threshold);
+      break;
+
+    case PROP_LOOKAHEAD_SECONDS:
+      g_value_set_int (value, thiz->lookahead_seconds);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2434,6 +3121,33 @@ gst_bt_demux_class_init (GstBtDemuxClass * klass)
           "Run typefind before negotiating", DEFAULT_TYPEFIND,
           (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+  g_object_class_install_property (gobject_class, PROP_POOL_ALLOCATED,
+      g_param_spec_int ("pool-allocated", "Pool allocated",
+          "Number of piece buffers the buffer pool allocated",
+          0, G_MAXINT, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_POOL_REUSED,
+      g_param_spec_int ("pool-reused", "Pool reused",
+          "Number of piece reads served by a recycled buffer",
+          0, G_MAXINT, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_POOL_OUTSTANDING,
+      g_param_spec_int ("pool-outstanding", "Pool outstanding",
+          "Number of piece buffers being read into or pushed downstream",
+          0, G_MAXINT, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_LOOKAHEAD_THRESHOLD,
+      g_param_spec_int ("lookahead-threshold", "Lookahead threshold",
+          "Percent of the playing file pushed before the start of the next file is fetched",
+          0, 100, DEFAULT_LOOKAHEAD_THRESHOLD,
+          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_LOOKAHEAD_SECONDS,
+      g_param_spec_int ("lookahead-seconds", "Lookahead seconds",
+          "Seconds of the next file to fetch ahead of the switch to it, 0 to disable",
+          0, G_MAXINT, DEFAULT_LOOKAHEAD_SECONDS,
+          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
 
 
   /* initialize the element class and pad template */
@@ -2479,11 +3193,15 @@ gst_bt_demux_init (GstBtDemux * thiz)
   thiz->num_blocks_last_piece = -1;
   thiz->blocks_per_piece_normal = -1;
 
+  thiz->pool = NULL;
 
   /* default properties */
   thiz->buffer_pieces = DEFAULT_BUFFER_PIECES;
   thiz->num_video_file = 0;
   thiz->typefind = DEFAULT_TYPEFIND;
+  thiz->lookahead_threshold = DEFAULT_LOOKAHEAD_THRESHOLD;
+  thiz->lookahead_seconds = DEFAULT_LOOKAHEAD_SECONDS;
+  thiz->lookahead_file_idx = -1;
 
   //let totem-object to select which fileidx of video to push (play)
   g_signal_connect (thiz, "notify::current-video-file-index",
@@ -2538,6 +3256,15 @@ printf ("[connect to btdemux...](btdemux_feed_playlist)\n");
   printf("(btdemux_feed_playlist)Start streaming, num files: %d, num pieces: %d, piece length: %d \n", 
       ti->num_files(),ti->num_pieces(),ti->piece_length());
 
+  //piece sized buffers for every read_piece(), enough for the pieces being buffered and the one being pushed
+  //up front, so steady playback recycles them rather than allocating a piece per read
+  if (demux->pool)
+  {
+    gst_buffer_pool_set_active (demux->pool, FALSE);
+    gst_object_unref (demux->pool);
+  }
+  demux->pool = gst_bt_buffer_pool_new (ti->piece_length (), demux->buffer_pieces + 1);
+
 
   /*---------------------- create the streams playlist  -------------------*/
   /*-----------------------------------------------------------------------*/
@@ -2582,8 +3309,8 @@ printf ("[connect to btdemux...](btdemux_feed_playlist)\n");
       fe = ti->file_at (i);
       stream->path = g_strdup (fe.path.c_str ());
 
-      //if not .mp4 file, skip, only support mp4/quicktime for now and is enough cuz video torrent mostly are .mp4
-      if(!g_str_has_suffix (stream->path, ".mp4"))
+      //if not a container we can locate the index of (mp4/quicktime, matroska, avi), skip
+      if (gst_bt_media_container_from_path (stream->path) == GST_BT_MEDIA_CONTAINER_NONE)
       {
         continue;
       }
@@ -2634,6 +3361,23 @@ printf ("[connect to btdemux...](btdemux_feed_playlist)\n");
   /* make sure to download sequentially */
   h.set_sequential_download (true);
 
+  /* locate the container index of the stream to be played now, rather than when the demuxer asks for it.
+   * The playlist starts with the current stream, or the first one */
+  for (walk = demux->streams; walk; walk = g_slist_next (walk))
+  {
+    if (GST_BT_DEMUX_STREAM (walk->data)->file_idx == demux->cur_streaming_fileidx)
+    {
+      break;
+    }
+  }
+  if (walk == NULL)
+  {
+    walk = demux->streams;
+  }
+  if (walk != NULL)
+  {
+    gst_bt_demux_stream_probe_index (demux, GST_BT_DEMUX_STREAM (walk->data), h, TRUE);
+  }
 
 }
 
@@ -2674,6 +3418,15 @@ void btdemux_feed_read_piece_alert(GObject* gobj, libtorrent::alert* a)
 
                                 printf("(bt_demux_handle_alert) BEGIN in read_piece_alert, piece idx:(%d)\n", 
                                 static_cast<int>(p->piece));
+      //pieces read to locate the container index are not pushed downstream
+      g_mutex_lock (thiz->streams_lock);
+      gboolean probe_read = gst_bt_demux_index_read_piece (thiz, h, p);
+      g_mutex_unlock (thiz->streams_lock);
+      if (probe_read)
+      {
+        break;
+      }
+
       //this piece read is not available for now, maybe it is not downloaded yet
       if (p->buffer == NULL)
       {
@@ -2820,7 +3573,7 @@ Video 1 territory (maybe moov header in the tail)        Video 2 territory
         //you will push the wrong data libav will show ERROR, which is a endless headache !
         //push ipc_data in read_piece_alert handling code <====> retrieve ipc_data in bt_demux_stream_push_loop
         /***** fill the `ipc_data` with read piece post by read_piece_alert, send the data to the stream thread */
-        ipc_data = g_new0 (GstBtDemuxBufferData /*the type of the elements to allocate*/, 1 /* the number of elements to allocate */);
+        ipc_data = new GstBtDemuxBufferData ();
         ipc_data->buffer = p->buffer; // a buffer containing all the data of the piece
         ipc_data->piece = p->piece; // the piece index that was read
         ipc_data->size = p->size; // number of bytes that was read, this doesn't split the case when two video share/interlacing in one piece
@@ -2927,6 +3680,7 @@ void btdemux_feed_piece_finished_alert(GObject* gobj, libtorrent::alert* a)
 
         g_mutex_lock (thiz->streams_lock);/***********************************************************************/
 
+        gst_bt_demux_index_piece_finished (thiz, h, static_cast<int>(p->piece_index));
 
         // although loop all streams here, only one stream is requested (see it is as playlist)
         /* read the piece once it is finished and send downstream in order (only for the stream we requested)*/
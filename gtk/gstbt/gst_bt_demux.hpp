@@ -25,6 +25,9 @@
 #include <gst/gst.h>
 // #include <gst/base/gstadapter.h>
 
+#include "gst_bt_buffer_pool.hpp"
+#include "gst_bt_media_index.hpp"
+
 //libtorrent
 #include "libtorrent/session.hpp"
 #include "libtorrent/torrent_info.hpp"
@@ -115,6 +118,28 @@ typedef struct _GstBtDemuxStream
   //gboolean array, signaling whether piece needs to downloading/buffering in Three-Piece-Area
   GArray* cur_buffering_flags;
 
+  //locating the container index (moov, Cues, idx1) before the demuxer asks for it
+  GstBtMediaIndexProbe index_probe;
+  //the piece the probe waits for, -1 once the index is found or given up on
+  gint index_probe_piece;
+  //read_piece() was called on index_probe_piece, its read_piece_alert is ours
+  gboolean index_probe_reading;
+  gint index_probe_reads;
+  //the probe was started. It is for the stream being played, or the next one fetched ahead
+  gboolean index_probe_started;
+  //the stream is being played, the pieces of its index are wanted at top_priority
+  gboolean index_urgent;
+  //the tail of the previous piece read, when a header straddles two pieces
+  GByteArray *index_probe_carry;
+  gint64 index_probe_carry_offset;
+  //the index being read, once the probe found it. Freed after it's parsed
+  GByteArray *index_data;
+  //GstBtMediaKeyframe array from the index, NULL if there's none (yet)
+  GArray *keyframes;
+  //the pieces the last user seek prefetched at top priority, -1 if none
+  gint prefetch_first;
+  gint prefetch_last;
+
 } GstBtDemuxStream;
 
 
@@ -145,6 +170,14 @@ typedef struct _GstBtDemux
   gboolean buffering;
   gint buffer_pieces;
 
+  //fetching the start of the next file before the playlist switches to it
+  gint lookahead_threshold;
+  gint lookahead_seconds;
+  //the file fetched ahead and its pieces, -1 if none yet
+  gint lookahead_file_idx;
+  gint lookahead_first;
+  gint lookahead_last;
+
   //piece related info 
   gint num_video_file;
   gint total_num_blocks;
@@ -155,6 +188,9 @@ typedef struct _GstBtDemux
 
   gpointer tor_handle; // from transmission Session feed us
 
+  //piece sized buffers libtorrent reads pieces into, NULL until the playlist is fed
+  GstBufferPool *pool;
+
   
 } GstBtDemux;
 
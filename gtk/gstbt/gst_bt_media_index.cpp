@@ -0,0 +1,783 @@
+/* Gst-Bt - BitTorrent related GStreamer elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gst_bt_media_index.hpp"
+
+#include <string.h>
+
+/* matroska element ids, with their length marker bits */
+#define EBML_ID_HEADER        0x1A45DFA3
+#define MKV_ID_SEGMENT        0x18538067
+#define MKV_ID_SEEKHEAD       0x114D9B74
+#define MKV_ID_SEEK           0x4DBB
+#define MKV_ID_SEEKID         0x53AB
+#define MKV_ID_SEEKPOSITION   0x53AC
+#define MKV_ID_INFO           0x1549A966
+#define MKV_ID_TIMECODESCALE  0x2AD7B1
+#define MKV_ID_CUES           0x1C53BB6B
+#define MKV_ID_CUEPOINT       0xBB
+#define MKV_ID_CUETIME        0xB3
+#define MKV_ID_CUETRACKPOS    0xB7
+#define MKV_ID_CUECLUSTERPOS  0xF1
+#define MKV_ID_CLUSTER        0x1F43B675
+
+#define NSECONDS 1000000000
+
+static guint32
+read_be32 (const guint8 * p)
+{
+  return ((guint32) p[0] << 24) | ((guint32) p[1] << 16)
+      | ((guint32) p[2] << 8) | (guint32) p[3];
+}
+
+static guint64
+read_be64 (const guint8 * p)
+{
+  return ((guint64) read_be32 (p) << 32) | read_be32 (p + 4);
+}
+
+static guint32
+read_le32 (const guint8 * p)
+{
+  return ((guint32) p[3] << 24) | ((guint32) p[2] << 16)
+      | ((guint32) p[1] << 8) | (guint32) p[0];
+}
+
+static gboolean
+is_fourcc (const guint8 * p)
+{
+  gint i;
+
+  for (i = 0; i < 4; i++)
+  {
+    if (p[i] < 0x20 || p[i] > 0x7e)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* reads an EBML element id, keeping its length marker. Returns the number
+ * of bytes it takes, 0 if there aren't enough of them and -1 if it's
+ * not an id */
+static gint
+read_ebml_id (const guint8 * p, gint64 avail, guint32 * id)
+{
+  gint len;
+  gint i;
+
+  if (avail < 1)
+    return 0;
+
+  if (p[0] & 0x80) len = 1;
+  else if (p[0] & 0x40) len = 2;
+  else if (p[0] & 0x20) len = 3;
+  else if (p[0] & 0x10) len = 4;
+  else return -1;
+
+  if (avail < len)
+    return 0;
+
+  *id = 0;
+  for (i = 0; i < len; i++)
+    *id = (*id << 8) | p[i];
+  return len;
+}
+
+/* reads an EBML variable size integer. All value bits set means the
+ * size is unknown (the element runs to the end of its parent) */
+static gint
+read_ebml_size (const guint8 * p, gint64 avail, guint64 * size,
+    gboolean * unknown)
+{
+  gint len;
+  gint i;
+  guint64 all_ones;
+
+  if (avail < 1)
+    return 0;
+  if (p[0] == 0)
+    return -1;
+
+  for (len = 1; !(p[0] & (0x80 >> (len - 1))); len++);
+  if (avail < len)
+    return 0;
+
+  *size = p[0] & (0xff >> len);
+  for (i = 1; i < len; i++)
+    *size = (*size << 8) | p[i];
+
+  all_ones = (G_GUINT64_CONSTANT (1) << (7 * len)) - 1;
+  *unknown = (*size == all_ones);
+  return len;
+}
+
+/* steps to the next child in the data of a master element. Returns FALSE
+ * at the end of the data, or when the child doesn't fit in it */
+static gboolean
+ebml_next_child (const guint8 * p, gint64 size, gint64 * off, guint32 * id,
+    const guint8 ** payload, gint64 * len)
+{
+  guint64 child_len;
+  gboolean unknown;
+  gint n, m;
+
+  if (*off >= size)
+    return FALSE;
+
+  n = read_ebml_id (p + *off, size - *off, id);
+  if (n <= 0)
+    return FALSE;
+  m = read_ebml_size (p + *off + n, size - *off - n, &child_len, &unknown);
+  if (m <= 0 || unknown || child_len > (guint64) (size - *off - n - m))
+    return FALSE;
+
+  *payload = p + *off + n + m;
+  *len = (gint64) child_len;
+  *off += n + m + child_len;
+  return TRUE;
+}
+
+static guint64
+ebml_uint (const guint8 * p, gint64 len)
+{
+  guint64 ret = 0;
+  gint64 i;
+
+  for (i = 0; i < len && i < 8; i++)
+    ret = (ret << 8) | p[i];
+  return ret;
+}
+
+/* finds the position of the Cues in a SeekHead's data, -1 if it has none */
+static gint64
+mkv_seekhead_cues (const guint8 * p, gint64 size)
+{
+  const guint8 *seek;
+  gint64 seek_len;
+  gint64 off = 0;
+  guint32 id;
+
+  while (ebml_next_child (p, size, &off, &id, &seek, &seek_len))
+  {
+    const guint8 *child;
+    gint64 child_len;
+    gint64 seek_off = 0;
+    guint32 seek_id = 0;
+    gint64 seek_pos = -1;
+
+    if (id != MKV_ID_SEEK)
+      continue;
+
+    while (ebml_next_child (seek, seek_len, &seek_off, &id, &child, &child_len))
+    {
+      if (id == MKV_ID_SEEKID)
+        seek_id = (guint32) ebml_uint (child, child_len);
+      else if (id == MKV_ID_SEEKPOSITION)
+        seek_pos = (gint64) ebml_uint (child, child_len);
+    }
+
+    if (seek_id == MKV_ID_CUES && seek_pos >= 0)
+      return seek_pos;
+  }
+  return -1;
+}
+
+/* the TimecodeScale in an Info's data, 1 ms if it has none */
+static gint64
+mkv_info_timecode_scale (const guint8 * p, gint64 size)
+{
+  const guint8 *child;
+  gint64 child_len;
+  gint64 off = 0;
+  guint32 id;
+
+  while (ebml_next_child (p, size, &off, &id, &child, &child_len))
+  {
+    if (id == MKV_ID_TIMECODESCALE && child_len > 0)
+      return (gint64) ebml_uint (child, child_len);
+  }
+  return 1000000;
+}
+
+/* boxes: 32 bit big endian size (1 means a 64 bit size follows the type,
+ * 0 means up to the end of the file), then the type. The moov box is
+ * either in front of the mdat or after it, at the end of the file */
+static GstBtMediaIndexResult
+probe_mp4 (GstBtMediaIndexProbe * probe, const guint8 * data,
+    gint64 data_offset, gint64 size, gint64 file_size)
+{
+  gint64 off = probe->offset;
+
+  while (off + 8 <= file_size)
+  {
+    gint64 avail = data_offset + size - off;
+    const guint8 *p;
+    guint64 box_size;
+    gint header = 8;
+
+    if (avail < 8)
+      break;
+    p = data + (off - data_offset);
+
+    box_size = read_be32 (p);
+    if (box_size == 1)
+    {
+      if (avail < 16)
+        break;
+      box_size = read_be64 (p + 8);
+      header = 16;
+    }
+    else if (box_size == 0)
+    {
+      box_size = file_size - off;
+    }
+
+    if (!is_fourcc (p + 4) || box_size < (guint64) header)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+
+    if (memcmp (p + 4, "moov", 4) == 0)
+    {
+      probe->index_start = off;
+      probe->index_end = off + (gint64) MIN (box_size, (guint64) (file_size - off));
+      return GST_BT_MEDIA_INDEX_FOUND;
+    }
+
+    if (box_size > (guint64) (file_size - off))
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    off += box_size;
+  }
+
+  probe->offset = off;
+  return off + 8 <= file_size ? GST_BT_MEDIA_INDEX_NEED_DATA
+      : GST_BT_MEDIA_INDEX_NOT_FOUND;
+}
+
+/* a RIFF file: "RIFF" size "AVI ", then chunks of a fourcc and a 32 bit
+ * little endian size, padded to an even size. The idx1 chunk follows the
+ * movi list, which holds all the media data */
+static GstBtMediaIndexResult
+probe_avi (GstBtMediaIndexProbe * probe, const guint8 * data,
+    gint64 data_offset, gint64 size, gint64 file_size)
+{
+  gint64 off = probe->offset;
+
+  if (off == 0)
+  {
+    if (data_offset != 0 || size < 12)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    if (memcmp (data, "RIFF", 4) != 0 || memcmp (data + 8, "AVI ", 4) != 0)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    off = 12;
+  }
+
+  while (off + 8 <= file_size)
+  {
+    gint64 avail = data_offset + size - off;
+    const guint8 *p;
+    guint32 chunk_size;
+
+    if (avail < 8)
+      break;
+    p = data + (off - data_offset);
+
+    chunk_size = read_le32 (p + 4);
+    if (!is_fourcc (p))
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+
+    if (memcmp (p, "idx1", 4) == 0)
+    {
+      probe->index_start = off;
+      probe->index_end = MIN (off + 8 + (gint64) chunk_size, file_size);
+      return GST_BT_MEDIA_INDEX_FOUND;
+    }
+
+    off += 8 + (gint64) chunk_size + (chunk_size & 1);
+  }
+
+  probe->offset = off;
+  return off + 8 <= file_size ? GST_BT_MEDIA_INDEX_NEED_DATA
+      : GST_BT_MEDIA_INDEX_NOT_FOUND;
+}
+
+/* an EBML header, then the Segment. Its first children are usually a
+ * SeekHead with the positions of the other top level elements, the Cues
+ * among them. The Cues come either before the first Cluster or at the end
+ * of the file. The Clusters aren't skipped one by one, that'd take a piece
+ * per Cluster, the walk jumps from the first one to where the SeekHead
+ * said the Cues are */
+static GstBtMediaIndexResult
+probe_mkv (GstBtMediaIndexProbe * probe, const guint8 * data,
+    gint64 data_offset, gint64 size, gint64 file_size)
+{
+  gint64 off = probe->offset;
+
+  while (off < file_size)
+  {
+    gint64 avail = data_offset + size - off;
+    const guint8 *p;
+    guint32 id;
+    guint64 len;
+    gboolean unknown;
+    gint n, m;
+
+    if (avail < 1)
+      break;
+    p = data + (off - data_offset);
+
+    n = read_ebml_id (p, avail, &id);
+    if (n < 0)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    if (n == 0)
+      break;
+    m = read_ebml_size (p + n, avail - n, &len, &unknown);
+    if (m < 0)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    if (m == 0)
+      break;
+
+    if (probe->segment_start < 0)
+    {
+      if (off == 0)
+      {
+        if (id != EBML_ID_HEADER || unknown)
+          return GST_BT_MEDIA_INDEX_NOT_FOUND;
+        off += n + m + len;
+        continue;
+      }
+      if (id != MKV_ID_SEGMENT)
+        return GST_BT_MEDIA_INDEX_NOT_FOUND;
+      probe->segment_start = off + n + m;
+      off = probe->segment_start;
+      continue;
+    }
+
+    if (id == MKV_ID_CUES)
+    {
+      probe->index_start = off;
+      probe->index_end = unknown ? file_size
+          : off + (gint64) MIN ((guint64) n + m + len, (guint64) (file_size - off));
+      return GST_BT_MEDIA_INDEX_FOUND;
+    }
+
+    if (id == MKV_ID_CLUSTER)
+    {
+      /* only jump forward, a bogus position must not make us go around
+       * in circles */
+      if (probe->cues_position > off)
+      {
+        off = probe->cues_position;
+        probe->cues_position = -1;
+        continue;
+      }
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+    }
+
+    if (unknown)
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+
+    /* the SeekHead and the Info are parsed in one go */
+    if ((id == MKV_ID_SEEKHEAD || id == MKV_ID_INFO) && avail < n + m + (gint64) len)
+      break;
+
+    if (id == MKV_ID_SEEKHEAD)
+    {
+      gint64 cues = mkv_seekhead_cues (p + n + m, (gint64) len);
+
+      if (cues >= 0)
+        probe->cues_position = probe->segment_start + cues;
+    }
+    else if (id == MKV_ID_INFO)
+    {
+      probe->timecode_scale = mkv_info_timecode_scale (p + n + m, (gint64) len);
+    }
+
+    off += n + m + len;
+  }
+
+  probe->offset = off;
+  return off < file_size ? GST_BT_MEDIA_INDEX_NEED_DATA
+      : GST_BT_MEDIA_INDEX_NOT_FOUND;
+}
+
+GstBtMediaContainer
+gst_bt_media_container_from_path (const gchar * path)
+{
+  GstBtMediaContainer ret = GST_BT_MEDIA_CONTAINER_NONE;
+  gchar *lower;
+
+  lower = g_ascii_strdown (path, -1);
+  if (g_str_has_suffix (lower, ".mp4") || g_str_has_suffix (lower, ".m4v")
+      || g_str_has_suffix (lower, ".mov"))
+    ret = GST_BT_MEDIA_CONTAINER_MP4;
+  else if (g_str_has_suffix (lower, ".mkv") || g_str_has_suffix (lower, ".webm"))
+    ret = GST_BT_MEDIA_CONTAINER_MKV;
+  else if (g_str_has_suffix (lower, ".avi"))
+    ret = GST_BT_MEDIA_CONTAINER_AVI;
+  g_free (lower);
+
+  return ret;
+}
+
+void
+gst_bt_media_index_probe_init (GstBtMediaIndexProbe * probe,
+    GstBtMediaContainer container)
+{
+  probe->container = container;
+  probe->offset = 0;
+  probe->segment_start = -1;
+  probe->cues_position = -1;
+  probe->timecode_scale = 1000000;
+  probe->index_start = -1;
+  probe->index_end = -1;
+}
+
+GstBtMediaIndexResult
+gst_bt_media_index_probe_feed (GstBtMediaIndexProbe * probe,
+    const guint8 * data, gint64 data_offset, gint64 size, gint64 file_size)
+{
+  /* the data must hold the place the walk continues at */
+  if (probe->offset < data_offset || probe->offset >= data_offset + size)
+    return GST_BT_MEDIA_INDEX_NEED_DATA;
+
+  switch (probe->container)
+  {
+    case GST_BT_MEDIA_CONTAINER_MP4:
+      return probe_mp4 (probe, data, data_offset, size, file_size);
+    case GST_BT_MEDIA_CONTAINER_MKV:
+      return probe_mkv (probe, data, data_offset, size, file_size);
+    case GST_BT_MEDIA_CONTAINER_AVI:
+      return probe_avi (probe, data, data_offset, size, file_size);
+    default:
+      return GST_BT_MEDIA_INDEX_NOT_FOUND;
+  }
+}
+
+/* steps to the next box in the data of a container box. Returns FALSE at
+ * the end of the data, or when the box doesn't fit in it */
+static gboolean
+mp4_next_box (const guint8 * p, gint64 size, gint64 * off, const guint8 ** type,
+    const guint8 ** payload, gint64 * len)
+{
+  guint64 box_size;
+  gint header = 8;
+
+  if (size - *off < 8)
+    return FALSE;
+
+  box_size = read_be32 (p + *off);
+  if (box_size == 1)
+  {
+    if (size - *off < 16)
+      return FALSE;
+    box_size = read_be64 (p + *off + 8);
+    header = 16;
+  }
+  else if (box_size == 0)
+  {
+    box_size = size - *off;
+  }
+  if (box_size < (guint64) header || box_size > (guint64) (size - *off))
+    return FALSE;
+
+  *type = p + *off + 4;
+  *payload = p + *off + header;
+  *len = (gint64) box_size - header;
+  *off += box_size;
+  return TRUE;
+}
+
+static const guint8 *
+mp4_find_box (const guint8 * p, gint64 size, const gchar * name, gint64 * len)
+{
+  const guint8 *type;
+  const guint8 *payload;
+  gint64 off = 0;
+
+  if (p == NULL)
+    return NULL;
+
+  while (mp4_next_box (p, size, &off, &type, &payload, len))
+  {
+    if (memcmp (type, name, 4) == 0)
+      return payload;
+  }
+  return NULL;
+}
+
+/* a full box with a 32 bit entry count after its version and flags, the
+ * entries must fit in it */
+static const guint8 *
+mp4_find_table (const guint8 * p, gint64 size, const gchar * name,
+    gint64 header, gint64 entry_size, guint32 * count)
+{
+  const guint8 *box;
+  gint64 len;
+
+  box = mp4_find_box (p, size, name, &len);
+  if (box == NULL || len < header)
+    return NULL;
+
+  *count = read_be32 (box + header - 4);
+  if ((len - header) / entry_size < (gint64) *count)
+    return NULL;
+  return box + header;
+}
+
+/* walks the samples of a video track chunk by chunk, to get the offsets and
+ * times of the sync samples */
+static GArray *
+mp4_trak_keyframes (const guint8 * trak, gint64 trak_size)
+{
+  const guint8 *mdia, *hdlr, *mdhd, *minf, *stbl;
+  const guint8 *stts, *stss, *stsc, *stsz, *stco;
+  gint64 mdia_len, hdlr_len, mdhd_len, minf_len, stbl_len, stsz_len;
+  guint32 stts_count, stss_count = 0, stsc_count, stco_count, sample_count;
+  guint32 sample_size;
+  guint32 timescale;
+  gboolean co64 = FALSE;
+  GArray *ret;
+  guint32 stts_i = 0, stts_left, stss_i = 0, stsc_i = 0;
+  guint32 chunk, sample = 1;
+  guint64 time = 0;
+
+  mdia = mp4_find_box (trak, trak_size, "mdia", &mdia_len);
+  hdlr = mp4_find_box (mdia, mdia_len, "hdlr", &hdlr_len);
+  if (hdlr == NULL || hdlr_len < 12 || memcmp (hdlr + 8, "vide", 4) != 0)
+    return NULL;
+
+  mdhd = mp4_find_box (mdia, mdia_len, "mdhd", &mdhd_len);
+  if (mdhd == NULL || mdhd_len < (mdhd[0] == 1 ? 24 : 16))
+    return NULL;
+  timescale = read_be32 (mdhd + (mdhd[0] == 1 ? 20 : 12));
+  if (timescale == 0)
+    return NULL;
+
+  minf = mp4_find_box (mdia, mdia_len, "minf", &minf_len);
+  stbl = mp4_find_box (minf, minf_len, "stbl", &stbl_len);
+  if (stbl == NULL)
+    return NULL;
+
+  stts = mp4_find_table (stbl, stbl_len, "stts", 8, 8, &stts_count);
+  stsc = mp4_find_table (stbl, stbl_len, "stsc", 8, 12, &stsc_count);
+  stco = mp4_find_table (stbl, stbl_len, "stco", 8, 4, &stco_count);
+  if (stco == NULL)
+  {
+    stco = mp4_find_table (stbl, stbl_len, "co64", 8, 8, &stco_count);
+    co64 = TRUE;
+  }
+  /* without a sync sample table every sample is a keyframe */
+  stss = mp4_find_table (stbl, stbl_len, "stss", 8, 4, &stss_count);
+  stsz = mp4_find_box (stbl, stbl_len, "stsz", &stsz_len);
+  if (stts == NULL || stsc == NULL || stco == NULL || stsz == NULL
+      || stts_count == 0 || stsc_count == 0 || stsz_len < 12)
+    return NULL;
+
+  sample_size = read_be32 (stsz + 4);
+  sample_count = read_be32 (stsz + 8);
+  if (sample_size == 0 && (stsz_len - 12) / 4 < (gint64) sample_count)
+    return NULL;
+
+  ret = g_array_new (FALSE, FALSE, sizeof (GstBtMediaKeyframe));
+  stts_left = read_be32 (stts);
+
+  for (chunk = 1; chunk <= stco_count && sample <= sample_count; chunk++)
+  {
+    guint64 offset;
+    guint32 per_chunk;
+    guint32 i;
+
+    while (stsc_i + 1 < stsc_count && read_be32 (stsc + (stsc_i + 1) * 12) <= chunk)
+      stsc_i++;
+    per_chunk = read_be32 (stsc + stsc_i * 12 + 4);
+    offset = co64 ? read_be64 (stco + (chunk - 1) * 8) : read_be32 (stco + (chunk - 1) * 4);
+
+    for (i = 0; i < per_chunk && sample <= sample_count; i++, sample++)
+    {
+      gboolean key = stss == NULL;
+
+      if (stss != NULL && stss_i < stss_count && read_be32 (stss + stss_i * 4) == sample)
+      {
+        key = TRUE;
+        stss_i++;
+      }
+
+      if (key)
+      {
+        GstBtMediaKeyframe kf;
+
+        kf.time = (gint64) (time / timescale * NSECONDS
+            + time % timescale * NSECONDS / timescale);
+        kf.offset = (gint64) offset;
+        g_array_append_val (ret, kf);
+      }
+
+      offset += sample_size ? sample_size : read_be32 (stsz + 12 + (sample - 1) * 4);
+
+      while (stts_left == 0 && stts_i + 1 < stts_count)
+      {
+        stts_i++;
+        stts_left = read_be32 (stts + stts_i * 8);
+      }
+      time += read_be32 (stts + stts_i * 8 + 4);
+      if (stts_left > 0)
+        stts_left--;
+    }
+  }
+
+  return ret;
+}
+
+static GArray *
+mp4_keyframes (const guint8 * moov, gint64 size)
+{
+  const guint8 *type;
+  const guint8 *payload;
+  gint64 len;
+  gint64 off = 0;
+
+  /* the moov box itself */
+  if (!mp4_next_box (moov, size, &off, &type, &payload, &len)
+      || memcmp (type, "moov", 4) != 0)
+    return NULL;
+
+  size = len;
+  moov = payload;
+  off = 0;
+  while (mp4_next_box (moov, size, &off, &type, &payload, &len))
+  {
+    GArray *ret;
+
+    if (memcmp (type, "trak", 4) != 0)
+      continue;
+    ret = mp4_trak_keyframes (payload, len);
+    if (ret != NULL)
+      return ret;
+  }
+  return NULL;
+}
+
+/* each CuePoint has a time and, per track, the position of the Cluster
+ * to start reading at. The first track's is taken */
+static GArray *
+mkv_keyframes (const GstBtMediaIndexProbe * probe, const guint8 * cues, gint64 size)
+{
+  const guint8 *payload;
+  const guint8 *point;
+  gint64 len;
+  gint64 point_len;
+  gint64 off = 0;
+  guint32 id;
+  GArray *ret;
+
+  if (!ebml_next_child (cues, size, &off, &id, &payload, &len) || id != MKV_ID_CUES)
+    return NULL;
+
+  ret = g_array_new (FALSE, FALSE, sizeof (GstBtMediaKeyframe));
+  off = 0;
+  while (ebml_next_child (payload, len, &off, &id, &point, &point_len))
+  {
+    const guint8 *child;
+    gint64 child_len;
+    gint64 point_off = 0;
+    gint64 time = -1;
+    gint64 position = -1;
+
+    if (id != MKV_ID_CUEPOINT)
+      continue;
+
+    while (ebml_next_child (point, point_len, &point_off, &id, &child, &child_len))
+    {
+      if (id == MKV_ID_CUETIME)
+      {
+        time = (gint64) ebml_uint (child, child_len) * probe->timecode_scale;
+      }
+      else if (id == MKV_ID_CUETRACKPOS && position < 0)
+      {
+        const guint8 *pos;
+        gint64 pos_len;
+        gint64 pos_off = 0;
+
+        while (ebml_next_child (child, child_len, &pos_off, &id, &pos, &pos_len))
+        {
+          if (id == MKV_ID_CUECLUSTERPOS)
+            position = probe->segment_start + (gint64) ebml_uint (pos, pos_len);
+        }
+      }
+    }
+
+    if (time >= 0 && position >= 0)
+    {
+      GstBtMediaKeyframe kf;
+
+      kf.time = time;
+      kf.offset = position;
+      g_array_append_val (ret, kf);
+    }
+  }
+
+  if (ret->len == 0)
+  {
+    g_array_free (ret, TRUE);
+    return NULL;
+  }
+  return ret;
+}
+
+GArray *
+gst_bt_media_index_keyframes (const GstBtMediaIndexProbe * probe,
+    const guint8 * index, gint64 size)
+{
+  GArray *ret = NULL;
+
+  switch (probe->container)
+  {
+    case GST_BT_MEDIA_CONTAINER_MP4:
+      ret = mp4_keyframes (index, size);
+      break;
+    case GST_BT_MEDIA_CONTAINER_MKV:
+      ret = mkv_keyframes (probe, index, size);
+      break;
+    default:
+      break;
+  }
+
+  if (ret != NULL && ret->len == 0)
+  {
+    g_array_free (ret, TRUE);
+    ret = NULL;
+  }
+  return ret;
+}
+
+guint
+gst_bt_media_index_keyframe_before (GArray * keyframes, gint64 time)
+{
+  guint lo = 0;
+  guint hi = keyframes->len;
+
+  /* the first keyframe after time */
+  while (lo < hi)
+  {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (keyframes, GstBtMediaKeyframe, mid).time <= time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo > 0 ? lo - 1 : 0;
+}
@@ -0,0 +1,106 @@
+/* Gst-Bt - BitTorrent related GStreamer elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GST_BT_MEDIA_INDEX_H
+#define GST_BT_MEDIA_INDEX_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* the containers whose index we know how to locate. The demuxers need the
+ * index before they can output the first frame, wherever it's stored in the
+ * file */
+typedef enum
+{
+  GST_BT_MEDIA_CONTAINER_NONE,
+  /* .mp4, .m4v, .mov -- the index is the moov box */
+  GST_BT_MEDIA_CONTAINER_MP4,
+  /* .mkv, .webm -- the index is the Cues element */
+  GST_BT_MEDIA_CONTAINER_MKV,
+  /* .avi -- the index is the idx1 chunk */
+  GST_BT_MEDIA_CONTAINER_AVI
+} GstBtMediaContainer;
+
+typedef enum
+{
+  /* index_start and index_end hold the location of the index */
+  GST_BT_MEDIA_INDEX_FOUND,
+  /* the walk ran past the data it was given, feed the data at offset */
+  GST_BT_MEDIA_INDEX_NEED_DATA,
+  /* no index, or not a file we can walk */
+  GST_BT_MEDIA_INDEX_NOT_FOUND
+} GstBtMediaIndexResult;
+
+/* walks the top level structure of a media file, a piece at a time, to find
+ * where its index is. All offsets are in bytes from the start of the file */
+typedef struct _GstBtMediaIndexProbe
+{
+  GstBtMediaContainer container;
+
+  /* where the walk continues */
+  gint64 offset;
+
+  /* the start of the matroska Segment's data, the SeekHead and Cues
+   * positions are relative to it. -1 until the Segment is found */
+  gint64 segment_start;
+
+  /* where the SeekHead says the Cues are, -1 if it doesn't. They're only
+   * jumped to at the first Cluster, so that the Info in between is seen */
+  gint64 cues_position;
+
+  /* nanoseconds per matroska timestamp tick, from the Info */
+  gint64 timecode_scale;
+
+  /* the index, [index_start, index_end) */
+  gint64 index_start;
+  gint64 index_end;
+} GstBtMediaIndexProbe;
+
+GstBtMediaContainer gst_bt_media_container_from_path (const gchar * path);
+
+void gst_bt_media_index_probe_init (GstBtMediaIndexProbe * probe,
+    GstBtMediaContainer container);
+
+/* continues the walk with the bytes [data_offset, data_offset + size) of the
+ * file. When the walk runs past them, NEED_DATA is returned and the probe's
+ * offset says where it continues. That may be inside the given data, when a
+ * header straddles its end */
+GstBtMediaIndexResult gst_bt_media_index_probe_feed (GstBtMediaIndexProbe * probe,
+    const guint8 * data, gint64 data_offset, gint64 size, gint64 file_size);
+
+/* a keyframe's timestamp in nanoseconds, and the offset of its data.
+ * matroska has the offset of the Cluster the keyframe is in */
+typedef struct _GstBtMediaKeyframe
+{
+  gint64 time;
+  gint64 offset;
+} GstBtMediaKeyframe;
+
+/* parses the index the probe found, from the mp4 video track's sync sample
+ * table or the matroska Cues. index holds the bytes [index_start,
+ * index_end). Returns an array of GstBtMediaKeyframe in time order, or NULL
+ * if there are none (avi is not supported, its idx1 has no times) */
+GArray * gst_bt_media_index_keyframes (const GstBtMediaIndexProbe * probe,
+    const guint8 * index, gint64 size);
+
+/* the position of the last keyframe at or before time, 0 if there's none */
+guint gst_bt_media_index_keyframe_before (GArray * keyframes, gint64 time);
+
+G_END_DECLS
+
+#endif /* GST_BT_MEDIA_INDEX_H */
@@ -161,6 +161,16 @@ namespace aux {
 		// enough room, returns 0
 		char* allocate_appendix(int s);
 
+		// the largest number of buffers handed to a single gathering
+		// write. asio passes at most this many iovec entries to
+		// sendmsg()/writev() and silently drops the rest, so there's no
+		// point building a longer vector than this.
+		static constexpr int max_iovec_entries = 64;
+
+		// builds the list of buffers to pass to a single gathering write
+		// (sendmsg()/writev()) covering up to ``to_send`` bytes from the
+		// front of the chain. The vector is capped at max_iovec_entries, in
+		// which case fewer than ``to_send`` bytes are covered.
 		span<boost::asio::const_buffer const> build_iovec(int to_send);
 
 		void clear();
@@ -206,7 +216,7 @@ namespace aux {
 		}
 
 		template <typename Buffer>
-		void build_vec(int bytes, std::vector<Buffer>& vec);
+		void build_vec(int bytes, std::vector<Buffer>& vec, int max_entries);
 
 		// this is the list of all the buffers we want to
 		// send
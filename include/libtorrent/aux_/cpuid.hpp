@@ -40,6 +40,7 @@ namespace libtorrent { namespace aux {
 	// initialized by static initializers (in cpuid.cpp)
 	TORRENT_EXTRA_EXPORT extern bool const sse42_support;
 	TORRENT_EXTRA_EXPORT extern bool const mmx_support;
+	TORRENT_EXTRA_EXPORT extern bool const avx2_support;
 	TORRENT_EXTRA_EXPORT extern bool const arm_neon_support;
 	TORRENT_EXTRA_EXPORT extern bool const arm_crc32c_support;
 } }
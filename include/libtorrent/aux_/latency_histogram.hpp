@@ -0,0 +1,99 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_LATENCY_HISTOGRAM_HPP_INCLUDED
+#define TORRENT_LATENCY_HISTOGRAM_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/aux_/array.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace libtorrent {
+namespace aux {
+
+	// a log-linear histogram of latency samples (in microseconds). Every
+	// power-of-two range is split into sub_buckets linear buckets, which
+	// bounds the relative error of a reported percentile to 1/sub_buckets
+	// while keeping the whole histogram a few kilobytes. Samples may be
+	// recorded from any thread. Percentiles are computed over the samples
+	// recorded since the previous call to snapshot(), which must only be
+	// called from one thread at a time.
+	struct TORRENT_EXTRA_EXPORT latency_histogram
+	{
+		latency_histogram();
+
+		latency_histogram(latency_histogram const&) = delete;
+		latency_histogram& operator=(latency_histogram const&) = delete;
+
+		void record(std::int64_t microseconds);
+
+		struct percentiles
+		{
+			// the number of samples these percentiles were computed from.
+			// When this is 0, the values are meaningless.
+			std::int64_t samples = 0;
+			std::int64_t p50 = 0;
+			std::int64_t p99 = 0;
+			std::int64_t p999 = 0;
+		};
+
+		// returns p50, p99 and p999 of the samples recorded since the last
+		// snapshot
+		percentiles snapshot();
+
+		static constexpr int sub_bucket_shift = 3;
+		static constexpr int sub_buckets = 1 << sub_bucket_shift;
+
+		// values at or above 2^max_shift microseconds (about 6 days) all
+		// land in the last bucket
+		static constexpr int max_shift = 39;
+		static constexpr int num_buckets = (max_shift - sub_bucket_shift + 1) * sub_buckets;
+
+		static int bucket_index(std::int64_t value);
+
+		// the value reported for samples falling in bucket ``idx``. This is
+		// the middle of the bucket's range
+		static std::int64_t bucket_value(int idx);
+
+	private:
+
+		aux::array<std::atomic<std::uint64_t>, num_buckets> m_buckets;
+
+		// the bucket counts as of the last snapshot, to compute the deltas
+		aux::array<std::uint64_t, num_buckets> m_last;
+	};
+}
+}
+
+#endif // TORRENT_LATENCY_HISTOGRAM_HPP_INCLUDED
@@ -0,0 +1,72 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_MAPPED_TORRENT_HPP_INCLUDED
+#define TORRENT_MAPPED_TORRENT_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+
+#if TORRENT_HAVE_MMAP || TORRENT_HAVE_MAP_VIEW_OF_FILE
+
+#include "libtorrent/bdecode.hpp"
+#include "libtorrent/error_code.hpp"
+
+#include <memory>
+#include <string>
+
+namespace libtorrent {
+
+	struct load_torrent_limits;
+
+namespace aux {
+
+	// a .torrent file mapped read-only into memory, along with the root of
+	// its decoded token table
+	struct TORRENT_EXTRA_EXPORT mapped_torrent
+	{
+		// refers to the first byte of the file and keeps the mapping alive
+		std::shared_ptr<char const> buffer;
+		int size = 0;
+
+		bdecode_node root;
+	};
+
+	// maps ``filename`` into memory and decodes it, with the limits in
+	// ``cfg``
+	TORRENT_EXTRA_EXPORT mapped_torrent map_torrent_file(std::string const& filename
+		, load_torrent_limits const& cfg, error_code& ec);
+}
+}
+
+#endif // HAVE_MMAP || HAVE_MAP_VIEW_OF_FILE
+
+#endif
@@ -0,0 +1,111 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_METRICS_SERVER_HPP_INCLUDED
+#define TORRENT_METRICS_SERVER_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/socket.hpp"
+#include "libtorrent/io_context.hpp"
+#include "libtorrent/error_code.hpp"
+#include "libtorrent/sha1_hash.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libtorrent {
+
+	struct counters;
+
+namespace aux {
+
+	struct metrics_connection;
+
+	// the per-torrent values included in a metrics snapshot
+	struct torrent_metrics
+	{
+		sha1_hash info_hash;
+		int download_payload_rate;
+		int upload_payload_rate;
+	};
+
+	// renders every metric in session_stats_metrics() plus the per-torrent
+	// rates in the OpenMetrics text format
+	TORRENT_EXTRA_EXPORT std::string render_openmetrics(counters const& cnt
+		, std::vector<torrent_metrics> const& torrents);
+
+	// a minimal, read-only HTTP server bound to the loopback interface. It
+	// serves the most recent snapshot passed to set_snapshot() at /metrics.
+	// The snapshot is rendered by the network thread, a scrape only copies a
+	// reference to it, so it never waits on the session or the disk. All of
+	// this runs on the network thread.
+	struct TORRENT_EXTRA_EXPORT metrics_server
+		: std::enable_shared_from_this<metrics_server>
+	{
+		explicit metrics_server(io_context& ios);
+		~metrics_server();
+
+		metrics_server(metrics_server const&) = delete;
+		metrics_server& operator=(metrics_server const&) = delete;
+
+		// start listening on 127.0.0.1:``port``
+		void start(int port, error_code& ec);
+		void close();
+
+		int listen_port() const { return m_port; }
+
+		void set_snapshot(std::string s);
+
+		// the max number of concurrent scrapes. Connections beyond this are
+		// closed right away
+		static constexpr int max_connections = 8;
+
+	private:
+
+		friend struct metrics_connection;
+
+		void start_accept();
+		void on_accept(error_code const& ec, tcp::socket s);
+
+		io_context& m_ios;
+		tcp::acceptor m_acceptor;
+		int m_port = 0;
+		bool m_closed = false;
+
+		std::shared_ptr<std::string const> m_snapshot;
+		std::vector<std::weak_ptr<metrics_connection>> m_connections;
+	};
+}
+}
+
+#endif // TORRENT_METRICS_SERVER_HPP_INCLUDED
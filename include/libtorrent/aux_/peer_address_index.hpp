@@ -0,0 +1,114 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_PEER_ADDRESS_INDEX_HPP_INCLUDED
+#define TORRENT_PEER_ADDRESS_INDEX_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/address.hpp"
+#include "libtorrent/span.hpp"
+#include "libtorrent/torrent_peer.hpp"
+#include "libtorrent/assert.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace libtorrent { namespace aux {
+
+	// an open addressing hash table (with linear probing) indexing the peers
+	// in peer_list by address. The table only holds positions into the
+	// peer_list's vector of peers, 4 bytes per slot. The addresses are read
+	// from the peers themselves, which is why every operation is passed the
+	// current vector of peers.
+	struct TORRENT_EXTRA_EXPORT peer_address_index
+	{
+		// adds the peer at position ``idx`` to the index
+		void insert(span<torrent_peer* const> peers, int idx);
+
+		// removes the peer at position ``idx`` from the index. ``peers``
+		// must still hold it at that position
+		void erase(span<torrent_peer* const> peers, int idx);
+
+		// updates the index for the peer at position ``from`` being moved to
+		// position ``to``. ``peers`` must still hold it at ``from``
+		void move(span<torrent_peer* const> peers, int from, int to);
+
+		// calls ``pred`` for the peers with address ``a`` until it returns
+		// true. Returns the position of that peer, or -1 if it never
+		// returned true
+		template <typename Pred>
+		int find(span<torrent_peer* const> peers, address const& a, Pred pred) const
+		{
+			if (m_size == 0) return -1;
+			std::size_t const mask = m_slots.size() - 1;
+			for (std::size_t i = hash(a) & mask;; i = (i + 1) & mask)
+			{
+				std::int32_t const idx = m_slots[i];
+				if (idx < 0) return -1;
+				torrent_peer* p = peers[idx];
+				if (p->address() == a && pred(p)) return idx;
+			}
+		}
+
+		// returns the position of the first peer with address ``a``, or -1
+		int find(span<torrent_peer* const> peers, address const& a) const
+		{ return find(peers, a, [](torrent_peer const*) { return true; }); }
+
+		int size() const { return m_size; }
+		void clear();
+
+		// the number of bytes of heap memory held by the index
+		std::size_t memory_usage() const
+		{ return m_slots.capacity() * sizeof(std::int32_t); }
+
+#if TORRENT_USE_INVARIANT_CHECKS
+		void check_invariant(span<torrent_peer* const> peers) const;
+#endif
+
+	private:
+
+		static std::size_t hash(address const& a);
+
+		// returns the slot holding position ``idx``
+		std::size_t find_slot(span<torrent_peer* const> peers, int idx) const;
+
+		void grow(span<torrent_peer* const> peers);
+
+		// each slot is a position in the peer vector, or -1 if empty
+		std::vector<std::int32_t> m_slots;
+
+		// the number of non-empty slots
+		int m_size = 0;
+	};
+}}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_PIECE_HASH_PIPELINE_HPP_INCLUDED
+#define TORRENT_PIECE_HASH_PIPELINE_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/error_code.hpp"
+#include "libtorrent/sha1_hash.hpp"
+#include "libtorrent/units.hpp"
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+namespace libtorrent {
+
+	class file_storage;
+
+namespace aux {
+
+	// computes the SHA-1 hash of every piece in ``fs``, whose files are
+	// found under ``save_path``. The files are read sequentially by the
+	// calling thread, in batches of at least 1 MiB, and the batches are
+	// hashed by ``num_threads`` hasher threads. One batch per thread, plus
+	// the one being read, is held in buffers, but no more than ``readahead``
+	// bytes, or two batches if that's more.
+	//
+	// ``on_piece`` is called on the calling thread, once for every piece, in
+	// the order the pieces complete. If ``cancel`` is set, hashing stops
+	// early without reporting an error.
+	TORRENT_EXTRA_EXPORT void hash_pieces(file_storage const& fs
+		, std::string const& save_path, int num_threads, std::int64_t readahead
+		, std::function<void(piece_index_t, sha1_hash const&)> const& on_piece
+		, std::atomic<bool> const* cancel, error_code& ec);
+}
+}
+
+#endif
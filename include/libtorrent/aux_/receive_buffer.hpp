@@ -39,6 +39,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/disk_buffer_holder.hpp"
 #include "libtorrent/sliding_average.hpp"
 #include "libtorrent/aux_/numeric_cast.hpp"
+#include "libtorrent/aux_/receive_buffer_pool.hpp"
 
 #include <climits>
 
@@ -49,7 +50,13 @@ struct TORRENT_EXTRA_EXPORT receive_buffer
 {
 	friend struct crypto_receive_buffer;
 
-	// explicitly disallow assignment, to silence msvc warning
+	// if a pool is specified, all allocations are borrowed from it and
+	// handed back to it when no longer needed
+	explicit receive_buffer(receive_buffer_pool* p = nullptr) : m_pool(p) {}
+	~receive_buffer();
+
+	// explicitly disallow copying, to silence msvc warning
+	receive_buffer(receive_buffer const&) = delete;
 	receive_buffer& operator=(receive_buffer const&) = delete;
 
 	int packet_size() const { return m_packet_size; }
@@ -75,6 +82,12 @@ struct TORRENT_EXTRA_EXPORT receive_buffer
 	void received(int bytes_transferred)
 	{
 		TORRENT_ASSERT(m_packet_size > 0);
+		if (m_disk_recv_buffer)
+		{
+			m_disk_recv_end += bytes_transferred;
+			TORRENT_ASSERT(m_disk_recv_start + m_disk_recv_end <= m_packet_size);
+			return;
+		}
 		m_recv_end += bytes_transferred;
 		TORRENT_ASSERT(m_recv_pos <= int(m_recv_buffer.size()));
 	}
@@ -84,7 +97,7 @@ struct TORRENT_EXTRA_EXPORT receive_buffer
 	int advance_pos(int bytes);
 
 	// has the read cursor reached the end cursor?
-	bool pos_at_end() { return m_recv_pos == m_recv_end; }
+	bool pos_at_end() { return m_recv_pos == m_recv_end + m_disk_recv_end; }
 
 	// size = the packet size to remove from the receive buffer
 	// packet_size = the next packet size to receive in the buffer
@@ -92,9 +105,26 @@ struct TORRENT_EXTRA_EXPORT receive_buffer
 	void cut(int size, int packet_size, int offset = 0);
 
 	// return the interval between the start of the buffer to the read cursor.
-	// This is the "current" packet.
+	// This is the "current" packet. If the payload of the current packet is
+	// being received into a disk buffer, only the header is returned.
 	span<char const> get() const;
 
+	// once the header of a piece message has been parsed, the rest of the
+	// packet (the last ``payload_size`` bytes of it) can be received straight
+	// into a disk buffer, to have it handed to the disk thread without
+	// copying it. Any payload bytes already received are moved into ``buf``.
+	// Returns false if the buffer cannot be switched at this point (in which
+	// case ``buf`` is freed).
+	bool assign_disk_buffer(disk_buffer_holder buf, int payload_size);
+
+	// true while the payload of the current packet is received into a disk
+	// buffer
+	bool has_disk_buffer() const { return bool(m_disk_recv_buffer); }
+
+	// returns the disk buffer holding the payload of the current packet. This
+	// may only be called once the packet is finished
+	disk_buffer_holder release_disk_buffer();
+
 
 	// the purpose of this function is to free up and cut off all messages
 	// in the receive buffer that have been parsed and processed.
@@ -103,18 +133,40 @@ struct TORRENT_EXTRA_EXPORT receive_buffer
 
 	void reset(int packet_size);
 
+	// if there's no message in flight, hand the allocation back to the pool
+	// and keep just a small buffer around, large enough for the buffered
+	// bytes and the next message header. Returns true if the buffer was
+	// released.
+	bool release_idle();
+
+	// the size of the buffer kept by idle connections
+	static constexpr int idle_buffer_size = 128;
+
 #if TORRENT_USE_INVARIANT_CHECKS
 	void check_invariant() const
 	{
 		TORRENT_ASSERT(m_recv_end >= m_recv_start);
 		TORRENT_ASSERT(m_recv_end <= int(m_recv_buffer.size()));
 		TORRENT_ASSERT(m_recv_start <= int(m_recv_buffer.size()));
-		TORRENT_ASSERT(m_recv_start + m_recv_pos <= int(m_recv_buffer.size()));
+		if (m_disk_recv_start > 0)
+		{
+			TORRENT_ASSERT(m_recv_end - m_recv_start == m_disk_recv_start);
+			TORRENT_ASSERT(m_recv_pos <= m_disk_recv_start + m_disk_recv_end);
+		}
+		else
+		{
+			TORRENT_ASSERT(m_recv_start + m_recv_pos <= int(m_recv_buffer.size()));
+		}
 	}
 #endif
 
 private:
 
+	// replace m_recv_buffer with a new allocation of (at least) size bytes,
+	// initialized by the bytes in init. The old buffer is returned to the
+	// pool (if any)
+	void reallocate(int size, span<char const> init);
+
 	// m_recv_buffer.data() (start of actual receive buffer)
 	// |
 	// |      m_recv_start (start of current packet)
@@ -154,6 +206,23 @@ private:
 	sliding_average<std::ptrdiff_t, 20> m_watermark;
 
 	buffer m_recv_buffer;
+
+	// the pool m_recv_buffer is borrowed from, or nullptr if it's allocated
+	// directly from the heap
+	receive_buffer_pool* m_pool = nullptr;
+
+	// if the payload of the current packet is received into a disk buffer,
+	// this is it. Only the packet's header is kept in m_recv_buffer
+	disk_buffer_holder m_disk_recv_buffer;
+
+	// the offset into the current packet where the payload received into
+	// m_disk_recv_buffer starts (i.e. the size of the header). This is 0
+	// when the packet is received into m_recv_buffer only. It's left set
+	// after the disk buffer has been released, until the next packet
+	int m_disk_recv_start = 0;
+
+	// the number of payload bytes received into m_disk_recv_buffer
+	int m_disk_recv_end = 0;
 };
 
 
@@ -0,0 +1,103 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_RECEIVE_BUFFER_POOL_HPP_INCLUDED
+#define TORRENT_RECEIVE_BUFFER_POOL_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/aux_/buffer.hpp"
+#include "libtorrent/aux_/array.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace libtorrent {
+
+	struct counters;
+
+namespace aux {
+
+	// a session-wide, size-classed pool of receive buffers. Peer connections
+	// borrow a buffer from here while a message is in flight and hand it back
+	// once they go idle. Buffers are binned by power-of-two size classes, so a
+	// returned buffer can satisfy any later request of its class without
+	// hitting the heap. This is only ever used from the network thread.
+	struct TORRENT_EXTRA_EXPORT receive_buffer_pool
+	{
+		explicit receive_buffer_pool(counters& cnt);
+		~receive_buffer_pool();
+
+		receive_buffer_pool(receive_buffer_pool const&) = delete;
+		receive_buffer_pool& operator=(receive_buffer_pool const&) = delete;
+
+		// returns a buffer of at least ``size`` bytes. The contents are
+		// uninitialized.
+		buffer allocate(int size);
+
+		// hand a buffer back to the pool. If the pool is already holding
+		// its limit of idle bytes, the buffer is freed.
+		void release(buffer buf);
+
+		// the max number of bytes the pool holds on to in idle buffers
+		void set_max_pooled_bytes(int bytes);
+
+		// frees all idle buffers. Returns the number of bytes freed
+		std::int64_t release_idle();
+
+		std::int64_t pooled_bytes() const { return m_pooled_bytes; }
+		std::int64_t in_use_bytes() const { return m_in_use_bytes; }
+
+		// size classes are 1 << n bytes, for n in [min_class_shift,
+		// max_class_shift]. Requests larger than the largest class are
+		// allocated (and freed) directly.
+		static constexpr int min_class_shift = 7;
+		static constexpr int max_class_shift = 22;
+		static constexpr int num_size_classes = max_class_shift - min_class_shift + 1;
+
+	private:
+
+		void update_counters();
+		void trim(std::int64_t limit);
+
+		counters& m_counters;
+
+		// one free list per size class
+		aux::array<std::vector<buffer>, num_size_classes> m_free;
+
+		std::int64_t m_pooled_bytes = 0;
+		std::int64_t m_in_use_bytes = 0;
+		std::int64_t m_max_pooled_bytes = 8 * 1024 * 1024;
+	};
+}
+}
+
+#endif // TORRENT_RECEIVE_BUFFER_POOL_HPP_INCLUDED
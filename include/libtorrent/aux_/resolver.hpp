@@ -41,10 +41,16 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <unordered_map>
 #include <vector>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
 
 #include "libtorrent/error_code.hpp"
 #include "libtorrent/io_context.hpp"
 #include "libtorrent/socket.hpp"
+#include "libtorrent/deadline_timer.hpp"
 #include "libtorrent/aux_/resolver_interface.hpp"
 #include "libtorrent/address.hpp"
 
@@ -54,23 +60,58 @@ namespace aux {
 struct TORRENT_EXTRA_EXPORT resolver final : resolver_interface
 {
 	explicit resolver(io_context& ios);
+	~resolver();
+	resolver(resolver const&) = delete;
+	resolver& operator=(resolver const&) = delete;
 
 	void async_resolve(std::string const& host, resolver_flags flags
 		, callback_t h) override;
 
+	void prefetch(std::string const& host) override;
+
 	void abort() override;
 
 	void set_cache_timeout(seconds timeout) override;
 
+	// the number of seconds a failed lookup is cached for
+	void set_negative_cache_timeout(seconds timeout);
+
+	// the max number of host names looked up in parallel. Lookups run on a
+	// pool of threads owned by the resolver, started on demand. 0 hands
+	// lookups to asio's resolver, which runs them one at a time.
+	void set_max_concurrency(int n);
+
+	// the function used by the lookup threads to resolve a host name. The
+	// default uses the system resolver. It's called without holding any
+	// locks, on one of the lookup threads. This is meant for tests and
+	// benchmarks, to stand in for a real DNS server.
+	using lookup_function = std::function<error_code(std::string const&
+		, std::vector<address>&)>;
+	void set_lookup_function(lookup_function f);
+
 private:
 
+	void start_lookup(std::string const& host, resolver_flags flags
+		, bool background);
+
 	void on_lookup(error_code const& ec, tcp::resolver::results_type ips
 		, std::string const& hostname);
 
+	void lookup_done(error_code const& ec, std::vector<address> const& ips
+		, std::string const& hostname);
+
+	void lookup_thread();
+
+	void arm_refresh_timer();
+	void on_refresh_timer(error_code const& ec);
+
 	struct dns_cache_entry
 	{
 		time_point last_seen;
 		std::vector<address> addresses;
+		// set when the entry has been asked for since it was last resolved.
+		// Only entries in use are refreshed in the background
+		bool used = false;
 	};
 
 	struct failed_dns_cache_entry
@@ -89,15 +130,46 @@ private:
 	// lookups in this resolver are not aborted on shutdown
 	tcp::resolver m_critical_resolver;
 
+	// refreshes cache entries in use before they time out, to keep lookups
+	// off the critical path of announces
+	deadline_timer m_refresh_timer;
+
 	// max number of cached entries
 	int m_max_size;
 
 	// timeout of cache entries
 	time_duration m_timeout;
 
+	// timeout of failed lookups
+	time_duration m_negative_timeout;
+
 	// the callbacks to call when a host resolution completes. This allows to
-	// attach more callbacks if the same host is looked up multiple times
+	// attach more callbacks if the same host is looked up multiple times.
+	// Prefetches and refreshes insert an empty callback, to mark the host
+	// as being looked up
 	std::multimap<std::string, resolver_interface::callback_t> m_callbacks;
+
+	bool m_refresh_timer_armed = false;
+	bool m_abort = false;
+
+	struct queued_lookup
+	{
+		std::string host;
+		resolver_flags flags;
+	};
+
+	// the state below is shared with the lookup threads and protected by
+	// m_queue_mutex. Lookups on behalf of a caller are served before
+	// prefetches and refreshes
+	std::mutex m_queue_mutex;
+	std::condition_variable m_queue_cond;
+	std::deque<queued_lookup> m_queue;
+	std::deque<queued_lookup> m_background_queue;
+	std::vector<std::thread> m_threads;
+	lookup_function m_lookup;
+	int m_max_concurrency = 0;
+	int m_active_lookups = 0;
+	bool m_shutdown = false;
 };
 
 }
@@ -65,6 +65,11 @@ struct TORRENT_EXTRA_EXPORT resolver_interface
 	virtual void async_resolve(std::string const& host, resolver_flags flags
 		, callback_t h) = 0;
 
+	// looks up ``host`` ahead of it being needed, to have it in the cache
+	// by the time it's asked for. Nothing is reported back. Prefetches are
+	// aborted on shutdown.
+	virtual void prefetch(std::string const& host) = 0;
+
 	virtual void abort() = 0;
 
 	virtual void set_cache_timeout(seconds timeout) = 0;
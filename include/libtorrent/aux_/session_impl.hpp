@@ -46,6 +46,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/socket_type.hpp"
 #include "libtorrent/torrent_peer.hpp"
 #include "libtorrent/torrent_peer_allocator.hpp"
+#include "libtorrent/aux_/receive_buffer_pool.hpp"
+#include "libtorrent/aux_/metrics_server.hpp"
 #include "libtorrent/performance_counters.hpp" // for counters
 #include "libtorrent/aux_/allocating_handler.hpp"
 #include "libtorrent/aux_/time.hpp"
@@ -404,6 +406,9 @@ namespace aux {
 			torrent_peer_allocator_interface& get_peer_allocator() override
 			{ return m_peer_allocator; }
 
+			receive_buffer_pool& get_receive_buffer_pool() override
+			{ return m_recv_buffer_pool; }
+
 			io_context& get_context() override { return m_io_context; }
 			resolver_interface& get_resolver() override { return m_host_resolver; }
 
@@ -544,6 +549,10 @@ namespace aux {
 			void post_torrent_updates(status_flags_t flags);
 			void post_session_stats();
 
+			// re-render the snapshot served by the metrics endpoint, if it's
+			// enabled. Called once per second from on_tick()
+			void update_metrics_snapshot();
+
 			std::vector<torrent_handle> get_torrents() const;
 
 			void pop_alerts(std::vector<alert*>* alerts);
@@ -736,6 +745,10 @@ namespace aux {
 			void update_auto_sequential();
 			void update_max_failcount();
 			void update_resolver_cache_timeout();
+			void update_resolver_negative_cache_timeout();
+			void update_resolver_max_concurrency();
+			void update_recv_buffer_pool_size();
+			void update_metrics_port();
 
 			void update_ip_notifier();
 			void update_upnp();
@@ -784,6 +797,15 @@ namespace aux {
 			// torrents) depend on this outliving them.
 			torrent_peer_allocator m_peer_allocator;
 
+			// peer connections borrow their receive buffers from this pool.
+			// The peer connections return their buffers on destruction, so
+			// this must outlive them
+			receive_buffer_pool m_recv_buffer_pool;
+
+			// the localhost OpenMetrics endpoint, only set when the
+			// metrics_port setting is non-zero
+			std::shared_ptr<metrics_server> m_metrics_server;
+
 			// this vector is used to store the block_info
 			// objects pointed to by partial_piece_info returned
 			// by torrent::get_download_queue.
@@ -928,6 +950,9 @@ namespace aux {
 			// TODO: replace this by a proper asio timer
 			int m_auto_manage_time_scaler = 0;
 
+			// the number of seconds until the next memory usage check
+			int m_memory_check_scaler = 0;
+
 			// works like unchoke_time_scaler but it
 			// is only decreased when the unchoke set
 			// is recomputed, and when it reaches zero,
@@ -969,6 +994,10 @@ namespace aux {
 				, int& tracker_limit
 				, int& lsd_limit, int& hard_limit, int type_limit);
 			void recalculate_auto_managed_torrents();
+
+			// updates the mem.* counters, and sheds memory if the session is
+			// over its memory_budget
+			void update_memory_usage();
 			void recalculate_unchoke_slots();
 			void recalculate_optimistic_unchoke_slots();
 
@@ -77,6 +77,7 @@ namespace aux {
 	struct bandwidth_manager;
 	struct resolver_interface;
 	struct alert_manager;
+	struct receive_buffer_pool;
 }
 
 	// hidden
@@ -147,6 +148,7 @@ namespace aux {
 		virtual alert_manager& alerts() = 0;
 
 		virtual torrent_peer_allocator_interface& get_peer_allocator() = 0;
+		virtual aux::receive_buffer_pool& get_receive_buffer_pool() = 0;
 		virtual io_context& get_context() = 0;
 		virtual aux::resolver_interface& get_resolver() = 0;
 
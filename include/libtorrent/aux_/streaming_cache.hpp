@@ -0,0 +1,150 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_STREAMING_CACHE_HPP_INCLUDED
+#define TORRENT_STREAMING_CACHE_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/storage_defs.hpp"
+#include "libtorrent/units.hpp"
+#include "libtorrent/span.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace libtorrent {
+namespace aux {
+
+	// a bounded cache of blocks around the stream cursor of each storage
+	// that's being played back. The cursor of a storage is the last piece
+	// the client read with torrent_handle::read_piece() and the playback
+	// flag. Blocks read by the client and blocks downloaded for the storage
+	// are kept, and when the cache is full, the pieces farthest from their
+	// storage's cursor are evicted first, in batches. Pieces behind the cursor count twice their distance, since
+	// playback moves away from them, but a backward seek over the last few
+	// pieces is still served from RAM. Storages that have never been read
+	// from with a cursor are not cached at all.
+	// This is used from the network thread and the disk threads.
+	struct TORRENT_EXTRA_EXPORT streaming_cache
+	{
+		streaming_cache() = default;
+		streaming_cache(streaming_cache const&) = delete;
+		streaming_cache& operator=(streaming_cache const&) = delete;
+
+		// the max number of bytes of blocks to hold. 0 disables the cache
+		// and frees everything in it. Shrinking it evicts right away.
+		void set_max_size(std::int64_t bytes);
+
+		bool enabled() const;
+
+		// move the stream cursor of ``st`` to ``piece``
+		void set_cursor(storage_index_t st, piece_index_t piece);
+		bool has_cursor(storage_index_t st) const;
+
+		// returns true if every block ``length`` bytes at ``offset`` into
+		// ``piece`` touch is in the cache. This lets the caller allocate a
+		// buffer for get() only when it will hit.
+		bool has(storage_index_t st, piece_index_t piece, int offset
+			, int length) const;
+
+		// copy ``buf.size()`` bytes at ``offset`` into ``piece`` to ``buf``.
+		// Returns false, leaving ``buf`` untouched, unless every block the
+		// range touches is in the cache.
+		bool get(storage_index_t st, piece_index_t piece, int offset
+			, span<char> buf) const;
+
+		// keep a copy of the block at ``offset`` (which must be block
+		// aligned). It is dropped right away if the storage has no cursor,
+		// or if it's farther from the cursor than everything else in a full
+		// cache.
+		void insert(storage_index_t st, piece_index_t piece, int offset
+			, span<char const> buf);
+
+		// drop a piece, when it failed the hash check
+		void erase_piece(storage_index_t st, piece_index_t piece);
+
+		// drop all pieces and the cursor of a storage, when it's removed or
+		// its files are deleted or re-checked
+		void erase_storage(storage_index_t st);
+
+		// the number of bytes of blocks held
+		std::int64_t size() const;
+
+	private:
+
+		using piece_key = std::pair<storage_index_t, piece_index_t>;
+
+		struct cached_block
+		{
+			std::unique_ptr<char[]> buf;
+			int size = 0;
+		};
+
+		struct cached_piece
+		{
+			std::vector<cached_block> blocks;
+		};
+
+		// how far the piece is from its storage's cursor. The piece with the
+		// highest score is evicted first
+		std::int64_t score(piece_key const& k) const;
+
+		bool has_range(cached_piece const& p, int offset, int end) const;
+
+		// when ``bytes`` more don't fit, erase pieces, highest score first,
+		// until the cache is down to 7/8 of its max size (or ``bytes`` fit,
+		// if that's more). Evicting a batch at a time keeps the scan over all
+		// pieces off the path of most inserts. Pieces scoring ``limit`` or
+		// lower are never evicted. Returns false if there wasn't enough to
+		// evict
+		bool make_room(std::int64_t bytes, std::int64_t limit
+			, piece_key const* keep);
+
+		void erase_impl(std::map<piece_key, cached_piece>::iterator it);
+
+		mutable std::mutex m_mutex;
+
+		std::int64_t m_max_size = 0;
+		std::int64_t m_size = 0;
+
+		std::map<piece_key, cached_piece> m_pieces;
+		std::map<storage_index_t, piece_index_t> m_cursors;
+	};
+
+}
+}
+
+#endif
@@ -0,0 +1,202 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_UTP_CONGESTION_CONTROL_HPP_INCLUDED
+#define TORRENT_UTP_CONGESTION_CONTROL_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/time.hpp"
+#include "libtorrent/aux_/packet_pool.hpp" // for TORRENT_ETHERNET_MTU
+
+#include <cstdint>
+#include <memory>
+
+namespace libtorrent { namespace aux {
+
+	struct utp_socket_manager;
+
+	// what the congestion controller is told about an ACK that acknowledged
+	// new payload
+	struct utp_ack_event
+	{
+		// the number of payload bytes acknowledged by this ACK
+		int acked_bytes;
+
+		// the number of payload bytes in flight before and after this ACK
+		int prev_in_flight;
+		int in_flight;
+
+		// the estimated one-way queuing delay, in microseconds
+		int delay;
+
+		// the lowest round-trip time of the packets acknowledged by this ACK,
+		// in microseconds
+		std::uint32_t rtt_sample;
+
+		// the average round-trip time, in milliseconds
+		int rtt;
+
+		int mss;
+		time_point now;
+	};
+
+	// the congestion controller of a uTP socket owns the congestion window.
+	// The socket decides what counts as an ACK of new data, a loss event
+	// (at most one per RTT) and a timeout, and the controller decides how
+	// the window responds to each. Which controller new sockets use is
+	// determined by settings_pack::utp_congestion_control.
+	struct TORRENT_EXTRA_EXPORT utp_congestion_controller
+	{
+		explicit utp_congestion_controller(utp_socket_manager& sm) : m_sm(sm) {}
+		virtual ~utp_congestion_controller() = default;
+
+		utp_congestion_controller(utp_congestion_controller const&) = delete;
+		utp_congestion_controller& operator=(utp_congestion_controller const&) = delete;
+
+		// the congestion window, in bytes
+		int window() const { return int(m_cwnd >> 16); }
+		bool slow_start() const { return m_slow_start; }
+		int ssthres() const { return m_ssthres; }
+
+		// the window never drops below one packet
+		void clamp_window(int const mss)
+		{
+			if (window() < mss) m_cwnd = std::int64_t(mss) * (1 << 16);
+		}
+
+		virtual void on_ack(utp_ack_event const& e) = 0;
+
+		// cuts the window by utp_loss_multiplier and leaves slow-start
+		virtual void on_loss(int mss, time_point now);
+
+		// all packets in flight timed out. If ``idle``, nothing was in
+		// flight and the window is only decayed, otherwise it's reset to one
+		// packet. Either way, the window is grown back in slow-start
+		virtual void on_timeout(bool idle, int mss, time_point now);
+
+		// the last loss or timeout turned out to be spurious, the packets were
+		// only reordered or delayed. Restores the window to what it was before
+		// it was cut, unless it has grown back past that since
+		void undo();
+
+	protected:
+
+		// called before the window is cut, to allow the cut to be undone
+		void save_window();
+
+		utp_socket_manager& m_sm;
+
+		// the max number of bytes in-flight. This is a fixed point
+		// value, to get the true number of bytes, shift right 16 bits
+		// the value is always >= 0, but the calculations performed on
+		// it in on_ack() are signed.
+		std::int64_t m_cwnd = TORRENT_ETHERNET_MTU << 16;
+
+		// the slow-start threshold. This is the congestion window size (m_cwnd)
+		// in bytes the last time we left slow-start mode. This is used as a
+		// threshold to leave slow-start earlier next time, to avoid packet-loss
+		std::int32_t m_ssthres = 0;
+
+		// the window and slow-start state before the last cut, or 0 if
+		// there's nothing to undo
+		std::int64_t m_prior_cwnd = 0;
+		std::int32_t m_prior_ssthres = 0;
+		bool m_prior_slow_start = false;
+
+		bool m_slow_start = true;
+	};
+
+	// LEDBAT, as described in BEP 29 and RFC 6817. The window grows and
+	// shrinks linearly with how far the queuing delay is from the target,
+	// by up to utp_gain_factor bytes per RTT
+	struct TORRENT_EXTRA_EXPORT utp_ledbat final : utp_congestion_controller
+	{
+		using utp_congestion_controller::utp_congestion_controller;
+		void on_ack(utp_ack_event const& e) override;
+	};
+
+	// LEDBAT++, as described in draft-irtf-iccrg-ledbat-plus-plus. Compared
+	// to LEDBAT it:
+	//
+	// * scales the gain down on short RTT paths, where LEDBAT ramps up too
+	//   fast to see its own queue
+	// * decreases the window multiplicatively, in proportion to how far
+	//   over the target the delay is, instead of linearly
+	// * leaves slow-start at 3/4 of the target delay and grows slower in it
+	// * periodically slows down to 2 packets for two RTTs, to let the queue
+	//   drain and the base delay be measured again. This keeps latecomers
+	//   from taking their own queue for the base delay
+	struct TORRENT_EXTRA_EXPORT utp_ledbat_plus_plus final : utp_congestion_controller
+	{
+		using utp_congestion_controller::utp_congestion_controller;
+		void on_ack(utp_ack_event const& e) override;
+		void on_loss(int mss, time_point now) override;
+		void on_timeout(bool idle, int mss, time_point now) override;
+
+	private:
+
+		// ends the slowdown (if one is in progress) and schedules the next
+		void end_slowdown(time_point now);
+
+		enum class phase : std::uint8_t
+		{
+			// the initial slow-start, no slowdown has been scheduled yet
+			initial,
+			normal,
+			// the window is held at 2 packets
+			frozen,
+			// slow-start back up to the window before the slowdown
+			recovering
+		};
+
+		// when the current slowdown started, and when the next is due
+		time_point m_slowdown_start;
+		time_point m_next_slowdown;
+
+		// the end of the frozen phase of a slowdown
+		time_point m_frozen_until;
+
+		// the average RTT as of the last ACK
+		time_duration m_rtt = milliseconds(100);
+
+		// the lowest RTT seen, in microseconds. Half of it is the estimate
+		// of the base one-way delay the gain is scaled by
+		std::uint32_t m_min_rtt = 0xffffffff;
+
+		phase m_phase = phase::initial;
+	};
+
+	TORRENT_EXTRA_EXPORT std::unique_ptr<utp_congestion_controller>
+	make_utp_congestion_controller(int algorithm, utp_socket_manager& sm);
+}}
+
+#endif
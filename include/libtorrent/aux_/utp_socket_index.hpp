@@ -0,0 +1,195 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TORRENT_UTP_SOCKET_INDEX_HPP_INCLUDED
+#define TORRENT_UTP_SOCKET_INDEX_HPP_INCLUDED
+
+#include "libtorrent/config.hpp"
+#include "libtorrent/address.hpp"
+#include "libtorrent/socket.hpp"
+#include "libtorrent/assert.hpp"
+
+#include <algorithm> // for max
+#include <vector>
+#include <cstdint>
+#include <cstring> // for memcpy
+
+namespace libtorrent { namespace aux {
+
+	// an open addressing hash table (with linear probing) mapping the remote
+	// endpoint and receive connection ID of uTP sockets to the sockets
+	// themselves. Each slot holds a pointer to the socket and the full hash
+	// of its key, so probing past other sockets, growing and erasing never
+	// touch the socket objects. Only the socket whose hash matches is asked
+	// for its key.
+	//
+	// ``Socket`` must provide ``remote_endpoint()`` and ``receive_id()``, and
+	// their values must not change while the socket is in the index.
+	template <typename Socket>
+	struct utp_socket_index
+	{
+		// adds ``s`` to the index, keyed by its current remote endpoint and
+		// receive ID. Adding a socket that's already in the index is a no-op
+		void insert(Socket* s)
+		{
+			std::uint32_t const h = hash(s->remote_endpoint(), s->receive_id());
+			if (find_slot(s, h) >= 0) return;
+
+			// keep the load factor at or below 1/2
+			if ((m_size + 1) * 2 > int(m_slots.size())) grow();
+
+			std::size_t const mask = m_slots.size() - 1;
+			std::size_t i = h & mask;
+			while (m_slots[i].sock != nullptr) i = (i + 1) & mask;
+			m_slots[i] = {s, h};
+			++m_size;
+		}
+
+		// removes ``s`` from the index, if it's there. Its key must be the
+		// same as when it was inserted
+		void erase(Socket* s)
+		{
+			std::ptrdiff_t const pos = find_slot(s
+				, hash(s->remote_endpoint(), s->receive_id()));
+			if (pos < 0) return;
+
+			std::size_t const mask = m_slots.size() - 1;
+			std::size_t i = std::size_t(pos);
+
+			// shift back any following entries in the probe sequence that
+			// would no longer be reachable with slot i empty
+			for (std::size_t j = (i + 1) & mask; m_slots[j].sock != nullptr; j = (j + 1) & mask)
+			{
+				std::size_t const home = m_slots[j].hash & mask;
+				// if home is cyclically in (i, j], the entry is still reachable
+				bool const reachable = i <= j
+					? (i < home && home <= j)
+					: (i < home || home <= j);
+				if (reachable) continue;
+				m_slots[i] = m_slots[j];
+				i = j;
+			}
+			m_slots[i] = {nullptr, 0};
+			--m_size;
+		}
+
+		// returns the socket receiving packets from ``ep`` with connection
+		// ID ``id``, or nullptr
+		Socket* find(udp::endpoint const& ep, std::uint16_t const id) const
+		{
+			if (m_size == 0) return nullptr;
+			std::uint32_t const h = hash(ep, id);
+			std::size_t const mask = m_slots.size() - 1;
+			for (std::size_t i = h & mask;; i = (i + 1) & mask)
+			{
+				slot const& e = m_slots[i];
+				if (e.sock == nullptr) return nullptr;
+				if (e.hash == h && e.sock->receive_id() == id
+					&& e.sock->remote_endpoint() == ep)
+					return e.sock;
+			}
+		}
+
+		int size() const { return m_size; }
+
+		void clear()
+		{
+			m_slots.clear();
+			m_size = 0;
+		}
+
+		static std::uint32_t hash(udp::endpoint const& ep, std::uint16_t const id)
+		{
+			address const a = ep.address();
+			std::uint64_t h;
+			if (a.is_v4())
+			{
+				h = a.to_v4().to_uint();
+			}
+			else
+			{
+				auto const b = a.to_v6().to_bytes();
+				std::uint64_t hi;
+				std::uint64_t lo;
+				std::memcpy(&hi, b.data(), 8);
+				std::memcpy(&lo, b.data() + 8, 8);
+				h = hi ^ (lo * 0x9e3779b97f4a7c15ULL);
+			}
+			h ^= (std::uint64_t(ep.port()) << 32) | (std::uint64_t(id) << 48);
+			// the table is indexed by the low bits, mix the high bits in
+			h *= 0x9e3779b97f4a7c15ULL;
+			return std::uint32_t(h ^ (h >> 32));
+		}
+
+	private:
+
+		struct slot
+		{
+			Socket* sock;
+			std::uint32_t hash;
+		};
+
+		// returns the slot holding ``s``, or -1
+		std::ptrdiff_t find_slot(Socket const* s, std::uint32_t const h) const
+		{
+			if (m_size == 0) return -1;
+			std::size_t const mask = m_slots.size() - 1;
+			for (std::size_t i = h & mask;; i = (i + 1) & mask)
+			{
+				if (m_slots[i].sock == nullptr) return -1;
+				if (m_slots[i].sock == s) return std::ptrdiff_t(i);
+			}
+		}
+
+		void grow()
+		{
+			std::vector<slot> old(std::max(std::size_t(16), m_slots.size() * 2)
+				, slot{nullptr, 0});
+			old.swap(m_slots);
+			std::size_t const mask = m_slots.size() - 1;
+			for (slot const& e : old)
+			{
+				if (e.sock == nullptr) continue;
+				std::size_t i = e.hash & mask;
+				while (m_slots[i].sock != nullptr) i = (i + 1) & mask;
+				m_slots[i] = e;
+			}
+		}
+
+		std::vector<slot> m_slots;
+
+		// the number of non-empty slots
+		int m_size = 0;
+	};
+}}
+
+#endif
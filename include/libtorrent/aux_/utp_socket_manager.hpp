@@ -36,8 +36,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #ifndef TORRENT_UTP_SOCKET_MANAGER_HPP_INCLUDED
 #define TORRENT_UTP_SOCKET_MANAGER_HPP_INCLUDED
 
-#include <map>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "libtorrent/aux_/socket_type.hpp"
 #include "libtorrent/session_status.hpp"
@@ -45,6 +46,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/session_settings.hpp"
 #include "libtorrent/span.hpp"
 #include "libtorrent/aux_/packet_pool.hpp"
+#include "libtorrent/aux_/utp_socket_index.hpp"
+#include "libtorrent/deadline_timer.hpp"
 
 namespace libtorrent {
 
@@ -99,11 +102,22 @@ namespace aux {
 			, error_code& ec, udp_send_flags_t flags = {});
 		void subscribe_writable(utp_socket_impl* s);
 
+		// call on_wake() on the socket at ``at``. This is how paced packets
+		// are sent, and how the loss detection timers fire, at a finer
+		// granularity than tick()
+		void wake_at(utp_socket_impl* s, time_point at);
+
 		void remove_udp_socket(std::weak_ptr<utp_socket_interface> sock);
 
 		// internal, used by utp_stream
 		void remove_socket(std::uint16_t id);
 
+		// called by the socket right before and after its remote endpoint is
+		// set. Incoming packets are only matched against sockets with a
+		// known remote endpoint
+		void unindex_socket(utp_socket_impl* s);
+		void index_socket(utp_socket_impl* s);
+
 		utp_socket_impl* new_utp_socket(utp_stream* str);
 		int gain_factor() const { return m_sett.get_int(settings_pack::utp_gain_factor); }
 		int target_delay() const { return m_sett.get_int(settings_pack::utp_target_delay) * 1000; }
@@ -114,6 +128,9 @@ namespace aux {
 		int min_timeout() const { return m_sett.get_int(settings_pack::utp_min_timeout); }
 		int loss_multiplier() const { return m_sett.get_int(settings_pack::utp_loss_multiplier); }
 		int cwnd_reduce_timer() const { return m_sett.get_int(settings_pack::utp_cwnd_reduce_timer); }
+		int congestion_control() const { return m_sett.get_int(settings_pack::utp_congestion_control); }
+		bool pacing() const { return m_sett.get_bool(settings_pack::utp_pacing); }
+		bool rack() const { return m_sett.get_bool(settings_pack::utp_rack); }
 
 		int mtu_for_dest(address const& addr) const;
 		int num_sockets() const { return int(m_utp_sockets.size()); }
@@ -149,9 +166,19 @@ namespace aux {
 		send_fun_t m_send_fun;
 		incoming_utp_callback_t m_cb;
 
-		// replace with a hash-map
-		using socket_map_t = std::multimap<std::uint16_t, std::unique_ptr<utp_socket_impl>>;
-		socket_map_t m_utp_sockets;
+		// removes the socket at position ``pos`` in m_utp_sockets. The last
+		// socket is moved into its place
+		void erase_socket(std::size_t pos);
+
+		void arm_wake_timer(time_point at);
+		void on_wake_timer(error_code const& ec);
+
+		// all uTP sockets, in no particular order
+		std::vector<std::unique_ptr<utp_socket_impl>> m_utp_sockets;
+
+		// the sockets whose remote endpoint is known, by endpoint and
+		// receive ID. This is what incoming packets are dispatched by
+		aux::utp_socket_index<utp_socket_impl> m_socket_index;
 
 		using socket_vector_t = std::vector<utp_socket_impl*>;
 
@@ -176,6 +203,13 @@ namespace aux {
 		// becomes writable again
 		socket_vector_t m_stalled_sockets;
 
+		// sockets that asked to be woken up, and when. A socket may be in
+		// here more than once
+		std::vector<std::pair<time_point, utp_socket_impl*>> m_wakeups;
+
+		// the sockets that are due, while they're being woken up
+		socket_vector_t m_woken;
+
 		// the last socket we received a packet on
 		utp_socket_impl* m_last_socket = nullptr;
 
@@ -188,6 +222,12 @@ namespace aux {
 
 		io_context& m_ios;
 
+		// fires when the next socket is due to be woken up.
+		// m_wake_timer_expiry is when it's set to, or max_time() when it's
+		// not armed
+		deadline_timer m_wake_timer;
+		time_point m_wake_timer_expiry = max_time();
+
 		std::array<int, 3> m_restrict_mtu;
 		int m_mtu_idx = 0;
 
@@ -47,6 +47,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/address.hpp"
 #include "libtorrent/aux_/invariant_check.hpp"
 #include "libtorrent/aux_/storage_utils.hpp" // for iovec_t
+#include "libtorrent/aux_/utp_congestion_control.hpp"
 
 #include <functional>
 
@@ -663,7 +664,8 @@ struct utp_socket_impl
 		, std::uint16_t seq_nr);
 	void write_sack(std::uint8_t* buf, int size) const;
 	void incoming(std::uint8_t const* buf, int size, packet_ptr p, time_point now);
-	void do_ledbat(int acked_bytes, int delay, int in_flight);
+	void congestion_control(int acked_bytes, int delay, int in_flight
+		, std::uint32_t rtt_sample, time_point now);
 	int packet_timeout() const;
 	bool test_socket_state();
 	void maybe_trigger_receive_callback(error_code const& ec);
@@ -675,9 +677,29 @@ struct utp_socket_impl
 	void update_mtu_limits();
 	void experienced_loss(std::uint32_t seq_nr, time_point now);
 
+	// asks the socket manager to call on_wake() at ``at``, unless an
+	// earlier wakeup is already pending
+	void wake_at(time_point at);
+
+	// RACK. Retransmits the packets sent before the most recently delivered
+	// one that are still unacknowledged a reordering window after it would
+	// have been expected to, and wakes up when the next one is due
+	void detect_lost_packets(time_point now);
+	time_duration reorder_window() const;
+
+	// the tail loss probe is armed while there is data in flight, and sent
+	// when no ACK has arrived for two RTTs, to elicit a SACK covering the
+	// tail of the flight before the retransmit timeout
+	void arm_tail_loss_probe(time_point now);
+	void send_tail_loss_probe();
+
 	void send_deferred_ack();
 	void socket_drained();
 
+	// called by the socket manager at the time asked for by wake_at(), to
+	// send payload held back by pacing and to run the loss detection timers
+	void on_wake(time_point now);
+
 	void set_userdata(utp_stream* s) { m_userdata = s; }
 	void abort();
 	udp::endpoint remote_endpoint() const;
@@ -841,20 +863,27 @@ private:
 	// 100 ms
 	time_point m_next_loss;
 
-	// the max number of bytes in-flight. This is a fixed point
-	// value, to get the true number of bytes, shift right 16 bits
-	// the value is always >= 0, but the calculations performed on
-	// it in do_ledbat() are signed.
-	std::int64_t m_cwnd = TORRENT_ETHERNET_MTU << 16;
+	// owns the congestion window, and decides how it responds to ACKs,
+	// losses and timeouts
+	std::unique_ptr<utp_congestion_controller> m_cc;
+
+	// with pacing, the earliest time the next payload packet may be sent
+	time_point m_next_send = min_time();
+
+	// the earliest wakeup pending with the socket manager, or max_time()
+	time_point m_wake_at = max_time();
+
+	// the time the most recently sent packet that has been acknowledged
+	// was sent. Unacknowledged packets sent before it are candidates for
+	// being lost
+	time_point m_rack_send_time = min_time();
+
+	// when the tail loss probe is due, or max_time() if it's not armed
+	time_point m_tlp_at = max_time();
 
 	timestamp_history m_delay_hist;
 	timestamp_history m_their_delay_hist;
 
-	// the slow-start threshold. This is the congestion window size (m_cwnd)
-	// in bytes the last time we left slow-start mode. This is used as a
-	// threshold to leave slow-start earlier next time, to avoid packet-loss
-	std::int32_t m_ssthres = 0;
-
 	// the number of bytes we have buffered in m_inbuf
 	std::int32_t m_buffered_incoming_bytes = 0;
 
@@ -911,6 +940,12 @@ private:
 	// the last receive delay sample
 	std::int32_t m_recv_delay = 0;
 
+	// the RTT of the packet m_rack_send_time is from, and the lowest RTT
+	// seen, in microseconds. The lowest RTT is also what tells an ACK of
+	// the original packet apart from one of its retransmit
+	std::uint32_t m_rack_rtt = 0;
+	std::uint32_t m_min_rtt = 0xffffffff;
+
 	// average RTT
 	sliding_average<int, 16> m_rtt;
 
@@ -964,6 +999,18 @@ private:
 	// will cause the window size to be cut in half
 	std::uint16_t m_loss_seq_nr = 0;
 
+	// the highest sequence number that has been acknowledged, cumulatively
+	// or selectively. Only packets below it are checked by RACK
+	std::uint16_t m_rack_seq_nr = 0;
+
+	// the sequence number of the last tail loss probe
+	std::uint16_t m_tlp_seq_nr = 0;
+
+	// the number of packets retransmitted since the congestion window was
+	// last cut, that haven't been found to be spurious. When the last one
+	// is, the cut is undone
+	std::uint16_t m_undo_retrans = 0;
+
 	// the max number of bytes we can send in a packet
 	// including the header
 	std::uint16_t m_mtu = TORRENT_ETHERNET_MTU - TORRENT_IPV4_HEADER - TORRENT_UDP_HEADER - 8 - 24 - 36;
@@ -994,6 +1041,10 @@ private:
 	// this affects the packet timeout time
 	std::uint8_t m_num_timeouts = 0;
 
+	// the reordering window is this many quarters of the lowest RTT. It's
+	// widened every time a retransmit turns out to be spurious
+	std::uint8_t m_reo_wnd_mult = 1;
+
 	// this is the cursor into m_delay_sample_hist
 	std::uint8_t m_delay_sample_idx:2;
 
@@ -1016,14 +1067,6 @@ private:
 	// this is true if nagle is enabled (which it is by default)
 	bool m_nagle:1;
 
-	// this is true while the socket is in slow start mode. It's
-	// only in slow-start during the start-up phase. Slow start
-	// (contrary to what its name suggest) means that we're growing
-	// the congestion window (cwnd) exponentially rather than linearly.
-	// this is done at startup of a socket in order to find its
-	// link capacity faster. This behaves similar to TCP slow start
-	bool m_slow_start:1;
-
 	// this is true as long as we have as many packets in
 	// flight as allowed by the congestion window (cwnd)
 	bool m_cwnd_full:1;
@@ -1055,6 +1098,19 @@ private:
 	// packet for this connection with a correct ack_nr, confirming that the
 	// other end is not spoofing its source IP
 	bool m_confirmed:1;
+
+	// this is true while the socket has payload held back by pacing, and
+	// is waiting for the socket manager to call on_wake()
+	bool m_paced:1;
+
+	// set once a packet that was only sent once is acknowledged after a
+	// packet with a higher sequence number. From then on, with RACK,
+	// duplicate ACKs no longer trigger retransmits on their own
+	bool m_reordering_seen:1;
+
+	// a tail loss probe has been sent, and no new data has been
+	// acknowledged since. Only one probe is sent per flight
+	bool m_tlp_sent:1;
 };
 
 }
@@ -106,18 +106,7 @@ namespace libtorrent {
 		bool all_set() const noexcept;
 
 		// returns true if no bit in the bitfield is set
-		bool none_set() const noexcept
-		{
-			if(size() == 0) return true;
-
-			const int words = num_words();
-			std::uint32_t const* b = buf();
-			for (int i = 0; i < words; ++i)
-			{
-				if (b[i] != 0) return false;
-			}
-			return true;
-		}
+		bool none_set() const noexcept;
 
 		// returns the size of the bitfield in bits.
 		int size() const noexcept
@@ -178,6 +167,26 @@ namespace libtorrent {
 		// returns the index to the last cleared bit in the bitfield, i.e. 0 bit.
 		int find_last_clear() const noexcept;
 
+		// returns the index of the first bit, at or after ``start``, that is
+		// set in ``bits`` and in ``want`` but not in ``exclude``. i.e. the
+		// first set bit of ``bits & ~exclude & want``. This is typically used
+		// to find a piece a peer has, that we don't have but want. The three
+		// bitfields are expected to be the same size. Returns -1 if there is
+		// no such bit.
+		static int find_first_set_and_not(bitfield const& bits
+			, bitfield const& exclude, bitfield const& want, int start = 0) noexcept;
+
+		// returns true if any bit is set in ``bits & ~exclude & want``.
+		static bool any_set_and_not(bitfield const& bits
+			, bitfield const& exclude, bitfield const& want) noexcept
+		{ return find_first_set_and_not(bits, exclude, want) != -1; }
+
+		// in-place bitwise AND (``bitwise_and``) and AND-NOT
+		// (``bitwise_and_not``) with ``rhs``. ``rhs`` is expected to be the
+		// same size as this bitfield, any bits beyond its end are treated as 0.
+		void bitwise_and(bitfield const& rhs) noexcept;
+		void bitwise_and_not(bitfield const& rhs) noexcept;
+
 		bool operator==(lt::bitfield const& rhs) const;
 
 		// internal
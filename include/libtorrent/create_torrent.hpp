@@ -528,8 +528,12 @@ namespace aux {
 	//
 	// 	void Fun(piece_index_t);
 	//
-	// The overloads taking a settings_pack may be used to configure the
-	// underlying disk access. Such as ``settings_pack::aio_threads``.
+	// The overloads that don't take a disk_io constructor read the files
+	// front to back on the calling thread and hash the pieces on one thread
+	// per core. ``settings_pack::checking_mem_usage`` limits how much data is
+	// read ahead of the hasher threads. The overloads taking a disk_io
+	// constructor go through that disk I/O subsystem instead, configured by
+	// the settings_pack, such as ``settings_pack::aio_threads``.
 	//
 	// The overloads that don't take an ``error_code&`` may throw an exception in case of a
 	// file error, the other overloads sets the error code to reflect the error, if any.
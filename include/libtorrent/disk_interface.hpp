@@ -176,6 +176,11 @@ namespace file_open_mode {
 		// hash does not need to be computed.
 		static constexpr disk_job_flags_t v1_hash = 5_bit;
 
+		// this read is the client playing the torrent's data back, by
+		// read_piece() with the playback flag. It moves the stream cursor
+		// of the storage, which the streaming cache retains blocks around.
+		static constexpr disk_job_flags_t stream_read = 6_bit;
+
 		// this flag instructs a hash job that we just completed this piece, and
 		// it should be flushed to disk
 		static constexpr disk_job_flags_t flush_piece = 7_bit;
@@ -218,6 +223,25 @@ namespace file_open_mode {
 			, std::function<void(storage_error const&)> handler
 			, disk_job_flags_t flags = {}) = 0;
 
+		// allocate a buffer for a peer to receive a block into, to then be
+		// passed to async_write_buffer() without copying it. ``exceeded`` is
+		// set to true if the disk buffers are exhausted, in which case the
+		// disk_observer will be notified once buffers are available again,
+		// just like for async_write(). The default implementation returns an
+		// empty holder, meaning the disk I/O subsystem does not support
+		// receiving into its buffers, and peers will call async_write().
+		virtual disk_buffer_holder allocate_write_buffer(bool& exceeded
+			, std::shared_ptr<disk_observer> o);
+
+		// like async_write(), but takes ownership of a buffer returned by
+		// allocate_write_buffer(). The buffer is assumed to hold ``r.length``
+		// bytes of the block. The default implementation forwards to
+		// async_write().
+		virtual bool async_write_buffer(storage_index_t storage, peer_request const& r
+			, disk_buffer_holder buf, std::shared_ptr<disk_observer> o
+			, std::function<void(storage_error const&)> handler
+			, disk_job_flags_t flags = {});
+
 		// Compute hash(es) for the specified piece. Unless the v1_hash flag is
 		// set (in ``flags``), the SHA-1 hash of the whole piece does not need
 		// to be computed.
@@ -37,6 +37,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 
 #include <string>
+#include <memory>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -133,10 +134,12 @@ namespace aux {
 		~file_entry();
 
 		void set_name(string_view n, bool borrow_string = false);
+		void set_pooled_name(char const* n);
 		string_view filename() const;
 
 		enum {
 			name_is_owned = (1 << 12) - 1,
+			name_is_pooled = (1 << 12) - 2,
 			not_a_symlink = (1 << 15) - 1,
 		};
 
@@ -159,8 +162,9 @@ namespace aux {
 
 		// the number of characters in the name. If this is
 		// name_is_owned, name is 0-terminated and owned by this object
-		// (i.e. it should be freed in the destructor). If
-		// the len is not name_is_owned, the name pointer does not belong
+		// (i.e. it should be freed in the destructor). If this is
+		// name_is_pooled, name is 0-terminated and belongs to the name pool
+		// of the file_storage. Otherwise the name pointer does not belong
 		// to this object, and it's not 0-terminated
 		std::uint64_t name_len:12;
 		// std::uint64_t pad_file:1;
@@ -429,6 +433,10 @@ namespace aux {
 		// returns the total number of bytes all the files in this torrent spans
 		std::int64_t total_size() const { return m_total_size; }
 
+		// returns an estimate of the number of bytes of heap memory held by
+		// this object. Name chunks shared with copies are counted in full.
+		std::size_t memory_usage() const;
+
 		// set and get the number of pieces in the torrent
 		void set_num_pieces(int n) { m_num_pieces = n; }
 		int num_pieces() const { TORRENT_ASSERT(m_piece_length > 0); return m_num_pieces; }
@@ -596,7 +604,10 @@ namespace aux {
 #if TORRENT_USE_INVARIANT_CHECKS
 		// internal
 		bool owns_name(file_index_t const f) const
-		{ return m_files[f].name_len == aux::file_entry::name_is_owned; }
+		{
+			return m_files[f].name_len == aux::file_entry::name_is_owned
+				|| m_files[f].name_len == aux::file_entry::name_is_pooled;
+		}
 #endif
 
 #if TORRENT_ABI_VERSION <= 2
@@ -656,6 +667,13 @@ namespace aux {
 		file_index_t last_file() const noexcept;
 
 		aux::path_index_t get_or_add_path(string_view path);
+		void rehash_paths(std::size_t size);
+
+		// returns the last file whose offset is <= ``offset``
+		file_index_t lookup_file(std::int64_t offset) const;
+
+		// copies ``n`` into the name pool and points ``e`` to it
+		void set_owned_name(aux::file_entry& e, string_view n);
 
 		// the number of bytes in a regular piece
 		// (i.e. not the potentially truncated last piece)
@@ -703,6 +721,25 @@ namespace aux {
 		// entry appended, to form full file paths
 		aux::vector<std::string, aux::path_index_t> m_paths;
 
+		// an open addressing hash table of indices into m_paths, used to
+		// intern directory names. Each slot holds the path index + 1, or 0 if
+		// the slot is empty
+		std::vector<std::uint32_t> m_path_table;
+
+		// the offset of every offset_index_stride:th file. This is small
+		// enough to stay in the cache, and narrows a search for a file by
+		// offset down to a single stride of m_files
+		static constexpr int offset_index_stride = 16;
+		std::vector<std::int64_t> m_offset_index;
+
+		// file names that are not borrowed from the metadata are copied into
+		// these chunks, back to back, rather than each getting an allocation
+		// of its own. Names are never removed, renamed files leave their old
+		// name behind. A chunk is only appended to while this object holds
+		// the only reference to it, copies share the chunks
+		std::vector<std::shared_ptr<char>> m_name_chunks;
+		int m_name_chunk_used = 0;
+
 		// name of torrent. For multi-file torrents
 		// this is always the root directory
 		std::string m_name;
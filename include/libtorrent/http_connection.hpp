@@ -40,6 +40,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <functional>
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "libtorrent/socket.hpp"
 #include "libtorrent/error_code.hpp"
@@ -50,6 +51,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/vector.hpp"
 #include "libtorrent/aux_/resolver_interface.hpp"
 #include "libtorrent/optional.hpp"
+#include "libtorrent/time.hpp"
 
 
 namespace libtorrent {
@@ -134,8 +136,40 @@ struct TORRENT_EXTRA_EXPORT http_connection
 
 	std::string const& url() const { return m_url; }
 
+	// when enabled, requests are sent with ``Connection: keep-alive`` and
+	// the socket is left open once a bottled response has been delivered,
+	// to be reused by the next get() to the same host
+	void keep_alive(bool k) { m_keep_alive = k; }
+
+	// true if the last response was received in full over a keep-alive
+	// connection the server did not ask to close, i.e. the socket can be
+	// handed to http_connection_pool::release()
+	bool reusable() const;
+
+	// true if the response to the last get() started arriving over a
+	// socket left open by a previous request. False if it had to be
+	// re-sent on a new connection because the idle one had gone stale
+	bool served_reused() const { return m_served_reused; }
+
+	// replaces the handlers, for a pooled connection taken over by a new
+	// owner
+	void rebind(http_handler handler
+		, http_connect_handler ch
+		, http_filter_handler fh
+		, hostname_filter_handler hfh);
+
+	std::string const& hostname() const { return m_hostname; }
+	int port() const { return m_port; }
+	boost::optional<bind_info_t> const& bind_addr() const { return m_bind_addr; }
+
 private:
 
+	// an idle keep-alive connection may have been closed by the server
+	// while it sat in the pool. If nothing of the response has been
+	// received yet, the request is re-issued on a new connection and this
+	// returns true
+	bool reconnect_stale();
+
 
 	void on_resolve(error_code const& e, std::vector<address> const& addresses);
 	void connect();
@@ -235,6 +269,60 @@ private:
 
 	// true while resolving hostname
 	bool m_resolving_host = false;
+
+	// send Connection: keep-alive and leave the socket open after the
+	// response
+	bool m_keep_alive = false;
+
+	// true while the current request is sent over a socket that was
+	// left open by a previous request, until the first response bytes
+	// arrive
+	bool m_reused = false;
+
+	// see served_reused()
+	bool m_served_reused = false;
+};
+
+// idle keep-alive http_connections, keyed by the host, port and bind
+// address they're connected with. Tracker requests to a host that has an
+// idle connection skip the DNS lookup and TCP handshake.
+struct TORRENT_EXTRA_EXPORT http_connection_pool
+{
+	http_connection_pool() = default;
+	http_connection_pool(http_connection_pool const&) = delete;
+	http_connection_pool& operator=(http_connection_pool const&) = delete;
+	~http_connection_pool();
+
+	// returns an idle connection to the host in ``url``, bound to
+	// ``bind_addr``, or nullptr if there is none. Connections that have
+	// been idle longer than ``idle_timeout`` are closed
+	std::shared_ptr<http_connection> acquire(std::string const& url
+		, boost::optional<bind_info_t> const& bind_addr
+		, time_duration idle_timeout);
+
+	// takes back a connection whose owner is done with it. It's kept idle
+	// if it's reusable() and its host has fewer than ``max_idle`` idle
+	// connections. Otherwise it's closed
+	void release(std::shared_ptr<http_connection> c, int max_idle);
+
+	// closes all idle connections
+	void close();
+
+	// closes the connections that have been idle longer than
+	// ``idle_timeout``
+	void expire(time_duration idle_timeout);
+
+	int num_idle() const { return int(m_idle.size()); }
+
+private:
+
+	struct idle_connection
+	{
+		std::shared_ptr<http_connection> conn;
+		time_point since;
+	};
+
+	std::vector<idle_connection> m_idle;
 };
 
 }
@@ -37,7 +37,6 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "libtorrent/config.hpp"
 
-#include <set>
 #include <vector>
 #include <cstdint>
 #include <tuple>
@@ -100,26 +99,49 @@ namespace aux {
 		filter_impl();
 		bool empty() const;
 		void add_rule(Addr first, Addr last, std::uint32_t flags);
+
+		// has the same effect as calling add_rule() for each of the
+		// ``rules``, in order. They are merged into the filter in a single
+		// sort-and-sweep pass
+		void add_rules(std::vector<ip_range<Addr>> const& rules);
+
 		std::uint32_t access(Addr const& addr) const;
 		template <typename ExternalAddressType>
 		std::vector<ip_range<ExternalAddressType>> export_filter() const;
 
+		// the number of bytes of heap memory held by the filter
+		std::size_t memory_usage() const;
+
 	private:
 
+		// rebuilds m_index from the block containing range ``first``
+		void update_index(std::size_t first);
+
+		// the number of ranges per block of m_index
+		static constexpr std::size_t index_stride = 16;
+
 		struct range
 		{
+			range() = default;
 			range(Addr addr, std::uint32_t a = 0) : start(addr), access(a) {} // NOLINT
 			bool operator<(range const& r) const { return start < r.start; }
 			bool operator<(Addr const& a) const { return start < a; }
-			Addr start;
+			Addr start{};
 			// the end of the range is implicit
-			// and given by the next entry in the set
-			std::uint32_t access;
+			// and given by the next entry in the list
+			std::uint32_t access = 0;
 			friend bool operator==(range const& lhs, range const& rhs)
 			{ return lhs.start == rhs.start && lhs.access == rhs.access; }
 		};
 
-		std::set<range> m_access_list;
+		// non-overlapping ranges, sorted by start address. The first
+		// range always starts at address zero
+		std::vector<range> m_access_list;
+
+		// the start address of every index_stride:th range. access() first
+		// searches this (small enough to stay in cache), then a single
+		// block of index_stride ranges of m_access_list
+		std::vector<Addr> m_index;
 	};
 
 	extern template class filter_impl<address_v4::bytes_type>;
@@ -173,6 +195,15 @@ struct TORRENT_EXPORT ip_filter
 	// precedence.
 	void add_rule(address const& first, address const& last, std::uint32_t flags);
 
+	// Adds all rules in ``v4`` and ``v6``, in order. The result is the same
+	// as calling add_rule() for each of them, but the rules are sorted and
+	// merged into the filter in one pass. Use this to load large block
+	// lists, adding them one at a time is quadratic in the number of
+	// ranges. The output of export_filter() can be passed straight back
+	// in.
+	void add_rules(std::vector<ip_range<address_v4>> const& v4
+		, std::vector<ip_range<address_v6>> const& v6 = {});
+
 	// Returns the access permissions for the given address (``addr``). The permission
 	// can currently be 0 or ``ip_filter::blocked``. The complexity of this operation
 	// is O(``log`` n), where n is the minimum number of non-overlapping ranges to describe
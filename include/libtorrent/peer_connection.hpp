@@ -586,6 +586,9 @@ namespace aux {
 		void incoming_bitfield(typed_bitfield<piece_index_t> const& bits);
 		void incoming_request(peer_request const& r);
 		void incoming_piece(peer_request const& p, char const* data);
+		// the payload was received straight into a disk buffer, see
+		// start_receive_piece()
+		void incoming_piece(peer_request const& p, disk_buffer_holder data);
 		void incoming_piece_fragment(int bytes);
 		void start_receive_piece(peer_request const& r);
 		void incoming_cancel(peer_request const& r);
@@ -679,6 +682,9 @@ namespace aux {
 		int send_buffer_capacity() const
 		{ return m_send_buffer.capacity(); }
 
+		int recv_buffer_capacity() const
+		{ return m_recv_buffer.capacity(); }
+
 		void max_out_request_queue(int s);
 		int max_out_request_queue() const;
 
@@ -703,6 +709,7 @@ namespace aux {
 		void on_disk() override;
 
 		int num_reading_bytes() const { return m_reading_bytes; }
+		int num_writing_bytes() const { return m_outstanding_writing_bytes; }
 
 		void setup_receive();
 
@@ -804,6 +811,9 @@ namespace aux {
 		int request_timeout() const;
 		void check_graceful_pause();
 
+		void incoming_piece_impl(peer_request const& p, char const* data
+			, disk_buffer_holder buffer);
+
 		int wanted_transfer(int channel);
 		int request_bandwidth(int channel, int bytes = 0);
 
@@ -1199,6 +1209,11 @@ namespace aux {
 		// outstanding requests need to increase at the same pace to keep up.
 		bool m_slow_start:1;
 
+		// set if the disk buffer the current block is being received into
+		// was allocated while the disk buffer pool was over its limit. It's
+		// reset by incoming_piece_impl(), whether the block is written or not
+		bool m_recv_disk_exceeded:1;
+
 #if TORRENT_USE_ASSERTS
 	public:
 		bool m_in_constructor = true;
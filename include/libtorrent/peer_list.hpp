@@ -39,6 +39,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #define TORRENT_POLICY_HPP_INCLUDED
 
 #include <algorithm>
+#include <vector>
 
 #include "libtorrent/fwd.hpp"
 #include "libtorrent/string_util.hpp" // for allocate_string_copy
@@ -53,7 +54,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/config.hpp"
 #include "libtorrent/debug.hpp"
 #include "libtorrent/peer_connection_interface.hpp"
-#include "libtorrent/aux_/deque.hpp"
+#include "libtorrent/aux_/peer_address_index.hpp"
 #include "libtorrent/peer_info.hpp" // for peer_source_flags_t
 #include "libtorrent/string_view.hpp"
 #include "libtorrent/pex_flags.hpp"
@@ -97,6 +98,16 @@ namespace libtorrent {
 		std::vector<torrent_peer*> erased;
 	};
 
+	// an entry in peer_list's cache of connect candidates
+	struct connect_candidate
+	{
+		torrent_peer* peer;
+
+		// the rank of the peer (see torrent_peer::rank()), computed once
+		// when the peer is added to the cache
+		std::uint32_t rank;
+	};
+
 	struct erase_peer_flags_tag;
 	using erase_peer_flags_t = flags::bitfield_flag<std::uint8_t, erase_peer_flags_tag>;
 
@@ -143,6 +154,11 @@ namespace libtorrent {
 
 		void set_seed(torrent_peer* p, bool s);
 
+		// erases peers we're not connected to until at most ``max_peers``
+		// are left. The ones least likely to be useful go first, by the same
+		// measure erase_peers() uses. Returns the number of peers erased
+		int trim_peers(torrent_state* state, int max_peers);
+
 		// this clears all cached peer priorities. It's called when
 		// our external IP changes
 		void clear_peer_prio();
@@ -157,7 +173,14 @@ namespace libtorrent {
 		int num_peers() const { return int(m_peers.size()); }
 		int num_candidate_cache() const { return int(m_candidate_cache.size()); }
 
-		using peers_t = aux::deque<torrent_peer*>;
+		// the number of bytes of memory held by the list, including the
+		// torrent_peer entries
+		std::size_t memory_usage() const;
+
+		// the peers are not kept in any particular order. Peers are looked up
+		// by address through m_index, and erased by moving the last peer
+		// into the hole.
+		using peers_t = std::vector<torrent_peer*>;
 		using iterator = peers_t::iterator;
 		using const_iterator = peers_t::const_iterator;
 		iterator begin() { return m_peers.begin(); }
@@ -165,18 +188,9 @@ namespace libtorrent {
 		const_iterator begin() const { return m_peers.begin(); }
 		const_iterator end() const { return m_peers.end(); }
 
-		std::pair<iterator, iterator> find_peers(address const& a)
-		{
-
-			return std::equal_range(
-				m_peers.begin(), m_peers.end(), a, peer_address_compare());
-		}
-
-		std::pair<const_iterator, const_iterator> find_peers(address const& a) const
-		{
-			return std::equal_range(
-				m_peers.begin(), m_peers.end(), a, peer_address_compare());
-		}
+		// returns all peers with address ``a``. There may be more than one
+		// if multiple connections per IP are allowed
+		std::vector<torrent_peer*> find_peers(address const& a) const;
 
 		torrent_peer* connect_one_peer(int session_time, torrent_state* state);
 
@@ -198,10 +212,16 @@ namespace libtorrent {
 
 		void update_peer(torrent_peer* p, peer_source_flags_t src
 			, pex_flags_t flags, tcp::endpoint const& remote);
-		bool insert_peer(torrent_peer* p, iterator iter
-			, pex_flags_t flags, torrent_state* state);
+		bool insert_peer(torrent_peer* p, pex_flags_t flags, torrent_state* state);
+
+		// returns the position of the peer with endpoint ``ep`` in m_peers,
+		// or -1
+		int find_peer(tcp::endpoint const& ep) const;
 
-		void find_connect_candidates(std::vector<torrent_peer*>& peers
+		// appends p to m_peers and the index
+		void add_to_peers(torrent_peer* p);
+
+		void find_connect_candidates(std::vector<connect_candidate>& peers
 			, int session_time, torrent_state* state);
 
 		bool is_connect_candidate(torrent_peer const& p) const;
@@ -214,6 +234,9 @@ namespace libtorrent {
 
 		peers_t m_peers;
 
+		// the address index of m_peers
+		aux::peer_address_index m_index;
+
 		// this should be nullptr for the most part. It's set
 		// to point to a valid torrent_peer object if that
 		// object needs to be kept alive. If we ever feel
@@ -243,8 +266,10 @@ namespace libtorrent {
 		// to scan all of it, start at this index
 		int m_round_robin = 0;
 
-		// a list of good connect candidates
-		std::vector<torrent_peer*> m_candidate_cache;
+		// a heap of good connect candidates, the best one at the front. The
+		// ranks are cached, so the cache is cleared whenever our external
+		// IP changes
+		std::vector<connect_candidate> m_candidate_cache;
 
 		// The number of peers in our torrent_peer list
 		// that are connect candidates. i.e. they're
@@ -257,6 +282,10 @@ namespace libtorrent {
 		// if a peer has failed this many times or more, we don't consider
 		// it a connect candidate anymore.
 		int m_max_failcount = 3;
+
+		// the number of IPv6 peers in m_peers. They take up more space than
+		// IPv4 ones
+		int m_num_v6_peers = 0;
 	};
 
 }
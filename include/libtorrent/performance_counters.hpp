@@ -41,9 +41,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <cstdint>
 #include <atomic>
 #include <mutex>
+#include <memory>
 
 namespace libtorrent {
 
+namespace aux {
+	struct latency_histogram;
+}
+
 	struct TORRENT_EXPORT counters
 	{
 		// internal
@@ -201,6 +206,12 @@ namespace libtorrent {
 			num_write_ops,
 			num_read_ops,
 			num_read_back,
+			num_zero_copy_blocks,
+
+			// reads of a streamed torrent served from the streaming cache,
+			// and the ones that had to go to disk
+			streaming_cache_hits,
+			streaming_cache_misses,
 
 			disk_read_time,
 			disk_write_time,
@@ -226,6 +237,32 @@ namespace libtorrent {
 			recv_failed_bytes,
 			recv_redundant_bytes,
 
+			// the number of peer receive buffers handed out by the session's
+			// receive buffer pool (hits) and the ones that had to be
+			// allocated from the heap (misses)
+			recv_buffer_pool_hits,
+			recv_buffer_pool_misses,
+
+			// the number of send buffers passed to gathering socket writes
+			num_send_buffers_gathered,
+
+			// UDP tracker requests avoided by batching scrapes of several
+			// torrents into one packet, and by sharing one connect round-trip
+			// between requests to the same tracker
+			udp_tracker_scrapes_batched,
+			udp_tracker_connects_saved,
+
+			// HTTP tracker requests sent over an idle keep-alive connection
+			// instead of a new one
+			http_tracker_connections_reused,
+
+			// the number of times the session was found over its memory
+			// budget, and what was given up to get back under it
+			memory_budget_exceeded,
+			memory_shed_pickers,
+			memory_shed_peers,
+			memory_shed_connections,
+
 
 			// uTP counters.
 			utp_packet_loss,
@@ -236,6 +273,11 @@ namespace libtorrent {
 			utp_packet_resend,
 			utp_samples_above_target,
 			utp_samples_below_target,
+			utp_slowdowns,
+			utp_paced_sends,
+			utp_rack_retransmit,
+			utp_tail_loss_probe,
+			utp_spurious_retransmit,
 			utp_payload_pkts_in,
 			utp_payload_pkts_out,
 			utp_invalid_pkts_in,
@@ -371,6 +413,7 @@ namespace libtorrent {
 			request_latency,
 
 			disk_blocks_in_use,
+			streaming_cache_bytes,
 			queued_disk_jobs,
 			num_running_disk_jobs,
 			num_read_jobs,
@@ -422,9 +465,56 @@ namespace libtorrent {
 
 			num_queued_tracker_announces,
 
+			// idle keep-alive connections held by the HTTP tracker
+			// connection pool
+			num_idle_http_tracker_connections,
+
+			// the number of bytes held idle in the receive buffer pool, and
+			// the number of bytes currently borrowed by peer connections
+			recv_buffer_pool_bytes,
+			recv_buffer_in_use_bytes,
+
+			// the memory held by all torrents, by subsystem. See
+			// torrent_memory_usage
+			piece_picker_memory,
+			peer_list_memory,
+			torrent_metadata_memory,
+			peer_connection_memory,
+
+			// latency percentiles (in microseconds) over the samples recorded
+			// since the previous session stats update. These are left
+			// unchanged for an interval without any samples.
+			// The order must match latency_histogram_t
+			disk_job_latency_p50,
+			disk_job_latency_p99,
+			disk_job_latency_p999,
+			piece_download_time_p50,
+			piece_download_time_p99,
+			piece_download_time_p999,
+			alert_queue_delay_p50,
+			alert_queue_delay_p99,
+			alert_queue_delay_p999,
+
 			num_counters,
 			num_gauges_counters = num_counters - num_stats_counters
 		};
+
+		// internal
+		enum latency_histogram_t
+		{
+			// the time to service a disk read, write or hash job
+			disk_job_latency_histogram,
+
+			// the time from the first block request of a piece until it
+			// passed the hash check
+			piece_download_time_histogram,
+
+			// the time from posting an alert until the client popped it
+			alert_queue_delay_histogram,
+
+			num_latency_histograms
+		};
+
 #ifdef ATOMIC_LLONG_LOCK_FREE
 #define TORRENT_COUNTER_NOEXCEPT noexcept
 #else
@@ -433,30 +523,60 @@ namespace libtorrent {
 
 		counters() TORRENT_COUNTER_NOEXCEPT;
 
+		~counters();
+
+		// copies are flat snapshots, the per-thread shards of the source
+		// are folded into the copy's values
 		counters(counters const&) TORRENT_COUNTER_NOEXCEPT;
 		counters& operator=(counters const&) & TORRENT_COUNTER_NOEXCEPT;
 
-		// returns the new value
+		// returns the new value. Stats counters (the monotonic ones) are
+		// accumulated in per-thread shards, for those the returned value
+		// only covers increments made through the calling thread's shard.
+		// Use operator[] to read the aggregate.
 		std::int64_t inc_stats_counter(int c, std::int64_t value = 1) TORRENT_COUNTER_NOEXCEPT;
 		std::int64_t operator[](int i) const TORRENT_COUNTER_NOEXCEPT;
 
 		void set_value(int c, std::int64_t value) TORRENT_COUNTER_NOEXCEPT;
 		void blend_stats_counter(int c, std::int64_t value, int ratio) TORRENT_COUNTER_NOEXCEPT;
 
+		// add a sample (in microseconds) to one of the latency histograms.
+		// This may be called from any thread
+		void record_latency(latency_histogram_t h, std::int64_t microseconds) TORRENT_COUNTER_NOEXCEPT;
+
+		// compute the percentiles of every latency histogram over the
+		// samples recorded since the last call, and store them in the
+		// corresponding gauges. This is called when posting session stats
+		void update_latency_percentiles() TORRENT_COUNTER_NOEXCEPT;
+
+		// the number of per-thread shards stats counters are spread over.
+		// Threads are assigned a shard round-robin, more threads than
+		// shards just means some of them share one
+		static constexpr int num_shards = 8;
+
 	private:
 
 		// TODO: some space could be saved here by making gauges 32 bits
-		// TODO: restore these to regular integers. Instead have one copy
-		// of the counters per thread and collect them at convenient
-		// synchronization points
 #ifdef ATOMIC_LLONG_LOCK_FREE
+		// gauges, and the part of stats counters that isn't (yet) held in
+		// one of the shards
 		aux::array<std::atomic<std::int64_t>, num_counters> m_stats_counter;
+
+		// one cache-line aligned copy of the stats counters per shard, so
+		// threads bumping the same counter don't bounce its cache line
+		// between cores. If the allocation failed, this is nullptr and all
+		// increments go to m_stats_counter
+		struct shard;
+		std::unique_ptr<shard[]> m_shards;
 #else
 		// if the atomic type isn't lock-free, use a single lock instead, for
 		// the whole array
 		mutable std::mutex m_mutex;
 		aux::array<std::int64_t, num_counters> m_stats_counter;
 #endif
+
+		// num_latency_histograms entries, or nullptr if the allocation failed
+		std::unique_ptr<aux::latency_histogram[]> m_histograms;
 	};
 }
 
@@ -62,13 +62,12 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/flags.hpp"
 #include "libtorrent/units.hpp"
 #include "libtorrent/index_range.hpp"
+#include "libtorrent/bitfield.hpp"
 
 namespace libtorrent {
 
 	struct torrent;
 	struct peer_connection;
-	template <typename Index>
-	struct typed_bitfield;
 	struct counters;
 	struct torrent_peer;
 
@@ -142,7 +141,12 @@ namespace libtorrent {
 		// pick pieces in sequential order
 		static constexpr picker_options_t sequential = 4_bit;
 
-		// 5_bit is available
+		// pick the pieces in the window set by set_sequential_window() in
+		// order, before any other piece. The pieces beyond the window are
+		// picked by the other options (rarest first, typically). Without
+		// this option, the pieces in the window are not picked at all,
+		// unless the sequential option is set
+		static constexpr picker_options_t sequential_window = 5_bit;
 
 		// only expands pieces (when prefer contiguous blocks is set)
 		// within properly aligned ranges, not the largest possible
@@ -216,6 +220,10 @@ namespace libtorrent {
 			// available for future use
 			std::uint16_t unused2:1;
 #endif
+
+			// when this piece entered the download queue. Used to measure
+			// piece download times
+			time_point started;
 		};
 
 		piece_picker(std::int64_t total_size, int piece_size);
@@ -260,6 +268,13 @@ namespace libtorrent {
 		// one past the last piece we do not have.
 		piece_index_t reverse_cursor() const { return m_reverse_cursor; }
 
+		// the window picked in order with the sequential_window option. It
+		// starts at ``cursor`` and spans the next ``num_pieces`` pieces we
+		// don't have and want
+		void set_sequential_window(piece_index_t cursor, int num_pieces);
+		piece_index_t window_cursor() const { return m_window_cursor; }
+		int window_pieces() const { return m_window_pieces; }
+
 		// sets all pieces to dont-have
 		void resize(std::int64_t total_size, int piece_size);
 		int num_pieces() const { return int(m_piece_map.size()); }
@@ -407,6 +422,19 @@ namespace libtorrent {
 		// has passed the hash check
 		bool has_piece_passed(piece_index_t) const;
 
+		// the time the given piece was first requested, or a default
+		// constructed time_point if it's not being downloaded
+		time_point download_start(piece_index_t) const;
+
+		// bitfields of the pieces with a priority above dont_download
+		// (``wanted_pieces``) and the pieces that have passed the hash check
+		// (``passed_pieces``). They are kept up to date, one bit at a time,
+		// as priorities and piece states change, and let peer interest be
+		// evaluated with
+		// bitfield::any_set_and_not() instead of a per-piece loop
+		typed_bitfield<piece_index_t> const& wanted_pieces() const;
+		typed_bitfield<piece_index_t> const& passed_pieces() const;
+
 		// returns the number of blocks there is in the given piece
 		int blocks_in_piece(piece_index_t) const;
 
@@ -483,6 +511,9 @@ namespace libtorrent {
 		// the number of pieces we want and don't have
 		int num_want_left() const { return num_pieces() - m_num_have - m_num_filtered + m_num_have_filtered; }
 
+		// the number of bytes of memory held by the piece picker
+		std::size_t memory_usage() const;
+
 #if TORRENT_USE_INVARIANT_CHECKS
 		void check_piece_state() const;
 		// used in debug mode
@@ -753,6 +784,10 @@ namespace libtorrent {
 		void break_one_seed();
 
 		void update_pieces() const;
+		void rebuild_interest_masks();
+
+		// move m_window_first past the pieces we have or filtered
+		void advance_window_first();
 
 		prio_index_t priority_begin(int prio) const;
 		prio_index_t priority_end(int prio) const;
@@ -890,6 +925,15 @@ namespace libtorrent {
 		// all the subsequent pieces
 		piece_index_t m_reverse_cursor{0};
 
+		// see set_sequential_window()
+		piece_index_t m_window_cursor{0};
+		int m_window_pieces = 0;
+
+		// the first piece at or after m_window_cursor we don't have and
+		// haven't filtered. The window starts here, it's kept up to date
+		// like m_cursor so picking doesn't walk the pieces we already have
+		piece_index_t m_window_first{0};
+
 		// the number of pieces we have (i.e. passed + flushed).
 		// This includes pieces that we have filtered but still have
 		int m_num_have = 0;
@@ -897,6 +941,10 @@ namespace libtorrent {
 		// if this is set to true, it means update_pieces()
 		// has to be called before accessing m_pieces.
 		mutable bool m_dirty = false;
+
+		// see wanted_pieces() and passed_pieces()
+		typed_bitfield<piece_index_t> m_wanted_mask;
+		typed_bitfield<piece_index_t> m_passed_mask;
 	public:
 
 		enum { max_pieces = (std::numeric_limits<int>::max)() - 1 };
@@ -938,6 +938,22 @@ namespace aux {
 			// previously deleted information from the disk.
 			enable_set_file_valid_data,
 
+			// when true, uTP sockets spread the packets of a congestion window
+			// out over the round-trip time, instead of sending them back to
+			// back as soon as the window opens. This keeps bursts from building
+			// queues (and losing packets) at the bottleneck on their own.
+			utp_pacing,
+
+			// when true, uTP sockets consider a packet lost once a packet sent
+			// after it has been acknowledged, and it's still unacknowledged a
+			// reordering window later (RACK). A probe is sent when the tail of
+			// a flight goes unacknowledged for two round-trips, instead of
+			// waiting for the retransmit timeout. Retransmits found to have been
+			// spurious widen the reordering window and undo the congestion
+			// window cut. When false, only duplicate ACKs and timeouts trigger
+			// retransmits.
+			utp_rack,
+
 			// When using a SOCKS5 proxy, UDP traffic is routed through the
 			// proxy by sending a UDP ASSOCIATE command. If this option is true,
 			// the UDP ASSOCIATE command will include the IP address and
@@ -1703,7 +1719,8 @@ namespace aux {
 			// regular disk I/O threads specified by settings_pack::aio_threads.
 			// These threads are only used for full checking of torrents. The
 			// hash checking done while downloading are done by the regular disk
-			// I/O threads.
+			// I/O threads. set_piece_hashes() without a disk I/O constructor
+			// hashes the pieces of a new torrent on this many threads too.
 			// The hasher threads do not only compute hashes, but also perform
 			// the read from disk. On storage optimal for sequential access,
 			// such as hard drives, this setting should be set to 1, which is
@@ -1907,7 +1924,9 @@ namespace aux {
 
 			// the number of seconds before the internal host name resolver
 			// considers a cache value timed out, negative values are interpreted
-			// as zero.
+			// as zero. Entries that are still being asked for are looked up
+			// again in the background once they reach 3/4 of this age, so
+			// that they don't expire in front of an announce.
 			resolver_cache_timeout,
 
 			// specify the not-sent low watermark for socket send buffers. This
@@ -1964,6 +1983,94 @@ namespace aux {
 			// operations. This file size limit is specified in 16 kiB blocks.
 			mmap_file_size_cutoff,
 
+			// the max number of bytes of idle peer receive buffers kept in the
+			// session-wide receive buffer pool. Peers borrow a receive buffer
+			// from the pool while a message is in flight and return it when
+			// they go idle. Buffers returned beyond this limit are freed.
+			recv_buffer_pool_size,
+
+			// when non-zero, the session serves all session_stats_metrics()
+			// counters and gauges, plus per-torrent payload rates, in the
+			// OpenMetrics text format at http://127.0.0.1:<metrics_port>/metrics.
+			// The endpoint only binds the loopback interface and is read-only.
+			// The snapshot it serves is refreshed once per second, by the part
+			// of the session tick that runs at most once a second, regardless
+			// of ``tick_interval``.
+			metrics_port,
+
+			// HTTP tracker requests are sent with ``Connection: keep-alive``
+			// and, once the response has been received, the connection is
+			// kept idle for the next request to the same host.
+			// ``tracker_http_pool_max_idle`` is the max number of idle
+			// connections kept per tracker host. 0 disables the pool, and
+			// every request uses a connection of its own.
+			// ``tracker_http_pool_idle_timeout`` is the number of seconds an
+			// idle connection is kept before it's closed.
+			tracker_http_pool_max_idle,
+			tracker_http_pool_idle_timeout,
+
+			// the max number of host names the internal resolver looks up in
+			// parallel. Lookups run on a pool of threads of this size. 0 falls
+			// back to asio's resolver, which runs one lookup at a time.
+			resolver_max_concurrency,
+
+			// the number of seconds a failed host name lookup is cached for.
+			// Until it times out, lookups of the same name fail right away with
+			// the same error. Negative values are interpreted as zero.
+			resolver_negative_cache_timeout,
+
+			// the max amount of memory (in kiB) the session should use, for
+			// torrent state, peer connections and disk buffers. 0 means no
+			// limit. Every few seconds, when over budget, the session gives up
+			// state that's the cheapest to rebuild until it's back under:
+			// first idle pooled receive buffers, then piece pickers kept by
+			// seeds, then half of the largest peer lists, and last,
+			// connections where neither side is interested. The memory used
+			// is reported by the ``mem.*`` counters.
+			memory_budget,
+
+			// the size (in MiB) of the streaming cache of the disk I/O
+			// subsystem. 0 disables it. It holds blocks around the piece each
+			// torrent was last played back from, with read_piece() and the
+			// ``torrent_handle::playback`` flag, the ones played back and the
+			// ones downloaded ahead, so that re-reads and backward seeks
+			// during playback are served from RAM instead of going back to
+			// disk. Hits and misses are reported by the
+			// ``disk.streaming_cache_*`` counters.
+			streaming_cache_size,
+
+			// the size of the window of torrents in ``sequential_window``
+			// mode. ``sequential_window_duration`` is in seconds, the window
+			// spans the pieces the torrent downloads in that long at its
+			// current download rate. It never spans fewer than
+			// ``sequential_window_min_pieces`` pieces, which is what it is
+			// until the torrent has a download rate.
+			sequential_window_duration,
+			sequential_window_min_pieces,
+
+			// the congestion controller used by new uTP connections, one of
+			// the values from utp_congestion_control_t. ``ledbat`` is the
+			// classic LEDBAT of BEP 29. ``ledbat_plus_plus`` adapts its gain to
+			// the RTT, backs off multiplicatively and periodically slows down
+			// to measure the base delay again. LEDBAT++ is designed for a
+			// ``utp_target_delay`` of 60 ms.
+			utp_congestion_control,
+
+			// the width (in seconds) of the slots tracker re-announces are
+			// rounded up to. Every torrent announcing to the same tracker uses
+			// the same slots, so their announces fall due together and share
+			// the UDP connect round-trip and the HTTP connection to the
+			// tracker. The slots of different trackers are offset from each
+			// other, to spread the load. 0 announces right when the interval
+			// expires.
+			announce_merge_window,
+
+			// the max number of bytes (in MiB) of file data set_piece_hashes()
+			// reads ahead of the hasher threads when creating a torrent. Every
+			// hasher thread is kept busy with a batch of pieces, plus one being
+			// read, as far as this allows.
+			create_torrent_readahead,
+
 
 			//GTK client enums
 
@@ -2091,6 +2198,12 @@ namespace aux {
 			peer_proportional = 1
 		};
 
+		enum utp_congestion_control_t : std::uint8_t
+		{
+			ledbat = 0,
+			ledbat_plus_plus = 1
+		};
+
 
 
 	
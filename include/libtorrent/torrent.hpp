@@ -477,7 +477,9 @@ namespace libtorrent {
 			bool fail;
 			error_code error;
 		};
-		void read_piece(piece_index_t);
+		// buffer is where to read the piece to, allocated if it's empty
+		void read_piece(piece_index_t, boost::shared_array<char> buffer
+			, read_piece_flags_t flags);
 		void on_disk_read_complete(disk_buffer_holder, storage_error const&
 			, peer_request const&, std::shared_ptr<read_piece_struct>);
 
@@ -504,6 +506,10 @@ namespace libtorrent {
 		bool is_sequential_download() const
 		{ return m_sequential_download || m_auto_sequential; }
 
+		void set_sequential_window(bool sw);
+		bool is_sequential_window() const { return m_sequential_window; }
+		void set_window_cursor(piece_index_t cursor);
+
 		void queue_up();
 		void queue_down();
 		void set_queue_position(queue_position_t p);
@@ -745,7 +751,7 @@ namespace libtorrent {
 		void update_peer_port(int port, torrent_peer* p, peer_source_flags_t src);
 		void set_seed(torrent_peer* p, bool s);
 		void clear_failcount(torrent_peer* p);
-		std::pair<peer_list::iterator, peer_list::iterator> find_peers(address const& a);
+		std::vector<torrent_peer*> find_peers(address const& a);
 
 		// the number of peers that belong to this torrent
 		int num_peers() const { return int(m_connections.size() - m_peers_to_disconnect.size()); }
@@ -770,6 +776,10 @@ namespace libtorrent {
 		void post_download_queue();
 
 		void update_auto_sequential();
+
+		// sizes the sequential window by the download rate and hands it to
+		// the piece picker
+		void update_sequential_window();
 	private:
 		void remove_connection(peer_connection const* p);
 	public:
@@ -1078,6 +1088,14 @@ namespace libtorrent {
 
 		void clear_peers();
 
+		torrent_memory_usage memory_usage() const;
+
+		// these give up state that can be rebuilt, when the session is over
+		// its memory budget. They return the number of bytes freed
+		std::int64_t release_seed_picker();
+		std::int64_t trim_peer_list(int max_peers);
+		std::int64_t disconnect_idle_peers();
+
 		bool has_storage() const { return bool(m_storage); }
 		storage_index_t storage() const { return m_storage; }
 
@@ -1351,6 +1369,11 @@ namespace libtorrent {
 		// this object is used to track download progress of individual files
 		aux::file_progress m_file_progress;
 
+		// torrent_info::memory_usage() walks the file list, the result is
+		// cached for the torrent_info object it was computed for
+		mutable torrent_info const* m_metadata_usage_for = nullptr;
+		mutable std::int64_t m_metadata_usage = 0;
+
 		// a queue of the most recent low-availability pieces we accessed on disk.
 		// These are good candidates for suggesting other peers to request from
 		// us.
@@ -1471,6 +1494,10 @@ namespace libtorrent {
 		// the number of pieces we completed the check of
 		piece_index_t m_num_checked_pieces{0};
 
+		// where the sequential window starts, set by the client as playback
+		// progresses
+		piece_index_t m_window_cursor{0};
+
 		// if the error occurred on a file, this is the index of that file
 		// there are a few special cases, when this is negative. See
 		// set_error()
@@ -1591,6 +1618,10 @@ namespace libtorrent {
 		// for improved disk I/O performance.
 		bool m_auto_sequential:1;
 
+		// pieces in a window ahead of m_window_cursor are picked in order,
+		// the rest rarest first. See torrent_flags::sequential_window
+		bool m_sequential_window:1;
+
 		// this means we haven't verified the file content
 		// of the files we're seeding. the m_verified bitfield
 		// indicates which pieces have been verified and which
@@ -147,7 +147,7 @@ namespace torrent_flags {
 	// high indices. The actual pieces that are picked depend on other factors
 	// still, such as which pieces a peer has and whether it is in parole mode
 	// or "prefer whole pieces"-mode. Sequential mode is not ideal for streaming
-	// media. For that, see set_piece_deadline() instead.
+	// media. For that, see sequential_window instead.
 	constexpr torrent_flags_t sequential_download = 9_bit;
 
 	// When this flag is set, the torrent will *force stop* whenever it
@@ -279,6 +279,15 @@ namespace torrent_flags {
 	// (dont_download).
 	constexpr torrent_flags_t default_dont_download = 23_bit;
 
+	// sets the sliding window download mode for the torrent. Pieces in a
+	// window ahead of the cursor set by torrent_handle::set_window_cursor()
+	// are picked in order, and the pieces beyond it rarest first. The window
+	// spans what the torrent downloads in ``sequential_window_duration``
+	// seconds at its current rate, so the swarm keeps trading rare pieces
+	// while playback stays fed. This is the mode to stream media with.
+	// ``sequential_download`` takes precedence over it.
+	constexpr torrent_flags_t sequential_window = 24_bit;
+
 
 
 	// all torrent flags combined. Can conveniently be used when creating masks
@@ -53,6 +53,7 @@ POSSIBILITY OF SUCH DAMAGE.
 // for deprecated force_reannounce
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #endif
+#include <boost/shared_array.hpp>
 #include "libtorrent/aux_/disable_warnings_pop.hpp"
 
 #include "libtorrent/fwd.hpp"
@@ -93,6 +94,7 @@ namespace aux {
 	using reannounce_flags_t = flags::bitfield_flag<std::uint8_t, struct reannounce_flags_tag>;
 	using queue_position_t = aux::strong_typedef<int, struct queue_position_tag>;
 	using file_progress_flags_t = flags::bitfield_flag<std::uint8_t, struct file_progress_flags_tag>;
+	using read_piece_flags_t = flags::bitfield_flag<std::uint8_t, struct read_piece_flags_tag>;
 
 	// holds the state of a block in a piece. Who we requested
 	// it from and how far along we are at downloading it.
@@ -207,6 +209,34 @@ namespace aux {
 #endif
 	};
 
+	// the memory attributed to a torrent, in bytes, broken down by the part
+	// of the torrent holding it. Returned by torrent_handle::memory_usage().
+	struct TORRENT_EXPORT torrent_memory_usage
+	{
+		// the piece picker, tracking piece availability and the pieces being
+		// downloaded. Seeds normally don't have one.
+		std::int64_t piece_picker = 0;
+
+		// the list of known peers, connected or not.
+		std::int64_t peer_list = 0;
+
+		// the torrent_info object, including the file list and the info
+		// section.
+		std::int64_t metadata = 0;
+
+		// the peer connections and their send and receive buffers.
+		std::int64_t connections = 0;
+
+		// blocks received from peers that are waiting to be written to disk.
+		// These are disk buffers, they are also included in the
+		// ``disk.disk_blocks_in_use`` session counter.
+		std::int64_t disk_writes = 0;
+
+		// the sum of all of the above
+		std::int64_t total() const
+		{ return piece_picker + peer_list + metadata + connections + disk_writes; }
+	};
+
 	// for std::hash (and to support using this type in unordered_map etc.)
 	TORRENT_EXPORT std::size_t hash_value(torrent_handle const& h);
 
@@ -269,6 +299,11 @@ namespace aux {
 		// being downloaded from peers may not be replaced.
 		static constexpr add_piece_flags_t overwrite_existing = 0_bit;
 
+		// the piece is read to be played back. This moves the stream cursor of
+		// the torrent to it, which the streaming cache of the disk I/O keeps
+		// blocks around (see settings_pack::streaming_cache_size).
+		static constexpr read_piece_flags_t playback = 0_bit;
+
 		// This function will write ``data`` to the storage as piece ``piece``,
 		// as if it had been downloaded from a peer.
 		//
@@ -309,12 +344,30 @@ namespace aux {
 		//
 		// Note that if you read multiple pieces, the read operations are not
 		// guaranteed to finish in the same order as you initiated them.
-		void read_piece(piece_index_t piece) const;
+		//
+		// The overload taking a ``buffer`` reads the piece into it instead of
+		// allocating one. It must hold at least piece_size(``piece``) bytes.
+		// The read_piece_alert carries the same buffer back, which lets a
+		// client recycle piece sized buffers from a pool of its own. If it's
+		// empty, one is allocated as usual.
+		//
+		// Pass the playback flag when the piece is read to play it back, as
+		// opposed to probing or indexing the file.
+		void read_piece(piece_index_t piece, read_piece_flags_t flags = {}) const;
+		void read_piece(piece_index_t piece, boost::shared_array<char> buffer
+			, read_piece_flags_t flags = {}) const;
 
 		// Returns true if this piece has been completely downloaded and written
 		// to disk, and false otherwise.
 		bool have_piece(piece_index_t piece) const;
 
+		// sets where the sequential window of a torrent in the
+		// torrent_flags::sequential_window mode starts. Typically the piece
+		// being played back, moved as playback progresses and on seeks. The
+		// window spans the next pieces the torrent doesn't have yet, they're
+		// picked in order, all other pieces rarest first.
+		void set_window_cursor(piece_index_t piece) const;
+
 #if TORRENT_ABI_VERSION == 1
 		// internal
 		TORRENT_DEPRECATED
@@ -1243,6 +1296,11 @@ namespace aux {
 		// trackers, DHT or local service discovery, for example.
 		void clear_peers();
 
+		// returns an estimate of the memory held by this torrent, broken
+		// down by subsystem. The same numbers, summed over all torrents, are
+		// reported by the ``mem.*`` session counters.
+		torrent_memory_usage memory_usage() const;
+
 		// ``set_max_uploads()`` sets the maximum number of peers that's unchoked
 		// at the same time on this torrent. If you set this to -1, there will be
 		// no limit. This defaults to infinite. The primary setting controlling
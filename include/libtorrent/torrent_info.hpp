@@ -149,6 +149,13 @@ namespace aux {
 
 		// the max number of bdecode tokens
 		int max_decode_tokens = 3000000;
+
+		// when loading a torrent from a file, and this is set, the file is
+		// mapped into memory rather than read. The info section and file
+		// names refer directly into the mapping instead of being copied, so
+		// the .torrent file must not be modified or truncated for as long as
+		// the torrent_info object is alive.
+		bool map_file = false;
 	};
 
 	using torrent_info_flags_t = flags::bitfield_flag<std::uint8_t, struct torrent_info_flags_tag>;
@@ -253,6 +260,10 @@ TORRENT_VERSION_NAMESPACE_3
 		file_storage const& files() const { return m_files; }
 		file_storage const& orig_files() const;
 
+		// returns an estimate of the number of bytes of memory held by this
+		// object, including the file list and the info section
+		std::size_t memory_usage() const;
+
 		// Renames the file with the specified index to the new name. The new
 		// filename is reflected by the ``file_storage`` returned by ``files()``
 		// but not by the one returned by ``orig_files()``.
@@ -659,7 +670,12 @@ TORRENT_VERSION_NAMESPACE_3
 		// populate the piece layers from the metadata
 		// bool parse_piece_layers(bdecode_node const& e, error_code& ec);
 
-		bool parse_torrent_file(bdecode_node const& torrent_file, error_code& ec, int piece_limit);
+		// if ``backing`` is set, it holds the buffer ``torrent_file`` was
+		// decoded from, and the info section is referenced rather than copied
+		bool parse_torrent_file(bdecode_node const& torrent_file, error_code& ec
+			, int piece_limit, std::shared_ptr<char const> const& backing = {});
+		bool parse_info_section(bdecode_node const& info, error_code& ec
+			, int max_pieces, std::shared_ptr<char const> const& backing);
 
 		void resolve_duplicate_filenames();
 
@@ -66,6 +66,10 @@ namespace libtorrent {
 		std::int64_t total_download() const;
 		std::int64_t total_upload() const;
 
+		// the rank of this peer, computed by hashing our IP with the remote IP
+		// of this peer. It's not cached in the peer record (to keep it small
+		// and to follow changes of our external address). The connect
+		// candidate cache in peer_list holds on to it instead.
 		std::uint32_t rank(external_ip const& external, int external_port) const;
 
 		libtorrent::address address() const;
@@ -99,11 +103,6 @@ namespace libtorrent {
 		// will refer to a valid peer_connection
 		peer_connection_interface* connection;
 
-		// as computed by hashing our IP with the remote
-		// IP of this peer
-		// calculated lazily
-		mutable std::uint32_t peer_rank;
-
 		// the time when this torrent_peer was optimistically unchoked
 		// the last time. in seconds since session was created
 		// 16 bits is enough to last for 18.2 hours
@@ -199,6 +198,8 @@ namespace libtorrent {
 #endif
 	};
 
+	// the IPv4 record is the common case by far. The address is packed into
+	// the tail of torrent_peer, for a 32 byte record on 64 bit systems
 	struct TORRENT_EXTRA_EXPORT ipv4_peer : torrent_peer
 	{
 		ipv4_peer(tcp::endpoint const& ep, bool connectable, peer_source_flags_t src);
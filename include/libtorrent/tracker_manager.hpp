@@ -49,6 +49,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <unordered_map>
 #include <deque>
+#include <map>
 
 #include "libtorrent/flags.hpp"
 #include "libtorrent/socket.hpp"
@@ -57,6 +58,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/peer_id.hpp"
 #include "libtorrent/peer.hpp" // peer_entry
 #include "libtorrent/deadline_timer.hpp"
+#include "libtorrent/http_connection.hpp"
 #include "libtorrent/union_endpoint.hpp"
 #include "libtorrent/io_context.hpp"
 #include "libtorrent/span.hpp"
@@ -363,6 +365,32 @@ enum class event_t : std::uint8_t
 			std::shared_ptr<udp_tracker_connection> c
 			, std::uint32_t tid);
 
+		// called by a UDP tracker connection that needs a connection ID from
+		// the tracker at ``a``. If another connection is already waiting for
+		// one, ``c`` is queued up behind it and this returns true. Otherwise
+		// the caller is expected to send the connect request and call
+		// udp_connect_done() once it completes or fails
+		bool join_udp_connect(address const& a
+			, std::shared_ptr<udp_tracker_connection> const& c);
+		void udp_connect_done(address const& a);
+
+		// the scrape is no longer accepting batched requests
+		void scrape_sent(udp_tracker_connection const* c);
+
+		// returns an idle keep-alive connection to the host in ``url``, or
+		// nullptr if there is none
+		std::shared_ptr<http_connection> acquire_http_connection(
+			std::string const& url, bind_info_t const& bind_addr);
+
+		// hands an HTTP tracker connection back to the keep-alive pool once
+		// its request is done. Connections that can't be reused are closed
+		void release_http_connection(std::shared_ptr<http_connection> c);
+
+		// closes the keep-alive connections that have been idle longer than
+		// tracker_http_pool_idle_timeout. Called once per second by the
+		// session
+		void expire_http_connections();
+
 		aux::session_settings const& settings() const { return m_settings; }
 		aux::resolver_interface& host_resolver() { return m_host_resolver; }
 
@@ -384,6 +412,17 @@ enum class event_t : std::uint8_t
 		std::vector<std::shared_ptr<http_tracker_connection>> m_http_conns;
 		std::deque<std::shared_ptr<http_tracker_connection>> m_queued;
 
+		// idle keep-alive connections to HTTP trackers
+		http_connection_pool m_http_pool;
+
+		// UDP scrapes that haven't been sent yet. Scrapes of other torrents
+		// on the same tracker are batched into these
+		std::vector<std::weak_ptr<udp_tracker_connection>> m_pending_scrapes;
+
+		// tracker addresses we have a UDP connect request in flight to, and
+		// the connections waiting for its connection ID
+		std::map<address, std::vector<std::weak_ptr<udp_tracker_connection>>> m_udp_connects;
+
 		send_fun_t m_send_fun;
 		send_fun_hostname_t m_send_fun_hostname;
 		aux::resolver_interface& m_host_resolver;
@@ -66,6 +66,15 @@ namespace libtorrent {
 
 		std::uint32_t transaction_id() const { return m_transaction_id; }
 
+		// the max number of info-hashes in a single scrape packet. BEP 15
+		// puts the limit at about 74, to stay within a typical MTU
+		static constexpr int max_scrape_hashes = 74;
+
+		// add another torrent's scrape of the same tracker to this (not yet
+		// sent) scrape request. If the batch is full, or the scrape has
+		// already gone out, this returns false and ``req`` is left untouched
+		bool add_scrape(tracker_request& req, std::weak_ptr<request_callback> c);
+
 	private:
 
 		enum class action_t : std::uint8_t
@@ -105,6 +114,15 @@ namespace libtorrent {
 		void send_udp_announce();
 		void send_udp_scrape();
 
+		// report an error to every scrape batched into this one. The primary
+		// request is failed through tracker_connection::fail()
+		void fail_batch(error_code const& ec, operation_t op
+			, char const* msg, seconds32 interval);
+
+		// if we're the connection other requests to this tracker are waiting
+		// on for a connection ID, let them go
+		void release_connect();
+
 		void on_timeout(error_code const& ec) override;
 
 		std::string m_hostname;
@@ -127,6 +145,22 @@ namespace libtorrent {
 		action_t m_state;
 
 		bool m_abort;
+
+		// set while we have a connect request in flight that other requests
+		// to the same tracker are waiting on
+		bool m_connect_leader = false;
+
+		// set once the scrape packet has been sent. No more scrapes can be
+		// batched into it after that
+		bool m_scrape_sent = false;
+
+		// scrapes of other torrents that ride along in our scrape packet
+		struct batched_scrape
+		{
+			tracker_request req;
+			std::weak_ptr<request_callback> requester;
+		};
+		std::vector<batched_scrape> m_batch;
 	};
 
 }
@@ -2221,6 +2221,7 @@ namespace {
 	constexpr picker_flags_t picker_log_alert::backup2;
 	constexpr picker_flags_t picker_log_alert::end_game;
 	constexpr picker_flags_t picker_log_alert::extent_affinity;
+	constexpr picker_flags_t picker_log_alert::window_pieces;
 
 	std::string picker_log_alert::message() const
 	{
@@ -2246,6 +2247,7 @@ namespace {
 			"backup2 ",
 			"end_game ",
 			"extent_affinity ",
+			"window_pieces ",
 		};
 
 		std::string ret = peer_alert::message();
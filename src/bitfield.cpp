@@ -40,8 +40,202 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <intrin.h>
 #endif
 
+#include <algorithm> // for min
+
+// the AVX2 kernels are built into every x86 build, and selected at runtime
+// based on aux::avx2_support. GCC and clang need the target attribute to
+// emit AVX2 instructions in a translation unit not built with -mavx2
+#if TORRENT_HAS_SSE && (defined __GNUC__ || (defined _MSC_VER && _MSC_VER >= 1800))
+#define TORRENT_BITFIELD_AVX2 1
+#include <immintrin.h>
+#else
+#define TORRENT_BITFIELD_AVX2 0
+#endif
+
+#if TORRENT_BITFIELD_AVX2 && defined __GNUC__
+#define TORRENT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TORRENT_TARGET_AVX2
+#endif
+
 namespace libtorrent {
 
+namespace {
+
+	int popcount32(std::uint32_t const v) noexcept
+	{
+#if defined __GNUC__ || defined __clang__
+		return __builtin_popcount(v);
+#else
+		// from:
+		// http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetParallel
+		static const int S[] = {1, 2, 4, 8, 16}; // Magic Binary Numbers
+		static const std::uint32_t B[] = {0x55555555, 0x33333333, 0x0F0F0F0F, 0x00FF00FF, 0x0000FFFF};
+
+		std::uint32_t c = v - ((v >> 1) & B[0]);
+		c = ((c >> S[1]) & B[1]) + (c & B[1]);
+		c = ((c >> S[2]) + c) & B[2];
+		c = ((c >> S[3]) + c) & B[3];
+		c = ((c >> S[4]) + c) & B[4];
+		return int(c);
+#endif
+	}
+
+	// these return the index of the first word in the range [i, words) that
+	// is non-zero (or, for the _and_not versions, where a & ~e & w is
+	// non-zero). If there is none, ``words`` is returned.
+	int find_word_sw(std::uint32_t const* a, int i, int const words) noexcept
+	{
+		for (; i < words; ++i)
+			if (a[i] != 0) return i;
+		return words;
+	}
+
+	int find_word_and_not_sw(std::uint32_t const* a, std::uint32_t const* e
+		, std::uint32_t const* w, int i, int const words) noexcept
+	{
+		for (; i < words; ++i)
+			if ((a[i] & ~e[i] & w[i]) != 0) return i;
+		return words;
+	}
+
+	void and_words_sw(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+		for (int i = 0; i < words; ++i) dst[i] &= src[i];
+	}
+
+	void and_not_words_sw(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+		for (int i = 0; i < words; ++i) dst[i] &= ~src[i];
+	}
+
+#if TORRENT_BITFIELD_AVX2
+	// the number of 32 bit words in one 256 bit register
+	constexpr int avx2_words = 8;
+
+	TORRENT_TARGET_AVX2
+	__m256i load256(std::uint32_t const* p) noexcept
+	{ return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+
+	TORRENT_TARGET_AVX2
+	int popcount_avx2(std::uint32_t const* a, int const words) noexcept
+	{
+		// count the bits of each nibble with a table lookup (shuffle) and
+		// sum the per-byte counts into the four 64 bit lanes
+		__m256i const lookup = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+			, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		__m256i const low_mask = _mm256_set1_epi8(0x0f);
+		__m256i acc = _mm256_setzero_si256();
+		int i = 0;
+		for (; i + avx2_words <= words; i += avx2_words)
+		{
+			__m256i const v = load256(a + i);
+			__m256i const lo = _mm256_and_si256(v, low_mask);
+			__m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+			__m256i const cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo)
+				, _mm256_shuffle_epi8(lookup, hi));
+			acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+		}
+		std::uint64_t lanes[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+		std::uint64_t ret = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		for (; i < words; ++i) ret += std::uint64_t(popcount32(a[i]));
+		return int(ret);
+	}
+
+	TORRENT_TARGET_AVX2
+	int find_word_avx2(std::uint32_t const* a, int i, int const words) noexcept
+	{
+		for (; i + avx2_words <= words; i += avx2_words)
+		{
+			__m256i const v = load256(a + i);
+			if (!_mm256_testz_si256(v, v)) break;
+		}
+		return find_word_sw(a, i, words);
+	}
+
+	TORRENT_TARGET_AVX2
+	int find_word_and_not_avx2(std::uint32_t const* a, std::uint32_t const* e
+		, std::uint32_t const* w, int i, int const words) noexcept
+	{
+		for (; i + avx2_words <= words; i += avx2_words)
+		{
+			// andnot computes ~e & a
+			__m256i const v = _mm256_andnot_si256(load256(e + i), load256(a + i));
+			if (!_mm256_testz_si256(v, load256(w + i))) break;
+		}
+		return find_word_and_not_sw(a, e, w, i, words);
+	}
+
+	TORRENT_TARGET_AVX2
+	void and_words_avx2(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+		int i = 0;
+		for (; i + avx2_words <= words; i += avx2_words)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i)
+				, _mm256_and_si256(load256(dst + i), load256(src + i)));
+		}
+		and_words_sw(dst + i, src + i, words - i);
+	}
+
+	TORRENT_TARGET_AVX2
+	void and_not_words_avx2(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+		int i = 0;
+		for (; i + avx2_words <= words; i += avx2_words)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i)
+				, _mm256_andnot_si256(load256(src + i), load256(dst + i)));
+		}
+		and_not_words_sw(dst + i, src + i, words - i);
+	}
+#endif // TORRENT_BITFIELD_AVX2
+
+	int find_word(std::uint32_t const* a, int const i, int const words) noexcept
+	{
+#if TORRENT_BITFIELD_AVX2
+		if (aux::avx2_support) return find_word_avx2(a, i, words);
+#endif
+		return find_word_sw(a, i, words);
+	}
+
+	int find_word_and_not(std::uint32_t const* a, std::uint32_t const* e
+		, std::uint32_t const* w, int const i, int const words) noexcept
+	{
+#if TORRENT_BITFIELD_AVX2
+		if (aux::avx2_support) return find_word_and_not_avx2(a, e, w, i, words);
+#endif
+		return find_word_and_not_sw(a, e, w, i, words);
+	}
+
+	void and_words(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+#if TORRENT_BITFIELD_AVX2
+		if (aux::avx2_support)
+		{
+			and_words_avx2(dst, src, words);
+			return;
+		}
+#endif
+		and_words_sw(dst, src, words);
+	}
+
+	void and_not_words(std::uint32_t* dst, std::uint32_t const* src, int const words) noexcept
+	{
+#if TORRENT_BITFIELD_AVX2
+		if (aux::avx2_support)
+		{
+			and_not_words_avx2(dst, src, words);
+			return;
+		}
+#endif
+		and_not_words_sw(dst, src, words);
+	}
+
+} // anonymous namespace
+
 	bool bitfield::all_set() const noexcept
 	{
 		if(size() == 0) return false;
@@ -74,10 +268,27 @@ namespace libtorrent {
 		return std::memcmp(lb, rb, std::size_t(num_words()) * 4) == 0;
 	}
 
+	bool bitfield::none_set() const noexcept
+	{
+		if (size() == 0) return true;
+		int const words = num_words();
+		return find_word(buf(), 0, words) == words;
+	}
+
 	int bitfield::count() const noexcept
 	{
 		int ret = 0;
 		int const words = num_words();
+#if TORRENT_BITFIELD_AVX2
+		if (aux::avx2_support && words > 0)
+		{
+			ret = popcount_avx2(buf(), words);
+			TORRENT_ASSERT(ret <= size());
+			TORRENT_ASSERT(ret >= 0);
+			return ret;
+		}
+#endif
+
 #if TORRENT_HAS_SSE
 		if (aux::mmx_support)
 		{
@@ -124,25 +335,7 @@ namespace libtorrent {
 #endif // TORRENT_HAS_ARM_NEON
 
 		for (int i = 1; i < words + 1; ++i)
-		{
-#if defined __GNUC__ || defined __clang__
-			ret += __builtin_popcountl(m_buf[i]);
-#else
-			std::uint32_t const v = m_buf[i];
-			// from:
-			// http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetParallel
-			static const int S[] = {1, 2, 4, 8, 16}; // Magic Binary Numbers
-			static const std::uint32_t B[] = {0x55555555, 0x33333333, 0x0F0F0F0F, 0x00FF00FF, 0x0000FFFF};
-
-			std::uint32_t c = v - ((v >> 1) & B[0]);
-			c = ((c >> S[1]) & B[1]) + (c & B[1]);
-			c = ((c >> S[2]) + c) & B[2];
-			c = ((c >> S[3]) + c) & B[3];
-			c = ((c >> S[4]) + c) & B[4];
-			ret += c;
-			TORRENT_ASSERT(ret <= size());
-#endif
-		}
+			ret += popcount32(m_buf[i]);
 
 		TORRENT_ASSERT(ret <= size());
 		TORRENT_ASSERT(ret >= 0);
@@ -217,8 +410,54 @@ namespace libtorrent {
 	{
 		int const num = num_words();
 		if (num == 0) return -1;
-		int const count = aux::count_leading_zeros({&m_buf[1], num});
-		return count != num * 32 ? count : -1;
+		int const word = find_word(buf(), 0, num);
+		if (word == num) return -1;
+		return word * 32 + aux::count_leading_zeros({&m_buf[1 + word], 1});
+	}
+
+	int bitfield::find_first_set_and_not(bitfield const& bits
+		, bitfield const& exclude, bitfield const& want, int const start) noexcept
+	{
+		TORRENT_ASSERT(start >= 0);
+		TORRENT_ASSERT(exclude.size() == bits.size());
+		TORRENT_ASSERT(want.size() == bits.size());
+
+		int const num = std::min({bits.num_words(), exclude.num_words(), want.num_words()});
+		int word = start / 32;
+		if (word >= num) return -1;
+
+		std::uint32_t const* a = bits.buf();
+		std::uint32_t const* e = exclude.buf();
+		std::uint32_t const* w = want.buf();
+
+		// the first word may be partial, mask off the bits before start
+		std::uint32_t v = a[word] & ~e[word] & w[word]
+			& aux::host_to_network(0xffffffff >> (start & 31));
+		if (v == 0)
+		{
+			word = find_word_and_not(a, e, w, word + 1, num);
+			if (word == num) return -1;
+			v = a[word] & ~e[word] & w[word];
+		}
+		return word * 32 + aux::count_leading_zeros({&v, 1});
+	}
+
+	void bitfield::bitwise_and(bitfield const& rhs) noexcept
+	{
+		TORRENT_ASSERT(rhs.size() == size());
+		int const words = num_words();
+		if (words == 0) return;
+		int const common = std::min(words, rhs.num_words());
+		if (common > 0) and_words(buf(), rhs.buf(), common);
+		if (common < words)
+			std::memset(buf() + common, 0, std::size_t(words - common) * 4);
+	}
+
+	void bitfield::bitwise_and_not(bitfield const& rhs) noexcept
+	{
+		TORRENT_ASSERT(rhs.size() == size());
+		int const common = std::min(num_words(), rhs.num_words());
+		if (common > 0) and_not_words(buf(), rhs.buf(), common);
 	}
 
 	int bitfield::find_last_clear() const noexcept
@@ -754,7 +754,10 @@ namespace libtorrent {
 		incoming_piece_fragment(piece_bytes);
 		if (!m_recv_buffer.packet_finished()) return;
 
-		incoming_piece(p, recv_buffer.data() + header_size);
+		if (m_recv_buffer.has_disk_buffer())
+			incoming_piece(p, m_recv_buffer.release_disk_buffer());
+		else
+			incoming_piece(p, recv_buffer.data() + header_size);
 		// maybe_send_hash_request();
 	}
 
@@ -35,6 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/assert.hpp"
 
 #include <algorithm> // for copy
+#include <limits>
 
 namespace libtorrent {
 namespace aux {
@@ -119,21 +120,24 @@ namespace aux {
 		TORRENT_ASSERT(is_single_thread());
 		TORRENT_ASSERT(!m_destructed);
 		m_tmp_vec.clear();
-		build_vec(to_send, m_tmp_vec);
+		build_vec(to_send, m_tmp_vec, max_iovec_entries);
 		return m_tmp_vec;
 	}
 
 	void chained_buffer::build_mutable_iovec(int bytes, std::vector<span<char>> &vec)
 	{
 		TORRENT_ASSERT(!m_destructed);
-		build_vec(bytes, vec);
+		build_vec(bytes, vec, (std::numeric_limits<int>::max)());
 	}
 
 	template <typename Buffer>
-	void chained_buffer::build_vec(int bytes, std::vector<Buffer>& vec)
+	void chained_buffer::build_vec(int bytes, std::vector<Buffer>& vec
+		, int max_entries)
 	{
 		TORRENT_ASSERT(!m_destructed);
-		for (auto i = m_vec.begin(), end(m_vec.end()); bytes > 0 && i != end; ++i)
+		TORRENT_ASSERT(max_entries > 0);
+		for (auto i = m_vec.begin(), end(m_vec.end()); bytes > 0 && i != end
+			&& max_entries > 0; ++i, --max_entries)
 		{
 			TORRENT_ASSERT(i->buf != nullptr);
 			if (i->used_size > bytes)
@@ -41,13 +41,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #if defined _MSC_VER && TORRENT_HAS_SSE
 #include <intrin.h>
 #include <nmmintrin.h>
+#include <immintrin.h>
 #endif
 
 #if TORRENT_HAS_SSE && defined __GNUC__
 #include <cpuid.h>
-#else
-#include <cstring> // for std::memset
 #endif
+#include <cstring> // for std::memset
 
 #if defined __GLIBC__ && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 16))
 #define TORRENT_HAS_AUXV 1
@@ -93,6 +93,42 @@ namespace {
 		TORRENT_UNUSED(type);
 		// for non-x86 and non-amd64, just return zeroes
 		std::memset(&info[0], 0, sizeof(std::uint32_t) * 4);
+#endif
+	}
+
+	// internal
+	// like cpuid(), but for leaves that take a sub-leaf in ecx
+	void cpuid_count(std::uint32_t* info, int type, int sub) noexcept
+	{
+#if defined _MSC_VER
+		__cpuidex(reinterpret_cast<int*>(info), type, sub);
+
+#elif defined __GNUC__
+		std::memset(&info[0], 0, sizeof(std::uint32_t) * 4);
+		if (__get_cpuid_max(0, nullptr) < std::uint32_t(type)) return;
+		__cpuid_count(std::uint32_t(type), std::uint32_t(sub)
+			, info[0], info[1], info[2], info[3]);
+#else
+		TORRENT_UNUSED(type);
+		TORRENT_UNUSED(sub);
+		std::memset(&info[0], 0, sizeof(std::uint32_t) * 4);
+#endif
+	}
+
+	// internal
+	// returns the XCR0 register, indicating which register sets the OS
+	// saves and restores on context switches
+	std::uint64_t xgetbv0() noexcept
+	{
+#if defined _MSC_VER
+		return _xgetbv(0);
+#elif defined __GNUC__
+		std::uint32_t eax = 0;
+		std::uint32_t edx = 0;
+		__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (std::uint64_t(edx) << 32) | eax;
+#else
+		return 0;
 #endif
 	}
 #endif
@@ -119,6 +155,23 @@ namespace {
 #endif
 	}
 
+	bool supports_avx2() noexcept
+	{
+#if TORRENT_HAS_SSE
+		std::uint32_t cpui[4] = {0};
+		cpuid(cpui, 1);
+		// OSXSAVE and AVX
+		if ((cpui[2] & (1 << 27)) == 0 || (cpui[2] & (1 << 28)) == 0)
+			return false;
+		// the OS has to preserve the XMM and YMM registers
+		if ((xgetbv0() & 0x6) != 0x6) return false;
+		cpuid_count(cpui, 7, 0);
+		return (cpui[1] & (1 << 5)) != 0;
+#else
+		return false;
+#endif
+	}
+
 	bool supports_arm_neon() noexcept
 	{
 #if TORRENT_HAS_ARM_NEON && TORRENT_HAS_AUXV
@@ -157,6 +210,7 @@ namespace {
 
 	bool const sse42_support = supports_sse42();
 	bool const mmx_support = supports_mmx();
+	bool const avx2_support = supports_avx2();
 	bool const arm_neon_support = supports_arm_neon();
 	bool const arm_crc32c_support = supports_arm_crc32c();
 } }
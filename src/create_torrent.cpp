@@ -46,6 +46,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/session_settings.hpp"
 #include "libtorrent/session.hpp" // for default_disk_io_constructor
 #include "libtorrent/aux_/directory.hpp"
+#include "libtorrent/aux_/piece_hash_pipeline.hpp"
 #include "libtorrent/disk_interface.hpp"
 
 #include <sys/types.h>
@@ -53,6 +54,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <functional>
 #include <memory>
+#include <thread>
 
 using namespace std::placeholders;
 
@@ -327,6 +329,45 @@ namespace {
 	private:
 		disk_interface& m_dio;
 	};
+
+	// reads the files sequentially on this thread and hashes the pieces on
+	// hashing_threads threads, bypassing the disk I/O subsystem
+	void hash_pieces_sequential(create_torrent& t, std::string const& p
+		, settings_interface const& sett
+		, std::function<void(piece_index_t)> const& f, error_code& ec
+		, std::atomic<bool> const* cancel)
+	{
+#if TORRENT_USE_UNC_PATHS
+		std::string const path = canonicalize_path(p);
+#else
+		std::string const& path = p;
+#endif
+
+		if (t.files().num_files() == 0)
+		{
+			ec = errors::no_files_in_torrent;
+			return;
+		}
+
+		if (t.files().total_size() == 0)
+		{
+			ec = errors::torrent_invalid_length;
+			return;
+		}
+
+		int const num_threads = std::max(1, sett.get_int(settings_pack::hashing_threads));
+		std::int64_t const readahead = std::int64_t(
+			sett.get_int(settings_pack::create_torrent_readahead)) * 1024 * 1024;
+
+		piece_index_t completed(0);
+		aux::hash_pieces(t.files(), path, num_threads, readahead
+			, [&](piece_index_t const piece, sha1_hash const& h)
+			{
+				t.set_hash(piece, h);
+				f(completed);
+				++completed;
+			}, cancel, ec);
+	}
 }
 
 	void set_piece_hashes(create_torrent& t, std::string const& p
@@ -340,7 +381,7 @@ namespace {
 		, settings_interface const& sett
 		, std::function<void(piece_index_t)> const& f, error_code& ec)
 	{
-		set_piece_hashes(t, p, sett, default_disk_io_constructor, f, ec);
+		hash_pieces_sequential(t, p, sett, f, ec, nullptr);
 	}
 
 
@@ -352,7 +393,10 @@ namespace {
 	{
 								// printf("line before aux::session_settings sett in set_piece_hashes_for_gtk \n");
 		aux::session_settings sett;
-		set_piece_hashes_for_gtk(t, p, sett, default_disk_io_constructor, f, ec, cancel_flag);
+		// creating a torrent is CPU bound, use every core
+		sett.set_int(settings_pack::hashing_threads
+			, std::max(1, int(std::thread::hardware_concurrency())));
+		hash_pieces_sequential(t, p, sett, f, ec, cancel_flag.get());
 	}
 
 
@@ -39,6 +39,23 @@ constexpr disk_job_flags_t disk_interface::force_copy;
 constexpr disk_job_flags_t disk_interface::sequential_access;
 constexpr disk_job_flags_t disk_interface::volatile_read;
 constexpr disk_job_flags_t disk_interface::v1_hash;
+constexpr disk_job_flags_t disk_interface::stream_read;
 constexpr disk_job_flags_t disk_interface::flush_piece;
 
+disk_buffer_holder disk_interface::allocate_write_buffer(bool& exceeded
+	, std::shared_ptr<disk_observer>)
+{
+	exceeded = false;
+	return disk_buffer_holder();
+}
+
+bool disk_interface::async_write_buffer(storage_index_t const storage
+	, peer_request const& r, disk_buffer_holder buf
+	, std::shared_ptr<disk_observer> o
+	, std::function<void(storage_error const&)> handler
+	, disk_job_flags_t const flags)
+{
+	return async_write(storage, r, buf.data(), std::move(o), std::move(handler), flags);
+}
+
 }
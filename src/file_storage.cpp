@@ -49,6 +49,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/disable_warnings_pop.hpp"
 
 #include <cstdio>
+#include <cstring>
 #include <cinttypes>
 #include <algorithm>
 #include <functional>
@@ -92,6 +93,7 @@ namespace libtorrent {
 	void file_storage::reserve(int num_files)
 	{
 		m_files.reserve(num_files);
+		m_offset_index.reserve(std::size_t(num_files / offset_index_stride + 1));
 	}
 
 	int file_storage::piece_size(piece_index_t const index) const
@@ -121,6 +123,19 @@ namespace {
 		return lhs.offset < rhs.offset;
 	}
 
+	// FNV-1a
+	std::uint32_t path_hash(string_view const path)
+	{
+		std::uint32_t ret = 2166136261u;
+		for (char const c : path)
+		{
+			ret ^= std::uint8_t(c);
+			ret *= 16777619u;
+		}
+		return ret;
+	}
+
+	int const name_chunk_size = 64 * 1024;
 }
 
 	// int file_storage::piece_size2(piece_index_t const index) const
@@ -164,7 +179,7 @@ namespace {
 		if (is_complete(path))
 		{
 			TORRENT_ASSERT(set_name);
-			e.set_name(path);
+			set_owned_name(e, path);
 			e.path_index = aux::file_entry::path_is_absolute;
 			return;
 		}
@@ -179,7 +194,7 @@ namespace {
 
 		if (branch_path.empty())
 		{
-			if (set_name) e.set_name(leaf);
+			if (set_name) set_owned_name(e, leaf);
 			e.path_index = aux::file_entry::no_path;
 			return;
 		}
@@ -204,28 +219,73 @@ namespace {
 		}
 
 		e.path_index = get_or_add_path(branch_path);
-		if (set_name) e.set_name(leaf);
+		if (set_name) set_owned_name(e, leaf);
 	}
 
 	aux::path_index_t file_storage::get_or_add_path(string_view const path)
 	{
+		// files are typically added one directory at a time
+		if (!m_paths.empty() && m_paths.back() == path)
+			return prev(m_paths.end_index());
+
+		// keep the table at most half full
+		if ((m_paths.size() + 1) * 2 > m_path_table.size())
+			rehash_paths(std::max(std::size_t(16), m_path_table.size() * 2));
+
 		// do we already have this path in the path list?
-		auto const p = std::find(m_paths.rbegin(), m_paths.rend(), path);
+		std::size_t const mask = m_path_table.size() - 1;
+		std::size_t slot = path_hash(path) & mask;
+		for (; m_path_table[slot] != 0; slot = (slot + 1) & mask)
+		{
+			aux::path_index_t const idx{m_path_table[slot] - 1};
+			// yes we do. use it
+			if (m_paths[idx] == path) return idx;
+		}
 
-		if (p == m_paths.rend())
+		// no, we don't. add it
+		auto const ret = m_paths.end_index();
+		TORRENT_ASSERT(path.size() == 0 || path[0] != '/');
+		m_paths.emplace_back(path.data(), path.size());
+		m_path_table[slot] = static_cast<std::uint32_t>(ret) + 1;
+		return ret;
+	}
+
+	void file_storage::rehash_paths(std::size_t const size)
+	{
+		TORRENT_ASSERT((size & (size - 1)) == 0);
+		m_path_table.assign(size, 0);
+		std::size_t const mask = size - 1;
+		for (auto const i : m_paths.range())
 		{
-			// no, we don't. add it
-			auto const ret = m_paths.end_index();
-			TORRENT_ASSERT(path.size() == 0 || path[0] != '/');
-			m_paths.emplace_back(path.data(), path.size());
-			return ret;
+			std::size_t slot = path_hash(m_paths[i]) & mask;
+			while (m_path_table[slot] != 0) slot = (slot + 1) & mask;
+			m_path_table[slot] = static_cast<std::uint32_t>(i) + 1;
 		}
-		else
+	}
+
+	void file_storage::set_owned_name(aux::file_entry& e, string_view const n)
+	{
+		if (n.empty())
 		{
-			// yes we do. use it
-			return aux::path_index_t{aux::numeric_cast<std::uint32_t>(
-				p.base() - m_paths.begin() - 1)};
+			e.set_name(n);
+			return;
+		}
+
+		int const size = int(n.size()) + 1;
+		if (m_name_chunks.empty()
+			|| m_name_chunks.back().use_count() > 1
+			|| m_name_chunk_used + size > std::max(name_chunk_size, size))
+		{
+			m_name_chunks.emplace_back(new char[std::size_t(std::max(name_chunk_size, size))]
+				, std::default_delete<char[]>());
+			m_name_chunk_used = 0;
 		}
+
+		char* const ret = m_name_chunks.back().get() + m_name_chunk_used;
+		std::memcpy(ret, n.data(), n.size());
+		ret[n.size()] = '\0';
+		m_name_chunk_used += size;
+		e.set_pooled_name(ret);
 	}
 
 #if TORRENT_ABI_VERSION == 1
@@ -270,6 +330,11 @@ namespace aux {
 		// , root(fe.root)
 		, path_index(fe.path_index)
 	{
+		if (fe.name_len == name_is_pooled)
+		{
+			set_pooled_name(fe.name);
+			return;
+		}
 		bool const borrow = fe.name_len != name_is_owned;
 		set_name(fe.filename(), borrow);
 	}
@@ -289,7 +354,12 @@ namespace aux {
 		// root = fe.root;
 
 		// if the name is not owned, don't allocate memory, we can point into the
-		// same metadata buffer
+		// same metadata buffer or name pool
+		if (fe.name_len == name_is_pooled)
+		{
+			set_pooled_name(fe.name);
+			return *this;
+		}
 		bool const borrow = fe.name_len != name_is_owned;
 		set_name(fe.filename(), borrow);
 
@@ -355,7 +425,7 @@ namespace aux {
 		{
 			// we have limited space in the length field. truncate string
 			// if it's too long
-			if (n.size() >= name_is_owned) n = n.substr(name_is_owned - 1);
+			if (n.size() >= name_is_pooled) n = n.substr(0, name_is_pooled - 1);
 
 			name = n.data();
 			name_len = aux::numeric_cast<std::uint64_t>(n.size());
@@ -367,9 +437,17 @@ namespace aux {
 		}
 	}
 
+	void file_entry::set_pooled_name(char const* n)
+	{
+		if (name_len == name_is_owned) delete[] name;
+		name = n;
+		name_len = name_is_pooled;
+	}
+
 	string_view file_entry::filename() const
 	{
-		if (name_len != name_is_owned) return {name, std::size_t(name_len)};
+		if (name_len != name_is_owned && name_len != name_is_pooled)
+			return {name, std::size_t(name_len)};
 		return name ? string_view(name) : string_view();
 	}
 
@@ -409,18 +487,8 @@ namespace aux {
 #if TORRENT_ABI_VERSION == 1
 	file_storage::iterator file_storage::file_at_offset_deprecated(std::int64_t offset) const
 	{
-		// find the file iterator and file offset
-		aux::file_entry target;
 		TORRENT_ASSERT(offset <= max_file_offset);
-		target.offset = aux::numeric_cast<std::uint64_t>(offset);
-		TORRENT_ASSERT(!compare_file_offset(target, m_files.front()));
-
-		auto file_iter = std::upper_bound(
-			begin_deprecated(), end_deprecated(), target, compare_file_offset);
-
-		TORRENT_ASSERT(file_iter != begin_deprecated());
-		--file_iter;
-		return file_iter;
+		return begin_deprecated() + static_cast<int>(lookup_file(offset));
 	}
 
 	file_storage::iterator file_storage::file_at_offset(std::int64_t offset) const
@@ -434,13 +502,28 @@ namespace aux {
 		TORRENT_ASSERT_PRECOND(offset >= 0);
 		TORRENT_ASSERT_PRECOND(offset < m_total_size);
 		TORRENT_ASSERT(offset <= max_file_offset);
-		// find the file iterator and file offset
+		return lookup_file(offset);
+	}
+
+	file_index_t file_storage::lookup_file(std::int64_t const offset) const
+	{
+		TORRENT_ASSERT(!m_files.empty());
+		TORRENT_ASSERT(m_offset_index.size()
+			== std::size_t((m_files.size() + offset_index_stride - 1) / offset_index_stride));
+
+		// first find the stride the file is in, then the file within it
+		auto const stride = std::upper_bound(m_offset_index.begin()
+			, m_offset_index.end(), offset);
+		TORRENT_ASSERT(stride != m_offset_index.begin());
+		int const first = int(stride - m_offset_index.begin() - 1) * offset_index_stride;
+		int const last = std::min(first + offset_index_stride, int(m_files.size()));
+
 		aux::file_entry target;
 		target.offset = aux::numeric_cast<std::uint64_t>(offset);
 		TORRENT_ASSERT(!compare_file_offset(target, m_files.front()));
 
-		auto file_iter = std::upper_bound(
-			m_files.begin(), m_files.end(), target, compare_file_offset);
+		auto file_iter = std::upper_bound(m_files.begin() + first
+			, m_files.begin() + last, target, compare_file_offset);
 
 		TORRENT_ASSERT(file_iter != m_files.begin());
 		--file_iter;
@@ -475,7 +558,8 @@ namespace aux {
 
 	int file_storage::file_name_len(file_index_t const index) const
 	{
-		if (m_files[index].name_len == aux::file_entry::name_is_owned)
+		if (m_files[index].name_len == aux::file_entry::name_is_owned
+			|| m_files[index].name_len == aux::file_entry::name_is_pooled)
 			return -1;
 		return m_files[index].name_len;
 	}
@@ -503,11 +587,8 @@ namespace aux {
 		if (std::int64_t(target.offset) > m_total_size - size)
 			size = m_total_size - std::int64_t(target.offset);
 
-		auto file_iter = std::upper_bound(
-			m_files.begin(), m_files.end(), target, compare_file_offset);
-
-		TORRENT_ASSERT(file_iter != m_files.begin());
-		--file_iter;
+		auto file_iter = m_files.begin()
+			+ static_cast<int>(lookup_file(std::int64_t(target.offset)));
 
 		std::int64_t file_offset = target.offset - file_iter->offset;
 		for (; size > 0; file_offset -= file_iter->size, ++file_iter)
@@ -734,6 +815,8 @@ namespace aux {
 
 		e.size = aux::numeric_cast<std::uint64_t>(file_size);
 		e.offset = aux::numeric_cast<std::uint64_t>(m_total_size);
+		if (static_cast<int>(last_file()) % offset_index_stride == 0)
+			m_offset_index.push_back(m_total_size);
 		// e.pad_file = bool(file_flags & file_storage::flag_pad_file);
 		e.hidden_attribute = bool(file_flags & file_storage::flag_hidden);
 		e.executable_attribute = bool(file_flags & file_storage::flag_executable);
@@ -1203,6 +1286,22 @@ namespace {
 	{ return at_deprecated(int(i - m_files.begin())); }
 #endif // TORRENT_ABI_VERSION
 
+	std::size_t file_storage::memory_usage() const
+	{
+		std::size_t ret = m_files.capacity() * sizeof(aux::file_entry)
+			+ m_file_hashes.capacity() * sizeof(char const*)
+			+ m_mtime.capacity() * sizeof(std::time_t)
+			+ m_paths.capacity() * sizeof(std::string)
+			+ m_path_table.capacity() * sizeof(std::uint32_t)
+			+ m_offset_index.capacity() * sizeof(std::int64_t)
+			+ m_name_chunks.capacity() * sizeof(std::shared_ptr<char>)
+			+ m_name_chunks.size() * std::size_t(name_chunk_size);
+		for (auto const& p : m_paths)
+			if (p.capacity() >= sizeof(std::string)) ret += p.capacity() + 1;
+		if (m_name.capacity() >= sizeof(std::string)) ret += m_name.capacity() + 1;
+		return ret;
+	}
+
 	void file_storage::swap(file_storage& ti) noexcept
 	{
 		using std::swap;
@@ -1211,6 +1310,10 @@ namespace {
 		// swap(ti.m_symlinks, m_symlinks);
 		swap(ti.m_mtime, m_mtime);
 		swap(ti.m_paths, m_paths);
+		swap(ti.m_path_table, m_path_table);
+		swap(ti.m_offset_index, m_offset_index);
+		swap(ti.m_name_chunks, m_name_chunks);
+		swap(ti.m_name_chunk_used, m_name_chunk_used);
 		swap(ti.m_name, m_name);
 		swap(ti.m_total_size, m_total_size);
 		swap(ti.m_num_pieces, m_num_pieces);
@@ -174,7 +174,8 @@ void http_connection::get(std::string const& url, time_duration timeout
 
 
 
-	request << "Connection: close\r\n\r\n";
+	request << (m_keep_alive ? "Connection: keep-alive\r\n\r\n"
+		: "Connection: close\r\n\r\n");
 
 	m_sendbuffer.assign(request.str());
 	m_url = url;
@@ -206,10 +207,28 @@ void http_connection::start(std::string const& hostname, int port
 	m_parser.reset();
 	m_recvbuffer.clear();
 	m_read_pos = 0;
+	m_served_reused = false;
 
-	if (m_sock && m_sock->is_open() && m_hostname == hostname && m_port == port
-		&& m_ssl == ssl && m_bind_addr == bind_addr)
+	bool reuse = m_sock && m_sock->is_open() && m_hostname == hostname
+		&& m_port == port && m_ssl == ssl && m_bind_addr == bind_addr;
+
+	if (reuse && m_filter_handler)
+	{
+		// the endpoint we're connected to still has to pass the new
+		// owner's filter
+		error_code ec;
+		std::vector<tcp::endpoint> eps{m_sock->remote_endpoint(ec)};
+		if (!ec) m_filter_handler(*this, eps);
+		reuse = !ec && !eps.empty();
+		if (m_abort) return;
+	}
+
+	m_reused = reuse;
+	if (reuse)
 	{
+		m_start_time = clock_type::now();
+		m_last_receive = m_start_time;
+		if (m_connect_handler) m_connect_handler(*this);
 		ADD_OUTSTANDING_ASYNC("http_connection::on_write");
 		async_write(*m_sock, boost::asio::buffer(m_sendbuffer)
 			, std::bind(&http_connection::on_write, me, _1));
@@ -354,6 +373,41 @@ void http_connection::close(bool force)
 
 
 
+bool http_connection::reusable() const
+{
+	return m_keep_alive && !m_abort && m_bottled && m_called
+		&& m_sock && m_sock->is_open()
+		&& m_parser.finished()
+		&& m_parser.protocol() == "HTTP/1.1"
+		&& !m_parser.connection_close();
+}
+
+void http_connection::rebind(http_handler handler
+	, http_connect_handler ch
+	, http_filter_handler fh
+	, hostname_filter_handler hfh)
+{
+	m_handler = std::move(handler);
+	m_connect_handler = std::move(ch);
+	m_filter_handler = std::move(fh);
+	m_hostname_filter_handler = std::move(hfh);
+}
+
+bool http_connection::reconnect_stale()
+{
+	if (!m_reused || m_read_pos > 0 || m_abort) return false;
+	m_reused = false;
+
+	error_code ec;
+	m_sock->close(ec);
+
+	std::string const hostname = m_hostname;
+	boost::optional<bind_info_t> const bind_addr = m_bind_addr;
+	start(hostname, m_port, m_completion_timeout, m_ssl, m_redirects
+		, bind_addr, m_resolve_flags);
+	return true;
+}
+
 void http_connection::on_resolve(error_code const& e
 	, std::vector<address> const& addresses)
 {
@@ -495,13 +549,16 @@ void http_connection::on_write(error_code const& e)
 
 	if (e)
 	{
+		if (reconnect_stale()) return;
 		callback(e);
 		return;
 	}
 
 	if (m_abort) return;
 
-	std::string().swap(m_sendbuffer);
+	// a reused connection keeps the request around until the response
+	// starts, in case it has to be sent again on a new connection
+	if (!m_reused) std::string().swap(m_sendbuffer);
 	m_recvbuffer.resize(4096);
 
 	int amount_to_read = int(m_recvbuffer.size()) - m_read_pos;
@@ -544,6 +601,15 @@ void http_connection::on_read(error_code const& e
 	// deletes this object
 	std::shared_ptr<http_connection> me(shared_from_this());
 
+	if (e && reconnect_stale()) return;
+
+	if (m_reused)
+	{
+		m_reused = false;
+		m_served_reused = true;
+		std::string().swap(m_sendbuffer);
+	}
+
 	// when using the asio SSL wrapper, it seems like
 	// we get the shut_down error instead of EOF
 	if (e == boost::asio::error::eof || e == boost::asio::error::shut_down)
@@ -633,6 +699,10 @@ void http_connection::on_read(error_code const& e
 			callback(e, span<char>(m_recvbuffer)
 				.first(m_read_pos)
 				.subspan(m_parser.body_start()));
+
+			// the socket now belongs to the next request, don't read
+			// past the end of this response
+			if (m_keep_alive) return;
 		}
 	}
 	else
@@ -728,4 +798,84 @@ void http_connection::rate_limit(int limit)
 	m_rate_limit = limit;
 }
 
+http_connection_pool::~http_connection_pool()
+{
+	close();
+}
+
+std::shared_ptr<http_connection> http_connection_pool::acquire(
+	std::string const& url
+	, boost::optional<bind_info_t> const& bind_addr
+	, time_duration const idle_timeout)
+{
+	expire(idle_timeout);
+
+	std::string protocol;
+	std::string hostname;
+	int port;
+	error_code ec;
+	std::tie(protocol, std::ignore, hostname, port, std::ignore)
+		= parse_url_components(url, ec);
+	if (ec) return {};
+	if (port == -1) port = protocol == "https" ? 443 : 80;
+
+	// prefer the most recently used connection, it's the least likely
+	// to have been closed by the server
+	for (auto i = m_idle.rbegin(); i != m_idle.rend(); ++i)
+	{
+		http_connection const& c = *i->conn;
+		if (c.hostname() != hostname || c.port() != port
+			|| !(c.bind_addr() == bind_addr))
+			continue;
+
+		std::shared_ptr<http_connection> ret = std::move(i->conn);
+		m_idle.erase(std::next(i).base());
+		return ret;
+	}
+	return {};
+}
+
+void http_connection_pool::release(std::shared_ptr<http_connection> c
+	, int const max_idle)
+{
+	// the handlers refer back to the previous owner
+	c->rebind(nullptr, nullptr, nullptr, nullptr);
+
+	int const same_host = c->reusable()
+		? int(std::count_if(m_idle.begin(), m_idle.end()
+			, [&c](idle_connection const& i)
+			{
+				return i.conn->hostname() == c->hostname()
+					&& i.conn->port() == c->port()
+					&& i.conn->bind_addr() == c->bind_addr();
+			}))
+		: max_idle;
+
+	if (same_host >= max_idle)
+	{
+		c->close();
+		return;
+	}
+	m_idle.push_back({std::move(c), aux::time_now()});
+}
+
+void http_connection_pool::close()
+{
+	for (auto& i : m_idle) i.conn->close(true);
+	m_idle.clear();
+}
+
+void http_connection_pool::expire(time_duration const idle_timeout)
+{
+	time_point const now = aux::time_now();
+	auto const new_end = std::remove_if(m_idle.begin(), m_idle.end()
+		, [&](idle_connection const& i)
+		{
+			if (now - i.since < idle_timeout) return false;
+			i.conn->close();
+			return true;
+		});
+	m_idle.erase(new_end, m_idle.end());
+}
+
 }
@@ -201,15 +201,37 @@ namespace libtorrent {
 			return;
 		}
 
+		auto const ls = bind_socket();
+		bind_info_t bi = [&ls](){
+			if (ls.get() == nullptr)
+				return bind_info_t{};
+			else
+				return bind_info_t{ls.device(), ls.get_local_endpoint().address()};
+		}();
+
 		using namespace std::placeholders;
-		m_tracker_connection = std::make_shared<http_connection>(m_ioc, m_man.host_resolver()
-			, std::bind(&http_tracker_connection::on_response, shared_from_this(), _1, _2, _3)
-			, true, settings.get_int(settings_pack::max_http_recv_buffer_size)
-			, std::bind(&http_tracker_connection::on_connect, shared_from_this(), _1)
-			, std::bind(&http_tracker_connection::on_filter, shared_from_this(), _1, _2)
-			, std::bind(&http_tracker_connection::on_filter_hostname, shared_from_this(), _1, _2)
+		m_tracker_connection = m_man.acquire_http_connection(url, bi);
+		if (m_tracker_connection)
+		{
+			m_tracker_connection->rebind(
+				std::bind(&http_tracker_connection::on_response, shared_from_this(), _1, _2, _3)
+				, std::bind(&http_tracker_connection::on_connect, shared_from_this(), _1)
+				, std::bind(&http_tracker_connection::on_filter, shared_from_this(), _1, _2)
+				, std::bind(&http_tracker_connection::on_filter_hostname, shared_from_this(), _1, _2));
+		}
+		else
+		{
+			m_tracker_connection = std::make_shared<http_connection>(m_ioc, m_man.host_resolver()
+				, std::bind(&http_tracker_connection::on_response, shared_from_this(), _1, _2, _3)
+				, true, settings.get_int(settings_pack::max_http_recv_buffer_size)
+				, std::bind(&http_tracker_connection::on_connect, shared_from_this(), _1)
+				, std::bind(&http_tracker_connection::on_filter, shared_from_this(), _1, _2)
+				, std::bind(&http_tracker_connection::on_filter_hostname, shared_from_this(), _1, _2)
 
-			);
+				);
+			m_tracker_connection->keep_alive(
+				settings.get_int(settings_pack::tracker_http_pool_max_idle) > 0);
+		}
 
 		int const timeout = tracker_req().event == event_t::stopped
 			? settings.get_int(settings_pack::stop_tracker_timeout)
@@ -224,14 +246,6 @@ namespace libtorrent {
 			? "curl/7.81.0"
 			: settings.get_str(settings_pack::user_agent);
 
-		auto const ls = bind_socket();
-		bind_info_t bi = [&ls](){
-			if (ls.get() == nullptr)
-				return bind_info_t{};
-			else
-				return bind_info_t{ls.device(), ls.get_local_endpoint().address()};
-		}();
-
 		// when sending stopped requests, prefer the cached DNS entry
 		// to avoid being blocked for slow or failing responses. Chances
 		// are that we're shutting down, and this should be a best-effort
@@ -259,7 +273,9 @@ namespace libtorrent {
 	{
 		if (m_tracker_connection)
 		{
-			m_tracker_connection->close();
+			// the connection goes back to the pool if the response left
+			// it reusable, otherwise the pool closes it
+			m_man.release_http_connection(std::move(m_tracker_connection));
 			m_tracker_connection.reset();
 		}
 		cancel();
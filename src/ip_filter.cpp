@@ -32,9 +32,14 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <iterator> // for next
+#include <algorithm>
+#include <queue>
+#include <array>
+#include <cstring>
 
 #include "libtorrent/ip_filter.hpp"
 #include "libtorrent/assert.hpp"
+#include "libtorrent/aux_/byteswap.hpp"
 
 namespace libtorrent {
 
@@ -63,6 +68,27 @@ namespace libtorrent {
 			TORRENT_ASSERT_FAIL();
 	}
 
+	void ip_filter::add_rules(std::vector<ip_range<address_v4>> const& v4
+		, std::vector<ip_range<address_v6>> const& v6)
+	{
+		if (!v4.empty())
+		{
+			std::vector<ip_range<address_v4::bytes_type>> rules;
+			rules.reserve(v4.size());
+			for (auto const& r : v4)
+				rules.push_back({r.first.to_bytes(), r.last.to_bytes(), r.flags});
+			m_filter4.add_rules(rules);
+		}
+		if (!v6.empty())
+		{
+			std::vector<ip_range<address_v6::bytes_type>> rules;
+			rules.reserve(v6.size());
+			for (auto const& r : v6)
+				rules.push_back({r.first.to_bytes(), r.last.to_bytes(), r.flags});
+			m_filter6.add_rules(rules);
+		}
+	}
+
 	std::uint32_t ip_filter::access(address const& addr) const
 	{
 		if (addr.is_v4())
@@ -162,18 +188,46 @@ namespace aux {
 	template EXPORT_INST address_v4::bytes_type max_addr<address_v4::bytes_type>();
 	template EXPORT_INST address_v6::bytes_type max_addr<address_v6::bytes_type>();
 
+	namespace {
+
+	// addresses are stored in network byte order, so comparing them is a
+	// lexicographical compare of the bytes. This does it four bytes at a
+	// time rather than the byte-wise memcmp() std::array's operator< ends
+	// up in
+	template <std::size_t N>
+	bool addr_less(std::array<std::uint8_t, N> const& lhs
+		, std::array<std::uint8_t, N> const& rhs)
+	{
+		static_assert(N % 4 == 0, "addresses are compared 32 bits at a time");
+		for (std::size_t i = 0; i < N; i += 4)
+		{
+			std::uint32_t l;
+			std::uint32_t r;
+			std::memcpy(&l, lhs.data() + i, 4);
+			std::memcpy(&r, rhs.data() + i, 4);
+			if (l != r) return network_to_host(l) < network_to_host(r);
+		}
+		return false;
+	}
+
+	bool addr_less(std::uint16_t const lhs, std::uint16_t const rhs)
+	{ return lhs < rhs; }
+
+	}
+
 	template <typename Addr>
 	filter_impl<Addr>::filter_impl()
 	{
 		// make the entire ip-range non-blocked
-		m_access_list.insert(range(zero<Addr>(), 0));
+		m_access_list.emplace_back(zero<Addr>(), 0);
+		m_index.push_back(zero<Addr>());
 	}
 
 	template <typename Addr>
 	bool filter_impl<Addr>::empty() const
 	{
 		return m_access_list.empty()
-			|| (m_access_list.size() == 1 && *m_access_list.begin() == range(zero<Addr>(), 0));
+			|| (m_access_list.size() == 1 && m_access_list.front() == range(zero<Addr>(), 0));
 	}
 
 	template <typename Addr>
@@ -182,70 +236,183 @@ namespace aux {
 		TORRENT_ASSERT(!m_access_list.empty());
 		TORRENT_ASSERT(first < last || first == last);
 
-		auto i = m_access_list.upper_bound(first);
-		auto j = m_access_list.upper_bound(last);
-
-		if (i != m_access_list.begin()) --i;
+		auto const after = [](Addr const& a, range const& r) { return addr_less(a, r.start); };
 
+		// i is the range containing first, j is the first range starting
+		// after last
+		auto const i = std::prev(std::upper_bound(m_access_list.begin()
+			, m_access_list.end(), first, after));
+		auto j = std::upper_bound(m_access_list.begin(), m_access_list.end()
+			, last, after);
 		TORRENT_ASSERT(j != m_access_list.begin());
-		TORRENT_ASSERT(j != i);
 
-		std::uint32_t first_access = i->access;
-		std::uint32_t last_access = std::prev(j)->access;
+		std::uint32_t const last_access = std::prev(j)->access;
+
+		// every range starting in [first, last] is replaced by (at most) the
+		// new rule and the tail of the range that contained last
+		auto const s = i->start == first ? i : std::next(i);
 
-		if (i->start != first && first_access != flags)
+		std::array<range, 2> ins;
+		std::size_t num_ins = 0;
+		if (s == m_access_list.begin() || std::prev(s)->access != flags)
+			ins[num_ins++] = range(first, flags);
+
+		if (last != max_addr<Addr>())
 		{
-			i = m_access_list.insert(i, range(first, flags));
+			Addr const next = plus_one(last);
+			if (j == m_access_list.end() || j->start != next)
+			{
+				if (last_access != flags)
+					ins[num_ins++] = range(next, last_access);
+			}
+			else if (j->access == flags)
+			{
+				// the range following the new rule has the same access, merge
+				// them
+				++j;
+			}
+		}
+
+		std::size_t const pos = std::size_t(s - m_access_list.begin());
+		std::size_t const num_erase = std::size_t(j - s);
+		std::size_t const common = std::min(num_erase, num_ins);
+		std::copy(ins.begin(), ins.begin() + common, m_access_list.begin() + pos);
+		if (num_erase > common)
+		{
+			m_access_list.erase(m_access_list.begin() + pos + common
+				, m_access_list.begin() + pos + num_erase);
 		}
-		else if (i != m_access_list.begin() && std::prev(i)->access == flags)
+		else
 		{
-			--i;
-			first_access = i->access;
+			m_access_list.insert(m_access_list.begin() + pos + common
+				, ins.begin() + common, ins.begin() + num_ins);
 		}
 		TORRENT_ASSERT(!m_access_list.empty());
-		TORRENT_ASSERT(i != m_access_list.end());
+		TORRENT_ASSERT(m_access_list.front().start == zero<Addr>());
 
-		if (i != j) m_access_list.erase(std::next(i), j);
-		if (i->start == first)
+		update_index(pos);
+	}
+
+	template <typename Addr>
+	void filter_impl<Addr>::add_rules(std::vector<ip_range<Addr>> const& rules)
+	{
+		TORRENT_ASSERT(!m_access_list.empty());
+
+		// every rule turns into an event where it starts and one just past
+		// its last address. Sweeping over them in address order, the access
+		// at any address is the one of the latest rule that has started
+		// but not ended, or the existing filter's if there is none
+		struct event
 		{
-			// This is an optimization over erasing and inserting a new element
-			// here.
-			// this const-cast is OK because we know that the new
-			// start address will keep the set correctly ordered
-			const_cast<Addr&>(i->start) = first;
-			const_cast<std::uint32_t&>(i->access) = flags;
-		}
-		else if (first_access != flags)
+			Addr addr;
+			// the index of the rule in rules
+			int rule;
+			bool start;
+		};
+
+		std::vector<event> events;
+		events.reserve(rules.size() * 2);
+		for (int i = 0; i < int(rules.size()); ++i)
 		{
-			m_access_list.insert(i, range(first, flags));
+			auto const& r = rules[std::size_t(i)];
+			TORRENT_ASSERT(r.first < r.last || r.first == r.last);
+			if (r.last < r.first) continue;
+			events.push_back({r.first, i, true});
+			if (r.last != max_addr<Addr>())
+				events.push_back({plus_one(r.last), i, false});
 		}
+		if (events.empty()) return;
 
-		if ((j != m_access_list.end()
-				&& minus_one(j->start) != last)
-			|| (j == m_access_list.end()
-				&& last != max_addr<Addr>()))
+		// rules exported from another filter, or read from a sorted block
+		// list, are already in order
+		auto const by_addr = [](event const& lhs, event const& rhs)
+		{ return addr_less(lhs.addr, rhs.addr); };
+		if (!std::is_sorted(events.begin(), events.end(), by_addr))
+			std::sort(events.begin(), events.end(), by_addr);
+
+		std::priority_queue<int> active;
+		std::vector<bool> ended(rules.size(), false);
+
+		std::vector<range> ret;
+		ret.reserve(m_access_list.size() + events.size());
+
+		auto base = m_access_list.begin();
+		std::uint32_t base_access = 0;
+		auto e = events.begin();
+		while (e != events.end() || base != m_access_list.end())
 		{
-			TORRENT_ASSERT(j == m_access_list.end() || last < minus_one(j->start));
-			if (last_access != flags)
-				j = m_access_list.insert(j, range(plus_one(last), last_access));
+			Addr const addr = (base == m_access_list.end()
+				|| (e != events.end() && e->addr < base->start))
+				? e->addr : base->start;
+
+			if (base != m_access_list.end() && base->start == addr)
+			{
+				base_access = base->access;
+				++base;
+			}
+
+			for (; e != events.end() && e->addr == addr; ++e)
+			{
+				if (e->start) active.push(e->rule);
+				else ended[std::size_t(e->rule)] = true;
+			}
+			while (!active.empty() && ended[std::size_t(active.top())])
+				active.pop();
+
+			std::uint32_t const a = active.empty() ? base_access
+				: rules[std::size_t(active.top())].flags;
+			if (ret.empty() || ret.back().access != a)
+				ret.emplace_back(addr, a);
 		}
 
-		if (j != m_access_list.end() && j->access == flags) m_access_list.erase(j);
-		TORRENT_ASSERT(!m_access_list.empty());
+		TORRENT_ASSERT(!ret.empty());
+		TORRENT_ASSERT(ret.front().start == zero<Addr>());
+		ret.shrink_to_fit();
+		m_access_list = std::move(ret);
+		m_index.clear();
+		update_index(0);
+		m_index.shrink_to_fit();
+	}
+
+	template <typename Addr>
+	void filter_impl<Addr>::update_index(std::size_t const first)
+	{
+		std::size_t const size = (m_access_list.size() + index_stride - 1) / index_stride;
+		m_index.resize(size);
+		for (std::size_t i = first / index_stride; i < size; ++i)
+			m_index[i] = m_access_list[i * index_stride].start;
 	}
 
 	template <typename Addr>
 	std::uint32_t filter_impl<Addr>::access(Addr const& addr) const
 	{
 		TORRENT_ASSERT(!m_access_list.empty());
-		auto i = m_access_list.upper_bound(addr);
-		if (i != m_access_list.begin()) --i;
-		TORRENT_ASSERT(i != m_access_list.end());
+		TORRENT_ASSERT(m_index.size() == (m_access_list.size() + index_stride - 1) / index_stride);
+
+		// find the block, then the range within it
+		auto const block = std::upper_bound(m_index.begin(), m_index.end(), addr
+			, [](Addr const& a, Addr const& start) { return addr_less(a, start); });
+		TORRENT_ASSERT(block != m_index.begin());
+		std::size_t const first = std::size_t(block - m_index.begin() - 1) * index_stride;
+		std::size_t const last = std::min(first + index_stride, m_access_list.size());
+
+		auto i = std::upper_bound(m_access_list.begin() + std::ptrdiff_t(first)
+			, m_access_list.begin() + std::ptrdiff_t(last), addr
+			, [](Addr const& a, range const& r) { return addr_less(a, r.start); });
+		TORRENT_ASSERT(i != m_access_list.begin());
+		--i;
 		TORRENT_ASSERT(i->start <= addr && (std::next(i) == m_access_list.end()
 			|| addr < std::next(i)->start));
 		return i->access;
 	}
 
+	template <typename Addr>
+	std::size_t filter_impl<Addr>::memory_usage() const
+	{
+		return m_access_list.capacity() * sizeof(range)
+			+ m_index.capacity() * sizeof(Addr);
+	}
+
 	template <typename Addr>
 	template <typename ExternalAddressType>
 	std::vector<ip_range<ExternalAddressType>> filter_impl<Addr>::export_filter() const
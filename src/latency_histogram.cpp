@@ -0,0 +1,126 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/latency_histogram.hpp"
+#include "libtorrent/assert.hpp"
+
+namespace libtorrent {
+namespace aux {
+
+namespace {
+
+	// floor(log2(v)), v must be > 0
+	int floor_log2(std::uint64_t v)
+	{
+		TORRENT_ASSERT(v > 0);
+#if defined __GNUC__ || defined __clang__
+		return 63 - __builtin_clzll(v);
+#else
+		int ret = 0;
+		while (v >>= 1) ++ret;
+		return ret;
+#endif
+	}
+}
+
+	constexpr int latency_histogram::sub_bucket_shift;
+	constexpr int latency_histogram::sub_buckets;
+	constexpr int latency_histogram::max_shift;
+	constexpr int latency_histogram::num_buckets;
+
+	latency_histogram::latency_histogram()
+	{
+		for (auto& b : m_buckets) b.store(0, std::memory_order_relaxed);
+		m_last.fill(0);
+	}
+
+	int latency_histogram::bucket_index(std::int64_t const value)
+	{
+		if (value < sub_buckets) return value < 0 ? 0 : int(value);
+		int const shift = floor_log2(std::uint64_t(value));
+		if (shift >= max_shift) return num_buckets - 1;
+		int const sub = int(std::uint64_t(value) >> (shift - sub_bucket_shift)) & (sub_buckets - 1);
+		return (shift - sub_bucket_shift + 1) * sub_buckets + sub;
+	}
+
+	std::int64_t latency_histogram::bucket_value(int const idx)
+	{
+		TORRENT_ASSERT(idx >= 0);
+		TORRENT_ASSERT(idx < num_buckets);
+		if (idx < sub_buckets) return idx;
+		int const shift = idx / sub_buckets - 1;
+		std::int64_t const sub = idx & (sub_buckets - 1);
+		std::int64_t const lower = (sub_buckets + sub) << shift;
+		return lower + ((std::int64_t(1) << shift) / 2);
+	}
+
+	void latency_histogram::record(std::int64_t const microseconds)
+	{
+		m_buckets[bucket_index(microseconds)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	latency_histogram::percentiles latency_histogram::snapshot()
+	{
+		aux::array<std::uint64_t, num_buckets> delta;
+		std::uint64_t total = 0;
+		for (int i = 0; i < num_buckets; ++i)
+		{
+			std::uint64_t const v = m_buckets[i].load(std::memory_order_relaxed);
+			delta[i] = v - m_last[i];
+			m_last[i] = v;
+			total += delta[i];
+		}
+
+		percentiles ret;
+		ret.samples = std::int64_t(total);
+		if (total == 0) return ret;
+
+		// the rank (1-based) of the sample at each percentile
+		std::uint64_t const r50 = (total * 500 + 999) / 1000;
+		std::uint64_t const r99 = (total * 990 + 999) / 1000;
+		std::uint64_t const r999 = (total * 999 + 999) / 1000;
+
+		std::uint64_t seen = 0;
+		bool have50 = false;
+		bool have99 = false;
+		for (int i = 0; i < num_buckets; ++i)
+		{
+			if (delta[i] == 0) continue;
+			seen += delta[i];
+			if (!have50 && seen >= r50) { ret.p50 = bucket_value(i); have50 = true; }
+			if (!have99 && seen >= r99) { ret.p99 = bucket_value(i); have99 = true; }
+			if (seen >= r999) { ret.p999 = bucket_value(i); break; }
+		}
+		return ret;
+	}
+}
+}
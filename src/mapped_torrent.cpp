@@ -0,0 +1,94 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/mapped_torrent.hpp"
+
+#if TORRENT_HAVE_MMAP || TORRENT_HAVE_MAP_VIEW_OF_FILE
+
+#include "libtorrent/torrent_info.hpp" // for load_torrent_limits
+#include "libtorrent/error.hpp"
+#include "libtorrent/aux_/mmap.hpp"
+#include "libtorrent/aux_/open_mode.hpp"
+#include "libtorrent/aux_/path.hpp"
+
+namespace libtorrent {
+namespace aux {
+
+	mapped_torrent map_torrent_file(std::string const& filename
+		, load_torrent_limits const& cfg, error_code& ec)
+	{
+		mapped_torrent ret;
+		ec.clear();
+
+		file_status st;
+		stat_file(filename, &st, ec);
+		if (ec) return ret;
+
+		if (st.file_size > cfg.max_buffer_size)
+		{
+			ec = errors::metadata_too_large;
+			return ret;
+		}
+		// there's no such thing as an empty mapping
+		if (st.file_size == 0)
+		{
+			ec = bdecode_errors::unexpected_eof;
+			return ret;
+		}
+
+		try
+		{
+			auto mapping = std::make_shared<file_mapping>(
+				file_handle(filename, 0, open_mode::read_only)
+				, open_mode::read_only, st.file_size
+#if TORRENT_HAVE_MAP_VIEW_OF_FILE
+				, std::make_shared<std::mutex>()
+#endif
+				);
+			span<char> const range = mapping->range();
+			ret.buffer = std::shared_ptr<char const>(mapping, range.data());
+			ret.size = int(range.size());
+		}
+		catch (storage_error const& e)
+		{
+			ec = e.ec;
+			return ret;
+		}
+
+		ret.root = bdecode({ret.buffer.get(), ret.size}, ec, nullptr
+			, cfg.max_decode_depth, cfg.max_decode_tokens);
+		return ret;
+	}
+}
+}
+
+#endif // HAVE_MMAP || HAVE_MAP_VIEW_OF_FILE
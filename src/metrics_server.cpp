@@ -0,0 +1,345 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/metrics_server.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/session_stats.hpp"
+#include "libtorrent/address.hpp"
+#include "libtorrent/deadline_timer.hpp"
+#include "libtorrent/hex.hpp" // to_hex
+#include "libtorrent/time.hpp"
+#include "libtorrent/string_view.hpp"
+
+#include "libtorrent/aux_/disable_warnings_push.hpp"
+#include <boost/asio/write.hpp>
+#include "libtorrent/aux_/disable_warnings_pop.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes> // for PRId64
+#include <cstdio>
+
+namespace libtorrent {
+namespace aux {
+
+namespace {
+
+	std::vector<stats_metric> const& all_metrics()
+	{
+		static std::vector<stats_metric> const m = session_stats_metrics();
+		return m;
+	}
+
+	// "net.sent_bytes" -> "libtorrent_net_sent_bytes"
+	void append_metric_name(std::string& out, char const* name)
+	{
+		out += "libtorrent_";
+		for (char const* c = name; *c != '\0'; ++c)
+			out += (*c == '.') ? '_' : *c;
+	}
+
+	void append_int(std::string& out, std::int64_t const v)
+	{
+		char buf[24];
+		int const len = std::snprintf(buf, sizeof(buf), "%" PRId64, v);
+		out.append(buf, std::size_t(len));
+	}
+
+	void append_torrent_family(std::string& out, char const* name, char const* help
+		, std::vector<torrent_metrics> const& torrents
+		, int torrent_metrics::*value)
+	{
+		out += "# HELP libtorrent_torrent_";
+		out += name;
+		out += ' ';
+		out += help;
+		out += "\n# TYPE libtorrent_torrent_";
+		out += name;
+		out += " gauge\n";
+		for (auto const& t : torrents)
+		{
+			out += "libtorrent_torrent_";
+			out += name;
+			out += "{info_hash=\"";
+			out += aux::to_hex(t.info_hash);
+			out += "\"} ";
+			append_int(out, t.*value);
+			out += '\n';
+		}
+	}
+
+	char const content_type[]
+		= "application/openmetrics-text; version=1.0.0; charset=utf-8";
+}
+
+	std::string render_openmetrics(counters const& cnt
+		, std::vector<torrent_metrics> const& torrents)
+	{
+		std::string out;
+		out.reserve(64 * 1024);
+
+		for (auto const& m : all_metrics())
+		{
+			bool const counter = m.type == metric_type_t::counter;
+			out += "# TYPE ";
+			append_metric_name(out, m.name);
+			out += counter ? " counter\n" : " gauge\n";
+			append_metric_name(out, m.name);
+			if (counter) out += "_total";
+			out += ' ';
+			append_int(out, cnt[m.value_index]);
+			out += '\n';
+		}
+
+		append_torrent_family(out, "download_payload_rate"
+			, "payload bytes per second received", torrents
+			, &torrent_metrics::download_payload_rate);
+		append_torrent_family(out, "upload_payload_rate"
+			, "payload bytes per second sent", torrents
+			, &torrent_metrics::upload_payload_rate);
+
+		out += "# EOF\n";
+		return out;
+	}
+
+	// one scrape. Reads the request head, answers from the snapshot current
+	// at that time and closes the connection.
+	struct metrics_connection : std::enable_shared_from_this<metrics_connection>
+	{
+		metrics_connection(std::shared_ptr<metrics_server> srv, tcp::socket s)
+			: m_server(std::move(srv))
+			, m_socket(std::move(s))
+			, m_timeout(m_server->m_ios)
+		{}
+
+		void start()
+		{
+			// don't let a client that never finishes its request hold on to
+			// one of the connection slots
+			m_timeout.expires_after(seconds(5));
+			m_timeout.async_wait([self = shared_from_this()](error_code const& ec)
+			{
+				if (ec) return;
+				self->close();
+			});
+			read_more();
+		}
+
+		void close()
+		{
+			error_code ec;
+			m_socket.close(ec);
+			m_timeout.cancel();
+		}
+
+	private:
+
+		void read_more()
+		{
+			if (m_size == int(m_buffer.size()))
+			{
+				respond("400 Bad Request", {});
+				return;
+			}
+			m_socket.async_read_some(boost::asio::buffer(m_buffer.data() + m_size
+				, m_buffer.size() - std::size_t(m_size))
+				, [self = shared_from_this()](error_code const& ec, std::size_t bytes)
+				{ self->on_read(ec, bytes); });
+		}
+
+		void on_read(error_code const& ec, std::size_t const bytes)
+		{
+			if (ec) { close(); return; }
+			m_size += int(bytes);
+
+			string_view const req(m_buffer.data(), std::size_t(m_size));
+			if (req.find("\r\n\r\n") == string_view::npos
+				&& req.find("\n\n") == string_view::npos)
+			{
+				read_more();
+				return;
+			}
+
+			// request line: <method> SP <target> SP <version>
+			auto const line_end = req.find_first_of("\r\n");
+			string_view const line = req.substr(0, line_end);
+			auto const sp1 = line.find(' ');
+			auto const sp2 = line.find(' ', sp1 == string_view::npos ? sp1 : sp1 + 1);
+			if (sp1 == string_view::npos || sp2 == string_view::npos)
+			{
+				respond("400 Bad Request", {});
+				return;
+			}
+			string_view const method = line.substr(0, sp1);
+			string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+			target = target.substr(0, target.find('?'));
+
+			if (method != "GET" && method != "HEAD")
+			{
+				respond("405 Method Not Allowed", {});
+				return;
+			}
+			if (target != "/metrics" && target != "/")
+			{
+				respond("404 Not Found", {});
+				return;
+			}
+
+			m_head_only = method == "HEAD";
+			respond("200 OK", m_server->m_snapshot);
+		}
+
+		void respond(char const* status, std::shared_ptr<std::string const> body)
+		{
+			m_body = std::move(body);
+			std::size_t const body_size = m_body ? m_body->size() : 0;
+
+			char header[300];
+			int const len = std::snprintf(header, sizeof(header)
+				, "HTTP/1.1 %s\r\n"
+				"Content-Type: %s\r\n"
+				"Content-Length: %d\r\n"
+				"Cache-Control: no-cache\r\n"
+				"Connection: close\r\n"
+				"\r\n"
+				, status
+				, m_body ? content_type : "text/plain"
+				, int(body_size));
+			m_header.assign(header, std::size_t(len));
+
+			std::array<boost::asio::const_buffer, 2> const bufs{{
+				boost::asio::buffer(m_header)
+				, boost::asio::buffer(m_body && !m_head_only
+					? m_body->data() : nullptr
+					, m_body && !m_head_only ? body_size : 0)}};
+
+			boost::asio::async_write(m_socket, bufs
+				, [self = shared_from_this()](error_code const&, std::size_t)
+				{
+					error_code ignore;
+					self->m_socket.shutdown(tcp::socket::shutdown_both, ignore);
+					self->close();
+				});
+		}
+
+		std::shared_ptr<metrics_server> m_server;
+		tcp::socket m_socket;
+		deadline_timer m_timeout;
+
+		std::array<char, 2048> m_buffer;
+		int m_size = 0;
+		bool m_head_only = false;
+
+		std::string m_header;
+		// keeps the snapshot we're sending alive, even if a new one is set
+		// in the meantime
+		std::shared_ptr<std::string const> m_body;
+	};
+
+	constexpr int metrics_server::max_connections;
+
+	metrics_server::metrics_server(io_context& ios)
+		: m_ios(ios)
+		, m_acceptor(ios)
+		, m_snapshot(std::make_shared<std::string const>("# EOF\n"))
+	{}
+
+	metrics_server::~metrics_server() = default;
+
+	void metrics_server::start(int const port, error_code& ec)
+	{
+		tcp::endpoint const ep(address_v4::loopback(), std::uint16_t(port));
+		m_acceptor.open(ep.protocol(), ec);
+		if (ec) return;
+		m_acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+		if (ec) return;
+		m_acceptor.bind(ep, ec);
+		if (ec) return;
+		m_acceptor.listen(max_connections, ec);
+		if (ec) return;
+		m_port = m_acceptor.local_endpoint(ec).port();
+		if (ec) return;
+		m_closed = false;
+		start_accept();
+	}
+
+	void metrics_server::close()
+	{
+		m_closed = true;
+		error_code ec;
+		m_acceptor.close(ec);
+		for (auto const& c : m_connections)
+		{
+			if (auto conn = c.lock()) conn->close();
+		}
+		m_connections.clear();
+	}
+
+	void metrics_server::set_snapshot(std::string s)
+	{
+		m_snapshot = std::make_shared<std::string const>(std::move(s));
+	}
+
+	void metrics_server::start_accept()
+	{
+		m_acceptor.async_accept([self = shared_from_this()](error_code const& ec, tcp::socket s)
+			{ self->on_accept(ec, std::move(s)); });
+	}
+
+	void metrics_server::on_accept(error_code const& ec, tcp::socket s)
+	{
+		if (m_closed) return;
+		// only keep accepting after errors that are specific to the one
+		// incoming connection, anything else would just spin
+		if (ec && ec != boost::asio::error::connection_aborted) return;
+		if (!ec)
+		{
+			m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end()
+				, [](std::weak_ptr<metrics_connection> const& c) { return c.expired(); })
+				, m_connections.end());
+
+			if (int(m_connections.size()) >= max_connections)
+			{
+				error_code ignore;
+				s.close(ignore);
+			}
+			else
+			{
+				auto conn = std::make_shared<metrics_connection>(shared_from_this(), std::move(s));
+				m_connections.push_back(conn);
+				conn->start();
+			}
+		}
+		start_accept();
+	}
+}
+}
@@ -55,6 +55,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/aux_/disk_job_pool.hpp"
 #include "libtorrent/aux_/disk_io_thread_pool.hpp"
 #include "libtorrent/aux_/store_buffer.hpp"
+#include "libtorrent/aux_/streaming_cache.hpp"
 #include "libtorrent/aux_/time.hpp"
 #include "libtorrent/aux_/alloca.hpp"
 #include "libtorrent/aux_/array.hpp"
@@ -173,6 +174,7 @@ namespace {
 				| disk_interface::sequential_access
 				| disk_interface::volatile_read
 				| disk_interface::v1_hash
+				| disk_interface::stream_read
 				| disk_interface::flush_piece))
 			== disk_job_flags_t{};
 	}
@@ -205,6 +207,12 @@ struct TORRENT_EXTRA_EXPORT mmap_disk_io final
 		, char const* buf, std::shared_ptr<disk_observer> o
 		, std::function<void(storage_error const&)> handler
 		, disk_job_flags_t flags = {}) override;
+	disk_buffer_holder allocate_write_buffer(bool& exceeded
+		, std::shared_ptr<disk_observer> o) override;
+	bool async_write_buffer(storage_index_t storage, peer_request const& r
+		, disk_buffer_holder buf, std::shared_ptr<disk_observer> o
+		, std::function<void(storage_error const&)> handler
+		, disk_job_flags_t flags = {}) override;
 	void async_hash(storage_index_t storage, piece_index_t piece/*, span<sha256_hash> v2*/
 		, disk_job_flags_t flags
 		, std::function<void(piece_index_t, sha1_hash const&, storage_error const&)> handler) override;
@@ -340,6 +348,10 @@ private:
 	// synchronize with the writing thread(s)
 	aux::store_buffer m_store_buffer;
 
+	// blocks around the stream cursor of the torrents being played back.
+	// Reads of those torrents are served from here before going to disk
+	aux::streaming_cache m_streaming_cache;
+
 	settings_interface const& m_settings;
 
 	// LRU cache of open files
@@ -448,6 +460,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 	void mmap_disk_io::remove_torrent(storage_index_t const idx)
 	{
 		TORRENT_ASSERT(m_torrents[idx] != nullptr);
+		m_streaming_cache.erase_storage(idx);
 		m_torrents[idx].reset();
 		m_free_slots.add(idx);
 	}
@@ -528,6 +541,8 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 		TORRENT_ASSERT(m_magic == 0x1337);
 		m_buffer_pool.set_settings(m_settings);
 		m_file_pool.resize(m_settings.get_int(settings_pack::file_pool_size));
+		m_streaming_cache.set_max_size(std::int64_t(m_settings.get_int(
+			settings_pack::streaming_cache_size)) * 1024 * 1024);
 
 		int const num_threads = m_settings.get_int(settings_pack::aio_threads);
 		int const num_hash_threads = m_settings.get_int(settings_pack::hashing_threads);
@@ -665,6 +680,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 			m_stats_counters.inc_stats_counter(counters::num_read_ops);
 			m_stats_counters.inc_stats_counter(counters::disk_read_time, read_time);
 			m_stats_counters.inc_stats_counter(counters::disk_job_time, read_time);
+			m_stats_counters.record_latency(counters::disk_job_latency_histogram, read_time);
 		}
 		return status_t::no_error;
 	}
@@ -699,6 +715,14 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 			m_stats_counters.inc_stats_counter(counters::num_read_ops);
 			m_stats_counters.inc_stats_counter(counters::disk_read_time, read_time);
 			m_stats_counters.inc_stats_counter(counters::disk_job_time, read_time);
+			m_stats_counters.record_latency(counters::disk_job_latency_histogram, read_time);
+
+			if ((j->flags & disk_interface::stream_read)
+				&& j->d.io.offset % default_block_size == 0)
+			{
+				m_streaming_cache.insert(j->storage->storage_index(), j->piece
+					, j->d.io.offset, b);
+			}
 		}
 		return status_t::no_error;
 	}
@@ -727,6 +751,12 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 			m_stats_counters.inc_stats_counter(counters::num_write_ops);
 			m_stats_counters.inc_stats_counter(counters::disk_write_time, write_time);
 			m_stats_counters.inc_stats_counter(counters::disk_job_time, write_time);
+			m_stats_counters.record_latency(counters::disk_job_latency_histogram, write_time);
+
+			// blocks downloaded for a torrent being played back are likely
+			// to be read soon
+			m_streaming_cache.insert(j->storage->storage_index(), j->piece
+				, j->d.io.offset, b);
 		}
 
 		{
@@ -774,6 +804,9 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 
 		disk_buffer_holder buffer;
 
+		if (flags & disk_interface::stream_read)
+			m_streaming_cache.set_cursor(storage, r.piece);
+
 		if (read_offset + r.length > default_block_size)
 		{
 			// This is an unaligned request spanning two blocks. One of the two
@@ -854,6 +887,26 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 			}
 		}
 
+		// the store buffer didn't have it, before going to disk, see if it's
+		// around the stream cursor. The buffer is only allocated on a hit
+		if (m_streaming_cache.has_cursor(storage))
+		{
+			if (m_streaming_cache.has(storage, r.piece, r.start, r.length))
+			{
+				buffer = disk_buffer_holder(m_buffer_pool, m_buffer_pool.allocate_buffer("send buffer"), r.length);
+				// the piece may have been evicted since has() returned
+				if (buffer && m_streaming_cache.get(storage, r.piece, r.start
+					, {buffer.data(), r.length}))
+				{
+					m_stats_counters.inc_stats_counter(counters::streaming_cache_hits);
+					handler(std::move(buffer), ec);
+					return;
+				}
+				buffer.reset();
+			}
+			m_stats_counters.inc_stats_counter(counters::streaming_cache_misses);
+		}
+
 		aux::mmap_disk_job* j = m_job_pool.allocate_job(aux::job_action_t::read);
 		j->storage = m_torrents[storage]->shared_from_this();
 		j->piece = r.piece;
@@ -870,11 +923,32 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 		, disk_job_flags_t const flags)
 	{
 		bool exceeded = false;
-		disk_buffer_holder buffer(m_buffer_pool, m_buffer_pool.allocate_buffer(
-			exceeded, o, "receive buffer"), default_block_size);
+		disk_buffer_holder buffer = allocate_write_buffer(exceeded, o);
 		if (!buffer) aux::throw_ex<std::bad_alloc>();
 		std::memcpy(buffer.data(), buf, aux::numeric_cast<std::size_t>(r.length));
 
+		async_write_buffer(storage, r, std::move(buffer), std::move(o)
+			, std::move(handler), flags);
+		return exceeded;
+	}
+
+	disk_buffer_holder mmap_disk_io::allocate_write_buffer(bool& exceeded
+		, std::shared_ptr<disk_observer> o)
+	{
+		return disk_buffer_holder(m_buffer_pool, m_buffer_pool.allocate_buffer(
+			exceeded, std::move(o), "receive buffer"), default_block_size);
+	}
+
+	bool mmap_disk_io::async_write_buffer(storage_index_t const storage
+		, peer_request const& r, disk_buffer_holder buffer
+		, std::shared_ptr<disk_observer>
+		, std::function<void(storage_error const&)> handler
+		, disk_job_flags_t const flags)
+	{
+		// if the disk buffers were exhausted, that was reported back when the
+		// buffer was allocated
+		TORRENT_ASSERT(buffer);
+		TORRENT_ASSERT(buffer.size() >= r.length);
 		TORRENT_ASSERT(r.start % default_block_size == 0);
 		TORRENT_ASSERT(r.length <= default_block_size);
 		TORRENT_ASSERT(r.start + r.length <= m_torrents[storage]->files().piece_size(r.piece));
@@ -891,7 +965,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 		m_store_buffer.insert({j->storage->storage_index(), j->piece, j->d.io.offset}
 			, boost::get<disk_buffer_holder>(j->argument).data());
 		add_job(j);
-		return exceeded;
+		return false;
 	}
 
 	void mmap_disk_io::async_hash(storage_index_t const storage
@@ -1155,6 +1229,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 			std::int64_t const read_time = total_microseconds(clock_type::now() - start_time);
 			m_stats_counters.inc_stats_counter(counters::disk_hash_time, read_time);
 			m_stats_counters.inc_stats_counter(counters::disk_job_time, read_time);
+			m_stats_counters.record_latency(counters::disk_job_latency_histogram, read_time);
 		}
 
 		if (v1)
@@ -1240,6 +1315,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 
 		// if this assert fails, something's wrong with the fence logic
 		TORRENT_ASSERT(j->storage->num_outstanding_jobs() == 1);
+		m_streaming_cache.erase_storage(j->storage->storage_index());
 		j->storage->delete_files(boost::get<remove_flags_t>(j->argument), j->error);
 		return j->error ? status_t::fatal_disk_error : status_t::no_error;
 	}
@@ -1252,6 +1328,9 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 		// if this assert fails, something's wrong with the fence logic
 		TORRENT_ASSERT(j->storage->num_outstanding_jobs() == 1);
 
+		// the files may have changed on disk since they were cached
+		m_streaming_cache.erase_storage(j->storage->storage_index());
+
 		add_torrent_params const* rd = boost::get<add_torrent_params const*>(j->argument);
 		add_torrent_params tmp;
 		if (rd == nullptr) rd = &tmp;
@@ -1350,6 +1429,7 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 
 		// gauges
 		c.set_value(counters::disk_blocks_in_use, m_buffer_pool.in_use());
+		c.set_value(counters::streaming_cache_bytes, m_streaming_cache.size());
 	}
 
 	status_t mmap_disk_io::do_file_priority(aux::mmap_disk_job* j)
@@ -1363,10 +1443,12 @@ TORRENT_EXPORT std::unique_ptr<disk_interface> mmap_disk_io_constructor(
 	// this job won't return until all outstanding jobs on this
 	// piece are completed or cancelled and the buffers for it
 	// have been evicted
-	status_t mmap_disk_io::do_clear_piece(aux::mmap_disk_job*)
+	status_t mmap_disk_io::do_clear_piece(aux::mmap_disk_job* j)
 	{
-		// there's nothing to do here, by the time this is called the jobs for
-		// this storage has been completed since this is a fence job
+		// by the time this is called the jobs for this storage has been
+		// completed since this is a fence job. The blocks of the piece the
+		// streaming cache picked up as they were written failed the hash check
+		m_streaming_cache.erase_piece(j->storage->storage_index(), j->piece);
 		return status_t::no_error;
 	}
 
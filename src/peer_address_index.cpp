@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/peer_address_index.hpp"
+
+#include <algorithm> // for max
+#include <cstring> // for memcpy
+
+namespace libtorrent { namespace aux {
+
+	std::size_t peer_address_index::hash(address const& a)
+	{
+		std::uint64_t h;
+		if (a.is_v4())
+		{
+			h = a.to_v4().to_uint();
+		}
+		else
+		{
+			auto const b = a.to_v6().to_bytes();
+			std::uint64_t hi;
+			std::uint64_t lo;
+			std::memcpy(&hi, b.data(), 8);
+			std::memcpy(&lo, b.data() + 8, 8);
+			h = hi ^ (lo * 0x9e3779b97f4a7c15ULL);
+		}
+		// the table is indexed by the low bits, mix the high bits in
+		h *= 0x9e3779b97f4a7c15ULL;
+		return std::size_t(h ^ (h >> 32));
+	}
+
+	std::size_t peer_address_index::find_slot(span<torrent_peer* const> peers
+		, int const idx) const
+	{
+		TORRENT_ASSERT(m_size > 0);
+		std::size_t const mask = m_slots.size() - 1;
+		for (std::size_t i = hash(peers[idx]->address()) & mask;; i = (i + 1) & mask)
+		{
+			TORRENT_ASSERT(m_slots[i] >= 0);
+			if (m_slots[i] == idx) return i;
+		}
+	}
+
+	void peer_address_index::insert(span<torrent_peer* const> peers, int const idx)
+	{
+		TORRENT_ASSERT(idx >= 0 && idx < peers.size());
+
+		// keep the load factor at or below 1/2
+		if ((m_size + 1) * 2 > int(m_slots.size())) grow(peers);
+
+		std::size_t const mask = m_slots.size() - 1;
+		std::size_t i = hash(peers[idx]->address()) & mask;
+		while (m_slots[i] >= 0) i = (i + 1) & mask;
+		m_slots[i] = std::int32_t(idx);
+		++m_size;
+	}
+
+	void peer_address_index::erase(span<torrent_peer* const> peers, int const idx)
+	{
+		std::size_t const mask = m_slots.size() - 1;
+		std::size_t i = find_slot(peers, idx);
+
+		// shift back any following entries in the probe sequence that would
+		// no longer be reachable with slot i empty
+		for (std::size_t j = (i + 1) & mask; m_slots[j] >= 0; j = (j + 1) & mask)
+		{
+			std::size_t const home = hash(peers[m_slots[j]]->address()) & mask;
+			// if home is cyclically in (i, j], the entry is still reachable
+			bool const reachable = i <= j
+				? (i < home && home <= j)
+				: (i < home || home <= j);
+			if (reachable) continue;
+			m_slots[i] = m_slots[j];
+			i = j;
+		}
+		m_slots[i] = -1;
+		--m_size;
+	}
+
+	void peer_address_index::move(span<torrent_peer* const> peers
+		, int const from, int const to)
+	{
+		m_slots[find_slot(peers, from)] = std::int32_t(to);
+	}
+
+	void peer_address_index::clear()
+	{
+		m_slots.clear();
+		m_size = 0;
+	}
+
+	void peer_address_index::grow(span<torrent_peer* const> peers)
+	{
+		std::vector<std::int32_t> old(std::max(std::size_t(16), m_slots.size() * 2), -1);
+		old.swap(m_slots);
+		std::size_t const mask = m_slots.size() - 1;
+		for (std::int32_t const idx : old)
+		{
+			if (idx < 0) continue;
+			std::size_t i = hash(peers[idx]->address()) & mask;
+			while (m_slots[i] >= 0) i = (i + 1) & mask;
+			m_slots[i] = idx;
+		}
+	}
+
+#if TORRENT_USE_INVARIANT_CHECKS
+	void peer_address_index::check_invariant(span<torrent_peer* const> peers) const
+	{
+		TORRENT_ASSERT(m_size == peers.size());
+		for (int i = 0; i < int(peers.size()); ++i)
+			TORRENT_ASSERT(find(peers, peers[i]->address()
+				, [&](torrent_peer const* p) { return p == peers[i]; }) == i);
+	}
+#endif
+}}
@@ -139,6 +139,7 @@ namespace libtorrent {
 		, m_peer_info(pack.peerinfo)
 		, m_counters(*pack.stats_counters)
 		, m_num_pieces(0)
+		, m_recv_buffer(&m_ses.get_receive_buffer_pool())
 		, m_max_out_request_queue(aux::clamp_assign<std::uint16_t>(m_settings.get_int(settings_pack::max_out_request_queue)))
 		, m_remote(pack.endp)
 		, m_disk_thread(*pack.disk_thread)
@@ -166,6 +167,7 @@ namespace libtorrent {
 		, m_has_metadata(true)
 		, m_exceeded_limit(false)
 		, m_slow_start(true)
+		, m_recv_disk_exceeded(false)
 	{
 		m_counters.inc_stats_counter(counters::num_tcp_peers
 			+ static_cast<std::uint8_t>(socket_type_idx(m_socket)));
@@ -522,20 +524,22 @@ namespace libtorrent {
 		{
 			t->need_picker();
 			piece_picker const& p = t->picker();
-			piece_index_t const end_piece(p.num_pieces());
-			for (piece_index_t j(0); j != end_piece; ++j)
+
+			// we're interested if the peer has any piece we want and
+			// haven't passed yet, i.e. any bit in have & ~passed & wanted
+			int const first = bitfield::find_first_set_and_not(m_have_piece
+				, p.passed_pieces(), p.wanted_pieces());
+			if (first != -1)
 			{
-				if (m_have_piece[j]
+				piece_index_t const j(first);
+				TORRENT_ASSERT(m_have_piece[j]
 					&& t->piece_priority(j) > dont_download
-					&& !p.has_piece_passed(j))
-				{
-					interested = true;
+					&& !p.has_piece_passed(j));
+				interested = true;
 #ifndef TORRENT_DISABLE_LOGGING
-					peer_log(peer_log_alert::info, "UPDATE_INTEREST", "interesting, piece: %d"
-						, static_cast<int>(j));
+				peer_log(peer_log_alert::info, "UPDATE_INTEREST", "interesting, piece: %d"
+					, first);
 #endif
-					break;
-				}
 			}
 		}
 
@@ -933,6 +937,15 @@ namespace libtorrent {
 			}
 		}
 
+		// snubbed peers are too slow to be trusted with the pieces needed
+		// next, they stick to the common pieces
+		if (t->is_sequential_window()
+			&& !t->is_sequential_download()
+			&& !m_snubbed)
+		{
+			ret |= piece_picker::sequential_window;
+		}
+
 		if (m_settings.get_bool(settings_pack::prioritize_partial_pieces))
 			ret |= piece_picker::prioritize_partials;
 
@@ -2689,6 +2702,24 @@ namespace libtorrent {
 			}
 			m_outstanding_bytes += r.length;
 		}
+
+		// receive the rest of the payload straight into a disk buffer. That
+		// way it can be handed to the disk thread without being copied out of
+		// the receive buffer
+		if (!m_disconnecting
+			&& !m_recv_buffer.packet_finished()
+			&& !m_recv_buffer.has_disk_buffer()
+			&& !t->is_seed())
+		{
+			bool exceeded = false;
+			disk_buffer_holder buf = m_disk_thread.allocate_write_buffer(exceeded, self());
+			if (buf && buf.size() >= r.length
+				&& m_recv_buffer.assign_disk_buffer(std::move(buf), r.length))
+			{
+				m_recv_disk_exceeded = exceeded;
+				m_counters.inc_stats_counter(counters::num_zero_copy_blocks);
+			}
+		}
 	}
 
 #if TORRENT_USE_INVARIANT_CHECKS
@@ -2727,6 +2758,19 @@ namespace libtorrent {
 	// -----------------------------
 
 	void peer_connection::incoming_piece(peer_request const& p, char const* data)
+	{
+		incoming_piece_impl(p, data, disk_buffer_holder());
+	}
+
+	void peer_connection::incoming_piece(peer_request const& p, disk_buffer_holder data)
+	{
+		TORRENT_ASSERT(data);
+		char const* const ptr = data.data();
+		incoming_piece_impl(p, ptr, std::move(data));
+	}
+
+	void peer_connection::incoming_piece_impl(peer_request const& p, char const* data
+		, disk_buffer_holder buffer)
 	{
 		TORRENT_ASSERT(is_single_thread());
 		INVARIANT_CHECK;
@@ -2737,6 +2781,11 @@ namespace libtorrent {
 		// we're not receiving any block right now
 		m_receiving_block = piece_block::invalid;
 
+		// the flag belongs to the disk buffer the block was received into.
+		// Take it now, since any of the early returns below drop the buffer
+		bool const recv_disk_exceeded = m_recv_disk_exceeded;
+		m_recv_disk_exceeded = false;
+
 #ifdef TORRENT_CORRUPT_DATA
 		// corrupt all pieces from certain peers
 		if (aux::is_v4(m_remote)
@@ -2924,9 +2973,22 @@ namespace libtorrent {
 
 		if (t->is_deleted()) return;
 
-		bool const exceeded = m_disk_thread.async_write(t->storage(), p, data, self()
-			, [conn = self(), p, t] (storage_error const& e)
-			{ conn->wrap(&peer_connection::on_disk_write_complete, e, p, t); });
+		auto write_handler = [conn = self(), p, t] (storage_error const& e)
+			{ conn->wrap(&peer_connection::on_disk_write_complete, e, p, t); };
+
+		bool exceeded = false;
+		if (buffer)
+		{
+			// the payload was received into a disk buffer, just hand it over
+			exceeded = m_disk_thread.async_write_buffer(t->storage(), p
+				, std::move(buffer), self(), std::move(write_handler))
+				|| recv_disk_exceeded;
+		}
+		else
+		{
+			exceeded = m_disk_thread.async_write(t->storage(), p, data, self()
+				, std::move(write_handler));
+		}
 		m_ses.deferred_submit_jobs();
 
 		// every peer is entitled to have two disk blocks allocated at any given
@@ -5776,7 +5838,13 @@ namespace libtorrent {
 #ifndef TORRENT_DISABLE_LOGGING
 		peer_log(peer_log_alert::outgoing, "ASYNC_WRITE", "bytes: %d", amount_to_send);
 #endif
+		// the whole chain of send buffers is handed to the socket as one
+		// buffer sequence, which TCP sockets issue as a single sendmsg() and
+		// uTP sockets gather straight into outgoing packets.
 		auto const vec = m_send_buffer.build_iovec(amount_to_send);
+		TORRENT_ASSERT(!vec.empty());
+		m_counters.inc_stats_counter(counters::num_send_buffers_gathered
+			, std::int64_t(vec.size()));
 		ADD_OUTSTANDING_ASYNC("peer_connection::on_send_data");
 
 #if TORRENT_USE_ASSERTS
@@ -6043,6 +6111,12 @@ namespace libtorrent {
 
 			int const quota_left = m_quota[download_channel];
 			if (buffer_size > quota_left) buffer_size = quota_left;
+
+			// while receiving into a disk buffer, we can't read past the end
+			// of the current block
+			if (m_recv_buffer.has_disk_buffer())
+				buffer_size = std::min(buffer_size, m_recv_buffer.max_receive());
+
 			if (buffer_size > 0)
 			{
 				span<char> const vec = m_recv_buffer.reserve(buffer_size);
@@ -6097,6 +6171,19 @@ namespace libtorrent {
 			? 100 : 0;
 		m_recv_buffer.normalize(force_shrink);
 
+		// if we're not expecting any piece data from this peer, it's idle.
+		// Hand the receive buffer back to the session's pool and just keep
+		// enough room for the next message header
+		if (m_download_queue.empty()
+			&& m_request_queue.empty()
+			&& m_recv_buffer.release_idle())
+		{
+#ifndef TORRENT_DISABLE_LOGGING
+			peer_log(peer_log_alert::incoming, "RELEASE_BUFFER", "%d bytes"
+				, m_recv_buffer.capacity());
+#endif
+		}
+
 		if (m_recv_buffer.max_receive() == 0)
 		{
 			// the message we're receiving is larger than our receive
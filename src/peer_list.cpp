@@ -68,22 +68,6 @@ namespace {
 
 	using namespace libtorrent;
 
-	struct match_peer_endpoint
-	{
-		match_peer_endpoint(address const& addr, std::uint16_t port)
-			: m_addr(addr), m_port(port)
-		{}
-
-		bool operator()(torrent_peer const* p) const
-		{
-			TORRENT_ASSERT(p->in_use);
-			return p->address() == m_addr && p->port == m_port;
-		}
-
-		address const& m_addr;
-		std::uint16_t m_port;
-	};
-
 	// this returns true if lhs is a better erase candidate than rhs
 	bool compare_peer_erase(torrent_peer const& lhs, torrent_peer const& rhs)
 	{
@@ -108,9 +92,12 @@ namespace {
 	}
 
 	// this returns true if lhs is a better connect candidate than rhs
-	bool compare_peer(torrent_peer const* lhs, torrent_peer const* rhs
-		, external_ip const& external, int const external_port, bool const finished)
+	bool compare_peer(connect_candidate const& lhs_candidate
+		, connect_candidate const& rhs_candidate, bool const finished)
 	{
+		torrent_peer const* lhs = lhs_candidate.peer;
+		torrent_peer const* rhs = rhs_candidate.peer;
+
 		// prefer peers with lower failcount
 		if (lhs->failcount != rhs->failcount)
 			return lhs->failcount < rhs->failcount;
@@ -136,11 +123,18 @@ namespace {
 		int const rhs_rank = source_rank(rhs->peer_source());
 		if (lhs_rank != rhs_rank) return lhs_rank > rhs_rank;
 
-		std::uint32_t const lhs_peer_rank = lhs->rank(external, external_port);
-		std::uint32_t const rhs_peer_rank = rhs->rank(external, external_port);
-		return lhs_peer_rank > rhs_peer_rank;
+		return lhs_candidate.rank > rhs_candidate.rank;
 	}
 
+	// the ordering of the connect candidate cache heap, keeping the best
+	// candidate at the front
+	struct worse_candidate
+	{
+		bool finished;
+		bool operator()(connect_candidate const& lhs, connect_candidate const& rhs) const
+		{ return compare_peer(rhs, lhs, finished); }
+	};
+
 } // anonymous namespace
 
 namespace libtorrent {
@@ -161,9 +155,11 @@ namespace libtorrent {
 		for (auto const p : m_peers)
 			m_peer_allocator.free_peer_entry(p);
 		m_peers.clear();
+		m_index.clear();
 		m_candidate_cache.clear();
 		m_num_connect_candidates = 0;
 		m_num_seeds = 0;
+		m_num_v6_peers = 0;
 	}
 
 	peer_list::~peer_list()
@@ -238,8 +234,8 @@ namespace libtorrent {
 	void peer_list::clear_peer_prio()
 	{
 		INVARIANT_CHECK;
-		for (auto& p : m_peers)
-			p->peer_rank = 0;
+		// the ranks in the candidate cache were computed against the old IP
+		m_candidate_cache.clear();
 	}
 
 	// disconnects and removes all peers that are now filtered
@@ -303,12 +299,10 @@ namespace libtorrent {
 		TORRENT_ASSERT(p->in_use);
 		TORRENT_ASSERT(m_locked_peer != p);
 
-		auto const range = std::equal_range(m_peers.begin(), m_peers.end(), p, peer_address_compare{});
-		auto const iter = std::find_if(range.first, range.second, [&](torrent_peer const* needle) {
-			return torrent_peer_equal(needle, p);
-		});
-		if (iter == range.second) return;
-		erase_peer(iter, state);
+		int const idx = m_index.find(m_peers, p->address()
+			, [p](torrent_peer const* pe) { return pe == p; });
+		if (idx < 0) return;
+		erase_peer(m_peers.begin() + idx, state);
 	}
 
 	// any peer that is erased from m_peers will be
@@ -331,16 +325,35 @@ namespace libtorrent {
 		if (is_connect_candidate(**i))
 			update_connect_candidates(-1);
 		TORRENT_ASSERT(m_num_connect_candidates < int(m_peers.size()));
-		if (m_round_robin > i - m_peers.begin()) --m_round_robin;
-		if (m_round_robin >= int(m_peers.size())) m_round_robin = 0;
 
 		// if this peer is in the connect candidate
 		// cache, erase it from there as well
-		auto const ci = std::find(m_candidate_cache.begin(), m_candidate_cache.end(), *i);
-		if (ci != m_candidate_cache.end()) m_candidate_cache.erase(ci);
+		torrent_peer* const p = *i;
+		auto const ci = std::find_if(m_candidate_cache.begin(), m_candidate_cache.end()
+			, [p](connect_candidate const& c) { return c.peer == p; });
+		if (ci != m_candidate_cache.end())
+		{
+			m_candidate_cache.erase(ci);
+			std::make_heap(m_candidate_cache.begin(), m_candidate_cache.end()
+				, worse_candidate{bool(m_finished)});
+		}
+
+		// fill the hole with the last peer, rather than shifting all peers
+		// after it
+		if (p->is_v6_addr) --m_num_v6_peers;
+
+		int const idx = int(i - m_peers.begin());
+		int const last = int(m_peers.size()) - 1;
+		m_index.erase(m_peers, idx);
+		if (idx != last)
+		{
+			m_index.move(m_peers, last, idx);
+			m_peers[idx] = m_peers[last];
+		}
+		m_peers.pop_back();
+		if (m_round_robin >= int(m_peers.size())) m_round_robin = 0;
 
-		m_peer_allocator.free_peer_entry(*i);
-		m_peers.erase(i);
+		m_peer_allocator.free_peer_entry(p);
 	}
 
 	bool peer_list::should_erase_immediately(torrent_peer const& p) const
@@ -409,8 +422,10 @@ namespace libtorrent {
 			{
 				if (should_erase_immediately(pe))
 				{
-					if (erase_candidate > current) --erase_candidate;
-					if (force_erase_candidate > current) --force_erase_candidate;
+					// erasing moves the last peer into this slot
+					int const last = int(m_peers.size()) - 1;
+					if (erase_candidate == last) erase_candidate = current;
+					if (force_erase_candidate == last) force_erase_candidate = current;
 					TORRENT_ASSERT(current >= 0 && current < int(m_peers.size()));
 					erase_peer(m_peers.begin() + current, state);
 					continue;
@@ -442,6 +457,41 @@ namespace libtorrent {
 		}
 	}
 
+	int peer_list::trim_peers(torrent_state* state, int const max_peers)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		INVARIANT_CHECK;
+
+		if (int(m_peers.size()) <= max_peers) return 0;
+
+		std::vector<torrent_peer*> candidates;
+		for (auto* pe : m_peers)
+		{
+			if (is_force_erase_candidate(*pe))
+				candidates.push_back(pe);
+		}
+
+		int const num_erase = std::min(int(candidates.size())
+			, int(m_peers.size()) - std::max(max_peers, 0));
+		std::partial_sort(candidates.begin(), candidates.begin() + num_erase
+			, candidates.end(), [](torrent_peer const* lhs, torrent_peer const* rhs)
+			{ return compare_peer_erase(*lhs, *rhs); });
+
+		for (int i = 0; i < num_erase; ++i)
+			erase_peer(candidates[std::size_t(i)], state);
+		return num_erase;
+	}
+
+	std::size_t peer_list::memory_usage() const
+	{
+		std::size_t const num_v4 = m_peers.size() - std::size_t(m_num_v6_peers);
+		return m_peers.capacity() * sizeof(torrent_peer*)
+			+ m_index.memory_usage()
+			+ m_candidate_cache.capacity() * sizeof(connect_candidate)
+			+ num_v4 * sizeof(ipv4_peer)
+			+ std::size_t(m_num_v6_peers) * sizeof(ipv6_peer);
+	}
+
 	// returns true if the peer was actually banned
 	bool peer_list::ban_peer(torrent_peer* p)
 	{
@@ -515,7 +565,7 @@ namespace libtorrent {
 		return true;
 	}
 
-	void peer_list::find_connect_candidates(std::vector<torrent_peer*>& peers
+	void peer_list::find_connect_candidates(std::vector<connect_candidate>& peers
 		, int session_time, torrent_state* state)
 	{
 		TORRENT_ASSERT(is_single_thread());
@@ -562,7 +612,9 @@ namespace libtorrent {
 				{
 					if (should_erase_immediately(pe))
 					{
-						if (erase_candidate > current) --erase_candidate;
+						// erasing moves the last peer into this slot
+						if (erase_candidate == int(m_peers.size()) - 1)
+							erase_candidate = current;
 						erase_peer(m_peers.begin() + current, state);
 						continue;
 					}
@@ -582,29 +634,67 @@ namespace libtorrent {
 				(int(pe.failcount) + 1) * state->min_reconnect_time)
 				continue;
 
-			// compare peer returns true if lhs is better than rhs. In this
-			// case, it returns true if the current candidate is better than
-			// pe, which is the peer m_round_robin points to. If it is, just
-			// keep looking.
-			if (peers.size() == candidate_count
-				&& compare_peer(peers.back(), &pe, external, external_port, m_finished)) continue;
-
-			if (peers.size() >= candidate_count)
-				peers.resize(candidate_count - 1);
+			connect_candidate const candidate{&pe, pe.rank(external, external_port)};
 
-			// insert this candidate sorted into peers
-			auto const i = std::lower_bound(peers.begin(), peers.end()
-				, &pe, std::bind(&compare_peer, _1, _2, std::cref(external), external_port, bool(m_finished)));
+			// while collecting, peers is a heap with the worst candidate at
+			// the front. compare peer returns true if lhs is better than rhs.
+			// In this case, it returns true if the worst candidate is better
+			// than pe, which is the peer m_round_robin points to. If it is,
+			// just keep looking.
+			if (int(peers.size()) == candidate_count)
+			{
+				if (compare_peer(peers.front(), candidate, m_finished)) continue;
+				std::pop_heap(peers.begin(), peers.end(), std::bind(&compare_peer
+					, _1, _2, bool(m_finished)));
+				peers.pop_back();
+			}
 
-			peers.insert(i, &pe);
+			peers.push_back(candidate);
+			std::push_heap(peers.begin(), peers.end(), std::bind(&compare_peer
+				, _1, _2, bool(m_finished)));
 		}
 
+		// turn it around, to have the best candidate at the front
+		std::make_heap(peers.begin(), peers.end(), worse_candidate{bool(m_finished)});
+
 		if (erase_candidate > -1)
 		{
 			erase_peer(m_peers.begin() + erase_candidate, state);
 		}
 	}
 
+	std::vector<torrent_peer*> peer_list::find_peers(address const& a) const
+	{
+		std::vector<torrent_peer*> ret;
+		m_index.find(m_peers, a, [&ret](torrent_peer* p)
+		{
+			ret.push_back(p);
+			return false;
+		});
+		return ret;
+	}
+
+	int peer_list::find_peer(tcp::endpoint const& ep) const
+	{
+		return m_index.find(m_peers, ep.address()
+			, [&ep](torrent_peer const* p) { return p->port == ep.port(); });
+	}
+
+	void peer_list::add_to_peers(torrent_peer* p)
+	{
+		m_peers.push_back(p);
+		try
+		{
+			m_index.insert(m_peers, int(m_peers.size()) - 1);
+		}
+		catch (...)
+		{
+			m_peers.pop_back();
+			throw;
+		}
+		if (p->is_v6_addr) ++m_num_v6_peers;
+	}
+
 	bool peer_list::new_connection(peer_connection_interface& c, int session_time
 		, torrent_state* state)
 	{
@@ -613,55 +703,16 @@ namespace libtorrent {
 
 		INVARIANT_CHECK;
 
-		iterator iter;
 		torrent_peer* i = nullptr;
 
-
-		// std::string const i2p_dest;
-
-
-		bool found = false;
 		// this check doesn't support i2p peers
-		if (state->allow_multiple_connections_per_ip)
-		{
-			auto const& remote = c.remote();
-			auto const addr = remote.address();
-			auto const range = find_peers(addr);
-			iter = std::find_if(range.first, range.second, match_peer_endpoint(addr, remote.port()));
-
-			if (iter != range.second)
-			{
-				TORRENT_ASSERT((*iter)->in_use);
-				found = true;
-			}
-		}
-		else
-		{
-
-			{
-				iter = std::lower_bound(
-					m_peers.begin(), m_peers.end()
-					, c.remote().address(), peer_address_compare()
-					);
-
-				if (iter != m_peers.end() && (*iter)->address() == c.remote().address())
-				{
-					TORRENT_ASSERT((*iter)->in_use);
-					found = true;
-				}
-			}
-		}
-
-		// make sure the iterator we got is properly sorted relative
-		// to the connection's address
-//		TORRENT_ASSERT(m_peers.empty()
-//			|| (iter == m_peers.end() && (*(iter-1))->address() < c.remote().address())
-//			|| (iter != m_peers.end() && c.remote().address() < (*iter)->address())
-//			|| (iter != m_peers.end() && iter != m_peers.begin() && (*(iter-1))->address() < c.remote().address()));
+		int const idx = state->allow_multiple_connections_per_ip
+			? find_peer(c.remote())
+			: m_index.find(m_peers, c.remote().address());
 
-		if (found)
+		if (idx >= 0)
 		{
-			i = *iter;
+			i = m_peers[idx];
 			TORRENT_ASSERT(i->in_use);
 			TORRENT_ASSERT(i->connection != &c);
 			TORRENT_ASSERT(i->address() == c.remote().address());
@@ -780,11 +831,6 @@ namespace libtorrent {
 					c.disconnect(errors::too_many_connections, operation_t::bittorrent);
 					return false;
 				}
-				// restore it
-				iter = std::lower_bound(
-					m_peers.begin(), m_peers.end()
-					, c.remote().address(), peer_address_compare()
-				);
 			}
 
 
@@ -800,11 +846,17 @@ namespace libtorrent {
 				else
 					p = new (p) ipv4_peer(c.remote(), false, {});
 
-				iter = m_peers.insert(iter, p);
-
-				if (m_round_robin >= iter - m_peers.begin()) ++m_round_robin;
+				try
+				{
+					add_to_peers(p);
+				}
+				catch (std::exception const&)
+				{
+					m_peer_allocator.free_peer_entry(p);
+					return false;
+				}
 
-				i = *iter;
+				i = p;
 
 				i->source = static_cast<std::uint8_t>(peer_info::incoming);
 			}
@@ -844,13 +896,10 @@ namespace libtorrent {
 
 		if (state->allow_multiple_connections_per_ip)
 		{
-			auto const addr = p->address();
-			auto const range = find_peers(addr);
-			auto const i = std::find_if(range.first, range.second
-				, match_peer_endpoint(addr, std::uint16_t(port)));
-			if (i != range.second)
+			int const i = find_peer(tcp::endpoint(p->address(), std::uint16_t(port)));
+			if (i >= 0)
 			{
-				torrent_peer& pp = **i;
+				torrent_peer& pp = *m_peers[i];
 				TORRENT_ASSERT(pp.in_use);
 				if (pp.connection)
 				{
@@ -874,14 +923,13 @@ namespace libtorrent {
 					erase_peer(p, state);
 					return false;
 				}
-				erase_peer(i, state);
+				erase_peer(m_peers.begin() + i, state);
 			}
 		}
 #if TORRENT_USE_ASSERTS
 		else
 		{
-			std::pair<iterator, iterator> range = find_peers(p->address());
-			TORRENT_ASSERT(std::distance(range.first, range.second) == 1);
+			TORRENT_ASSERT(find_peers(p->address()).size() == 1);
 		}
 #endif
 
@@ -930,8 +978,7 @@ namespace libtorrent {
 	}
 
 	// this is an internal function
-	bool peer_list::insert_peer(torrent_peer* p, iterator iter
-		, pex_flags_t const flags
+	bool peer_list::insert_peer(torrent_peer* p, pex_flags_t const flags
 		, torrent_state* state)
 	{
 		TORRENT_ASSERT(is_single_thread());
@@ -948,18 +995,9 @@ namespace libtorrent {
 			erase_peers(state);
 			if (int(m_peers.size()) >= max_peerlist_size)
 				return false;
-
-			// since some peers were removed, we need to
-			// update the iterator to make it valid again
-
-			iter = std::lower_bound(
-				m_peers.begin(), m_peers.end()
-				, p->address(), peer_address_compare());
 		}
 
-		iter = m_peers.insert(iter, p);
-
-		if (m_round_robin >= iter - m_peers.begin()) ++m_round_robin;
+		add_to_peers(p);
 
 		if (flags & pex_seed)
 			p->maybe_upload_only = true;
@@ -1047,26 +1085,13 @@ namespace libtorrent {
 		if (remote_address.is_v6() && remote_address.to_v6().is_link_local())
 			return nullptr;
 
-		iterator iter;
 		torrent_peer* p = nullptr;
 
-		bool found = false;
-		if (state->allow_multiple_connections_per_ip)
-		{
-			auto const range = find_peers(remote_address);
-			iter = std::find_if(range.first, range.second
-				, match_peer_endpoint(remote_address, remote.port()));
-			if (iter != range.second) found = true;
-		}
-		else
-		{
-			iter = std::lower_bound(m_peers.begin(), m_peers.end()
-				, remote_address, peer_address_compare());
-
-			if (iter != m_peers.end() && (*iter)->address() == remote_address) found = true;
-		}
+		int const idx = state->allow_multiple_connections_per_ip
+			? find_peer(remote)
+			: m_index.find(m_peers, remote_address);
 
-		if (!found)
+		if (idx < 0)
 		{
 			// we don't have any info about this peer.
 			// add a new entry
@@ -1084,7 +1109,7 @@ namespace libtorrent {
 
 			try
 			{
-				if (!insert_peer(p, iter, flags, state))
+				if (!insert_peer(p, flags, state))
 				{
 					m_peer_allocator.free_peer_entry(p);
 					return nullptr;
@@ -1099,7 +1124,7 @@ namespace libtorrent {
 		}
 		else
 		{
-			p = *iter;
+			p = m_peers[idx];
 			TORRENT_ASSERT(p->in_use);
 			update_peer(p, src, flags, remote);
 			state->first_time_seen = false;
@@ -1116,14 +1141,16 @@ namespace libtorrent {
 		if (bool(m_finished) != state->is_finished)
 			recalculate_connect_candidates(state);
 
+		worse_candidate const cmp{bool(m_finished)};
+
 		// clear out any peers from the cache that no longer
 		// are connection candidates
-		for (auto i = m_candidate_cache.begin(); i != m_candidate_cache.end();)
+		auto const new_end = std::remove_if(m_candidate_cache.begin(), m_candidate_cache.end()
+			, [this](connect_candidate const& c) { return !is_connect_candidate(*c.peer); });
+		if (new_end != m_candidate_cache.end())
 		{
-			if (!is_connect_candidate(**i))
-				i = m_candidate_cache.erase(i);
-			else
-				++i;
+			m_candidate_cache.erase(new_end, m_candidate_cache.end());
+			std::make_heap(m_candidate_cache.begin(), m_candidate_cache.end(), cmp);
 		}
 
 		if (m_candidate_cache.empty())
@@ -1132,8 +1159,9 @@ namespace libtorrent {
 			if (m_candidate_cache.empty()) return nullptr;
 		}
 
-		torrent_peer* p = m_candidate_cache.front();
-		m_candidate_cache.erase(m_candidate_cache.begin());
+		std::pop_heap(m_candidate_cache.begin(), m_candidate_cache.end(), cmp);
+		torrent_peer* p = m_candidate_cache.back().peer;
+		m_candidate_cache.pop_back();
 
 		TORRENT_ASSERT(p->in_use);
 
@@ -1231,6 +1259,8 @@ namespace libtorrent {
 
 		m_num_connect_candidates = 0;
 		m_finished = state->is_finished;
+		// the heap order of the candidate cache depends on m_finished
+		m_candidate_cache.clear();
 		m_max_failcount = state->max_failcount;
 
 		m_num_connect_candidates += static_cast<int>(std::count_if(m_peers.begin(), m_peers.end()
@@ -1251,10 +1281,7 @@ namespace libtorrent {
 
 		TORRENT_ASSERT(c);
 
-		auto const iter = std::lower_bound(m_peers.begin(), m_peers.end()
-			, c->remote().address(), peer_address_compare());
-
-		if (iter != m_peers.end() && (*iter)->address() == c->remote().address())
+		if (m_index.find(m_peers, c->remote().address()) >= 0)
 			return true;
 
 		return std::any_of(m_peers.begin(), m_peers.end()
@@ -1273,22 +1300,21 @@ namespace libtorrent {
 		TORRENT_ASSERT(is_single_thread());
 		TORRENT_ASSERT(m_num_connect_candidates >= 0);
 		TORRENT_ASSERT(m_num_connect_candidates <= int(m_peers.size()));
+		TORRENT_ASSERT(m_index.size() == int(m_peers.size()));
+		TORRENT_ASSERT(m_num_v6_peers >= 0 && m_num_v6_peers <= int(m_peers.size()));
 
 #ifdef TORRENT_EXPENSIVE_INVARIANT_CHECKS
+		m_index.check_invariant(m_peers);
+
 		int connect_candidates = 0;
+		int v6_peers = 0;
 
-		const_iterator prev = m_peers.end();
-		for (const_iterator i = m_peers.begin(); i != m_peers.end(); ++i)
+		for (torrent_peer const* i : m_peers)
 		{
-			if (prev != m_peers.end()) ++prev;
-			if (i == m_peers.begin() + 1) prev = m_peers.begin();
-			if (prev != m_peers.end())
-			{
-				TORRENT_ASSERT(!((*i)->address() < (*prev)->address()));
-			}
-			torrent_peer const& p = **i;
+			torrent_peer const& p = *i;
 			TORRENT_ASSERT(p.in_use);
 			if (is_connect_candidate(p)) ++connect_candidates;
+			if (p.is_v6_addr) ++v6_peers;
 			if (!p.connection)
 			{
 				continue;
@@ -1303,6 +1329,7 @@ namespace libtorrent {
 		}
 
 		TORRENT_ASSERT(m_num_connect_candidates == connect_candidates);
+		TORRENT_ASSERT(m_num_v6_peers == v6_peers);
 #endif // TORRENT_EXPENSIVE_INVARIANT_CHECKS
 
 	}
@@ -32,15 +32,49 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "libtorrent/performance_counters.hpp"
+#include "libtorrent/aux_/latency_histogram.hpp"
 #include "libtorrent/assert.hpp"
 #include <cstring> // for memset
+#include <new> // for nothrow
 
 namespace libtorrent {
 
+	constexpr int counters::num_shards;
+
+#ifdef ATOMIC_LLONG_LOCK_FREE
+	struct alignas(64) counters::shard
+	{
+		shard()
+		{
+			for (auto& v : values) v.store(0, std::memory_order_relaxed);
+		}
+		aux::array<std::atomic<std::int64_t>, num_stats_counters> values;
+	};
+
+namespace {
+
+	// the shard the calling thread increments stats counters in. This is
+	// the same index for every counters object
+	int this_thread_shard()
+	{
+		static std::atomic<int> next_shard{0};
+		thread_local int const idx
+			= next_shard.fetch_add(1, std::memory_order_relaxed) % counters::num_shards;
+		return idx;
+	}
+}
+#endif
+
 	// TODO: move stats_counter_t out of counters
 	// TODO: should bittorrent keep-alive messages have a counter too?
 	// TODO: It would be nice if this could be an internal type. default_disk_constructor depends on it now
 	counters::counters() TORRENT_COUNTER_NOEXCEPT
+#ifdef ATOMIC_LLONG_LOCK_FREE
+		: m_shards(new (std::nothrow) shard[num_shards])
+		, m_histograms(new (std::nothrow) aux::latency_histogram[num_latency_histograms])
+#else
+		: m_histograms(new (std::nothrow) aux::latency_histogram[num_latency_histograms])
+#endif
 	{
 #ifdef ATOMIC_LLONG_LOCK_FREE
 		for (auto& counter : m_stats_counter)
@@ -50,17 +84,12 @@ namespace libtorrent {
 #endif
 	}
 
+	counters::~counters() = default;
+
 	counters::counters(counters const& c) TORRENT_COUNTER_NOEXCEPT
+		: counters()
 	{
-#ifdef ATOMIC_LLONG_LOCK_FREE
-		for (int i = 0; i < m_stats_counter.end_index(); ++i)
-			m_stats_counter[i].store(
-				c.m_stats_counter[i].load(std::memory_order_relaxed)
-					, std::memory_order_relaxed);
-#else
-		std::lock_guard<std::mutex> l(c.m_mutex);
-		m_stats_counter = c.m_stats_counter;
-#endif
+		*this = c;
 	}
 
 	counters& counters::operator=(counters const& c) & TORRENT_COUNTER_NOEXCEPT
@@ -68,9 +97,7 @@ namespace libtorrent {
 		if (&c == this) return *this;
 #ifdef ATOMIC_LLONG_LOCK_FREE
 		for (int i = 0; i < m_stats_counter.end_index(); ++i)
-			m_stats_counter[i].store(
-				c.m_stats_counter[i].load(std::memory_order_relaxed)
-					, std::memory_order_relaxed);
+			set_value(i, c[i]);
 #else
 		std::lock_guard<std::mutex> l(m_mutex);
 		std::lock_guard<std::mutex> l2(c.m_mutex);
@@ -85,7 +112,13 @@ namespace libtorrent {
 		TORRENT_ASSERT(i < num_counters);
 
 #ifdef ATOMIC_LLONG_LOCK_FREE
-		return m_stats_counter[i].load(std::memory_order_relaxed);
+		std::int64_t ret = m_stats_counter[i].load(std::memory_order_relaxed);
+		if (i < num_stats_counters && m_shards)
+		{
+			for (int s = 0; s < num_shards; ++s)
+				ret += m_shards[s].values[i].load(std::memory_order_relaxed);
+		}
+		return ret;
 #else
 		std::lock_guard<std::mutex> l(m_mutex);
 		return m_stats_counter[i];
@@ -104,7 +137,10 @@ namespace libtorrent {
 		TORRENT_ASSERT(c < num_counters);
 
 #ifdef ATOMIC_LLONG_LOCK_FREE
-		std::int64_t pv = m_stats_counter[c].fetch_add(value, std::memory_order_relaxed);
+		std::atomic<std::int64_t>& cnt = (c < num_stats_counters && m_shards)
+			? m_shards[this_thread_shard()].values[c]
+			: m_stats_counter[c];
+		std::int64_t pv = cnt.fetch_add(value, std::memory_order_relaxed);
 		TORRENT_ASSERT(pv + value >= 0);
 		return pv + value;
 #else
@@ -145,6 +181,15 @@ namespace libtorrent {
 		TORRENT_ASSERT(c < num_counters);
 
 #ifdef ATOMIC_LLONG_LOCK_FREE
+		// empty the shards before storing the base value. An increment racing
+		// with this either lands before the exchange and is overwritten by
+		// the new value, or after it and is added to the new value. Zeroing
+		// the shards after the store would lose it
+		if (c < num_stats_counters && m_shards)
+		{
+			for (int s = 0; s < num_shards; ++s)
+				m_shards[s].values[c].exchange(0, std::memory_order_relaxed);
+		}
 		m_stats_counter[c].store(value);
 #else
 		std::lock_guard<std::mutex> l(m_mutex);
@@ -157,4 +202,31 @@ namespace libtorrent {
 #endif
 	}
 
+	void counters::record_latency(latency_histogram_t const h
+		, std::int64_t const microseconds) TORRENT_COUNTER_NOEXCEPT
+	{
+		TORRENT_ASSERT(h >= 0);
+		TORRENT_ASSERT(h < num_latency_histograms);
+		if (!m_histograms) return;
+		m_histograms[h].record(microseconds);
+	}
+
+	void counters::update_latency_percentiles() TORRENT_COUNTER_NOEXCEPT
+	{
+		static_assert(piece_download_time_p50 == disk_job_latency_p50 + 3 * piece_download_time_histogram
+			, "latency gauges must be in the same order as latency_histogram_t");
+		static_assert(alert_queue_delay_p50 == disk_job_latency_p50 + 3 * alert_queue_delay_histogram
+			, "latency gauges must be in the same order as latency_histogram_t");
+
+		if (!m_histograms) return;
+		for (int h = 0; h < num_latency_histograms; ++h)
+		{
+			auto const p = m_histograms[h].snapshot();
+			if (p.samples == 0) continue;
+			int const first = disk_job_latency_p50 + 3 * h;
+			set_value(first, p.p50);
+			set_value(first + 1, p.p99);
+			set_value(first + 2, p.p999);
+		}
+	}
 }
@@ -0,0 +1,249 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/piece_hash_pipeline.hpp"
+#include "libtorrent/file_storage.hpp"
+#include "libtorrent/file.hpp" // for file_handle, pread_all
+#include "libtorrent/hasher.hpp"
+#include "libtorrent/error.hpp"
+#include "libtorrent/aux_/open_mode.hpp"
+#include "libtorrent/aux_/scope_end.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace libtorrent {
+namespace aux {
+
+namespace {
+
+	// a run of consecutive pieces, read in one pass over the files
+	struct piece_batch
+	{
+		piece_index_t first{0};
+		int num_pieces = 0;
+		std::vector<char> buffer;
+	};
+
+	// reads the files of a torrent front to back, keeping the current file
+	// open between calls
+	struct sequential_reader
+	{
+		sequential_reader(file_storage const& fs, std::string const& save_path)
+			: m_fs(fs), m_save_path(save_path) {}
+
+		// fills ``buf`` with the content of the torrent, starting at the
+		// first byte of ``piece``
+		void read(piece_index_t const piece, span<char> buf, error_code& ec)
+		{
+			for (file_slice const& s : m_fs.map_block(piece, 0, buf.size()))
+			{
+				if (s.file_index != m_file_index)
+				{
+					open(s.file_index, ec);
+					if (ec) return;
+				}
+
+				span<char> const dst = buf.first(s.size);
+				int const ret = pread_all(m_file.fd(), dst, s.offset, ec);
+				if (ec) return;
+				if (ret < dst.size())
+				{
+					ec = errors::file_too_short;
+					return;
+				}
+				buf = buf.subspan(s.size);
+			}
+		}
+
+	private:
+
+		void open(file_index_t const f, error_code& ec)
+		{
+			try
+			{
+				m_file = file_handle(m_fs.file_path(f, m_save_path), 0
+					, open_mode::read_only | open_mode::no_atime);
+			}
+			catch (storage_error const& e)
+			{
+				ec = e.ec;
+				m_file_index = file_index_t{-1};
+				return;
+			}
+			m_file_index = f;
+
+#if (TORRENT_HAS_FADVISE && defined POSIX_FADV_SEQUENTIAL)
+			// we read every file exactly once, front to back. Ask for more
+			// aggressive read-ahead
+			::posix_fadvise(m_file.fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+		}
+
+		file_storage const& m_fs;
+		std::string const& m_save_path;
+		file_handle m_file;
+		file_index_t m_file_index{-1};
+	};
+}
+
+	void hash_pieces(file_storage const& fs, std::string const& save_path
+		, int const num_threads, std::int64_t const readahead
+		, std::function<void(piece_index_t, sha1_hash const&)> const& on_piece
+		, std::atomic<bool> const* cancel, error_code& ec)
+	{
+		ec.clear();
+		TORRENT_ASSERT(num_threads > 0);
+
+		int const num_pieces = fs.num_pieces();
+		int const piece_length = fs.piece_length();
+
+		// small pieces are read several at a time, to keep the reads large
+		int const pieces_per_batch = std::max(1, 1024 * 1024 / piece_length);
+		std::int64_t const batch_size = std::int64_t(pieces_per_batch) * piece_length;
+
+		// every hasher thread should have a batch to work on while the next
+		// one is being read, as far as the readahead allows. Two batches are
+		// the minimum to overlap reading and hashing at all
+		int const max_batches = (num_pieces + pieces_per_batch - 1) / pieces_per_batch;
+		int const num_batches = int(std::min(std::int64_t(max_batches)
+			, std::max(std::int64_t(2)
+				, std::min(std::int64_t(num_threads) + 1, readahead / batch_size))));
+
+		std::mutex mutex;
+		// signalled when there's a batch to hash, or when it's time to quit
+		std::condition_variable hash_cond;
+		// signalled when a batch has been hashed
+		std::condition_variable done_cond;
+
+		std::vector<piece_batch> batches(static_cast<std::size_t>(num_batches));
+		std::vector<piece_batch*> free_batches;
+		for (auto& b : batches) free_batches.push_back(&b);
+		std::deque<piece_batch*> queued;
+
+		// hashed pieces that have not been reported to on_piece yet
+		std::vector<std::pair<piece_index_t, sha1_hash>> done;
+		bool quit = false;
+
+		auto hash_loop = [&]
+		{
+			std::vector<std::pair<piece_index_t, sha1_hash>> hashes;
+			std::unique_lock<std::mutex> l(mutex);
+			for (;;)
+			{
+				hash_cond.wait(l, [&] { return quit || !queued.empty(); });
+				if (quit) return;
+				piece_batch* const b = queued.front();
+				queued.pop_front();
+				l.unlock();
+
+				hashes.clear();
+				char const* ptr = b->buffer.data();
+				for (int i = 0; i < b->num_pieces; ++i)
+				{
+					piece_index_t const p = b->first + piece_index_t::diff_type(i);
+					int const size = fs.piece_size(p);
+					hashes.emplace_back(p, hasher(ptr, size).final());
+					ptr += size;
+				}
+
+				l.lock();
+				done.insert(done.end(), hashes.begin(), hashes.end());
+				free_batches.push_back(b);
+				done_cond.notify_one();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		auto const join = aux::scope_end([&]
+		{
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				quit = true;
+			}
+			hash_cond.notify_all();
+			for (auto& t : threads) t.join();
+		});
+		for (int i = 0; i < num_threads; ++i)
+			threads.emplace_back(hash_loop);
+
+		sequential_reader reader(fs, save_path);
+		piece_index_t next_piece(0);
+		int completed = 0;
+		std::vector<std::pair<piece_index_t, sha1_hash>> report;
+		while (completed < num_pieces)
+		{
+			piece_batch* b = nullptr;
+			{
+				std::unique_lock<std::mutex> l(mutex);
+				done_cond.wait(l, [&] { return !done.empty()
+					|| (next_piece < fs.end_piece() && !free_batches.empty()); });
+				report.swap(done);
+				if (next_piece < fs.end_piece() && !free_batches.empty())
+				{
+					b = free_batches.back();
+					free_batches.pop_back();
+				}
+			}
+
+			for (auto const& p : report) on_piece(p.first, p.second);
+			completed += int(report.size());
+			report.clear();
+
+			if (cancel != nullptr && *cancel) return;
+			if (b == nullptr) continue;
+
+			b->first = next_piece;
+			b->num_pieces = std::min(pieces_per_batch, num_pieces - static_cast<int>(next_piece));
+			std::int64_t const start = static_cast<int>(b->first) * std::int64_t(piece_length);
+			std::int64_t const end = std::min(fs.total_size()
+				, start + std::int64_t(b->num_pieces) * piece_length);
+			b->buffer.resize(std::size_t(end - start));
+
+			reader.read(b->first, b->buffer, ec);
+			if (ec) return;
+			next_piece += piece_index_t::diff_type(b->num_pieces);
+
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				queued.push_back(b);
+			}
+			hash_cond.notify_one();
+		}
+	}
+}
+}
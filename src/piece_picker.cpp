@@ -130,6 +130,7 @@ namespace libtorrent {
 	constexpr picker_options_t piece_picker::on_parole;
 	constexpr picker_options_t piece_picker::prioritize_partials;
 	constexpr picker_options_t piece_picker::sequential;
+	constexpr picker_options_t piece_picker::sequential_window;
 	constexpr picker_options_t piece_picker::align_expanded_pieces;
 	constexpr picker_options_t piece_picker::piece_extent_affinity;
 
@@ -186,6 +187,8 @@ namespace libtorrent {
 		m_piece_map.resize(num_pieces, piece_pos(0, 0));
 		m_reverse_cursor = m_piece_map.end_index();
 		m_cursor = piece_index_t(0);
+		m_window_cursor = std::min(m_window_cursor, m_piece_map.end_index());
+		m_window_first = m_window_cursor;
 
 		for (auto& c : m_downloads) c.clear();
 		m_block_info.clear();
@@ -217,10 +220,32 @@ namespace libtorrent {
 			m_reverse_cursor > piece_index_t(0) && (i->have() || i->filtered());
 			++i, --m_reverse_cursor);
 
+		advance_window_first();
+
 		m_blocks_in_last_piece = aux::numeric_cast<std::uint16_t>(blocks_in_last_piece);
 		if (m_blocks_in_last_piece == 0) m_blocks_in_last_piece = aux::numeric_cast<std::uint16_t>(blocks_per_piece());
 
 		TORRENT_ASSERT(m_blocks_in_last_piece <= blocks_per_piece());
+
+		rebuild_interest_masks();
+	}
+
+	void piece_picker::set_sequential_window(piece_index_t const cursor
+		, int const num_pieces)
+	{
+		m_window_cursor = std::max(piece_index_t(0)
+			, std::min(cursor, m_piece_map.end_index()));
+		m_window_pieces = std::max(num_pieces, 0);
+		m_window_first = m_window_cursor;
+		advance_window_first();
+	}
+
+	void piece_picker::advance_window_first()
+	{
+		while (m_window_first < m_piece_map.end_index()
+			&& (m_piece_map[m_window_first].have()
+			|| m_piece_map[m_window_first].filtered()))
+			++m_window_first;
 	}
 
 	void piece_picker::piece_info(piece_index_t const index, piece_picker::downloading_piece& st) const
@@ -298,6 +323,7 @@ namespace libtorrent {
 		TORRENT_ASSERT(block_index >= 0);
 		TORRENT_ASSERT(block_index < std::numeric_limits<std::uint16_t>::max());
 		ret.info_idx = std::uint16_t(block_index);
+		ret.started = clock_type::now();
 		TORRENT_ASSERT(int(ret.info_idx) * blocks_per_piece()
 			+ blocks_per_piece() <= int(m_block_info.size()));
 
@@ -357,6 +383,9 @@ namespace libtorrent {
 		m_free_block_infos.push_back(i->info_idx);
 
 		TORRENT_ASSERT(find_dl_piece(download_state, i->index) == i);
+		// if the piece passed the hash check but isn't flushed yet, it no
+		// longer counts as passed once it leaves the download queue
+		if (!m_piece_map[i->index].have()) m_passed_mask.clear_bit(i->index);
 		m_piece_map[i->index].state(piece_pos::piece_open);
 		m_downloads[download_state].erase(i);
 
@@ -584,6 +613,8 @@ namespace libtorrent {
 		TORRENT_ASSERT(m_reverse_cursor > m_cursor
 			|| (m_cursor == m_piece_map.end_index()
 				&& m_reverse_cursor == piece_index_t(0)));
+		TORRENT_ASSERT(m_window_first >= m_window_cursor);
+		TORRENT_ASSERT(m_window_first <= m_piece_map.end_index());
 
 		if (!m_dirty)
 		{
@@ -622,6 +653,20 @@ namespace libtorrent {
 			}
 		}
 
+		for (auto const i : m_piece_map.range())
+		{
+			piece_pos const& p = m_piece_map[i];
+			TORRENT_ASSERT(m_wanted_mask.get_bit(i) == !p.filtered());
+			bool passed = p.have();
+			if (!passed && p.download_queue() != piece_pos::piece_open)
+			{
+				auto const dp = find_dl_piece(p.download_queue(), i);
+				passed = dp != m_downloads[p.download_queue()].end()
+					&& dp->passed_hash_check;
+			}
+			TORRENT_ASSERT(m_passed_mask.get_bit(i) == passed);
+		}
+
 		int num_filtered = 0;
 		int num_have_filtered = 0;
 		int num_have = 0;
@@ -1615,6 +1660,7 @@ namespace libtorrent {
 
 		TORRENT_ASSERT(!i->passed_hash_check);
 		i->passed_hash_check = true;
+		m_passed_mask.set_bit(index);
 		++m_num_passed;
 
 		if (i->finished < blocks_in_piece(index)) return;
@@ -1672,12 +1718,15 @@ namespace libtorrent {
 				m_reverse_cursor = piece_index_t(0);
 				m_cursor = m_piece_map.end_index();
 			}
+			if (index >= m_window_cursor && index < m_window_first)
+				m_window_first = index;
 		}
 
 		--m_num_have;
 		m_have_pad_bytes -= pad_bytes_in_piece(index);
 		TORRENT_ASSERT(m_have_pad_bytes >= 0);
 		p.set_not_have();
+		m_passed_mask.clear_bit(index);
 
 		if (m_dirty) return;
 		if (p.priority(this) >= 0) add(index);
@@ -1730,6 +1779,7 @@ namespace libtorrent {
 		m_have_pad_bytes += pad_bytes_in_piece(index);
 		TORRENT_ASSERT(m_have_pad_bytes <= num_pad_bytes());
 		p.set_have();
+		m_passed_mask.set_bit(index);
 		if (m_cursor == prev(m_reverse_cursor)
 			&& m_cursor == index)
 		{
@@ -1757,6 +1807,7 @@ namespace libtorrent {
 		}
 		TORRENT_ASSERT(m_reverse_cursor > m_cursor
 			|| (m_cursor == m_piece_map.end_index() && m_reverse_cursor == piece_index_t(0)));
+		if (m_window_first == index) advance_window_first();
 		if (priority == -1) return;
 		if (m_dirty) return;
 		remove(priority, info_index);
@@ -1783,6 +1834,7 @@ namespace libtorrent {
 		m_filtered_pad_bytes = 0;
 		m_cursor = m_piece_map.end_index();
 		m_reverse_cursor = piece_index_t{0};
+		m_window_first = m_piece_map.end_index();
 		m_num_passed = num_pieces();
 		m_num_have = num_pieces();
 
@@ -1792,6 +1844,7 @@ namespace libtorrent {
 			p.set_have();
 			p.state(piece_pos::piece_open);
 		}
+		m_passed_mask.set_all();
 	}
 
 	bool piece_picker::set_piece_priority(piece_index_t const index
@@ -1853,6 +1906,7 @@ namespace libtorrent {
 						|| m_piece_map[prev(m_reverse_cursor)].filtered()))
 						--m_reverse_cursor;
 				}
+				if (m_window_first == index) advance_window_first();
 			}
 			ret = true;
 		}
@@ -1881,6 +1935,8 @@ namespace libtorrent {
 					m_reverse_cursor = piece_index_t(0);
 					m_cursor = m_piece_map.end_index();
 				}
+				if (index >= m_window_cursor && index < m_window_first)
+					m_window_first = index;
 			}
 			ret = true;
 		}
@@ -1888,6 +1944,8 @@ namespace libtorrent {
 		TORRENT_ASSERT(m_num_have_filtered >= 0);
 
 		p.piece_priority = static_cast<std::uint8_t>(new_piece_priority);
+		if (p.filtered()) m_wanted_mask.clear_bit(index);
+		else m_wanted_mask.set_bit(index);
 		int const new_priority = p.priority(this);
 
 		if (prev_priority != new_priority && !m_dirty)
@@ -2019,6 +2077,8 @@ namespace {
 		// only one of rarest_first and sequential can be set.
 		TORRENT_ASSERT(((options & rarest_first) ? 1 : 0)
 			+ ((options & sequential) ? 1 : 0) <= 1);
+		// the window is only picked in order ahead of non-sequential picking
+		TORRENT_ASSERT(!(options & sequential) || !(options & sequential_window));
 #ifdef TORRENT_EXPENSIVE_INVARIANT_CHECKS
 		INVARIANT_CHECK;
 #endif
@@ -2124,6 +2184,36 @@ namespace {
 			}
 		}
 
+		// the pieces in [m_window_first, window_end) are picked from in
+		// order with the sequential_window option, the rarest first and
+		// random picking below skip them. Peers picking without the option
+		// (snubbed ones) skip them too, they are left to the faster peers
+		piece_index_t window_end = m_window_first;
+		if (!(options & sequential))
+		{
+			int left = m_window_pieces;
+			for (piece_index_t i = m_window_first;
+				i < m_piece_map.end_index() && left > 0; ++i)
+			{
+				window_end = next(i);
+				if (m_piece_map[i].have() || m_piece_map[i].filtered()) continue;
+				--left;
+				if (!(options & sequential_window)) continue;
+				if (!is_piece_free(i, pieces)) continue;
+
+				ret |= picker_log_alert::window_pieces;
+
+				num_blocks = add_blocks(i, pieces
+					, interesting_blocks, backup_blocks
+					, backup_blocks2, num_blocks
+					, prefer_contiguous_blocks, peer, ignored_pieces
+					, options);
+				if (num_blocks <= 0) return ret;
+			}
+		}
+		auto const in_window = [&](piece_index_t const i)
+		{ return i >= m_window_first && i < window_end; };
+
 		if (options & sequential)
 		{
 			if (m_dirty) update_pieces();
@@ -2201,6 +2291,7 @@ namespace {
 						pc.inc_stats_counter(counters::piece_picker_reverse_rare_loops);
 
 						if (!is_piece_free(m_pieces[p], pieces)) continue;
+						if (in_window(m_pieces[p])) continue;
 
 						ret |= picker_log_alert::reverse_rarest_first;
 
@@ -2229,6 +2320,7 @@ namespace {
 						{
 							if (!m_piece_map[p].have()) have_all = false;
 							if (!is_piece_free(p, pieces)) continue;
+							if (in_window(p)) continue;
 
 							ret |= picker_log_alert::extent_affinity;
 
@@ -2255,6 +2347,7 @@ namespace {
 					pc.inc_stats_counter(counters::piece_picker_rare_loops);
 
 					if (!is_piece_free(i, pieces)) continue;
+					if (in_window(i)) continue;
 
 					ret |= picker_log_alert::rarest_first;
 
@@ -2279,7 +2372,8 @@ namespace {
 			{
 				// skip pieces we can't pick, and suggested pieces
 				// since we've already picked those
-				while (!is_piece_free(piece, pieces) || contains(ignored_pieces, piece))
+				while (!is_piece_free(piece, pieces) || contains(ignored_pieces, piece)
+					|| in_window(piece))
 				{
 					pc.inc_stats_counter(counters::piece_picker_rand_start_loops);
 					++piece;
@@ -2868,6 +2962,24 @@ get_out:
 		return {start, end};
 	}
 
+	std::size_t piece_picker::memory_usage() const
+	{
+		std::size_t ret = sizeof(*this)
+			+ m_piece_map.capacity() * sizeof(piece_pos)
+			+ m_pieces.capacity() * sizeof(piece_index_t)
+			+ m_priority_boundaries.capacity() * sizeof(prio_index_t)
+			+ m_block_info.capacity() * sizeof(block_info)
+			+ m_free_block_infos.capacity() * sizeof(std::uint16_t)
+			+ m_recent_extents.capacity() * sizeof(piece_extent_t)
+			// a hash node holds the value and a next pointer, plus a bucket
+			+ m_pads_in_piece.size() * (sizeof(std::pair<piece_index_t const, int>) + sizeof(void*))
+			+ m_pads_in_piece.bucket_count() * sizeof(void*)
+			+ std::size_t(m_wanted_mask.num_words() + m_passed_mask.num_words()) * 4;
+		for (auto const& q : m_downloads)
+			ret += q.capacity() * sizeof(downloading_piece);
+		return ret;
+	}
+
 	bool piece_picker::is_piece_finished(piece_index_t const index) const
 	{
 		piece_pos const& p = m_piece_map[index];
@@ -2934,6 +3046,54 @@ get_out:
 		return bool(i->passed_hash_check);
 	}
 
+	time_point piece_picker::download_start(piece_index_t const index) const
+	{
+		TORRENT_ASSERT(index < m_piece_map.end_index());
+		TORRENT_ASSERT(index >= piece_index_t(0));
+
+		auto const state = m_piece_map[index].download_queue();
+		if (state == piece_pos::piece_open) return time_point();
+		auto const i = find_dl_piece(state, index);
+		if (i == m_downloads[state].end()) return time_point();
+		return i->started;
+	}
+
+	typed_bitfield<piece_index_t> const& piece_picker::wanted_pieces() const
+	{
+		return m_wanted_mask;
+	}
+
+	typed_bitfield<piece_index_t> const& piece_picker::passed_pieces() const
+	{
+		return m_passed_mask;
+	}
+
+	void piece_picker::rebuild_interest_masks()
+	{
+		int const num = num_pieces();
+		m_wanted_mask.resize(num);
+		m_passed_mask.resize(num);
+		m_wanted_mask.clear_all();
+		m_passed_mask.clear_all();
+
+		for (auto const i : m_piece_map.range())
+		{
+			piece_pos const& p = m_piece_map[i];
+			if (p.piece_priority != piece_pos::filter_priority)
+				m_wanted_mask.set_bit(i);
+			if (p.index == piece_pos::we_have_index)
+				m_passed_mask.set_bit(i);
+		}
+
+		// pieces that passed the hash check but haven't been flushed to
+		// disk yet are still in the download queue
+		for (auto const& queue : m_downloads)
+		{
+			for (auto const& dp : queue)
+				if (dp.passed_hash_check) m_passed_mask.set_bit(dp.index);
+		}
+	}
+
 	std::vector<piece_picker::downloading_piece>::iterator piece_picker::find_dl_piece(
 		download_queue_t const queue, piece_index_t const index)
 	{
@@ -3474,6 +3634,7 @@ get_out:
 			// but it seems reasonable to not break the
 			// accounting over it.
 			i->passed_hash_check = false;
+			m_passed_mask.clear_bit(piece);
 			TORRENT_ASSERT(m_num_passed > 0);
 			--m_num_passed;
 		}
@@ -3526,6 +3687,7 @@ get_out:
 			// some of the blocks to disk, which means we
 			// can't consider the piece complete
 			i->passed_hash_check = false;
+			m_passed_mask.clear_bit(block.piece_index);
 			TORRENT_ASSERT(m_num_passed > 0);
 			--m_num_passed;
 		}
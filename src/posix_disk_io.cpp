@@ -123,6 +123,7 @@ namespace {
 				m_stats_counters.inc_stats_counter(counters::num_read_ops);
 				m_stats_counters.inc_stats_counter(counters::disk_read_time, read_time);
 				m_stats_counters.inc_stats_counter(counters::disk_job_time, read_time);
+				m_stats_counters.record_latency(counters::disk_job_latency_histogram, read_time);
 			}
 
 			post(m_ios, [h = std::move(handler), b = std::move(buffer), error] () mutable
@@ -149,6 +150,7 @@ namespace {
 				m_stats_counters.inc_stats_counter(counters::num_write_ops);
 				m_stats_counters.inc_stats_counter(counters::disk_write_time, write_time);
 				m_stats_counters.inc_stats_counter(counters::disk_job_time, write_time);
+				m_stats_counters.record_latency(counters::disk_job_latency_histogram, write_time);
 			}
 
 			post(m_ios, [=, h = std::move(handler)]{ h(error); });
@@ -214,6 +216,7 @@ namespace {
 				m_stats_counters.inc_stats_counter(counters::num_read_ops, blocks_to_read);
 				m_stats_counters.inc_stats_counter(counters::disk_hash_time, read_time);
 				m_stats_counters.inc_stats_counter(counters::disk_job_time, read_time);
+				m_stats_counters.record_latency(counters::disk_job_latency_histogram, read_time);
 			}
 
 			post(m_ios, [=, h = std::move(handler)]{ h(piece, hash, error); });
@@ -262,6 +262,7 @@ namespace {
 
 
 		apply_flag(ret.flags, rd, "sequential_download", torrent_flags::sequential_download);
+		apply_flag(ret.flags, rd, "sequential_window", torrent_flags::sequential_window);
 		apply_flag(ret.flags, rd, "stop_when_ready", torrent_flags::stop_when_ready);
 		apply_flag(ret.flags, rd, "disable_lsd", torrent_flags::disable_lsd);
 		apply_flag(ret.flags, rd, "disable_pex", torrent_flags::disable_pex);
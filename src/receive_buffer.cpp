@@ -41,8 +41,25 @@ POSSIBILITY OF SUCH DAMAGE.
 namespace libtorrent {
 namespace aux {
 
+receive_buffer::~receive_buffer()
+{
+	if (m_pool) m_pool->release(std::move(m_recv_buffer));
+}
+
+void receive_buffer::reallocate(int const size, span<char const> const init)
+{
+	TORRENT_ASSERT(init.size() <= size);
+	buffer new_buffer = m_pool ? m_pool->allocate(size) : buffer(size);
+	if (!init.empty())
+		std::copy(init.begin(), init.end(), new_buffer.data());
+	if (m_pool) m_pool->release(std::move(m_recv_buffer));
+	m_recv_buffer = std::move(new_buffer);
+}
+
 int receive_buffer::max_receive() const
 {
+	if (m_disk_recv_start > 0)
+		return m_packet_size - m_disk_recv_start - m_disk_recv_end;
 	return int(m_recv_buffer.size()) - m_recv_end;
 }
 
@@ -55,11 +72,19 @@ span<char> receive_buffer::reserve(int const size)
 	// normalize() must be called before receiving more data
 	TORRENT_ASSERT(m_recv_start == 0);
 
+	if (m_disk_recv_buffer)
+	{
+		// never read past the end of the payload, bytes of the next message
+		// must not end up in the disk buffer
+		int const n = std::min(size, max_receive());
+		TORRENT_ASSERT(n > 0);
+		return {m_disk_recv_buffer.data() + m_disk_recv_end, n};
+	}
+
 	if (int(m_recv_buffer.size()) < m_recv_end + size)
 	{
 		int const new_size = std::max(m_recv_end + size, m_packet_size);
-		buffer new_buffer(new_size, {m_recv_buffer.data(), m_recv_end});
-		m_recv_buffer = std::move(new_buffer);
+		reallocate(new_size, {m_recv_buffer.data(), m_recv_end});
 
 		// since we just increased the size of the buffer, reset the watermark to
 		// start at our new size (avoid flapping the buffer size)
@@ -80,8 +105,7 @@ void receive_buffer::grow(int const limit)
 		? m_packet_size : std::min(current_size * 3 / 2, limit);
 
 	// re-allocate the buffer and copy over the part of it that's used
-	buffer new_buffer(new_size, {m_recv_buffer.data(), m_recv_end});
-	m_recv_buffer = std::move(new_buffer);
+	reallocate(new_size, {m_recv_buffer.data(), m_recv_end});
 
 	// since we just increased the size of the buffer, reset the watermark to
 	// start at our new size (avoid flapping the buffer size)
@@ -103,6 +127,7 @@ int receive_buffer::advance_pos(int const bytes)
 void receive_buffer::cut(int const size, int const packet_size, int const offset)
 {
 	INVARIANT_CHECK;
+	TORRENT_ASSERT(m_disk_recv_start == 0);
 	TORRENT_ASSERT(packet_size > 0);
 	TORRENT_ASSERT(int(m_recv_buffer.size()) >= size);
 	TORRENT_ASSERT(int(m_recv_buffer.size()) >= m_recv_pos);
@@ -148,10 +173,60 @@ span<char const> receive_buffer::get() const
 		return {};
 	}
 
+	if (m_disk_recv_start > 0)
+	{
+		// the payload lives in the disk buffer, only return the header
+		return span<char const>(m_recv_buffer).subspan(m_recv_start
+			, std::min(m_recv_pos, m_disk_recv_start));
+	}
+
 	TORRENT_ASSERT(m_recv_start + m_recv_pos <= int(m_recv_buffer.size()));
 	return span<char const>(m_recv_buffer).subspan(m_recv_start, m_recv_pos);
 }
 
+bool receive_buffer::assign_disk_buffer(disk_buffer_holder buf, int const payload_size)
+{
+	INVARIANT_CHECK;
+	TORRENT_ASSERT(buf);
+	TORRENT_ASSERT(!m_disk_recv_buffer);
+	TORRENT_ASSERT(m_disk_recv_start == 0);
+	TORRENT_ASSERT(payload_size > 0);
+	TORRENT_ASSERT(buf.size() >= payload_size);
+
+	int const header_size = m_packet_size - payload_size;
+	TORRENT_ASSERT(header_size > 0);
+
+	// we can only switch if the whole header has been received and there are
+	// no bytes buffered past the read cursor. Those could belong to the next
+	// message
+	if (m_recv_pos < header_size
+		|| m_recv_pos >= m_packet_size
+		|| m_recv_end - m_recv_start != m_recv_pos)
+		return false;
+
+	int const payload_received = m_recv_pos - header_size;
+	if (payload_received > 0)
+	{
+		std::memcpy(buf.data(), m_recv_buffer.data() + m_recv_start + header_size
+			, std::size_t(payload_received));
+	}
+
+	m_recv_end = m_recv_start + header_size;
+	m_disk_recv_start = header_size;
+	m_disk_recv_end = payload_received;
+	m_disk_recv_buffer = std::move(buf);
+	return true;
+}
+
+disk_buffer_holder receive_buffer::release_disk_buffer()
+{
+	TORRENT_ASSERT(packet_finished());
+	TORRENT_ASSERT(m_disk_recv_buffer);
+	// m_disk_recv_start is left set, to have get() keep returning just the
+	// header. reset() clears it
+	return std::move(m_disk_recv_buffer);
+}
+
 
 
 // the purpose of this function is to free up and cut off all messages
@@ -177,13 +252,11 @@ void receive_buffer::normalize(int const force_shrink)
 	{
 		int const target_size = std::max(std::max(force_shrink
 			, int(bytes_to_shift.size())), m_packet_size);
-		buffer new_buffer(target_size, bytes_to_shift);
-		m_recv_buffer = std::move(new_buffer);
+		reallocate(target_size, bytes_to_shift);
 	}
 	else if (shrink_buffer)
 	{
-		buffer new_buffer(m_watermark.mean(), bytes_to_shift);
-		m_recv_buffer = std::move(new_buffer);
+		reallocate(int(m_watermark.mean()), bytes_to_shift);
 	}
 	else if (m_recv_end > m_recv_start
 		&& m_recv_start > 0)
@@ -205,6 +278,23 @@ void receive_buffer::reset(int const packet_size)
 	INVARIANT_CHECK;
 	TORRENT_ASSERT(int(m_recv_buffer.size()) >= m_recv_end);
 	TORRENT_ASSERT(packet_size > 0);
+
+	if (m_disk_recv_start > 0)
+	{
+		// the payload was received into a disk buffer. Reads were never
+		// allowed past the end of the packet, so there's nothing else in the
+		// receive buffer to keep
+		TORRENT_ASSERT(m_recv_end - m_recv_start == m_disk_recv_start);
+		m_disk_recv_buffer.reset();
+		m_disk_recv_start = 0;
+		m_disk_recv_end = 0;
+		m_recv_pos = 0;
+		m_recv_start = 0;
+		m_recv_end = 0;
+		m_packet_size = packet_size;
+		return;
+	}
+
 	if (m_recv_end > m_packet_size)
 	{
 		cut(m_packet_size, packet_size);
@@ -217,7 +307,25 @@ void receive_buffer::reset(int const packet_size)
 	m_packet_size = packet_size;
 }
 
+bool receive_buffer::release_idle()
+{
+	INVARIANT_CHECK;
+
+	// normalize() must be called first
+	TORRENT_ASSERT(m_recv_start == 0);
 
+	// a message larger than the idle buffer is in flight
+	if (m_disk_recv_start > 0
+		|| m_recv_end > idle_buffer_size
+		|| m_packet_size > idle_buffer_size)
+		return false;
+
+	if (capacity() <= idle_buffer_size) return false;
+
+	reallocate(idle_buffer_size, {m_recv_buffer.data(), m_recv_end});
+	m_watermark = {};
+	return true;
+}
 
 } // namespace aux
 } // namespace libtorrent
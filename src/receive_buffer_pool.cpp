@@ -0,0 +1,167 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/receive_buffer_pool.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/assert.hpp"
+
+namespace libtorrent {
+namespace aux {
+
+namespace {
+
+	// the smallest n such that (1 << n) >= size
+	int ceil_log2(std::ptrdiff_t const size)
+	{
+		int ret = 0;
+		while ((std::ptrdiff_t(1) << ret) < size) ++ret;
+		return ret;
+	}
+
+	// the largest n such that (1 << n) <= size
+	int floor_log2(std::ptrdiff_t size)
+	{
+		int ret = -1;
+		while (size > 0)
+		{
+			size >>= 1;
+			++ret;
+		}
+		return ret;
+	}
+}
+
+	constexpr int receive_buffer_pool::min_class_shift;
+	constexpr int receive_buffer_pool::max_class_shift;
+	constexpr int receive_buffer_pool::num_size_classes;
+
+	receive_buffer_pool::receive_buffer_pool(counters& cnt)
+		: m_counters(cnt)
+	{}
+
+	receive_buffer_pool::~receive_buffer_pool()
+	{
+		// all borrowed buffers are expected to have been returned by now
+		TORRENT_ASSERT(m_in_use_bytes == 0);
+	}
+
+	buffer receive_buffer_pool::allocate(int const size)
+	{
+		TORRENT_ASSERT(size > 0);
+		int const shift = std::max(ceil_log2(size), min_class_shift);
+
+		if (shift > max_class_shift)
+		{
+			// too big to be pooled
+			buffer ret(size);
+			m_in_use_bytes += ret.size();
+			update_counters();
+			return ret;
+		}
+
+		auto& free_list = m_free[shift - min_class_shift];
+		if (!free_list.empty())
+		{
+			buffer ret = std::move(free_list.back());
+			free_list.pop_back();
+			m_pooled_bytes -= ret.size();
+			m_in_use_bytes += ret.size();
+			m_counters.inc_stats_counter(counters::recv_buffer_pool_hits);
+			update_counters();
+			TORRENT_ASSERT(ret.size() >= size);
+			return ret;
+		}
+
+		buffer ret(std::ptrdiff_t(1) << shift);
+		m_in_use_bytes += ret.size();
+		m_counters.inc_stats_counter(counters::recv_buffer_pool_misses);
+		update_counters();
+		return ret;
+	}
+
+	void receive_buffer_pool::release(buffer buf)
+	{
+		if (buf.empty()) return;
+
+		std::ptrdiff_t const size = buf.size();
+		m_in_use_bytes -= size;
+		TORRENT_ASSERT(m_in_use_bytes >= 0);
+
+		// file the buffer under the largest class it can satisfy
+		int const shift = floor_log2(size);
+		if (shift >= min_class_shift
+			&& shift <= max_class_shift
+			&& m_pooled_bytes + size <= m_max_pooled_bytes)
+		{
+			m_free[shift - min_class_shift].push_back(std::move(buf));
+			m_pooled_bytes += size;
+		}
+		update_counters();
+	}
+
+	void receive_buffer_pool::set_max_pooled_bytes(int const bytes)
+	{
+		m_max_pooled_bytes = std::max(bytes, 0);
+		trim(m_max_pooled_bytes);
+		update_counters();
+	}
+
+	std::int64_t receive_buffer_pool::release_idle()
+	{
+		std::int64_t const ret = m_pooled_bytes;
+		trim(0);
+		update_counters();
+		return ret;
+	}
+
+	void receive_buffer_pool::trim(std::int64_t const limit)
+	{
+		// free the largest buffers first, they are the cheapest to give up in
+		// terms of number of heap operations saved
+		for (int i = num_size_classes - 1; i >= 0 && m_pooled_bytes > limit; --i)
+		{
+			auto& free_list = m_free[i];
+			while (!free_list.empty() && m_pooled_bytes > limit)
+			{
+				m_pooled_bytes -= free_list.back().size();
+				free_list.pop_back();
+			}
+		}
+	}
+
+	void receive_buffer_pool::update_counters()
+	{
+		m_counters.set_value(counters::recv_buffer_pool_bytes, m_pooled_bytes);
+		m_counters.set_value(counters::recv_buffer_in_use_bytes, m_in_use_bytes);
+	}
+}
+}
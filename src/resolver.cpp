@@ -35,6 +35,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/debug.hpp"
 #include "libtorrent/aux_/time.hpp"
 
+#include <algorithm>
+
 namespace libtorrent {
 namespace aux {
 
@@ -46,14 +48,28 @@ namespace aux {
 		: m_ios(ios)
 		, m_resolver(ios)
 		, m_critical_resolver(ios)
+		, m_refresh_timer(ios)
 		, m_max_size(700)
 		, m_timeout(seconds(1200))
+		, m_negative_timeout(seconds(1200))
 	{}
 
+	resolver::~resolver()
+	{
+		{
+			std::lock_guard<std::mutex> l(m_queue_mutex);
+			m_shutdown = true;
+		}
+		m_queue_cond.notify_all();
+		for (auto& t : m_threads) t.join();
+	}
+
 namespace {
 	void callback(resolver_interface::callback_t h
 		, error_code const& ec, std::vector<address> const& ips)
 	{
+		// prefetches and refreshes don't have a callback
+		if (!h) return;
 		try {
 			h(ec, ips);
 		} catch (std::exception&) {
@@ -66,28 +82,52 @@ namespace {
 		, std::string const& hostname)
 	{
 		COMPLETE_ASYNC("resolver::on_lookup");
+		std::vector<address> addresses;
+		if (!ec)
+		{
+			for (auto i : ips)
+				addresses.push_back(i.endpoint().address());
+		}
+		lookup_done(ec, addresses, hostname);
+	}
+
+	void resolver::lookup_done(error_code const& ec, std::vector<address> const& ips
+		, std::string const& hostname)
+	{
+		auto const range = m_callbacks.equal_range(hostname);
+		bool const requested = std::any_of(range.first, range.second
+			, [](std::pair<std::string const, callback_t> const& c) { return bool(c.second); });
+
 		if (ec)
 		{
-			failed_dns_cache_entry& ce = m_failed_cache[hostname];
-			ce.last_seen = time_now();
-			ce.error = ec;
+			// a failed refresh keeps the entry we have until it times out.
+			// Nobody is waiting for it, and a transient failure shouldn't
+			// replace addresses that are likely still good
+			bool const keep = !requested && m_cache.count(hostname) > 0;
 
-			// if the cache grows too big, weed out the
-			// oldest entries
-			if (int(m_failed_cache.size()) > m_max_size)
+			// lookups cancelled on shutdown say nothing about the host
+			if (!keep && ec != boost::asio::error::operation_aborted)
 			{
-				auto oldest = m_failed_cache.begin();
-				for (auto k = m_failed_cache.begin(); k != m_failed_cache.end(); ++k)
+				failed_dns_cache_entry& ce = m_failed_cache[hostname];
+				ce.last_seen = time_now();
+				ce.error = ec;
+
+				// if the cache grows too big, weed out the
+				// oldest entries
+				if (int(m_failed_cache.size()) > m_max_size)
 				{
-					if (k->second.last_seen < oldest->second.last_seen)
-						oldest = k;
-				}
+					auto oldest = m_failed_cache.begin();
+					for (auto k = m_failed_cache.begin(); k != m_failed_cache.end(); ++k)
+					{
+						if (k->second.last_seen < oldest->second.last_seen)
+							oldest = k;
+					}
 
-				// remove the oldest entry
-				m_failed_cache.erase(oldest);
+					// remove the oldest entry
+					m_failed_cache.erase(oldest);
+				}
 			}
 
-			auto const range = m_callbacks.equal_range(hostname);
 			for (auto c = range.first; c != range.second; ++c)
 				callback(std::move(c->second), ec, {});
 			m_callbacks.erase(range.first, range.second);
@@ -102,11 +142,9 @@ namespace {
 
 		dns_cache_entry& ce = m_cache[hostname];
 		ce.last_seen = time_now();
-		ce.addresses.clear();
-		for (auto i : ips)
-			ce.addresses.push_back(i.endpoint().address());
+		ce.addresses = ips;
+		ce.used = requested;
 
-		auto const range = m_callbacks.equal_range(hostname);
 		for (auto c = range.first; c != range.second; ++c)
 			callback(std::move(c->second), ec, ce.addresses);
 		m_callbacks.erase(range.first, range.second);
@@ -125,6 +163,8 @@ namespace {
 			// remove the oldest entry
 			m_cache.erase(oldest);
 		}
+
+		arm_refresh_timer();
 	}
 
 	void resolver::async_resolve(std::string const& host, resolver_flags const flags
@@ -148,6 +188,7 @@ namespace {
 			if ((flags & resolver_interface::cache_only)
 				|| i->second.last_seen + m_timeout >= time_now())
 			{
+				i->second.used = true;
 				std::vector<address> ips = i->second.addresses;
 				post(m_ios, [h, ec, ips] { callback(h, ec, ips); });
 				return;
@@ -157,9 +198,9 @@ namespace {
 		auto const k = m_failed_cache.find(host);
 		if (k != m_failed_cache.end())
 		{
-			// keep cache entries valid for m_timeout seconds
+			// keep failed entries valid for m_negative_timeout seconds
 			if ((flags & resolver_interface::cache_only)
-				|| k->second.last_seen + m_timeout >= time_now())
+				|| k->second.last_seen + m_negative_timeout >= time_now())
 			{
 				error_code error_code = k->second.error;
 				post(m_ios, [h, error_code] { callback(h, error_code, {}); });
@@ -183,11 +224,64 @@ namespace {
 
 		// if there is an existing outtanding lookup, our callback will be
 		// called once it completes. We're done here.
-		if (done) return;
+		if (done)
+		{
+			// it may be a prefetch still queued behind other background
+			// lookups. Now that someone is waiting for it, move it ahead
+			std::lock_guard<std::mutex> l(m_queue_mutex);
+			auto const b = std::find_if(m_background_queue.begin(), m_background_queue.end()
+				, [&](queued_lookup const& e) { return e.host == host; });
+			if (b != m_background_queue.end())
+			{
+				m_queue.push_back({std::move(b->host), b->flags & flags});
+				m_background_queue.erase(b);
+			}
+			return;
+		}
+
+		start_lookup(host, flags, false);
+	}
+
+	void resolver::prefetch(std::string const& host)
+	{
+		if (m_abort) return;
+
+		error_code ec;
+		make_address(host, ec);
+		if (!ec) return;
+
+		auto const i = m_cache.find(host);
+		if (i != m_cache.end() && i->second.last_seen + m_timeout >= time_now())
+			return;
+
+		auto const k = m_failed_cache.find(host);
+		if (k != m_failed_cache.end() && k->second.last_seen + m_negative_timeout >= time_now())
+			return;
+
+		if (m_callbacks.find(host) != m_callbacks.end()) return;
+
+		m_callbacks.insert({host, callback_t{}});
+		start_lookup(host, resolver_interface::abort_on_shutdown, true);
+	}
+
+	void resolver::start_lookup(std::string const& host, resolver_flags const flags
+		, bool const background)
+	{
+		ADD_OUTSTANDING_ASYNC("resolver::on_lookup");
+
+		{
+			std::unique_lock<std::mutex> l(m_queue_mutex);
+			if (m_max_concurrency > 0)
+			{
+				(background ? m_background_queue : m_queue).push_back({host, flags});
+				l.unlock();
+				m_queue_cond.notify_one();
+				return;
+			}
+		}
 
 		// the port is ignored
 		using namespace std::placeholders;
-		ADD_OUTSTANDING_ASYNC("resolver::on_lookup");
 		if (flags & resolver_interface::abort_on_shutdown)
 		{
 			m_resolver.async_resolve(host, "80", std::bind(&resolver::on_lookup, this, _1, _2
@@ -200,9 +294,124 @@ namespace {
 		}
 	}
 
+	void resolver::lookup_thread()
+	{
+		// each thread has a resolver of its own for blocking lookups. The
+		// io_context is never run
+		io_context ios;
+		tcp::resolver sys_resolver(ios);
+
+		std::unique_lock<std::mutex> l(m_queue_mutex);
+		for (;;)
+		{
+			m_queue_cond.wait(l, [this] {
+				// lookups queued before the pool was turned off are still
+				// served, one at a time
+				return m_shutdown || (m_active_lookups < std::max(1, m_max_concurrency)
+					&& (!m_queue.empty() || !m_background_queue.empty()));
+			});
+			if (m_shutdown) return;
+
+			auto& q = m_queue.empty() ? m_background_queue : m_queue;
+			queued_lookup job = std::move(q.front());
+			q.pop_front();
+			lookup_function const lookup = m_lookup;
+			++m_active_lookups;
+			l.unlock();
+
+			error_code ec;
+			std::vector<address> ips;
+			if (lookup)
+			{
+				ec = lookup(job.host, ips);
+			}
+			else
+			{
+				auto const results = sys_resolver.resolve(job.host, "80", ec);
+				if (!ec)
+				{
+					for (auto const& i : results)
+						ips.push_back(i.endpoint().address());
+				}
+			}
+
+			post(m_ios, [this, ec, ips = std::move(ips), host = std::move(job.host)] {
+				COMPLETE_ASYNC("resolver::on_lookup");
+				lookup_done(ec, ips, host);
+			});
+
+			l.lock();
+			--m_active_lookups;
+			if (!m_queue.empty() || !m_background_queue.empty())
+			{
+				// a lower concurrency limit may have left another thread
+				// waiting for this slot
+				m_queue_cond.notify_one();
+			}
+		}
+	}
+
+	void resolver::arm_refresh_timer()
+	{
+		if (m_refresh_timer_armed || m_abort || m_timeout <= seconds(0)) return;
+		m_refresh_timer_armed = true;
+
+		// check often enough to catch every entry in the last quarter of its
+		// life time
+		m_refresh_timer.expires_after(std::max(time_duration(seconds(1)), m_timeout / 8));
+		m_refresh_timer.async_wait([this](error_code const& ec) { on_refresh_timer(ec); });
+	}
+
+	void resolver::on_refresh_timer(error_code const& ec)
+	{
+		m_refresh_timer_armed = false;
+		if (ec || m_abort) return;
+
+		// entries that have been asked for since they were resolved are
+		// looked up again once they reach 3/4 of their life time. The
+		// addresses we have are served until the new ones arrive
+		time_point const now = time_now();
+		time_duration const refresh_age = m_timeout - m_timeout / 4;
+		for (auto& e : m_cache)
+		{
+			if (!e.second.used) continue;
+			if (now - e.second.last_seen < refresh_age) continue;
+			if (m_callbacks.find(e.first) != m_callbacks.end()) continue;
+			e.second.used = false;
+			m_callbacks.insert({e.first, callback_t{}});
+			start_lookup(e.first, resolver_interface::abort_on_shutdown, true);
+		}
+
+		if (!m_cache.empty()) arm_refresh_timer();
+	}
+
 	void resolver::abort()
 	{
+		m_abort = true;
 		m_resolver.cancel();
+		m_refresh_timer.cancel();
+
+		// queued lookups that are not critical for shutting down are
+		// cancelled the same way asio cancels them
+		std::vector<std::string> cancelled;
+		{
+			std::lock_guard<std::mutex> l(m_queue_mutex);
+			for (auto* q : {&m_queue, &m_background_queue})
+			{
+				auto const it = std::stable_partition(q->begin(), q->end()
+					, [](queued_lookup const& e) { return !(e.flags & resolver_interface::abort_on_shutdown); });
+				for (auto i = it; i != q->end(); ++i)
+					cancelled.push_back(std::move(i->host));
+				q->erase(it, q->end());
+			}
+		}
+		for (auto& host : cancelled)
+		{
+			post(m_ios, [this, host = std::move(host)] {
+				COMPLETE_ASYNC("resolver::on_lookup");
+				lookup_done(boost::asio::error::operation_aborted, {}, host);
+			});
+		}
 	}
 
 	void resolver::set_cache_timeout(seconds const timeout)
@@ -212,5 +421,33 @@ namespace {
 		else
 			m_timeout = seconds(0);
 	}
+
+	void resolver::set_negative_cache_timeout(seconds const timeout)
+	{
+		if (timeout >= seconds(0))
+			m_negative_timeout = timeout;
+		else
+			m_negative_timeout = seconds(0);
+	}
+
+	void resolver::set_max_concurrency(int const n)
+	{
+		{
+			std::lock_guard<std::mutex> l(m_queue_mutex);
+			m_max_concurrency = std::max(0, n);
+
+			// threads are never stopped when the limit is lowered, the
+			// extra ones just stay idle
+			while (int(m_threads.size()) < m_max_concurrency)
+				m_threads.emplace_back([this] { lookup_thread(); });
+		}
+		m_queue_cond.notify_all();
+	}
+
+	void resolver::set_lookup_function(lookup_function f)
+	{
+		std::lock_guard<std::mutex> l(m_queue_mutex);
+		m_lookup = std::move(f);
+	}
 }
 }
@@ -374,6 +374,8 @@ namespace aux {
 
 		: m_settings(pack)
 
+		, m_recv_buffer_pool(m_stats_counters)
+
 		, m_io_context(ioc)
 
 		, m_alerts(m_settings.get_int(settings_pack::alert_queue_size)
@@ -761,6 +763,12 @@ namespace aux {
 		stop_upnp();
 		stop_natpmp();
 
+		if (m_metrics_server)
+		{
+			m_metrics_server->close();
+			m_metrics_server.reset();
+		}
+
 		m_lsd_announce_timer.cancel();
 
 
@@ -2947,6 +2955,14 @@ namespace {
 		// don't do any of the following while we're shutting down
 		if (m_abort) return;
 
+		// this is below the once per second check above, rendering the
+		// snapshot on every tick_interval would be wasted work
+		update_metrics_snapshot();
+
+		// idle keep-alive tracker connections are closed once they time
+		// out, not just when the next tracker request comes along
+		m_tracker_manager.expire_http_connections();
+
 		switch (m_settings.get_int(settings_pack::mixed_mode_algorithm))
 		{
 			case settings_pack::prefer_tcp:
@@ -3008,6 +3024,12 @@ namespace {
 			recalculate_auto_managed_torrents();
 		}
 
+		if (--m_memory_check_scaler < 0)
+		{
+			m_memory_check_scaler = 4;
+			update_memory_usage();
+		}
+
 		// --------------------------------------------------------------
 		// check for incoming connections that might have timed out
 		// --------------------------------------------------------------
@@ -4138,7 +4160,7 @@ namespace {
 			m_alerts.emplace_alert<session_stats_header_alert>();
 		}
 		m_disk_thread->update_stats_counters(m_stats_counters);
-
+		m_stats_counters.update_latency_percentiles();
 
 		m_stats_counters.set_value(counters::limiter_up_queue
 			, m_upload_rate.queue_size());
@@ -4153,6 +4175,25 @@ namespace {
 		m_alerts.emplace_alert<session_stats_alert>(m_stats_counters);
 	}
 
+	void session_impl::update_metrics_snapshot()
+	{
+		if (!m_metrics_server) return;
+
+		// the disk queue gauges are only pulled on demand
+		m_disk_thread->update_stats_counters(m_stats_counters);
+
+		std::vector<torrent_metrics> torrents;
+		torrents.reserve(m_torrents.size());
+		for (auto const& t : m_torrents)
+		{
+			if (t->is_aborted()) continue;
+			stat const& st = t->statistics();
+			torrents.push_back({t->info_hash().v1
+				, st.download_payload_rate(), st.upload_payload_rate()});
+		}
+		m_metrics_server->set_snapshot(render_openmetrics(m_stats_counters, torrents));
+	}
+
 
 	std::vector<torrent_handle> session_impl::get_torrents() const
 	{
@@ -4713,12 +4754,129 @@ namespace {
 			i->update_max_failcount();
 	}
 
+	void session_impl::update_memory_usage()
+	{
+		torrent_memory_usage sum;
+		for (auto const& t : m_torrents)
+		{
+			torrent_memory_usage const u = t->memory_usage();
+			sum.piece_picker += u.piece_picker;
+			sum.peer_list += u.peer_list;
+			sum.metadata += u.metadata;
+			sum.connections += u.connections;
+		}
+		m_stats_counters.set_value(counters::piece_picker_memory, sum.piece_picker);
+		m_stats_counters.set_value(counters::peer_list_memory, sum.peer_list);
+		m_stats_counters.set_value(counters::torrent_metadata_memory, sum.metadata);
+		m_stats_counters.set_value(counters::peer_connection_memory, sum.connections);
+
+		int const budget_kib = m_settings.get_int(settings_pack::memory_budget);
+		if (budget_kib <= 0) return;
+
+		// blocks waiting to be written are disk buffers. They are counted
+		// once, through the disk I/O subsystem, rather than per torrent
+		m_disk_thread->update_stats_counters(m_stats_counters);
+		std::int64_t const budget = std::int64_t(budget_kib) * 1024;
+		std::int64_t used = sum.piece_picker + sum.peer_list + sum.metadata
+			+ sum.connections + m_recv_buffer_pool.pooled_bytes()
+			+ m_stats_counters[counters::disk_blocks_in_use] * default_block_size;
+		if (used <= budget) return;
+
+		m_stats_counters.inc_stats_counter(counters::memory_budget_exceeded);
+#ifndef TORRENT_DISABLE_LOGGING
+		if (should_log())
+		{
+			session_log("memory budget exceeded: %" PRId64 " kiB used, budget: %d kiB"
+				, used / 1024, budget_kib);
+		}
+#endif
+
+		// shed the state that's cheapest to rebuild first. Idle pooled
+		// receive buffers just save heap allocations
+		used -= m_recv_buffer_pool.release_idle();
+
+		// seeds only have a piece picker in suggest_read_cache mode, it's
+		// created again with the next connection
+		for (auto const& t : m_torrents)
+		{
+			if (used <= budget) return;
+			used -= t->release_seed_picker();
+		}
+
+		// peer lists are refilled by trackers and peer exchange. Halve the
+		// largest ones first
+		std::vector<torrent*> by_peers;
+		for (auto const& t : m_torrents)
+			if (t->num_known_peers() > 0) by_peers.push_back(t.get());
+		std::sort(by_peers.begin(), by_peers.end(), [](torrent const* lhs, torrent const* rhs)
+			{ return lhs->num_known_peers() > rhs->num_known_peers(); });
+		for (auto* t : by_peers)
+		{
+			if (used <= budget) return;
+			used -= t->trim_peer_list(t->num_known_peers() / 2);
+		}
+
+		// last, close connections that are idle in both directions
+		for (auto const& t : m_torrents)
+		{
+			if (used <= budget) return;
+			used -= t->disconnect_idle_peers();
+		}
+	}
+
 	void session_impl::update_resolver_cache_timeout()
 	{
 		int const timeout = m_settings.get_int(settings_pack::resolver_cache_timeout);
 		m_host_resolver.set_cache_timeout(seconds(timeout));
 	}
 
+	void session_impl::update_resolver_negative_cache_timeout()
+	{
+		int const timeout = m_settings.get_int(settings_pack::resolver_negative_cache_timeout);
+		m_host_resolver.set_negative_cache_timeout(seconds(timeout));
+	}
+
+	void session_impl::update_resolver_max_concurrency()
+	{
+		m_host_resolver.set_max_concurrency(m_settings.get_int(settings_pack::resolver_max_concurrency));
+	}
+
+	void session_impl::update_recv_buffer_pool_size()
+	{
+		m_recv_buffer_pool.set_max_pooled_bytes(
+			m_settings.get_int(settings_pack::recv_buffer_pool_size));
+	}
+
+	void session_impl::update_metrics_port()
+	{
+		int const port = m_settings.get_int(settings_pack::metrics_port);
+		if (m_metrics_server)
+		{
+			if (port == m_metrics_server->listen_port()) return;
+			m_metrics_server->close();
+			m_metrics_server.reset();
+		}
+		if (port <= 0 || port > 65535 || m_abort) return;
+
+		auto srv = std::make_shared<metrics_server>(m_io_context);
+		error_code ec;
+		srv->start(port, ec);
+		if (ec)
+		{
+#ifndef TORRENT_DISABLE_LOGGING
+			session_log("failed to open metrics endpoint on 127.0.0.1:%d: %s"
+				, port, ec.message().c_str());
+#endif
+			srv->close();
+			return;
+		}
+#ifndef TORRENT_DISABLE_LOGGING
+		session_log("serving metrics on http://127.0.0.1:%d/metrics", port);
+#endif
+		m_metrics_server = std::move(srv);
+		update_metrics_snapshot();
+	}
+
 
 
 	void session_impl::update_ip_notifier()
@@ -5483,6 +5641,14 @@ namespace {
 	void session_impl::pop_alerts(std::vector<alert*>* alerts)
 	{
 		m_alerts.get_all(*alerts);
+
+		if (alerts->empty()) return;
+		time_point const now = clock_type::now();
+		for (alert const* a : *alerts)
+		{
+			m_stats_counters.record_latency(counters::alert_queue_delay_histogram
+				, total_microseconds(now - a->timestamp()));
+		}
 	}
 
 #if TORRENT_ABI_VERSION == 1
@@ -134,7 +134,10 @@ session_params read_session_params(bdecode_node const& e, save_state_flags_t con
 	if (flags & session_handle::save_ip_filter)
 	{
 		auto const v4 = e.dict_find_list("ip_filter4");
-		ip_filter load;
+		// the saved ranges are sorted and non-overlapping, add_rules() loads
+		// them in a single pass
+		std::vector<ip_range<address_v4>> rules4;
+		std::vector<ip_range<address_v6>> rules6;
 		if (v4)
 		{
 			int const count = v4.list_size();
@@ -148,7 +151,7 @@ session_params read_session_params(bdecode_node const& e, save_state_flags_t con
 				auto const f = aux::read_uint32(ptr);
 				// ignore invalid entries
 				if (first > last) continue;
-				load.add_rule(first, last, f);
+				rules4.push_back({first, last, f});
 			}
 		}
 
@@ -166,10 +169,12 @@ session_params read_session_params(bdecode_node const& e, save_state_flags_t con
 				auto const f = aux::read_uint32(ptr);
 				// ignore invalid entries
 				if (first > last) continue;
-				load.add_rule(first, last, f);
+				rules6.push_back({first, last, f});
 			}
 		}
 
+		ip_filter load;
+		load.add_rules(rules4, rules6);
 		if (!load.empty())
 		{
 			params.ip_filter = std::move(load);
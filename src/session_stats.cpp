@@ -332,6 +332,15 @@ namespace {
 
 		METRIC(disk, disk_blocks_in_use)
 
+		// ``streaming_cache_hits`` and ``streaming_cache_misses`` count the
+		// reads of torrents being played back (see ``streaming_cache_size``)
+		// that were served from the streaming cache, and the ones that had to
+		// go to disk. ``streaming_cache_bytes`` is the size of the blocks held
+		// in the cache.
+		METRIC(disk, streaming_cache_hits)
+		METRIC(disk, streaming_cache_misses)
+		METRIC(disk, streaming_cache_bytes)
+
 		// ``queued_disk_jobs`` is the number of disk jobs currently queued,
 		// waiting to be executed by a disk thread.
 		METRIC(disk, queued_disk_jobs)
@@ -360,6 +369,11 @@ namespace {
 		// the total number of blocks run through SHA-1 hashing
 		METRIC(disk, num_blocks_hashed)
 
+		// the number of blocks whose payload was received from the socket
+		// straight into a disk buffer, without being copied out of the peer's
+		// receive buffer
+		METRIC(disk, num_zero_copy_blocks)
+
 		// the number of disk I/O operation for reads and writes. One disk
 		// operation may transfer more then one block.
 		METRIC(disk, num_write_ops)
@@ -425,6 +439,26 @@ namespace {
 		METRIC(utp, utp_samples_above_target)
 		METRIC(utp, utp_samples_below_target)
 
+		// The number of times LEDBAT++ sockets slowed down to two packets to
+		// measure the base delay again
+		METRIC(utp, utp_slowdowns)
+
+		// The number of times a packet was held back by pacing, to be sent
+		// later in the RTT
+		METRIC(utp, utp_paced_sends)
+
+		// The number of packets retransmitted because packets sent after them
+		// were acknowledged, and they weren't within the reordering window
+		METRIC(utp, utp_rack_retransmit)
+
+		// The number of probes sent because the tail of a flight went
+		// unacknowledged
+		METRIC(utp, utp_tail_loss_probe)
+
+		// The number of retransmits found to have been unnecessary, because
+		// the original packet was acknowledged
+		METRIC(utp, utp_spurious_retransmit)
+
 		// The total number of packets carrying payload received and sent,
 		// respectively.
 		METRIC(utp, utp_payload_pkts_in)
@@ -498,6 +532,78 @@ namespace {
 		// this measure the number of tracker announces currently in the
 		// queue
 		METRIC(tracker, num_queued_tracker_announces)
+
+		// ``udp_tracker_scrapes_batched`` is the number of UDP scrapes that
+		// were sent as part of another torrent's scrape packet to the same
+		// tracker, instead of in a request of their own.
+		// ``udp_tracker_connects_saved`` is the number of UDP tracker connect
+		// requests avoided by waiting for a connect already in flight to the
+		// same tracker
+		METRIC(tracker, udp_tracker_scrapes_batched)
+		METRIC(tracker, udp_tracker_connects_saved)
+
+		// ``http_tracker_connections_reused`` is the number of HTTP tracker
+		// requests answered over a pooled keep-alive connection, saving a DNS
+		// lookup and a TCP handshake. Requests that had to reconnect because
+		// the idle connection had gone stale are not counted. ``num_idle_http_tracker_connections``
+		// is the number of keep-alive connections currently held idle.
+		METRIC(tracker, http_tracker_connections_reused)
+		METRIC(tracker, num_idle_http_tracker_connections)
+
+		// the number of bytes of memory held by all torrents, broken down by
+		// subsystem. These are estimates, updated every few seconds. The
+		// disk buffers are reported by ``disk.disk_blocks_in_use``.
+		METRIC(mem, piece_picker_memory)
+		METRIC(mem, peer_list_memory)
+		METRIC(mem, torrent_metadata_memory)
+		METRIC(mem, peer_connection_memory)
+
+		// ``memory_budget_exceeded`` is the number of times the session was
+		// found to be over its ``memory_budget``. The others count the state
+		// given up to get back under it: piece pickers of seeds dropped,
+		// peer list entries erased and idle peer connections closed.
+		METRIC(mem, memory_budget_exceeded)
+		METRIC(mem, memory_shed_pickers)
+		METRIC(mem, memory_shed_peers)
+		METRIC(mem, memory_shed_connections)
+
+		// the number of peer receive buffers served from the session-wide
+		// receive buffer pool, and the number that had to be allocated from
+		// the heap because no pooled buffer of the right size class was idle.
+		METRIC(sock_bufs, recv_buffer_pool_hits)
+		METRIC(sock_bufs, recv_buffer_pool_misses)
+
+		// ``num_send_buffers_gathered`` is the total number of chained send
+		// buffers passed to peer socket writes. Every write hands the whole
+		// chain to a single gathering sendmsg()/writev() call (or, for uTP,
+		// copies it straight into packets).
+		METRIC(sock_bufs, num_send_buffers_gathered)
+
+		// ``recv_buffer_pool_bytes`` is the number of bytes held idle by the
+		// receive buffer pool. ``recv_buffer_in_use_bytes`` is the number of
+		// bytes currently borrowed by peer connections for messages in flight.
+		METRIC(sock_bufs, recv_buffer_pool_bytes)
+		METRIC(sock_bufs, recv_buffer_in_use_bytes)
+
+		// the 50th, 99th and 99.9th percentile (in microseconds) of the time
+		// it took to service a disk read, write or hash job, since the
+		// previous session stats update
+		METRIC(disk, disk_job_latency_p50)
+		METRIC(disk, disk_job_latency_p99)
+		METRIC(disk, disk_job_latency_p999)
+
+		// percentiles (in microseconds) of the time from the first block
+		// request of a piece until it passed the hash check, for pieces that
+		// completed since the previous session stats update
+		METRIC(picker, piece_download_time_p50)
+		METRIC(picker, piece_download_time_p99)
+		METRIC(picker, piece_download_time_p999)
+
+		// percentiles (in microseconds) of the time alerts spent in the alert
+		// queue before being popped by the client
+		METRIC(ses, alert_queue_delay_p50)
+		METRIC(ses, alert_queue_delay_p99)
+		METRIC(ses, alert_queue_delay_p999)
 		// ... more
 	}});
 #undef METRIC
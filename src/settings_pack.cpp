@@ -240,6 +240,8 @@ constexpr int DISK_WRITE_MODE = settings_pack::enable_os_cache;
 		SET(ssrf_mitigation, true, nullptr),
 		SET(allow_idna, false, nullptr),
 		SET(enable_set_file_valid_data, false, nullptr),
+		SET(utp_pacing, false, nullptr),
+		SET(utp_rack, true, nullptr),
 		// SET(socks5_udp_send_local_ep, false, nullptr),
 
 
@@ -419,6 +421,19 @@ constexpr int DISK_WRITE_MODE = settings_pack::enable_os_cache;
 		SET(metadata_token_limit, 2500000, nullptr),
 		SET(disk_write_mode, settings_pack::mmap_write_mode_t::auto_mmap_write, nullptr),
 		SET(mmap_file_size_cutoff, 40, nullptr),
+		SET(recv_buffer_pool_size, 8 * 1024 * 1024, &session_impl::update_recv_buffer_pool_size),
+		SET(metrics_port, 0, &session_impl::update_metrics_port),
+		SET(tracker_http_pool_max_idle, 4, nullptr),
+		SET(tracker_http_pool_idle_timeout, 60, nullptr),
+		SET(resolver_max_concurrency, 4, &session_impl::update_resolver_max_concurrency),
+		SET(resolver_negative_cache_timeout, 60, &session_impl::update_resolver_negative_cache_timeout),
+		SET(memory_budget, 0, nullptr),
+		SET(streaming_cache_size, 0, nullptr),
+		SET(sequential_window_duration, 10, nullptr),
+		SET(sequential_window_min_pieces, 4, nullptr),
+		SET(utp_congestion_control, settings_pack::ledbat, nullptr),
+		SET(announce_merge_window, 15, nullptr),
+		SET(create_torrent_readahead, 256, nullptr),
 
 
 		//------------------GTK client settings ---------------------
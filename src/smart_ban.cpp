@@ -35,6 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #ifndef TORRENT_DISABLE_EXTENSIONS
 
+#include <algorithm> // for find
 #include <vector>
 #include <map>
 #include <utility>
@@ -187,12 +188,12 @@ namespace {
 			hasher h;
 			h.update({buffer.data(), block_size});
 
-			auto const range = m_torrent.find_peers(a);
+			auto const peers = m_torrent.find_peers(a);
 
 			// there is no peer with this address anymore
-			if (range.first == range.second) return;
+			if (peers.empty()) return;
 
-			torrent_peer* p = (*range.first);
+			torrent_peer* p = peers.front();
 			block_entry e = {p, h.final()};
 
 			auto i = m_block_hashes.lower_bound(b);
@@ -271,15 +272,10 @@ namespace {
 			if (b.second.digest == ok_digest) return;
 
 			// find the peer
-			auto range = m_torrent.find_peers(a);
-			if (range.first == range.second) return;
-			torrent_peer* p = nullptr;
-			for (; range.first != range.second; ++range.first)
-			{
-				if (b.second.peer != *range.first) continue;
-				p = *range.first;
-			}
-			if (p == nullptr) return;
+			auto const peers = m_torrent.find_peers(a);
+			auto const it = std::find(peers.begin(), peers.end(), b.second.peer);
+			if (it == peers.end()) return;
+			torrent_peer* p = *it;
 
 #ifndef TORRENT_DISABLE_LOGGING
 			if (m_torrent.should_log())
@@ -0,0 +1,243 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/streaming_cache.hpp"
+#include "libtorrent/disk_interface.hpp" // for default_block_size
+#include "libtorrent/assert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+
+namespace libtorrent {
+namespace aux {
+
+	void streaming_cache::set_max_size(std::int64_t const bytes)
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		m_max_size = std::max(bytes, std::int64_t(0));
+		if (m_max_size == 0)
+		{
+			m_pieces.clear();
+			m_cursors.clear();
+			m_size = 0;
+			return;
+		}
+		make_room(0, -1, nullptr);
+	}
+
+	bool streaming_cache::enabled() const
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		return m_max_size > 0;
+	}
+
+	void streaming_cache::set_cursor(storage_index_t const st, piece_index_t const piece)
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		if (m_max_size == 0) return;
+		m_cursors[st] = piece;
+	}
+
+	bool streaming_cache::has_cursor(storage_index_t const st) const
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		return m_cursors.count(st) > 0;
+	}
+
+	bool streaming_cache::has(storage_index_t const st, piece_index_t const piece
+		, int const offset, int const length) const
+	{
+		TORRENT_ASSERT(offset >= 0);
+		std::lock_guard<std::mutex> l(m_mutex);
+		auto const it = m_pieces.find({st, piece});
+		if (it == m_pieces.end()) return false;
+		return has_range(it->second, offset, offset + length);
+	}
+
+	bool streaming_cache::get(storage_index_t const st, piece_index_t const piece
+		, int const offset, span<char> const buf) const
+	{
+		TORRENT_ASSERT(offset >= 0);
+		std::lock_guard<std::mutex> l(m_mutex);
+		auto const it = m_pieces.find({st, piece});
+		if (it == m_pieces.end()) return false;
+
+		auto const& blocks = it->second.blocks;
+		int const end = offset + int(buf.size());
+
+		// first make sure the whole range is there, then copy
+		if (!has_range(it->second, offset, end)) return false;
+
+		char* dst = buf.data();
+		for (int o = offset; o < end;)
+		{
+			int const block_offset = o % default_block_size;
+			int const len = std::min(end - o, default_block_size - block_offset);
+			std::memcpy(dst, blocks[std::size_t(o / default_block_size)].buf.get()
+				+ block_offset, std::size_t(len));
+			dst += len;
+			o += len;
+		}
+		return true;
+	}
+
+	void streaming_cache::insert(storage_index_t const st, piece_index_t const piece
+		, int const offset, span<char const> const buf)
+	{
+		TORRENT_ASSERT(offset % default_block_size == 0);
+		TORRENT_ASSERT(buf.size() <= default_block_size);
+		if (offset % default_block_size != 0 || buf.size() > default_block_size)
+			return;
+
+		std::lock_guard<std::mutex> l(m_mutex);
+		if (m_max_size == 0) return;
+		if (m_cursors.count(st) == 0) return;
+
+		piece_key const k{st, piece};
+		std::size_t const idx = std::size_t(offset / default_block_size);
+
+		auto it = m_pieces.find(k);
+		if (it != m_pieces.end()
+			&& idx < it->second.blocks.size()
+			&& it->second.blocks[idx].buf)
+		{
+			// the block is re-written, after a failed hash check for instance
+			cached_block& b = it->second.blocks[idx];
+			std::memcpy(b.buf.get(), buf.data(), std::size_t(buf.size()));
+			b.size = int(buf.size());
+			return;
+		}
+
+		if (!make_room(default_block_size, score(k), &k)) return;
+
+		std::unique_ptr<char[]> mem(new (std::nothrow) char[default_block_size]);
+		if (!mem) return;
+		std::memcpy(mem.get(), buf.data(), std::size_t(buf.size()));
+
+		if (it == m_pieces.end()) it = m_pieces.emplace(k, cached_piece{}).first;
+		auto& blocks = it->second.blocks;
+		if (idx >= blocks.size()) blocks.resize(idx + 1);
+		blocks[idx].buf = std::move(mem);
+		blocks[idx].size = int(buf.size());
+		m_size += default_block_size;
+	}
+
+	void streaming_cache::erase_piece(storage_index_t const st, piece_index_t const piece)
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		auto const it = m_pieces.find({st, piece});
+		if (it != m_pieces.end()) erase_impl(it);
+	}
+
+	void streaming_cache::erase_storage(storage_index_t const st)
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		m_cursors.erase(st);
+		auto it = m_pieces.lower_bound({st, piece_index_t(0)});
+		while (it != m_pieces.end() && it->first.first == st)
+		{
+			auto const next = std::next(it);
+			erase_impl(it);
+			it = next;
+		}
+	}
+
+	std::int64_t streaming_cache::size() const
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		return m_size;
+	}
+
+	std::int64_t streaming_cache::score(piece_key const& k) const
+	{
+		auto const c = m_cursors.find(k.first);
+		if (c == m_cursors.end()) return std::numeric_limits<std::int64_t>::max();
+		std::int64_t const d = static_cast<int>(k.second) - static_cast<int>(c->second);
+		return d >= 0 ? d : -d * 2;
+	}
+
+	bool streaming_cache::has_range(cached_piece const& p, int const offset
+		, int const end) const
+	{
+		auto const& blocks = p.blocks;
+		for (int o = offset - offset % default_block_size; o < end; o += default_block_size)
+		{
+			std::size_t const idx = std::size_t(o / default_block_size);
+			if (idx >= blocks.size() || !blocks[idx].buf) return false;
+			if (o + blocks[idx].size < std::min(end, o + default_block_size)) return false;
+		}
+		return true;
+	}
+
+	bool streaming_cache::make_room(std::int64_t const bytes, std::int64_t const limit
+		, piece_key const* keep)
+	{
+		if (m_size + bytes <= m_max_size) return true;
+
+		std::int64_t const target = std::min(m_max_size - bytes
+			, m_max_size - m_max_size / 8);
+
+		using victim_t = std::pair<std::int64_t, std::map<piece_key, cached_piece>::iterator>;
+		std::vector<victim_t> victims;
+		for (auto it = m_pieces.begin(); it != m_pieces.end(); ++it)
+		{
+			if (keep != nullptr && it->first == *keep) continue;
+			std::int64_t const s = score(it->first);
+			if (s <= limit) continue;
+			victims.emplace_back(s, it);
+		}
+		std::sort(victims.begin(), victims.end()
+			, [](victim_t const& lhs, victim_t const& rhs)
+			{ return lhs.first > rhs.first; });
+
+		// erasing a map element doesn't invalidate the other iterators
+		for (auto const& v : victims)
+		{
+			if (m_size <= target) break;
+			erase_impl(v.second);
+		}
+		return m_size + bytes <= m_max_size;
+	}
+
+	void streaming_cache::erase_impl(std::map<piece_key, cached_piece>::iterator const it)
+	{
+		for (auto const& b : it->second.blocks)
+			if (b.buf) m_size -= default_block_size;
+		TORRENT_ASSERT(m_size >= 0);
+		m_pieces.erase(it);
+	}
+
+}
+}
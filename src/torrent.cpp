@@ -142,6 +142,23 @@ bool is_downloading_state(int const st)
 			return false;
 	}
 }
+
+// rounds ``t`` up to the next slot of ``window`` seconds. The slots are the
+// same for every torrent announcing to the tracker at ``url``, so their
+// re-announces fall due together, and offset by a hash of the tracker's
+// host name so that different trackers aren't all announced to at once
+time_point32 merge_announce_time(time_point32 const t, std::string const& url
+	, seconds32 const window)
+{
+	if (window <= seconds32(0)) return t;
+	error_code ec;
+	std::string const host = std::get<2>(parse_url_components(url, ec));
+	std::int64_t const w = window.count();
+	std::int64_t const offset = std::int64_t(std::hash<std::string>{}(ec ? url : host) % std::size_t(w));
+	std::int64_t const s = t.time_since_epoch().count() - offset;
+	std::int64_t const rem = ((s % w) + w) % w;
+	return rem == 0 ? t : t + seconds32(w - rem);
+}
 } // anonymous namespace
 
 	// constexpr web_seed_flag_t torrent::ephemeral;
@@ -210,6 +227,7 @@ bool is_downloading_state(int const st)
 		, m_added(false)
 		, m_sequential_download(p.flags & torrent_flags::sequential_download)
 		, m_auto_sequential(false)
+		, m_sequential_window(p.flags & torrent_flags::sequential_window)
 		, m_seed_mode(false)
 		, m_stop_when_ready(p.flags & torrent_flags::stop_when_ready)
 		, m_enable_lsd(!bool(p.flags & torrent_flags::disable_lsd))
@@ -601,6 +619,22 @@ bool is_downloading_state(int const st)
 		update_want_tick();
 		update_state_list();
 
+		// get the tracker host names into the resolver cache while the files
+		// are being checked, rather than when the first announce goes out
+		if (!m_paused || m_auto_managed)
+		{
+			for (auto const& t : m_trackers)
+			{
+				error_code ec;
+				std::string hostname;
+				using std::ignore;
+				std::tie(ignore, ignore, hostname, ignore, ignore)
+					= parse_url_components(t.url, ec);
+				if (ec || hostname.empty()) continue;
+				m_ses.get_resolver().prefetch(hostname);
+			}
+		}
+
 		if (m_torrent_file->is_valid())
 		{
 			init();
@@ -679,7 +713,8 @@ bool is_downloading_state(int const st)
 			m_ses.close_connection(p);
 	}
 
-	void torrent::read_piece(piece_index_t const piece)
+	void torrent::read_piece(piece_index_t const piece, boost::shared_array<char> buffer
+		, read_piece_flags_t const read_flags)
 	{
 		error_code ec;
 		if (m_abort || m_deleted)
@@ -717,7 +752,9 @@ bool is_downloading_state(int const st)
 		}
 
 		std::shared_ptr<read_piece_struct> rp = std::make_shared<read_piece_struct>();
-		rp->piece_data.reset(new (std::nothrow) char[std::size_t(piece_size)]);
+		rp->piece_data = std::move(buffer);
+		if (!rp->piece_data)
+			rp->piece_data.reset(new (std::nothrow) char[std::size_t(piece_size)]);
 		if (!rp->piece_data)
 		{
 			m_ses.alerts().emplace_alert<read_piece_alert>(
@@ -731,6 +768,11 @@ bool is_downloading_state(int const st)
 		auto const read_mode = settings().get_int(settings_pack::disk_io_read_mode);
 		if (read_mode == settings_pack::disable_os_cache)
 			flags |= disk_interface::volatile_read;
+		// only playback reads move the stream cursor of the disk I/O's
+		// streaming cache. Reads probing the file for its index would
+		// make it jump away from what's being played
+		if (read_flags & torrent_handle::playback)
+			flags |= disk_interface::stream_read;
 
 		peer_request r;
 		r.piece = piece;
@@ -822,6 +864,8 @@ bool is_downloading_state(int const st)
 // #endif
 		if (m_sequential_download)
 			ret |= torrent_flags::sequential_download;
+		if (m_sequential_window)
+			ret |= torrent_flags::sequential_window;
 		if (m_stop_when_ready)
 			ret |= torrent_flags::stop_when_ready;
 
@@ -865,6 +909,8 @@ bool is_downloading_state(int const st)
 // #endif
 		if (mask & torrent_flags::sequential_download)
 			set_sequential_download(bool(flags & torrent_flags::sequential_download));
+		if (mask & torrent_flags::sequential_window)
+			set_sequential_window(bool(flags & torrent_flags::sequential_window));
 		if (mask & torrent_flags::stop_when_ready)
 			stop_when_ready(bool(flags & torrent_flags::stop_when_ready));
 	
@@ -1164,6 +1210,83 @@ bool is_downloading_state(int const st)
 		if (m_peer_list) m_peer_list->clear();
 	}
 
+	torrent_memory_usage torrent::memory_usage() const
+	{
+		TORRENT_ASSERT(is_single_thread());
+		torrent_memory_usage ret;
+		if (m_picker)
+			ret.piece_picker = std::int64_t(m_picker->memory_usage());
+		if (m_peer_list)
+			ret.peer_list = std::int64_t(m_peer_list->memory_usage());
+
+		if (m_metadata_usage_for != m_torrent_file.get())
+		{
+			m_metadata_usage = std::int64_t(m_torrent_file->memory_usage());
+			m_metadata_usage_for = m_torrent_file.get();
+		}
+		ret.metadata = m_metadata_usage;
+
+		ret.connections = std::int64_t(m_connections.capacity() * sizeof(peer_connection*));
+		for (auto const* p : m_connections)
+		{
+			ret.connections += std::int64_t(sizeof(*p))
+				+ p->send_buffer_capacity() + p->recv_buffer_capacity();
+			ret.disk_writes += p->num_writing_bytes();
+		}
+		return ret;
+	}
+
+	std::int64_t torrent::release_seed_picker()
+	{
+		// seeds only keep their piece picker in suggest_read_cache mode. It's
+		// created again with the next connection
+		if (!m_picker || !m_have_all) return 0;
+
+		std::int64_t const ret = std::int64_t(m_picker->memory_usage());
+		m_picker.reset();
+		m_file_progress.clear();
+		update_gauge();
+		inc_stats_counter(counters::memory_shed_pickers);
+		return ret;
+	}
+
+	std::int64_t torrent::trim_peer_list(int const max_peers)
+	{
+		if (!m_peer_list) return 0;
+
+		std::int64_t const before = std::int64_t(m_peer_list->memory_usage());
+		torrent_state st = get_peer_list_state();
+		int const erased = m_peer_list->trim_peers(&st, max_peers);
+		peers_erased(st.erased);
+		inc_stats_counter(counters::memory_shed_peers, erased);
+		return before - std::int64_t(m_peer_list->memory_usage());
+	}
+
+	std::int64_t torrent::disconnect_idle_peers()
+	{
+		// connections where neither side is interested in the other, and
+		// nothing is in flight. They can be re-established if either side
+		// becomes interested again
+		std::vector<peer_connection*> idle;
+		for (auto* p : m_connections)
+		{
+			if (p->is_disconnecting() || p->is_connecting()) continue;
+			if (p->is_interesting() || p->is_peer_interested()) continue;
+			if (!p->download_queue().empty() || !p->upload_queue().empty()) continue;
+			idle.push_back(p);
+		}
+
+		std::int64_t ret = 0;
+		for (auto* p : idle)
+		{
+			ret += std::int64_t(sizeof(*p))
+				+ p->send_buffer_capacity() + p->recv_buffer_capacity();
+			p->disconnect(errors::timed_out_no_interest, operation_t::bittorrent);
+		}
+		inc_stats_counter(counters::memory_shed_connections, int(idle.size()));
+		return ret;
+	}
+
 	void torrent::need_picker()
 	{
 		if (m_picker) return;
@@ -1190,6 +1313,7 @@ bool is_downloading_state(int const st)
 
 		m_picker = std::move(pp);
 
+		update_sequential_window();
 		update_gauge();
 
 		for (auto const p : m_connections)
@@ -3052,7 +3176,8 @@ namespace {
 					m_complete_sent = true;
 				}
 				ae->verified = true;
-				a.next_announce = now + interval;
+				a.next_announce = merge_announce_time(now + interval, r.url
+					, seconds32(settings().get_int(settings_pack::announce_merge_window)));
 				a.min_announce = now + resp.min_interval;
 				a.updating = false;
 				a.fails = 0;
@@ -3906,6 +4031,13 @@ namespace {
 
 		inc_stats_counter(counters::num_piece_passed);
 
+		time_point const started = m_picker->download_start(index);
+		if (started != time_point())
+		{
+			m_ses.stats_counters().record_latency(counters::piece_download_time_histogram
+				, total_microseconds(clock_type::now() - started));
+		}
+
 		if (settings().get_int(settings_pack::suggest_mode)
 			== settings_pack::suggest_read_cache)
 		{
@@ -7686,22 +7818,6 @@ namespace {
 			TORRENT_ASSERT(m_abort || m_error || !m_picker || m_picker->num_pieces() == 0);
 		}
 
-#ifdef TORRENT_EXPENSIVE_INVARIANT_CHECKS
-		// make sure we haven't modified the peer object
-		// in a way that breaks the sort order
-		if (m_peer_list && m_peer_list->begin() != m_peer_list->end())
-		{
-			auto i = m_peer_list->begin();
-			auto p = i++;
-			auto end(m_peer_list->end());
-			peer_address_compare cmp;
-			for (; i != end; ++i, ++p)
-			{
-				TORRENT_ASSERT(!cmp(*i, *p));
-			}
-		}
-#endif
-
 /*
 		if (m_picker && !m_abort)
 		{
@@ -7748,6 +7864,58 @@ namespace {
 		state_updated();
 	}
 
+	void torrent::set_sequential_window(bool const sw)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		if (m_sequential_window == sw) return;
+		m_sequential_window = sw;
+#ifndef TORRENT_DISABLE_LOGGING
+		debug_log("*** set-sequential-window: %d", sw);
+#endif
+
+		update_sequential_window();
+		set_need_save_resume(torrent_handle::if_config_changed);
+
+		state_updated();
+	}
+
+	void torrent::set_window_cursor(piece_index_t const cursor)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		if (cursor < piece_index_t(0)) return;
+		m_window_cursor = cursor;
+#ifndef TORRENT_DISABLE_LOGGING
+		debug_log("*** set-window-cursor: %d", static_cast<int>(cursor));
+#endif
+		update_sequential_window();
+	}
+
+	void torrent::update_sequential_window()
+	{
+		if (!m_picker) return;
+
+		if (!m_sequential_window)
+		{
+			m_picker->set_sequential_window(m_window_cursor, 0);
+			return;
+		}
+
+		// the window holds what we download in sequential_window_duration
+		// seconds. A fast torrent needs a wide window to keep all its peers
+		// busy with in-order pieces, a slow one only needs a few pieces ahead
+		// of the cursor and can leave the rest to rarest first
+		std::int64_t const rate = m_stat.download_payload_rate();
+		std::int64_t const duration = std::max(0
+			, settings().get_int(settings_pack::sequential_window_duration));
+		std::int64_t const min_pieces = std::max(0
+			, settings().get_int(settings_pack::sequential_window_min_pieces));
+		std::int64_t const pieces = std::max(min_pieces
+			, rate * duration / m_torrent_file->piece_length());
+
+		m_picker->set_sequential_window(m_window_cursor
+			, int(std::min(pieces, std::int64_t(m_torrent_file->num_pieces()))));
+	}
+
 	void torrent::queue_up()
 	{
 		// finished torrents may not change their queue positions, as it's set to
@@ -8944,6 +9112,9 @@ namespace {
 		m_total_downloaded += m_stat.last_payload_downloaded();
 		m_stat.second_tick(tick_interval_ms);
 
+		// the window follows the download rate
+		if (m_sequential_window) update_sequential_window();
+
 		// these counters are saved in the resume data, since they updated
 		// we need to save the resume data too
 		set_need_save_resume(torrent_handle::if_counters_changed);
@@ -9957,7 +10128,7 @@ namespace {
 		update_want_peers();
 	}
 
-	std::pair<peer_list::iterator, peer_list::iterator> torrent::find_peers(address const& a)
+	std::vector<torrent_peer*> torrent::find_peers(address const& a)
 	{
 		need_peer_list();
 		return m_peer_list->find_peers(a);
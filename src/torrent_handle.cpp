@@ -76,6 +76,7 @@ namespace libtorrent {
 	constexpr resume_data_flags_t torrent_handle::if_metadata_changed;
 
 	constexpr add_piece_flags_t torrent_handle::overwrite_existing;
+	constexpr read_piece_flags_t torrent_handle::playback;
 	constexpr pause_flags_t torrent_handle::graceful_pause;
 	constexpr pause_flags_t torrent_handle::clear_disk_cache;
 	// constexpr deadline_flags_t torrent_handle::alert_when_available;
@@ -738,9 +739,21 @@ namespace libtorrent {
 		async_call(&torrent::add_piece_async, piece, std::move(data), flags);
 	}
 
-	void torrent_handle::read_piece(piece_index_t piece) const
+	void torrent_handle::read_piece(piece_index_t piece
+		, read_piece_flags_t const flags) const
 	{
-		async_call(&torrent::read_piece, piece);
+		async_call(&torrent::read_piece, piece, boost::shared_array<char>(), flags);
+	}
+
+	void torrent_handle::read_piece(piece_index_t piece
+		, boost::shared_array<char> buffer, read_piece_flags_t const flags) const
+	{
+		async_call(&torrent::read_piece, piece, std::move(buffer), flags);
+	}
+
+	void torrent_handle::set_window_cursor(piece_index_t const piece) const
+	{
+		async_call(&torrent::set_window_cursor, piece);
 	}
 
 	bool torrent_handle::have_piece(piece_index_t piece) const
@@ -820,6 +833,11 @@ namespace libtorrent {
 		async_call(&torrent::clear_peers);
 	}
 
+	torrent_memory_usage torrent_handle::memory_usage() const
+	{
+		return sync_call_ret<torrent_memory_usage>(torrent_memory_usage{}, &torrent::memory_usage);
+	}
+
 #if TORRENT_ABI_VERSION == 1
 	void torrent_handle::force_reannounce(
 		boost::posix_time::time_duration duration) const
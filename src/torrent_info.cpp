@@ -55,6 +55,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "libtorrent/hex.hpp" // to_hex
 #include "libtorrent/aux_/numeric_cast.hpp"
 #include "libtorrent/aux_/file_pointer.hpp"
+#include "libtorrent/aux_/mapped_torrent.hpp"
 #include "libtorrent/disk_interface.hpp" // for default_block_size
 #include "libtorrent/span.hpp"
 
@@ -965,8 +966,22 @@ namespace {
 	torrent_info::torrent_info(std::string const& filename
 		, load_torrent_limits const& cfg)
 	{
-		std::vector<char> buf;
 		error_code ec;
+#if TORRENT_HAVE_MMAP || TORRENT_HAVE_MAP_VIEW_OF_FILE
+		if (cfg.map_file)
+		{
+			aux::mapped_torrent t = aux::map_torrent_file(filename, cfg, ec);
+			if (ec) aux::throw_ex<system_error>(ec);
+
+			if (!parse_torrent_file(t.root, ec, cfg.max_pieces, t.buffer))
+				aux::throw_ex<system_error>(ec);
+
+			INVARIANT_CHECK;
+			return;
+		}
+#endif
+
+		std::vector<char> buf;
 		int ret = load_file(filename, buf, ec, cfg.max_buffer_size);
 		if (ret < 0) aux::throw_ex<system_error>(ec);
 
@@ -1054,6 +1069,21 @@ namespace {
 		m_orig_files.reset(new file_storage(m_files));
 	}
 
+	std::size_t torrent_info::memory_usage() const
+	{
+		std::size_t ret = sizeof(*this)
+			+ m_files.memory_usage()
+			+ std::size_t(m_info_section_size)
+			+ m_urls.capacity() * sizeof(announce_entry)
+			+ m_comment.size()
+			+ m_created_by.size();
+		if (m_orig_files)
+			ret += sizeof(file_storage) + m_orig_files->memory_usage();
+		for (auto const& ae : m_urls)
+			ret += ae.url.size() + ae.trackerid.size();
+		return ret;
+	}
+
 #if TORRENT_ABI_VERSION <= 2
 	void torrent_info::swap(torrent_info& ti)
 	{
@@ -1099,6 +1129,13 @@ namespace {
 
 	bool torrent_info::parse_info_section(bdecode_node const& info
 		, error_code& ec, int const max_pieces)
+	{
+		return parse_info_section(info, ec, max_pieces, {});
+	}
+
+	bool torrent_info::parse_info_section(bdecode_node const& info
+		, error_code& ec, int const max_pieces
+		, std::shared_ptr<char const> const& backing)
 	{
 		// printf("13242META: in parse_info_section;;;\n");
 		
@@ -1124,10 +1161,20 @@ namespace {
 			return false;
 		}
 
-		// copy the info section
 		m_info_section_size = int(section.size());
-		m_info_section.reset(new char[aux::numeric_cast<std::size_t>(m_info_section_size)]);
-		std::memcpy(m_info_section.get(), section.data(), aux::numeric_cast<std::size_t>(m_info_section_size));
+		if (backing)
+		{
+			// the info section is never written to, refer to it in the
+			// backing buffer and keep that alive instead of copying it
+			m_info_section = boost::shared_array<char>(const_cast<char*>(section.data())
+				, [backing](char*) {});
+		}
+		else
+		{
+			// copy the info section
+			m_info_section.reset(new char[aux::numeric_cast<std::size_t>(m_info_section_size)]);
+			std::memcpy(m_info_section.get(), section.data(), aux::numeric_cast<std::size_t>(m_info_section_size));
+		}
 
 		// this is the offset from the start of the torrent file buffer to the
 		// info-dictionary (within the torrent file).
@@ -1510,7 +1557,8 @@ namespace {
 	}
 
 	bool torrent_info::parse_torrent_file(bdecode_node const& torrent_file
-		, error_code& ec, int const piece_limit)
+		, error_code& ec, int const piece_limit
+		, std::shared_ptr<char const> const& backing)
 	{
 		if (torrent_file.type() != bdecode_node::dict_t)
 		{
@@ -1540,7 +1588,7 @@ namespace {
 			return false;
 		}
 
-		if (!parse_info_section(info, ec, piece_limit)) return false;
+		if (!parse_info_section(info, ec, piece_limit, backing)) return false;
 		resolve_duplicate_filenames();
 
 		// if (m_info_hash.has_v2())
@@ -142,7 +142,6 @@ namespace libtorrent {
 		: prev_amount_upload(0)
 		, prev_amount_download(0)
 		, connection(nullptr)
-		, peer_rank(0)
 		, last_optimistically_unchoked(0)
 		, last_connected(0)
 		, port(port_)
@@ -169,12 +168,9 @@ namespace libtorrent {
 	std::uint32_t torrent_peer::rank(external_ip const& external, int external_port) const
 	{
 		TORRENT_ASSERT(in_use);
-//TODO: how do we deal with our external address changing?
-		if (peer_rank == 0)
-			peer_rank = peer_priority(
-				tcp::endpoint(external.external_address(this->address()), std::uint16_t(external_port))
-				, tcp::endpoint(this->address(), this->port));
-		return peer_rank;
+		return peer_priority(
+			tcp::endpoint(external.external_address(this->address()), std::uint16_t(external_port))
+			, tcp::endpoint(this->address(), this->port));
 	}
 
 #ifndef TORRENT_DISABLE_LOGGING
@@ -226,6 +222,12 @@ namespace libtorrent {
 	ipv4_peer::ipv4_peer(ipv4_peer const&) = default;
 	ipv4_peer& ipv4_peer::operator=(ipv4_peer const& p) & = default;
 
+#ifndef _MSC_VER
+	// msvc doesn't pack the bool bit-fields into the same storage unit as the
+	// integer ones, so this only holds for gcc and clang
+	static_assert(sizeof(ipv4_peer) <= 32, "ipv4_peer is expected to fit in 32 bytes");
+#endif
+
 
 	ipv6_peer::ipv6_peer(tcp::endpoint const& ep, bool c
 		, peer_source_flags_t const src)
@@ -34,6 +34,7 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <cctype>
+#include <algorithm>
 
 #include "libtorrent/tracker_manager.hpp"
 #include "libtorrent/http_tracker_connection.hpp"
@@ -252,6 +253,58 @@ constexpr tracker_request_flags_t tracker_request::scrape_request;
 	{
 		TORRENT_ASSERT(is_single_thread());
 		m_udp_conns.erase(c->transaction_id());
+		scrape_sent(c);
+	}
+
+	void tracker_manager::scrape_sent(udp_tracker_connection const* c)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		m_pending_scrapes.erase(std::remove_if(m_pending_scrapes.begin(), m_pending_scrapes.end()
+			, [c](std::weak_ptr<udp_tracker_connection> const& w)
+			{
+				auto const p = w.lock();
+				return !p || p.get() == c;
+			}), m_pending_scrapes.end());
+	}
+
+	bool tracker_manager::join_udp_connect(address const& a
+		, std::shared_ptr<udp_tracker_connection> const& c)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		auto const i = m_udp_connects.find(a);
+		if (i == m_udp_connects.end())
+		{
+			// the caller becomes the one sending the connect request
+			m_udp_connects[a];
+			return false;
+		}
+		i->second.push_back(c);
+		m_stats_counters.inc_stats_counter(counters::udp_tracker_connects_saved);
+		return true;
+	}
+
+	void tracker_manager::udp_connect_done(address const& a)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		auto const i = m_udp_connects.find(a);
+		if (i == m_udp_connects.end()) return;
+		auto const waiters = std::move(i->second);
+		m_udp_connects.erase(i);
+
+		// if the connect succeeded, the connection ID is in the cache now and
+		// the waiters go straight to announcing/scraping. If it failed, the
+		// first one will send its own connect request and the rest queue up
+		// behind it again
+		for (auto const& w : waiters)
+		{
+			auto c = w.lock();
+			if (!c) continue;
+			post(c->get_executor(), [c]
+			{
+				if (c->cancelled()) return;
+				c->start_announce();
+			});
+		}
 	}
 
 	void tracker_manager::update_transaction_id(
@@ -299,8 +352,28 @@ constexpr tracker_request_flags_t tracker_request::scrape_request;
 		}
 		else if (protocol == "udp")
 		{
+			bool const scrape = bool(req.kind & tracker_request::scrape_request);
+			if (scrape)
+			{
+				// BEP 15 allows scraping many info-hashes in one packet. If we
+				// have a scrape of the same tracker that hasn't gone out yet,
+				// just add this torrent to it
+				for (auto const& w : m_pending_scrapes)
+				{
+					auto const p = w.lock();
+					if (!p) continue;
+					tracker_request const& pr = p->tracker_req();
+					if (pr.url != req.url || !(pr.outgoing_socket == req.outgoing_socket))
+						continue;
+					if (!p->add_scrape(req, c)) continue;
+					m_stats_counters.inc_stats_counter(counters::udp_tracker_scrapes_batched);
+					return;
+				}
+			}
+
 			auto con = std::make_shared<udp_tracker_connection>(ios, *this, std::move(req), c);
 			m_udp_conns[con->transaction_id()] = con;
+			if (scrape) m_pending_scrapes.push_back(con);
 			con->start();
 			return;
 		}
@@ -412,10 +485,46 @@ constexpr tracker_request_flags_t tracker_request::scrape_request;
 		m_send_fun(sock, ep, p, ec, flags);
 	}
 
+	std::shared_ptr<http_connection> tracker_manager::acquire_http_connection(
+		std::string const& url, bind_info_t const& bind_addr)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		std::shared_ptr<http_connection> ret = m_http_pool.acquire(url, bind_addr
+			, seconds(m_settings.get_int(settings_pack::tracker_http_pool_idle_timeout)));
+		m_stats_counters.set_value(counters::num_idle_http_tracker_connections
+			, m_http_pool.num_idle());
+		return ret;
+	}
+
+	void tracker_manager::release_http_connection(std::shared_ptr<http_connection> c)
+	{
+		TORRENT_ASSERT(is_single_thread());
+		// only count the connections whose idle socket actually carried the
+		// request, not the ones that had to reconnect
+		if (c->served_reused())
+			m_stats_counters.inc_stats_counter(counters::http_tracker_connections_reused);
+		m_http_pool.release(std::move(c), m_abort ? 0
+			: m_settings.get_int(settings_pack::tracker_http_pool_max_idle));
+		m_stats_counters.set_value(counters::num_idle_http_tracker_connections
+			, m_http_pool.num_idle());
+	}
+
+	void tracker_manager::expire_http_connections()
+	{
+		TORRENT_ASSERT(is_single_thread());
+		if (m_http_pool.num_idle() == 0) return;
+		m_http_pool.expire(seconds(m_settings.get_int(
+			settings_pack::tracker_http_pool_idle_timeout)));
+		m_stats_counters.set_value(counters::num_idle_http_tracker_connections
+			, m_http_pool.num_idle());
+	}
+
 	void tracker_manager::stop()
 	{
 		abort_all_requests();
 		m_abort = true;
+		m_http_pool.close();
+		m_stats_counters.set_value(counters::num_idle_http_tracker_connections, 0);
 	}
 
 	void tracker_manager::abort_all_requests(bool all)
@@ -37,6 +37,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <cctype>
 #include <functional>
 #include <tuple>
+#include <array>
 
 #include "libtorrent/parse_url.hpp"
 #include "libtorrent/udp_tracker_connection.hpp"
@@ -90,6 +91,7 @@ namespace libtorrent {
 
 		if (ec)
 		{
+			fail_batch(ec, operation_t::parse_address, "", seconds32(0));
 			tracker_connection::fail(ec, operation_t::parse_address);
 			return;
 		}
@@ -122,9 +124,54 @@ namespace libtorrent {
 			, settings.get_int(settings_pack::tracker_receive_timeout));
 	}
 
+	constexpr int udp_tracker_connection::max_scrape_hashes;
+
+	bool udp_tracker_connection::add_scrape(tracker_request& req
+		, std::weak_ptr<request_callback> c)
+	{
+		TORRENT_ASSERT(tracker_req().kind & tracker_request::scrape_request);
+		TORRENT_ASSERT(req.kind & tracker_request::scrape_request);
+		if (m_scrape_sent || cancelled()) return false;
+		if (int(m_batch.size()) + 1 >= max_scrape_hashes) return false;
+
+#ifndef TORRENT_DISABLE_LOGGING
+		std::shared_ptr<request_callback> cb = c.lock();
+		if (cb && cb->should_log())
+		{
+			cb->debug_log("*** UDP_TRACKER [ batching scrape with %d other torrents: %s ]"
+				, int(m_batch.size()) + 1, req.url.c_str());
+		}
+#endif
+		m_batch.push_back({std::move(req), std::move(c)});
+		return true;
+	}
+
+	void udp_tracker_connection::fail_batch(error_code const& ec, operation_t const op
+		, char const* msg, seconds32 const interval)
+	{
+		for (auto& b : m_batch)
+		{
+			auto cb = b.requester.lock();
+			if (!cb) continue;
+			// we need to post the error to avoid deadlock
+			post(get_executor(), std::bind(&request_callback::tracker_request_error
+				, std::move(cb), std::move(b.req), ec, op, std::string(msg), interval));
+		}
+		m_batch.clear();
+	}
+
+	void udp_tracker_connection::release_connect()
+	{
+		if (!m_connect_leader) return;
+		m_connect_leader = false;
+		m_man.udp_connect_done(m_target.address());
+	}
+
 	void udp_tracker_connection::fail(error_code const& ec, operation_t const op
 		, char const* msg, seconds32 const interval, seconds32 const min_interval)
 	{
+		release_connect();
+
 		// m_target failed. remove it from the endpoint list
 		auto const i = std::find(m_endpoints.begin()
 			, m_endpoints.end(), make_tcp(m_target));
@@ -135,6 +182,7 @@ namespace libtorrent {
 		// fail the whole announce
 		if (m_endpoints.empty() || !tracker_req().outgoing_socket)
 		{
+			fail_batch(ec, op, msg, interval.count() == 0 ? min_interval : interval);
 			tracker_connection::fail(ec, op, msg, interval, min_interval);
 			return;
 		}
@@ -269,6 +317,23 @@ namespace libtorrent {
 		}
 		l.unlock();
 
+		// if another request to this tracker is already waiting for a
+		// connection ID, don't send a connect of our own. We'll be restarted
+		// once it arrives
+		if (m_man.join_udp_connect(m_target.address(), shared_from_this()))
+		{
+#ifndef TORRENT_DISABLE_LOGGING
+			std::shared_ptr<request_callback> cb = requester();
+			if (cb && cb->should_log())
+			{
+				cb->debug_log("*** UDP_TRACKER [ waiting for pending connect to %s ]"
+					, print_endpoint(m_target).c_str());
+			}
+#endif
+			return;
+		}
+		m_connect_leader = true;
+
 		send_udp_connect();
 	}
 
@@ -289,7 +354,11 @@ namespace libtorrent {
 
 	void udp_tracker_connection::close()
 	{
+		// the scrapes piggy-backing on this one still expect an answer
+		fail_batch(boost::asio::error::operation_aborted, operation_t::unknown
+			, "", seconds32(0));
 		cancel();
+		release_connect();
 		m_man.remove_request(this);
 	}
 
@@ -436,10 +505,14 @@ namespace libtorrent {
 		update_transaction_id();
 		std::int64_t const connection_id = aux::read_int64(buf);
 
-		std::lock_guard<std::mutex> l(m_cache_mutex);
+		std::unique_lock<std::mutex> l(m_cache_mutex);
 		connection_cache_entry& cce = m_connection_cache[m_target.address()];
 		cce.connection_id = connection_id;
 		cce.expires = aux::time_now() + seconds(m_man.settings().get_int(settings_pack::udp_tracker_token_expiry));
+		l.unlock();
+
+		// the connection ID is cached now, let anyone waiting for it go
+		release_connect();
 
 		if (!(tracker_req().kind & tracker_request::scrape_request))
 			send_udp_announce();
@@ -525,32 +598,52 @@ namespace libtorrent {
 		TORRENT_ASSERT(i != m_connection_cache.end());
 		if (i == m_connection_cache.end()) return;
 
-		char buf[8 + 4 + 4 + 20];
+		// once the packet is out, no more scrapes can join
+		if (!m_scrape_sent)
+		{
+			m_scrape_sent = true;
+			m_man.scrape_sent(this);
+		}
+
+		std::array<char, 8 + 4 + 4 + 20 * max_scrape_hashes> buf;
 		span<char> view = buf;
 
 		aux::write_int64(i->second.connection_id, view); // connection_id
 		aux::write_int32(action_t::scrape, view); // action (scrape)
 		aux::write_int32(m_transaction_id, view); // transaction_id
-		// info_hash
+		// info_hashes, our own first, followed by the batched ones
 		std::copy(tracker_req().info_hash.begin(), tracker_req().info_hash.end()
 			, view.data());
-#if TORRENT_USE_ASSERTS
-		TORRENT_ASSERT(view.size() == 20);
+		view = view.subspan(20);
+		for (auto const& b : m_batch)
+		{
+			std::copy(b.req.info_hash.begin(), b.req.info_hash.end(), view.data());
+			view = view.subspan(20);
+		}
+		span<char const> const packet(buf.data(), int(buf.size()) - int(view.size()));
+
+#ifndef TORRENT_DISABLE_LOGGING
+		std::shared_ptr<request_callback> cb = requester();
+		if (cb && cb->should_log())
+		{
+			cb->debug_log("==> UDP_TRACKER_SCRAPE [ hashes: %d ]"
+				, int(m_batch.size()) + 1);
+		}
 #endif
 
 		error_code ec;
 		if (!m_hostname.empty())
 		{
 			m_man.send_hostname(bind_socket(), m_hostname.c_str(), m_target.port()
-				, buf, ec, udp_socket::tracker_connection);
+				, packet, ec, udp_socket::tracker_connection);
 		}
 		else
 		{
-			m_man.send(bind_socket(), m_target, buf, ec
+			m_man.send(bind_socket(), m_target, packet, ec
 				, udp_socket::tracker_connection);
 		}
 		m_state = action_t::scrape;
-		sent_bytes(sizeof(buf) + 28); // assuming UDP/IP header
+		sent_bytes(int(packet.size()) + 28); // assuming UDP/IP header
 		++m_attempts;
 		if (ec)
 		{
@@ -662,10 +755,34 @@ namespace libtorrent {
 			return true;
 		}
 
+		// the response has one (complete, downloaded, incomplete) triplet
+		// per info-hash, in the order they were requested
 		int const complete = aux::read_int32(buf);
 		int const downloaded = aux::read_int32(buf);
 		int const incomplete = aux::read_int32(buf);
 
+		for (auto& b : m_batch)
+		{
+			if (buf.size() < 12)
+			{
+				// the tracker didn't include this one
+				std::shared_ptr<request_callback> bcb = b.requester.lock();
+				if (!bcb) continue;
+				post(get_executor(), std::bind(&request_callback::tracker_request_error
+					, std::move(bcb), std::move(b.req)
+					, error_code(errors::invalid_tracker_response_length)
+					, operation_t::bittorrent, std::string(), seconds32(0)));
+				continue;
+			}
+			int const bcomplete = aux::read_int32(buf);
+			int const bdownloaded = aux::read_int32(buf);
+			int const bincomplete = aux::read_int32(buf);
+			std::shared_ptr<request_callback> bcb = b.requester.lock();
+			if (!bcb) continue;
+			bcb->tracker_scrape_response(b.req, bcomplete, bincomplete, bdownloaded, -1);
+		}
+		m_batch.clear();
+
 		std::shared_ptr<request_callback> cb = requester();
 		if (!cb)
 		{
@@ -0,0 +1,311 @@
+/*
+
+Copyright (c) 2026, libtorrentSN contributors
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the distribution.
+    * Neither the name of the author nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "libtorrent/aux_/utp_congestion_control.hpp"
+#include "libtorrent/aux_/utp_socket_manager.hpp"
+#include "libtorrent/performance_counters.hpp"
+#include "libtorrent/settings_pack.hpp"
+#include "libtorrent/assert.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace libtorrent { namespace aux {
+
+	void utp_congestion_controller::on_loss(int const mss, time_point)
+	{
+		save_window();
+		m_cwnd = std::max(m_cwnd * m_sm.loss_multiplier() / 100
+			, std::int64_t(mss) * (1 << 16));
+
+		// if we happen to be in slow-start mode, we need to leave it
+		// note that we set ssthres to the window size _after_ reducing it. Next slow
+		// start should end before we over shoot.
+		if (m_slow_start)
+		{
+			m_ssthres = std::int32_t(m_cwnd >> 16);
+			m_slow_start = false;
+		}
+	}
+
+	void utp_congestion_controller::on_timeout(bool const idle, int const mss
+		, time_point)
+	{
+		save_window();
+		if (idle && window() >= mss)
+		{
+			// this is just a timeout because this direction of
+			// the stream is idle. Don't reset the cwnd, just decay it
+			m_cwnd = std::max(m_cwnd * 2 / 3, std::int64_t(mss) * (1 << 16));
+		}
+		else
+		{
+			// we timed out because a packet was not ACKed or because
+			// the cwnd was made smaller than one packet
+			m_cwnd = std::int64_t(mss) * (1 << 16);
+		}
+
+		// when we time out, the cwnd is reset to 1 MSS, which means we
+		// need to ramp it up quickly again. enter slow start mode. This time
+		// we're very likely to have an ssthres set, which will make us leave
+		// slow start before inducing more delay or loss.
+		m_slow_start = true;
+	}
+
+	void utp_congestion_controller::undo()
+	{
+		if (m_prior_cwnd == 0) return;
+		m_cwnd = std::max(m_cwnd, m_prior_cwnd);
+		m_ssthres = std::max(m_ssthres, m_prior_ssthres);
+		m_slow_start = m_slow_start || m_prior_slow_start;
+		m_prior_cwnd = 0;
+	}
+
+	void utp_congestion_controller::save_window()
+	{
+		m_prior_cwnd = m_cwnd;
+		m_prior_ssthres = m_ssthres;
+		m_prior_slow_start = m_slow_start;
+	}
+
+	void utp_ledbat::on_ack(utp_ack_event const& e)
+	{
+		// the portion of the in-flight bytes that were acked. This is used to make
+		// the gain factor be scaled by the rtt. The formula is applied once per
+		// rtt, or on every ACK scaled by the number of ACKs per rtt
+		TORRENT_ASSERT(e.prev_in_flight > 0);
+		TORRENT_ASSERT(e.acked_bytes > 0);
+
+		int const target_delay = std::max(1, m_sm.target_delay());
+
+		// true if the upper layer is pushing enough data down the socket to be
+		// limited by the cwnd. If this is not the case, we should not adjust cwnd.
+		bool const cwnd_saturated = (e.in_flight + e.acked_bytes + e.mss > window());
+
+		// all of these are fixed points with 16 bits fraction portion
+		std::int64_t const window_factor = (std::int64_t(e.acked_bytes) * (1 << 16)) / e.prev_in_flight;
+		std::int64_t const delay_factor = (std::int64_t(target_delay - e.delay) * (1 << 16)) / target_delay;
+		std::int64_t scaled_gain;
+
+		if (e.delay >= target_delay)
+		{
+			if (m_slow_start)
+			{
+				m_ssthres = std::int32_t(window() / 2);
+				m_slow_start = false;
+			}
+
+			m_sm.inc_stats_counter(counters::utp_samples_above_target);
+		}
+		else
+		{
+			m_sm.inc_stats_counter(counters::utp_samples_below_target);
+		}
+
+		std::int64_t const linear_gain = ((window_factor * delay_factor) >> 16)
+			* std::int64_t(m_sm.gain_factor());
+
+		// if the user is not saturating the link (i.e. not filling the
+		// congestion window), don't adjust it at all.
+		if (cwnd_saturated)
+		{
+			std::int64_t const exponential_gain = std::int64_t(e.acked_bytes) * (1 << 16);
+			if (m_slow_start)
+			{
+				// mimic TCP slow-start by adding the number of acked
+				// bytes to cwnd
+				if (m_ssthres != 0 && ((m_cwnd + exponential_gain) >> 16) > m_ssthres)
+				{
+					// if we would exceed the slow start threshold by growing the cwnd
+					// exponentially, don't do it, and leave slow-start mode. This
+					// make us avoid causing more delay and/or packet loss by being too
+					// aggressive
+					m_slow_start = false;
+					scaled_gain = linear_gain;
+				}
+				else
+				{
+					scaled_gain = std::max(exponential_gain, linear_gain);
+				}
+			}
+			else
+			{
+				scaled_gain = linear_gain;
+			}
+		}
+		else
+		{
+			scaled_gain = 0;
+		}
+
+		// make sure we don't wrap the cwnd
+		if (scaled_gain >= std::numeric_limits<std::int64_t>::max() - m_cwnd)
+			scaled_gain = std::numeric_limits<std::int64_t>::max() - m_cwnd - 1;
+
+		// don't drop below 1*MSS. This behavior is from rfc6817 (LEDBAT). This differs
+		// from BEP 29 which allows cwnd to drop to 0, however this way avoids needing
+		// to wait until the next timeout to resume sending.
+		if ((m_cwnd + scaled_gain) >> 16 < e.mss)
+			m_cwnd = std::int64_t(e.mss) * (1 << 16);
+		else
+			m_cwnd += scaled_gain;
+
+		TORRENT_ASSERT(window() >= e.mss);
+	}
+
+	void utp_ledbat_plus_plus::on_ack(utp_ack_event const& e)
+	{
+		TORRENT_ASSERT(e.prev_in_flight > 0);
+		TORRENT_ASSERT(e.acked_bytes > 0);
+
+		int const target_delay = std::max(1, m_sm.target_delay());
+		if (e.rtt_sample > 0) m_min_rtt = std::min(m_min_rtt, e.rtt_sample);
+		m_rtt = milliseconds(std::max(e.rtt, 1));
+
+		m_sm.inc_stats_counter(e.delay >= target_delay
+			? counters::utp_samples_above_target
+			: counters::utp_samples_below_target);
+
+		if (m_phase == phase::frozen)
+		{
+			if (e.now < m_frozen_until) return;
+			m_phase = phase::recovering;
+		}
+
+		bool const cwnd_saturated = (e.in_flight + e.acked_bytes + e.mss > window());
+
+		// the gain is 1 / min(16, ceil(2 * target / base delay)) packets per
+		// RTT. The base one-way delay is estimated as half the lowest RTT
+		int const base_delay = int(std::min(m_min_rtt / 2, std::uint32_t(target_delay)));
+		int const gain_div = base_delay <= 0 ? 16
+			: std::min(16, (2 * target_delay + base_delay - 1) / base_delay);
+
+		std::int64_t scaled_gain = 0;
+		if (m_slow_start)
+		{
+			if (e.delay > target_delay * 3 / 4
+				|| (m_ssthres != 0 && window() >= m_ssthres))
+			{
+				m_slow_start = false;
+				if (m_phase == phase::initial)
+				{
+					// the first slowdown is two RTTs after the initial
+					// slow-start
+					m_ssthres = window();
+					m_phase = phase::normal;
+					m_next_slowdown = e.now + 2 * m_rtt;
+				}
+				else if (m_phase == phase::recovering)
+				{
+					end_slowdown(e.now);
+				}
+			}
+			else if (cwnd_saturated)
+			{
+				scaled_gain = std::int64_t(e.acked_bytes) * (1 << 16) / gain_div;
+			}
+		}
+		else if (cwnd_saturated)
+		{
+			// per RTT, the window grows by the gain while under the target
+			// delay. Over it, it shrinks by the window times how far over the
+			// target it is (minus the gain), but by no more than half
+			std::int64_t const gain = std::int64_t(e.mss) * (1 << 16) / gain_div;
+			std::int64_t const per_rtt = e.delay < target_delay ? gain
+				: std::max(gain - m_cwnd / target_delay * (e.delay - target_delay)
+					, -m_cwnd / 2);
+			scaled_gain = per_rtt * e.acked_bytes / e.prev_in_flight;
+		}
+
+		if (m_phase == phase::normal && !m_slow_start && e.now >= m_next_slowdown)
+		{
+			// slow down to 2 packets for two RTTs, then slow-start back up
+			// to where we were
+			m_ssthres = window();
+			m_cwnd = std::min(m_cwnd, std::int64_t(e.mss) * 2 * (1 << 16));
+			m_slowdown_start = e.now;
+			m_frozen_until = e.now + 2 * m_rtt;
+			m_phase = phase::frozen;
+			m_slow_start = true;
+			m_sm.inc_stats_counter(counters::utp_slowdowns);
+			return;
+		}
+
+		// make sure we don't wrap the cwnd
+		if (scaled_gain >= std::numeric_limits<std::int64_t>::max() - m_cwnd)
+			scaled_gain = std::numeric_limits<std::int64_t>::max() - m_cwnd - 1;
+
+		if ((m_cwnd + scaled_gain) >> 16 < e.mss)
+			m_cwnd = std::int64_t(e.mss) * (1 << 16);
+		else
+			m_cwnd += scaled_gain;
+	}
+
+	void utp_ledbat_plus_plus::on_loss(int const mss, time_point const now)
+	{
+		utp_congestion_controller::on_loss(mss, now);
+		if (m_phase == phase::initial)
+		{
+			m_phase = phase::normal;
+			m_next_slowdown = now + 2 * m_rtt;
+		}
+		else if (m_phase != phase::normal)
+		{
+			end_slowdown(now);
+		}
+	}
+
+	void utp_ledbat_plus_plus::on_timeout(bool const idle, int const mss
+		, time_point const now)
+	{
+		utp_congestion_controller::on_timeout(idle, mss, now);
+		// the window was just reset, there's nothing left to drain
+		if (m_phase == phase::frozen) m_phase = phase::recovering;
+	}
+
+	void utp_ledbat_plus_plus::end_slowdown(time_point const now)
+	{
+		TORRENT_ASSERT(m_phase == phase::frozen || m_phase == phase::recovering);
+		// the slowdowns are spaced 9 times their duration apart, to cost
+		// at most about 10% of the throughput
+		m_next_slowdown = now + 9 * (now - m_slowdown_start);
+		m_phase = phase::normal;
+	}
+
+	std::unique_ptr<utp_congestion_controller> make_utp_congestion_controller(
+		int const algorithm, utp_socket_manager& sm)
+	{
+		if (algorithm == settings_pack::ledbat_plus_plus)
+			return std::make_unique<utp_ledbat_plus_plus>(sm);
+		return std::make_unique<utp_ledbat>(sm);
+	}
+}}
@@ -62,30 +62,48 @@ namespace aux {
 		, m_sett(sett)
 		, m_counters(cnt)
 		, m_ios(ios)
+		, m_wake_timer(ios)
 		, m_ssl_context(ssl_context)
 	{
 		m_restrict_mtu.fill(65536);
 	}
 
-	utp_socket_manager::~utp_socket_manager() = default;
+	utp_socket_manager::~utp_socket_manager()
+	{
+		// the sockets return their packets to m_packet_pool, which is
+		// destructed before m_utp_sockets
+		m_utp_sockets.clear();
+	}
 
 	void utp_socket_manager::tick(time_point now)
 	{
-		for (auto i = m_utp_sockets.begin()
-			, end(m_utp_sockets.end()); i != end;)
+		// the sockets are looked up by index, they may connect new sockets
+		for (std::size_t i = 0; i < m_utp_sockets.size();)
 		{
-			if (i->second->should_delete())
+			if (m_utp_sockets[i]->should_delete())
 			{
-				if (m_last_socket == i->second.get()) m_last_socket = nullptr;
-				if (m_deferred_ack == i->second.get()) m_deferred_ack = nullptr;
-				i = m_utp_sockets.erase(i);
+				erase_socket(i);
 				continue;
 			}
-			i->second->tick(now);
+			m_utp_sockets[i]->tick(now);
 			++i;
 		}
 	}
 
+	void utp_socket_manager::erase_socket(std::size_t const pos)
+	{
+		utp_socket_impl* s = m_utp_sockets[pos].get();
+		if (m_last_socket == s) m_last_socket = nullptr;
+		if (m_deferred_ack == s) m_deferred_ack = nullptr;
+		m_socket_index.erase(s);
+		m_wakeups.erase(std::remove_if(m_wakeups.begin(), m_wakeups.end()
+			, [s](std::pair<time_point, utp_socket_impl*> const& e) { return e.second == s; })
+			, m_wakeups.end());
+		if (pos != m_utp_sockets.size() - 1)
+			m_utp_sockets[pos] = std::move(m_utp_sockets.back());
+		m_utp_sockets.pop_back();
+	}
+
 	int utp_socket_manager::mtu_for_dest(address const& addr) const
 	{
 		int mtu = 0;
@@ -172,13 +190,10 @@ namespace aux {
 			m_deferred_ack = nullptr;
 		}
 
-		auto r = m_utp_sockets.equal_range(id);
-
-		for (; r.first != r.second; ++r.first)
+		if (utp_socket_impl* s = m_socket_index.find(ep, id))
 		{
-			if (!r.first->second->match(ep, id)) continue;
-			bool const ret = r.first->second->incoming_packet(p, ep, receive_time);
-			if (ret) m_last_socket = r.first->second.get();
+			bool const ret = s->incoming_packet(p, ep, receive_time);
+			if (ret) m_last_socket = s;
 			return ret;
 		}
 
@@ -242,6 +257,48 @@ namespace aux {
 		m_stalled_sockets.push_back(s);
 	}
 
+	void utp_socket_manager::wake_at(utp_socket_impl* s, time_point const at)
+	{
+		m_wakeups.emplace_back(at, s);
+		if (at < m_wake_timer_expiry) arm_wake_timer(at);
+	}
+
+	void utp_socket_manager::arm_wake_timer(time_point const at)
+	{
+		m_wake_timer_expiry = at;
+		m_wake_timer.expires_at(at);
+		m_wake_timer.async_wait([this](error_code const& ec) { on_wake_timer(ec); });
+	}
+
+	void utp_socket_manager::on_wake_timer(error_code const& ec)
+	{
+		// the timer is cancelled when it's re-armed for an earlier time, or
+		// when we're being destructed
+		if (ec) return;
+
+		m_wake_timer_expiry = max_time();
+		time_point const now = clock_type::now();
+		time_point next = max_time();
+		m_woken.clear();
+		for (std::size_t i = 0; i < m_wakeups.size();)
+		{
+			if (m_wakeups[i].first <= now)
+			{
+				m_woken.push_back(m_wakeups[i].second);
+				m_wakeups[i] = m_wakeups.back();
+				m_wakeups.pop_back();
+				continue;
+			}
+			next = std::min(next, m_wakeups[i].first);
+			++i;
+		}
+
+		// the sockets may ask to be woken up again, and arm the timer
+		for (auto const s : m_woken) s->on_wake(now);
+
+		if (next < m_wake_timer_expiry) arm_wake_timer(next);
+	}
+
 	void utp_socket_manager::writable()
 	{
 		if (!m_stalled_sockets.empty())
@@ -298,20 +355,29 @@ namespace aux {
 		auto iface = sock.lock();
 		for (auto& s : m_utp_sockets)
 		{
-			if (s.second->m_sock.lock() != iface)
+			if (s->m_sock.lock() != iface)
 				continue;
 
-			s.second->abort();
+			s->abort();
 		}
 	}
 
 	void utp_socket_manager::remove_socket(std::uint16_t const id)
 	{
-		auto const i = m_utp_sockets.find(id);
+		auto const i = std::find_if(m_utp_sockets.begin(), m_utp_sockets.end()
+			, [id](std::unique_ptr<utp_socket_impl> const& s) { return s->receive_id() == id; });
 		if (i == m_utp_sockets.end()) return;
-		if (m_last_socket == i->second.get()) m_last_socket = nullptr;
-		if (m_deferred_ack == i->second.get()) m_deferred_ack = nullptr;
-		m_utp_sockets.erase(i);
+		erase_socket(std::size_t(i - m_utp_sockets.begin()));
+	}
+
+	void utp_socket_manager::unindex_socket(utp_socket_impl* s)
+	{
+		m_socket_index.erase(s);
+	}
+
+	void utp_socket_manager::index_socket(utp_socket_impl* s)
+	{
+		m_socket_index.insert(s);
 	}
 
 	void utp_socket_manager::inc_stats_counter(int counter, int delta)
@@ -340,7 +406,7 @@ namespace aux {
 		}
 		auto impl = std::make_unique<utp_socket_impl>(recv_id, send_id, str, *this);
 		auto const ret = impl.get();
-		m_utp_sockets.emplace(recv_id, std::move(impl));
+		m_utp_sockets.push_back(std::move(impl));
 		return ret;
 	}
 }
@@ -131,6 +131,11 @@ void set_utp_stream_logging(bool enable) {
 
 #endif
 
+// payload packets that are due this close to now are sent right away. At
+// high rates, this sends a few packets per wakeup instead of waking up for
+// each
+constexpr time_duration pacing_slack = milliseconds(1);
+
 enum
 {
 	ACK_MASK = 0xffff,
@@ -164,6 +169,7 @@ utp_socket_impl::utp_socket_impl(std::uint16_t const recv_id
 	: m_sm(sm)
 	, m_userdata(userdata)
 	, m_timeout(clock_type::now() + milliseconds(m_sm.connect_timeout()))
+	, m_cc(make_utp_congestion_controller(m_sm.congestion_control(), m_sm))
 	, m_send_id(send_id)
 	, m_recv_id(recv_id)
 	, m_delay_sample_idx(0)
@@ -172,13 +178,15 @@ utp_socket_impl::utp_socket_impl(std::uint16_t const recv_id
 	, m_out_eof(false)
 	, m_attached(true)
 	, m_nagle(true)
-	, m_slow_start(true)
 	, m_cwnd_full(false)
 	, m_null_buffers(false)
 	, m_deferred_ack(false)
 	, m_subscribe_drained(false)
 	, m_stalled(false)
 	, m_confirmed(false)
+	, m_paced(false)
+	, m_reordering_seen(false)
+	, m_tlp_sent(false)
 {
 	TORRENT_ASSERT((m_recv_id == ((m_send_id + 1) & 0xffff))
 		|| (m_send_id == ((m_recv_id + 1) & 0xffff)));
@@ -267,7 +275,7 @@ void utp_socket_impl::update_mtu_limits()
 
 	m_mtu = (m_mtu_floor + m_mtu_ceiling) / 2;
 
-	if ((m_cwnd >> 16) < m_mtu) m_cwnd = std::int64_t(m_mtu) * (1 << 16);
+	m_cc->clamp_window(m_mtu);
 
 	UTP_LOGV("%8p: updating MTU to: %d [%d, %d]\n"
 		, static_cast<void*>(this), m_mtu, m_mtu_floor, m_mtu_ceiling);
@@ -367,7 +375,8 @@ utp_stream::~utp_stream()
 	{
 		UTP_LOGV("%8p: utp_stream destructed\n", static_cast<void*>(m_impl));
 		m_impl->destroy();
-		m_impl->detach();
+		// cancelling a pending handler may already have detached us
+		if (m_impl) m_impl->detach();
 		m_impl = nullptr;
 	}
 }
@@ -762,8 +771,10 @@ void utp_socket_impl::do_connect(tcp::endpoint const& ep)
 	int const mtu = m_sm.mtu_for_dest(ep.address());
 	init_mtu(mtu);
 	TORRENT_ASSERT(m_connect_handler == false);
+	m_sm.unindex_socket(this);
 	m_remote_address = ep.address();
 	m_port = ep.port();
+	m_sm.index_socket(this);
 
 	m_connect_handler = true;
 
@@ -973,6 +984,7 @@ void utp_socket_impl::send_syn()
 	m_seq_nr = std::uint16_t(random(0xffff));
 	m_acked_seq_nr = (m_seq_nr - 1) & ACK_MASK;
 	m_loss_seq_nr = m_acked_seq_nr;
+	m_rack_seq_nr = m_acked_seq_nr;
 	m_ack_nr = 0;
 	m_fast_resend_seq_nr = m_seq_nr;
 
@@ -1084,6 +1096,52 @@ void utp_socket_impl::writable()
 	maybe_trigger_send_callback({});
 }
 
+void utp_socket_impl::on_wake(time_point const now)
+{
+	// this is a left-over from a wakeup that was pushed back, a later one
+	// is pending
+	if (m_wake_at > now + pacing_slack) return;
+	m_wake_at = max_time();
+
+	if (state() == state_t::error_wait || state() == state_t::deleting) return;
+
+	if (m_paced)
+	{
+		if (m_next_send - pacing_slack > now)
+		{
+			wake_at(m_next_send - pacing_slack);
+		}
+		// if the socket is stalled, it'll resume sending once it's writable
+		else if (!m_stalled)
+		{
+			m_paced = false;
+			while (send_pkt());
+			maybe_trigger_send_callback({});
+			if (state() == state_t::error_wait || state() == state_t::deleting) return;
+		}
+		else
+		{
+			m_paced = false;
+		}
+	}
+
+	detect_lost_packets(now);
+	if (state() == state_t::error_wait || state() == state_t::deleting) return;
+
+	if (m_tlp_at != max_time())
+	{
+		if (m_tlp_at > now + pacing_slack) wake_at(m_tlp_at);
+		else send_tail_loss_probe();
+	}
+}
+
+void utp_socket_impl::wake_at(time_point const at)
+{
+	if (at >= m_wake_at) return;
+	m_wake_at = at;
+	m_sm.wake_at(this, at);
+}
+
 void utp_socket_impl::send_fin()
 {
 	INVARIANT_CHECK;
@@ -1287,6 +1345,10 @@ std::pair<std::uint32_t, int> utp_socket_impl::parse_sack(std::uint16_t const pa
 		num_to_resend = 0;
 	}
 
+	// on a path that reorders packets, counting duplicate ACKs causes
+	// spurious retransmits. Leave it to RACK, which allows for the reordering
+	if (m_sm.rack() && m_reordering_seen) num_to_resend = 0;
+
 	// now we need to (likely) prune the tail of the resend list, since all
 	// "unacked" packets that weren't followed by an acked one, don't count
 	while (num_to_resend > 0 && !compare_less_wrap(resend[num_to_resend - 1], last_resend, ACK_MASK))
@@ -1499,7 +1561,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 	// general.
 	bool const mtu_probe = (m_mtu_seq == 0
 		&& m_seq_nr != 0
-		&& (m_cwnd >> 16) > m_mtu_floor * 3);
+		&& m_cc->window() > m_mtu_floor * 3);
 	// for non MTU-probes, use the conservative packet size
 	int const effective_mtu = mtu_probe ? m_mtu : m_mtu_floor;
 
@@ -1538,7 +1600,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 	// if we have one MSS worth of data, make sure it fits in our
 	// congestion window and the advertised receive window from
 	// the other end.
-	if (m_bytes_in_flight + payload_size > std::min(int(m_cwnd >> 16)
+	if (m_bytes_in_flight + payload_size > std::min(m_cc->window()
 		, int(m_adv_wnd)))
 	{
 		// we can't fit a full packet of payload in the cwnd, but if
@@ -1550,7 +1612,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 
 		UTP_LOGV("%8p: no space in window send_buffer_size:%d cwnd:%d "
 			"adv_wnd:%u in-flight:%d mtu:%u\n"
-			, static_cast<void*>(this), m_write_buffer_size, int(m_cwnd >> 16)
+			, static_cast<void*>(this), m_write_buffer_size, m_cc->window()
 			, m_adv_wnd, m_bytes_in_flight, m_mtu);
 
 		if (!force)
@@ -1561,13 +1623,33 @@ bool utp_socket_impl::send_pkt(int const flags)
 				"adv_wnd:%d in-flight:%d mtu:%u effective-mtu:%d\n"
 				, static_cast<void*>(this), int(m_seq_nr), int(m_ack_nr)
 				, m_send_id, print_endpoint(udp::endpoint(m_remote_address, m_port)).c_str()
-				, header_size, m_error.message().c_str(), m_write_buffer_size, int(m_cwnd >> 16)
+				, header_size, m_error.message().c_str(), m_write_buffer_size, m_cc->window()
 				, m_adv_wnd, m_bytes_in_flight, m_mtu, effective_mtu);
 #endif
 			return false;
 		}
 	}
 
+	// with pacing, payload packets are spread out over the RTT. When the
+	// next one isn't due yet, we can still send an ACK without payload
+	if (payload_size > 0 && m_sm.pacing()
+		&& m_next_send > clock_type::now() + pacing_slack)
+	{
+		if (!m_paced)
+		{
+			m_paced = true;
+			wake_at(m_next_send - pacing_slack);
+			m_sm.inc_stats_counter(counters::utp_paced_sends);
+		}
+
+		if (flags & pkt_ack) payload_size = 0;
+
+		UTP_LOGV("%8p: paced, next send in %d us\n", static_cast<void*>(this)
+			, int(total_microseconds(m_next_send - clock_type::now())));
+
+		if (!force) return false;
+	}
+
 	// if we don't have any data to send, or can't send any data
 	// and we don't have any data to force, don't send a packet
 	if (payload_size == 0 && !force)
@@ -1578,7 +1660,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 			"adv_wnd:%u in-flight:%d mtu:%u\n"
 			, static_cast<void*>(this), int(m_seq_nr), int(m_ack_nr)
 			, m_send_id, print_endpoint(udp::endpoint(m_remote_address, m_port)).c_str()
-			, header_size, m_error.message().c_str(), m_write_buffer_size, int(m_cwnd >> 16)
+			, header_size, m_error.message().c_str(), m_write_buffer_size, m_cc->window()
 			, m_adv_wnd, m_bytes_in_flight, m_mtu);
 #endif
 		return false;
@@ -1724,7 +1806,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 		// payload
 		UTP_LOGV("%8p: NAGLE not enough payload send_buffer_size:%d cwnd:%d "
 			"adv_wnd:%u in-flight:%d mtu:%d effective_mtu:%d\n"
-			, static_cast<void*>(this), m_write_buffer_size, int(m_cwnd >> 16)
+			, static_cast<void*>(this), m_write_buffer_size, m_cc->window()
 			, m_adv_wnd, m_bytes_in_flight, m_mtu, effective_mtu);
 		TORRENT_ASSERT(!m_nagle_packet);
 		TORRENT_ASSERT(h->seq_nr == m_seq_nr);
@@ -1767,7 +1849,7 @@ bool utp_socket_impl::send_pkt(int const flags)
 		"mtu_probe:%d extension:%d\n"
 		, static_cast<void*>(this), int(h->seq_nr), int(h->ack_nr), packet_type_names[h->get_type()]
 		, m_send_id, print_endpoint(udp::endpoint(m_remote_address, m_port)).c_str()
-		, p->size, m_error.message().c_str(), m_write_buffer_size, int(m_cwnd >> 16)
+		, p->size, m_error.message().c_str(), m_write_buffer_size, m_cc->window()
 		, m_adv_wnd, m_bytes_in_flight, m_mtu, std::uint32_t(h->timestamp_microseconds)
 		, std::uint32_t(h->timestamp_difference_microseconds), int(p->mtu_probe)
 		, h->extension);
@@ -1890,6 +1972,19 @@ bool utp_socket_impl::send_pkt(int const flags)
 		m_seq_nr = (m_seq_nr + 1) & ACK_MASK;
 		TORRENT_ASSERT(payload_size >= 0);
 		if (!m_stalled) m_bytes_in_flight += new_in_flight;
+
+		// the pacing rate is cwnd / RTT, doubled during slow-start and
+		// 25% over it otherwise, to leave the window room to grow
+		int const rtt = m_rtt.mean();
+		if (m_sm.pacing() && rtt > 0)
+		{
+			std::int64_t const interval = std::int64_t(new_in_flight + header_size)
+				* rtt * 1000 * (m_cc->slow_start() ? 2 : 4)
+				/ (std::int64_t(m_cc->window()) * (m_cc->slow_start() ? 4 : 5));
+			m_next_send = std::max(m_next_send, now) + microseconds(interval);
+		}
+
+		arm_tail_loss_probe(now);
 	}
 	else if (flags & pkt_fin)
 	{
@@ -1972,7 +2067,7 @@ bool utp_socket_impl::resend_packet(packet* p, bool fast_resend)
 	// since we can't re-packetize, some packets that are
 	// larger than the congestion window must be allowed through
 	// but only if we don't have any outstanding bytes
-	int const window_size_left = std::min(int(m_cwnd >> 16), int(m_adv_wnd)) - m_bytes_in_flight;
+	int const window_size_left = std::min(m_cc->window(), int(m_adv_wnd)) - m_bytes_in_flight;
 	if (!fast_resend
 		&& p->size - p->header_size > window_size_left
 		&& m_bytes_in_flight > 0)
@@ -1998,6 +2093,11 @@ bool utp_socket_impl::resend_packet(packet* p, bool fast_resend)
 #endif
 	p->need_resend = false;
 	auto* h = reinterpret_cast<utp_header*>(p->buf);
+
+	// a tail loss probe isn't repairing a loss the window was cut for
+	if (p->num_transmissions > 0 && !(m_tlp_sent && h->seq_nr == m_tlp_seq_nr))
+		++m_undo_retrans;
+
 	// update packet header
 	h->timestamp_difference_microseconds = m_reply_micro;
 	p->send_time = clock_type::now();
@@ -2034,7 +2134,7 @@ bool utp_socket_impl::resend_packet(packet* p, bool fast_resend)
 		"adv_wnd:%d in-flight:%d mtu:%d timestamp:%u time_diff:%d\n"
 		, static_cast<void*>(this), int(h->seq_nr), int(h->ack_nr), packet_type_names[h->get_type()]
 		, m_send_id, print_endpoint(udp::endpoint(m_remote_address, m_port)).c_str()
-		, p->size, ec.message().c_str(), m_write_buffer_size, int(m_cwnd >> 16)
+		, p->size, ec.message().c_str(), m_write_buffer_size, m_cc->window()
 		, m_adv_wnd, m_bytes_in_flight, m_mtu, std::uint32_t(h->timestamp_microseconds)
 		, std::uint32_t(h->timestamp_difference_microseconds));
 #endif
@@ -2093,21 +2193,113 @@ void utp_socket_impl::experienced_loss(std::uint32_t const seq_nr, time_point co
 	m_next_loss = now + milliseconds(m_sm.cwnd_reduce_timer());
 
 	// cut window size in 2
-	m_cwnd = std::max(m_cwnd * m_sm.loss_multiplier() / 100
-		, std::int64_t(m_mtu) * (1 << 16));
+	m_cc->on_loss(m_mtu, now);
+	m_undo_retrans = 0;
 	m_loss_seq_nr = m_seq_nr;
-	UTP_LOGV("%8p: Lost packet %d caused cwnd cut. m_loss_seq_nr:%d\n"
-		, static_cast<void*>(this), seq_nr, m_seq_nr);
+	UTP_LOGV("%8p: Lost packet %d caused cwnd cut. m_loss_seq_nr:%d cwnd:%d ssthres:%d\n"
+		, static_cast<void*>(this), seq_nr, m_seq_nr, m_cc->window(), m_cc->ssthres());
+}
+
+time_duration utp_socket_impl::reorder_window() const
+{
+	// a quarter of the lowest RTT, widened for every spurious retransmit, but
+	// never wider than the average RTT
+	std::int64_t const window = std::int64_t(m_min_rtt / 4) * m_reo_wnd_mult;
+	return microseconds(std::min(window, std::int64_t(m_rtt.mean()) * 1000));
+}
+
+void utp_socket_impl::detect_lost_packets(time_point const now)
+{
+	INVARIANT_CHECK;
 
-	// if we happen to be in slow-start mode, we need to leave it
-	// note that we set ssthres to the window size _after_ reducing it. Next slow
-	// start should end before we over shoot.
-	if (m_slow_start)
+	if (!m_sm.rack()) return;
+	if (m_rack_send_time == min_time() || m_min_rtt == 0xffffffff) return;
+
+	time_duration const reo_wnd = reorder_window();
+	time_point next = max_time();
+	bool cut_cwnd = true;
+
+	for (int i = (m_acked_seq_nr + 1) & ACK_MASK;
+		compare_less_wrap(std::uint32_t(i), m_rack_seq_nr, ACK_MASK);
+		i = (i + 1) & ACK_MASK)
 	{
-		m_ssthres = std::int32_t(m_cwnd >> 16);
-		m_slow_start = false;
-		UTP_LOGV("%8p: experienced loss, slow_start -> 0 ssthres:%d\n"
-			, static_cast<void*>(this), m_ssthres);
+		packet* p = m_outbuf.at(aux::numeric_cast<packet_buffer::index_type>(i));
+		if (!p || p->need_resend) continue;
+
+		// only packets sent before one that has been delivered can be
+		// inferred to be lost
+		if (p->send_time > m_rack_send_time) continue;
+
+		time_point const deadline = p->send_time + microseconds(m_rack_rtt) + reo_wnd;
+		if (deadline > now)
+		{
+			next = std::min(next, deadline);
+			continue;
+		}
+
+		UTP_LOGV("%8p: Packet %d lost (RACK). reo_wnd:%d us\n"
+			, static_cast<void*>(this), i, int(total_microseconds(reo_wnd)));
+
+		m_sm.inc_stats_counter(counters::utp_rack_retransmit);
+
+		// don't cut cwnd if the packet we lost was the MTU probe
+		// the logic to handle a lost MTU probe is in resend_packet()
+		if (cut_cwnd && (i != m_mtu_seq || m_mtu_seq == 0))
+		{
+			experienced_loss(std::uint32_t(i), now);
+			cut_cwnd = false;
+		}
+
+		// don't fast-resend this packet again
+		if (m_fast_resend_seq_nr == i)
+			m_fast_resend_seq_nr = (m_fast_resend_seq_nr + 1) & ACK_MASK;
+
+		if (!resend_packet(p, true)) return;
+	}
+
+	if (next != max_time()) wake_at(next);
+}
+
+void utp_socket_impl::arm_tail_loss_probe(time_point const now)
+{
+	m_tlp_at = max_time();
+	if (!m_sm.rack() || m_tlp_sent || m_bytes_in_flight == 0
+		|| m_rtt.num_samples() == 0)
+		return;
+
+	// two RTTs, but not so short that the ACK to a single packet would
+	// miss it
+	time_point const at = now + milliseconds(std::max(m_rtt.mean() * 2, 10));
+
+	// the retransmit timeout comes first anyway
+	if (at >= m_timeout) return;
+
+	m_tlp_at = at;
+	wake_at(at);
+}
+
+void utp_socket_impl::send_tail_loss_probe()
+{
+	INVARIANT_CHECK;
+
+	m_tlp_at = max_time();
+	if (m_tlp_sent || m_stalled) return;
+
+	// probe with the last packet sent that's still unacknowledged. Its ACK
+	// carries a SACK for the rest of the flight. The FIN is sent at m_seq_nr
+	int const last = state() == state_t::fin_sent ? m_seq_nr : ((m_seq_nr - 1) & ACK_MASK);
+	for (int i = last; i != m_acked_seq_nr; i = (i - 1) & ACK_MASK)
+	{
+		packet* p = m_outbuf.at(aux::numeric_cast<packet_buffer::index_type>(i));
+		if (!p || p->need_resend) continue;
+
+		UTP_LOGV("%8p: sending tail loss probe seq_nr:%d\n", static_cast<void*>(this), i);
+
+		m_tlp_sent = true;
+		m_tlp_seq_nr = std::uint16_t(i);
+		m_sm.inc_stats_counter(counters::utp_tail_loss_probe);
+		resend_packet(p, true);
+		return;
 	}
 }
 
@@ -2197,6 +2389,49 @@ std::uint32_t utp_socket_impl::ack_packet(packet_ptr p, time_point const receive
 		TORRENT_ASSERT_FAIL();
 	}
 
+	// an ACK of a retransmitted packet that arrives sooner than any ACK
+	// could, was for an earlier transmission. The retransmit was spurious,
+	// the packet was only delayed or reordered
+	if (p->num_transmissions > 1 && m_min_rtt != 0xffffffff && rtt < m_min_rtt / 2)
+	{
+		UTP_LOGV("%8p: acked packet %d (%d bytes) spurious retransmit (rtt:%u min-rtt:%u)\n"
+			, static_cast<void*>(this), seq_nr, p->size - p->header_size
+			, rtt / 1000, m_min_rtt / 1000);
+
+		// the tail loss probe isn't expected to repair anything
+		if (!m_tlp_sent || seq_nr != m_tlp_seq_nr)
+		{
+			m_sm.inc_stats_counter(counters::utp_spurious_retransmit);
+			if (m_sm.rack())
+			{
+				if (m_reo_wnd_mult < 16) ++m_reo_wnd_mult;
+				if (m_undo_retrans > 0 && --m_undo_retrans == 0) m_cc->undo();
+			}
+		}
+		if (compare_less_wrap(m_rack_seq_nr, seq_nr, ACK_MASK))
+			m_rack_seq_nr = seq_nr;
+		release_packet(std::move(p));
+		return std::numeric_limits<std::uint32_t>::max();
+	}
+
+	if (p->num_transmissions == 1)
+	{
+		m_min_rtt = std::min(m_min_rtt, rtt);
+		if (compare_less_wrap(seq_nr, m_rack_seq_nr, ACK_MASK))
+			m_reordering_seen = true;
+	}
+
+	// for a retransmitted packet, we can't tell which transmission was
+	// acknowledged unless the RTT is plausible for the last one
+	if (p->send_time > m_rack_send_time
+		&& (p->num_transmissions == 1 || rtt >= m_min_rtt))
+	{
+		m_rack_send_time = p->send_time;
+		m_rack_rtt = rtt;
+	}
+	if (compare_less_wrap(m_rack_seq_nr, seq_nr, ACK_MASK))
+		m_rack_seq_nr = seq_nr;
+
 	UTP_LOGV("%8p: acked packet %d (%d bytes) (rtt:%u)\n"
 		, static_cast<void*>(this), seq_nr, p->size - p->header_size, rtt / 1000);
 
@@ -2466,7 +2701,7 @@ void utp_socket_impl::init_mtu(int const mtu)
 
 	// if the window size is smaller than one packet size
 	// set it to one
-	if ((m_cwnd >> 16) < m_mtu) m_cwnd = std::int64_t(m_mtu) * (1 << 16);
+	m_cc->clamp_window(m_mtu);
 
 	UTP_LOGV("%8p: initializing MTU to: %d [%d, %d]\n"
 		, static_cast<void*>(this), m_mtu, m_mtu_floor, m_mtu_ceiling);
@@ -2517,8 +2752,10 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 
 	if (state() == state_t::none && ph->get_type() == ST_SYN)
 	{
+		m_sm.unindex_socket(this);
 		m_remote_address = ep.address();
 		m_port = ep.port();
+		m_sm.index_socket(this);
 	}
 
 	if (state() != state_t::none && ph->get_type() == ST_SYN)
@@ -2767,7 +3004,8 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 		, static_cast<void*>(this), packet_timeout());
 
 	if (m_duplicate_acks >= dup_ack_limit
-		&& ((m_acked_seq_nr + 1) & ACK_MASK) == m_fast_resend_seq_nr)
+		&& ((m_acked_seq_nr + 1) & ACK_MASK) == m_fast_resend_seq_nr
+		&& !(m_sm.rack() && m_reordering_seen))
 	{
 		// LOSS
 
@@ -2790,6 +3028,14 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 		}
 	}
 
+	if (m_sm.rack() && state() != state_t::error_wait && state() != state_t::deleting)
+	{
+		// new data was acknowledged, the probe (if any) did its job
+		if (acked_bytes > 0) m_tlp_sent = false;
+		detect_lost_packets(receive_time);
+		arm_tail_loss_probe(receive_time);
+	}
+
 	// ptr points to the payload of the packet
 	// size is the packet size, payload is the
 	// number of payload bytes are in this packet
@@ -2872,6 +3118,7 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 				m_seq_nr = std::uint16_t(random(0xffff));
 				m_acked_seq_nr = (m_seq_nr - 1) & ACK_MASK;
 				m_loss_seq_nr = m_acked_seq_nr;
+				m_rack_seq_nr = m_acked_seq_nr;
 				m_fast_resend_seq_nr = m_seq_nr;
 
 #if TORRENT_UTP_LOG
@@ -2950,7 +3197,8 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 				// sure to clamp it as a sanity check
 				if (delay > min_rtt) delay = min_rtt;
 
-				do_ledbat(acked_bytes, int(delay), prev_bytes_in_flight);
+				congestion_control(acked_bytes, int(delay), prev_bytes_in_flight
+					, min_rtt, receive_time);
 				m_send_delay = std::int32_t(delay);
 			}
 
@@ -3056,7 +3304,7 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 					, delay / 1000.0
 					, their_delay / 1000.0
 					, int(m_sm.target_delay() - delay) / 1000.0
-					, std::uint32_t(m_cwnd >> 16)
+					, std::uint32_t(m_cc->window())
 					, 0
 					, our_delay_base
 					, (delay + their_delay) / 1000.0
@@ -3065,7 +3313,7 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 					, m_bytes_in_flight
 					, 0.0 // float(scaled_gain)
 					, m_rtt.mean()
-					, int((m_cwnd * 1000 / (m_rtt.mean()?m_rtt.mean():50)) >> 16)
+					, int(std::int64_t(m_cc->window()) * 1000 / (m_rtt.mean()?m_rtt.mean():50))
 					, 0
 					, m_adv_wnd
 					, packet_timeout()
@@ -3082,7 +3330,7 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 					, m_write_buffer_size
 					, m_read_buffer_size
 					, m_fast_resend_seq_nr
-					, m_ssthres);
+					, m_cc->ssthres());
 			}
 #endif
 
@@ -3196,120 +3444,36 @@ bool utp_socket_impl::incoming_packet(span<char const> b
 	return true;
 }
 
-void utp_socket_impl::do_ledbat(const int acked_bytes, const int delay
-	, const int in_flight)
+void utp_socket_impl::congestion_control(int const acked_bytes, int const delay
+	, int const in_flight, std::uint32_t const rtt_sample, time_point const now)
 {
 	INVARIANT_CHECK;
 
-	// the portion of the in-flight bytes that were acked. This is used to make
-	// the gain factor be scaled by the rtt. The formula is applied once per
-	// rtt, or on every ACK scaled by the number of ACKs per rtt
 	TORRENT_ASSERT(in_flight > 0);
 	TORRENT_ASSERT(acked_bytes > 0);
 
-	const int target_delay = std::max(1, m_sm.target_delay());
-
-	// true if the upper layer is pushing enough data down the socket to be
-	// limited by the cwnd. If this is not the case, we should not adjust cwnd.
-	const bool cwnd_saturated = (m_bytes_in_flight + acked_bytes + m_mtu > (m_cwnd >> 16));
-
-	// all of these are fixed points with 16 bits fraction portion
-	const std::int64_t window_factor = (std::int64_t(acked_bytes) * (1 << 16)) / in_flight;
-	const std::int64_t delay_factor = (std::int64_t(target_delay - delay) * (1 << 16)) / target_delay;
-	std::int64_t scaled_gain;
-
-	if (delay >= target_delay)
-	{
-		if (m_slow_start)
-		{
-			UTP_LOGV("%8p: off_target: %d slow_start -> 0\n"
-				, static_cast<void*>(this), target_delay - delay);
-			m_ssthres = std::int32_t((m_cwnd >> 16) / 2);
-			m_slow_start = false;
-		}
-
-		m_sm.inc_stats_counter(counters::utp_samples_above_target);
-	}
-	else
-	{
-		m_sm.inc_stats_counter(counters::utp_samples_below_target);
-	}
-
-	std::int64_t const linear_gain = ((window_factor * delay_factor) >> 16)
-		* std::int64_t(m_sm.gain_factor());
-
-	// if the user is not saturating the link (i.e. not filling the
-	// congestion window), don't adjust it at all.
-	if (cwnd_saturated)
-	{
-		std::int64_t const exponential_gain = std::int64_t(acked_bytes) * (1 << 16);
-		if (m_slow_start)
-		{
-			// mimic TCP slow-start by adding the number of acked
-			// bytes to cwnd
-			if (m_ssthres != 0 && ((m_cwnd + exponential_gain) >> 16) > m_ssthres)
-			{
-				// if we would exceed the slow start threshold by growing the cwnd
-				// exponentially, don't do it, and leave slow-start mode. This
-				// make us avoid causing more delay and/or packet loss by being too
-				// aggressive
-				m_slow_start = false;
-				scaled_gain = linear_gain;
-				UTP_LOGV("%8p: cwnd > ssthres (%d) slow_start -> 0\n"
-					, static_cast<void*>(this), m_ssthres);
-			}
-			else
-			{
-				scaled_gain = std::max(exponential_gain, linear_gain);
-			}
-		}
-		else
-		{
-			scaled_gain = linear_gain;
-		}
-	}
-	else
-	{
-		scaled_gain = 0;
-	}
-
-	// make sure we don't wrap the cwnd
-	if (scaled_gain >= std::numeric_limits<std::int64_t>::max() - m_cwnd)
-		scaled_gain = std::numeric_limits<std::int64_t>::max() - m_cwnd - 1;
-
-	UTP_LOGV("%8p: do_ledbat delay:%d off_target: %d window_factor:%f target_factor:%f "
-		"scaled_gain:%f cwnd:%d slow_start:%d\n"
-		, static_cast<void*>(this), delay, target_delay - delay, window_factor / double(1 << 16)
-		, delay_factor / double(1 << 16)
-		, scaled_gain / double(1 << 16), int(m_cwnd >> 16)
-		, int(m_slow_start));
-
-	// don't drop below 1*MSS. This behavior is from rfc6817 (LEDBAT). This differs
-	// from BEP 29 which allows cwnd to drop to 0, however this way avoids needing
-	// to wait until the next timeout to resume sending.
-	if ((m_cwnd + scaled_gain) >> 16 < m_mtu)
-		m_cwnd = std::int64_t(m_mtu) * (1 << 16);
-	else
-		m_cwnd += scaled_gain;
-
-	TORRENT_ASSERT((m_cwnd >> 16) >= m_mtu);
-
-	int const window_size_left = std::min(int(m_cwnd >> 16), int(m_adv_wnd)) - in_flight + acked_bytes;
+	utp_ack_event e;
+	e.acked_bytes = acked_bytes;
+	e.prev_in_flight = in_flight;
+	e.in_flight = m_bytes_in_flight;
+	e.delay = delay;
+	e.rtt_sample = rtt_sample;
+	e.rtt = m_rtt.mean();
+	e.mss = m_mtu;
+	e.now = now;
+	m_cc->on_ack(e);
+
+	UTP_LOGV("%8p: congestion_control delay:%d off_target: %d cwnd:%d slow_start:%d\n"
+		, static_cast<void*>(this), delay, m_sm.target_delay() - delay
+		, m_cc->window(), int(m_cc->slow_start()));
+
+	int const window_size_left = std::min(m_cc->window(), int(m_adv_wnd)) - in_flight + acked_bytes;
 	if (window_size_left >= m_mtu)
 	{
 		UTP_LOGV("%8p: mtu:%d in_flight:%d adv_wnd:%d cwnd:%d acked_bytes:%d cwnd_full -> 0\n"
-			, static_cast<void*>(this), m_mtu, in_flight, int(m_adv_wnd), int(m_cwnd >> 16), acked_bytes);
+			, static_cast<void*>(this), m_mtu, in_flight, int(m_adv_wnd), m_cc->window(), acked_bytes);
 		m_cwnd_full = false;
 	}
-/*
-	if ((m_cwnd >> 16) >= m_adv_wnd)
-	{
-		m_slow_start = false;
-		m_ssthres = (m_cwnd >> 16);
-		UTP_LOGV("%8p: cwnd > advertised wnd (%u) slow_start -> 0\n"
-			, static_cast<void*>(this), m_adv_wnd);
-	}
-*/
 }
 
 void utp_stream::bind(endpoint_type const&, error_code&) { }
@@ -3415,38 +3579,20 @@ void utp_socket_impl::tick(time_point const now)
 
 		if (!ignore_loss)
 		{
-			// set cwnd to 1 MSS
-			if (m_bytes_in_flight == 0 && (m_cwnd >> 16) >= m_mtu)
-			{
-				// this is just a timeout because this direction of
-				// the stream is idle. Don't reset the cwnd, just decay it
-				m_cwnd = std::max(m_cwnd * 2 / 3, std::int64_t(m_mtu) * (1 << 16));
-			}
-			else
-			{
-				// we timed out because a packet was not ACKed or because
-				// the cwnd was made smaller than one packet
-				m_cwnd = std::int64_t(m_mtu) * (1 << 16);
-			}
-
-			TORRENT_ASSERT(m_cwnd >= 0);
+			// set cwnd to 1 MSS, or if this direction of the stream is
+			// idle, decay it. Either way, slow-start back up
+			m_cc->on_timeout(m_bytes_in_flight == 0, m_mtu, now);
+			m_undo_retrans = 0;
 
 			m_timeout = now + milliseconds(packet_timeout());
 
-			UTP_LOGV("%8p: resetting cwnd:%d\n"
-				, static_cast<void*>(this), int(m_cwnd >> 16));
+			UTP_LOGV("%8p: resetting cwnd:%d slow_start -> 1\n"
+				, static_cast<void*>(this), m_cc->window());
 
 			// since we've already timed out now, don't count
 			// loss that we might detect for packets that just
 			// timed out
 			m_loss_seq_nr = m_seq_nr;
-
-			// when we time out, the cwnd is reset to 1 MSS, which means we
-			// need to ramp it up quickly again. enter slow start mode. This time
-			// we're very likely to have an ssthres set, which will make us leave
-			// slow start before inducing more delay or loss.
-			m_slow_start = true;
-			UTP_LOGV("%8p: slow_start -> 1\n", static_cast<void*>(this));
 		}
 
 		// we dropped all packets, that includes the mtu probe
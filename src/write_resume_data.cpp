@@ -108,6 +108,7 @@ namespace {
 
 
 		ret["sequential_download"] = bool(atp.flags & torrent_flags::sequential_download);
+		ret["sequential_window"] = bool(atp.flags & torrent_flags::sequential_window);
 		ret["stop_when_ready"] = bool(atp.flags & torrent_flags::stop_when_ready);
 		ret["disable_lsd"] = bool(atp.flags & torrent_flags::disable_lsd);
 		ret["disable_pex"] = bool(atp.flags & torrent_flags::disable_pex);